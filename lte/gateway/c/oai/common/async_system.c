@@ -99,6 +99,41 @@ void *async_system_task(__attribute__((unused)) void *args_p)
           }
         } break;
 
+        case ASYNC_SYSTEM_BATCH: {
+          OAILOG_DEBUG(
+            LOG_ASYNC_SYSTEM,
+            "C popen() call: %s, %d bytes of input\n",
+            bdata(ASYNC_SYSTEM_BATCH(received_message_p).system_command),
+            blength(ASYNC_SYSTEM_BATCH(received_message_p).input));
+          rc = -1;
+          FILE *fp = popen(
+            bdata(ASYNC_SYSTEM_BATCH(received_message_p).system_command), "w");
+          if (fp) {
+            bstring input = ASYNC_SYSTEM_BATCH(received_message_p).input;
+            if (input) {
+              fwrite(input->data, 1, input->slen, fp);
+            }
+            rc = pclose(fp);
+          }
+          if (rc) {
+            OAILOG_ERROR(
+              LOG_ASYNC_SYSTEM,
+              "ERROR in batch command %s: %d\n",
+              bdata(ASYNC_SYSTEM_BATCH(received_message_p).system_command),
+              rc);
+          }
+          MessageDef *message_p =
+            itti_alloc_new_message(TASK_ASYNC_SYSTEM, ASYNC_SYSTEM_BATCH_RESULT);
+          AssertFatal(message_p, "itti_alloc_new_message Failed");
+          ASYNC_SYSTEM_BATCH_RESULT(message_p).batch_id =
+            ASYNC_SYSTEM_BATCH(received_message_p).batch_id;
+          ASYNC_SYSTEM_BATCH_RESULT(message_p).rc = rc;
+          itti_send_msg_to_task(
+            ITTI_MSG_ORIGIN_ID(received_message_p),
+            INSTANCE_DEFAULT,
+            message_p);
+        } break;
+
         case TERMINATE_MESSAGE: {
           async_system_exit();
           itti_exit_task();
@@ -159,6 +194,26 @@ int async_system_command(
   return rv;
 }
 
+//------------------------------------------------------------------------------
+// Runs command once with input on its standard input, for tools that apply
+// many changes in one go (iptables-restore...). The exit status is sent back
+// to sender_itti_task in an ASYNC_SYSTEM_BATCH_RESULT tagged with batch_id.
+int async_system_batch(
+  int sender_itti_task,
+  uint32_t batch_id,
+  const char *command,
+  STOLEN_REF bstring *input)
+{
+  MessageDef *message_p = NULL;
+  message_p = itti_alloc_new_message(sender_itti_task, ASYNC_SYSTEM_BATCH);
+  AssertFatal(message_p, "itti_alloc_new_message Failed");
+  ASYNC_SYSTEM_BATCH(message_p).system_command = bfromcstr(command);
+  ASYNC_SYSTEM_BATCH(message_p).input = *input;
+  ASYNC_SYSTEM_BATCH(message_p).batch_id = batch_id;
+  *input = NULL;
+  return itti_send_msg_to_task(TASK_ASYNC_SYSTEM, INSTANCE_DEFAULT, message_p);
+}
+
 //------------------------------------------------------------------------------
 void async_system_exit(void)
 {
@@ -39,11 +39,19 @@
 #ifndef FILE_ASYNC_SYSTEM_SEEN
 #define FILE_ASYNC_SYSTEM_SEEN
 
+#include "bstrlib.h"
+#include "common_defs.h"
+
 int async_system_init(void);
 int async_system_command(
   int sender_itti_task,
   bool is_abort_on_error,
   char *format,
   ...);
+int async_system_batch(
+  int sender_itti_task,
+  uint32_t batch_id,
+  const char *command,
+  STOLEN_REF bstring *input);
 
 #endif /* FILE_SHARED_TS_LOG_SEEN */
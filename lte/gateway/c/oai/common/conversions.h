@@ -235,6 +235,27 @@
     OCTET_STRING_fromBuf(tBCDsTRING, _buf, 3);                                 \
   } while (0)
 
+/* The 3 octet TBCD encoding of a PLMN as one integer, to use it as a key */
+#define MCC_MNC_TO_PLMN_KEY(mCC, mNC, mNCdIGITlENGTH)                          \
+  ((((uint32_t)((MCC_MNC_DECIMAL(mCC) << 4) | MCC_HUNDREDS(mCC))) << 16) |     \
+   (((uint32_t)(                                                               \
+      (MNC_HUNDREDS(mNC, mNCdIGITlENGTH) << 4) | MCC_MNC_DIGIT(mCC)))          \
+    << 8) |                                                                    \
+   ((uint32_t)((MCC_MNC_DIGIT(mNC) << 4) | MCC_MNC_DECIMAL(mNC))))
+
+#define TBCD_TO_PLMN_KEY(tBCDsTRING)                                           \
+  ((((uint32_t)(tBCDsTRING)->buf[0]) << 16) |                                  \
+   (((uint32_t)(tBCDsTRING)->buf[1]) << 8) | ((uint32_t)(tBCDsTRING)->buf[2]))
+
+#define PLMN_KEY_TO_PLMNID(pLMNkEY, oCTETsTRING)                               \
+  do {                                                                         \
+    (oCTETsTRING)->buf = calloc(3, sizeof(uint8_t));                           \
+    (oCTETsTRING)->buf[0] = (uint8_t)((pLMNkEY) >> 16);                        \
+    (oCTETsTRING)->buf[1] = (uint8_t)((pLMNkEY) >> 8);                         \
+    (oCTETsTRING)->buf[2] = (uint8_t)(pLMNkEY);                                \
+    (oCTETsTRING)->size = 3;                                                   \
+  } while (0)
+
 #define TBCD_TO_MCC_MNC(tBCDsTRING, mCC, mNC, mNCdIGITlENGTH)                  \
   do {                                                                         \
     int mNC_hundred;                                                           \
@@ -41,10 +41,14 @@
  * Intertask Interface Constants
  ******************************************************************************/
 
-#define ITTI_PORT (10007)
-
 /* This is the queue size for signal dumper */
 #define ITTI_QUEUE_MAX_ELEMENTS (64 * 1024)
-#define ITTI_DUMP_MAX_CON (5) /* Max connections in parallel */
+
+/* Memory the message pools may grow to before messages come from the heap */
+#define ITTI_MEMORY_POOLS_DEFAULT_LIMIT_MB (256)
+
+/* Messages kept per thread by the ITTI trace, and where it is dumped */
+#define ITTI_TRACE_DEFAULT_RECORDS (8192)
+#define ITTI_TRACE_DEFAULT_FILE "/var/log/mme_itti_trace.bin"
 
 #endif /* FILE_INTERTASK_INTERFACE_CONF_SEEN */
@@ -57,12 +57,20 @@ void itti_free_msg_content(MessageDef *const message_p)
       }
     } break;
 
+    case ASYNC_SYSTEM_BATCH: {
+      bdestroy_wrapper(&ASYNC_SYSTEM_BATCH(message_p).system_command);
+      bdestroy_wrapper(&ASYNC_SYSTEM_BATCH(message_p).input);
+    } break;
+
+    case ASYNC_SYSTEM_BATCH_RESULT: break;
+
     case GTPV1U_CREATE_TUNNEL_REQ:
     case GTPV1U_CREATE_TUNNEL_RESP:
     case GTPV1U_UPDATE_TUNNEL_REQ:
     case GTPV1U_UPDATE_TUNNEL_RESP:
     case GTPV1U_DELETE_TUNNEL_REQ:
     case GTPV1U_DELETE_TUNNEL_RESP:
+    case GTPV1U_TUNNEL_FAILURE_IND:
       // DO nothing
       break;
 
@@ -55,6 +55,10 @@
 
 #define S6A_CONF_FILE "../S6A/freediameter/s6a.conf"
 
+#define AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS (16384)
+#define AUTH_VECTOR_CACHE_TTL_S (600) ///< Lifetime of cached auth vectors (s)
+#define AUTH_VECTOR_PREFETCH_TIMEOUT_S (10) ///< Wait for prefetch answer (s)
+
 /*******************************************************************************
  * SCTP Constants
  ******************************************************************************/
@@ -63,6 +67,8 @@
 #define SCTP_OUT_STREAMS (32)
 #define SCTP_IN_STREAMS (32)
 #define SCTP_MAX_ATTEMPTS (5)
+// Messages queued per association while its socket is not writable
+#define SCTP_MAX_SEND_QUEUE_DEPTH (1024)
 
 /*******************************************************************************
  * MME global definitions
@@ -40,3 +40,13 @@ MESSAGE_DEF(
   MESSAGE_PRIORITY_MED,
   itti_async_system_command_t,
   async_system_command)
+MESSAGE_DEF(
+  ASYNC_SYSTEM_BATCH,
+  MESSAGE_PRIORITY_MED,
+  itti_async_system_batch_t,
+  async_system_batch)
+MESSAGE_DEF(
+  ASYNC_SYSTEM_BATCH_RESULT,
+  MESSAGE_PRIORITY_MED,
+  itti_async_system_batch_result_t,
+  async_system_batch_result)
@@ -38,10 +38,26 @@
 #define FILE_ASYNC_SYSTEM_MESSAGES_TYPES_SEEN
 
 #define ASYNC_SYSTEM_COMMAND(mSGpTR) (mSGpTR)->ittiMsg.async_system_command
+#define ASYNC_SYSTEM_BATCH(mSGpTR) (mSGpTR)->ittiMsg.async_system_batch
+#define ASYNC_SYSTEM_BATCH_RESULT(mSGpTR)                                      \
+  (mSGpTR)->ittiMsg.async_system_batch_result
 
 typedef struct itti_async_system_command_s {
   bstring system_command;
   bool is_abort_on_error;
 } itti_async_system_command_t;
 
+// Runs system_command once, with input written to its standard input
+typedef struct itti_async_system_batch_s {
+  bstring system_command;
+  bstring input;
+  uint32_t batch_id;
+} itti_async_system_batch_t;
+
+// Sent back to the task that requested the batch
+typedef struct itti_async_system_batch_result_s {
+  uint32_t batch_id;
+  int rc; // exit status of the command, 0 on success
+} itti_async_system_batch_result_t;
+
 #endif /* FILE_ASYNC_SYSTEM_MESSAGES_TYPES_SEEN */
@@ -62,6 +62,11 @@ MESSAGE_DEF(
   MESSAGE_PRIORITY_MED,
   Gtpv1uDeleteTunnelResp,
   gtpv1uDeleteTunnelResp)
+MESSAGE_DEF(
+  GTPV1U_TUNNEL_FAILURE_IND,
+  MESSAGE_PRIORITY_MED,
+  Gtpv1uTunnelFailureInd,
+  gtpv1uTunnelFailureInd)
 MESSAGE_DEF(
   GTPV1U_TUNNEL_DATA_IND,
   MESSAGE_PRIORITY_MED,
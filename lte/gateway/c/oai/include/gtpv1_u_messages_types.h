@@ -79,6 +79,15 @@ typedef struct Gtpv1uDeleteTunnelResp_s {
   teid_t S1u_teid;     ///< local S1U Tunnel Endpoint Identifier to be deleted
 } Gtpv1uDeleteTunnelResp;
 
+// Sent to the SGW when the datapath rejects a tunnel change after the change
+// was queued, as batched tunnel changes are only acked later
+typedef struct Gtpv1uTunnelFailureInd_s {
+  bool is_delete;      ///< The change deleted the tunnel, else it added it
+  teid_t sgw_S1u_teid; ///< SGW S1U local Tunnel Endpoint Identifier
+  teid_t enb_S1u_teid; ///< eNB S1U Tunnel Endpoint Identifier
+  int error;           ///< errno reported by the datapath
+} Gtpv1uTunnelFailureInd;
+
 typedef struct Gtpv1uTunnelDataInd_s {
   uint8_t *buffer;
   uint32_t length;
@@ -38,6 +38,7 @@
 
 #include <pthread.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <arpa/inet.h>
 #include <stdlib.h>
 #include "mme_default_values.h"
@@ -82,6 +83,13 @@
 
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_CONFIG "INTERTASK_INTERFACE"
 #define MME_CONFIG_STRING_INTERTASK_INTERFACE_QUEUE_SIZE "ITTI_QUEUE_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_MEMORY_LIMIT                \
+  "ITTI_POOL_MEMORY_LIMIT_MB"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_RECORDS                    \
+  "ITTI_TRACE_RECORDS"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_PAYLOAD_SIZE               \
+  "ITTI_TRACE_PAYLOAD_SIZE"
+#define MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_FILE "ITTI_TRACE_FILE"
 
 #define MME_CONFIG_STRING_S6A_CONFIG "S6A"
 #define MME_CONFIG_STRING_S6A_CONF_FILE_PATH "S6A_CONF"
@@ -177,6 +185,12 @@ typedef struct served_tai_s {
     uint16_t *plmn_mnc;
     uint16_t *plmn_mnc_len;
     uint16_t *tac;
+
+    /* Sorted lookup tables built from the lists above, without duplicates */
+    uint8_t nb_plmn_keys;
+    uint32_t *plmn_keys; // MCC_MNC_TO_PLMN_KEY of each served PLMN
+    uint8_t nb_tacs;
+    uint16_t *tacs;
 } served_tai_t;
 
 typedef struct sctp_config_s {
@@ -207,6 +221,10 @@ typedef struct s6a_config_s {
 
 typedef struct itti_config_s {
     uint32_t queue_size;
+    uint32_t pool_memory_limit_mb;
+    uint32_t trace_records;
+    uint32_t trace_payload_size;
+    bstring trace_file;
     bstring log_file;
 } itti_config_t;
 
@@ -249,10 +267,12 @@ typedef struct gummei_config_s {
   gummei_t gummei[MAX_GUMMEI];
 } gummei_config_t;
 
+/*
+ * The MME configuration is only written by mme_config_parse_opt_line, before
+ * the ITTI tasks are started. It is read-only afterwards, so tasks read it
+ * without taking any lock.
+ */
 typedef struct mme_config_s {
-  /* Reader/writer lock for this configuration */
-  pthread_rwlock_t rw_lock;
-
   bstring config_file;
   bstring pid_dir;
   bstring realm;
@@ -312,11 +332,14 @@ void mme_config_display(mme_config_t *);
 
 void mme_config_exit(void);
 
-#define mme_config_read_lock(mMEcONFIG)                                        \
-  pthread_rwlock_rdlock(&(mMEcONFIG)->rw_lock)
-#define mme_config_write_lock(mMEcONFIG)                                       \
-  pthread_rwlock_wrlock(&(mMEcONFIG)->rw_lock)
-#define mme_config_unlock(mMEcONFIG)                                           \
-  pthread_rwlock_unlock(&(mMEcONFIG)->rw_lock)
+/*
+ * Build the lookup tables of served_tai, once its lists are final. The
+ * lookups below are binary searches in them
+ */
+void mme_config_build_served_tai_lookup(served_tai_t *served_tai);
+bool mme_config_is_served_plmn(
+  const served_tai_t *served_tai,
+  uint32_t plmn_key);
+bool mme_config_is_served_tac(const served_tai_t *served_tai, uint16_t tac);
 
 #endif /* FILE_MME_CONFIG_SEEN */
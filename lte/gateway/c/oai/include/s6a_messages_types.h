@@ -99,6 +99,10 @@ typedef struct s6a_auth_info_req_s {
    * Only present and interpreted if re_synchronization == 1.
    */
   uint8_t resync_param[RAND_LENGTH_OCTETS + AUTS_LENGTH];
+  /* Vectors are requested for the auth vector cache, not for a UE context.
+   * Echoed back in the answer.
+   */
+  unsigned is_prefetch : 1;
 } s6a_auth_info_req_t;
 
 typedef struct s6a_auth_info_ans_s {
@@ -109,6 +113,8 @@ typedef struct s6a_auth_info_ans_s {
   s6a_result_t result;
   /* Authentication info containing the vector(s) */
   authentication_info_t auth_info;
+  /* Answer to a request with is_prefetch set */
+  unsigned is_prefetch : 1;
 } s6a_auth_info_ans_t;
 
 typedef struct s6a_cancel_location_req_s {
@@ -66,8 +66,13 @@ int decode_supported_codec_list(
   uint8_t ielen = 0;
 
   if (iei_present) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, SUPPORTED_CODEC_LIST_IE_MIN_LENGTH, len);
     CHECK_IEI_DECODER(CC_SUPPORTED_CODEC_LIST_IE, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (SUPPORTED_CODEC_LIST_IE_MIN_LENGTH - 1), len);
   }
 
   ielen = *(buffer + decoded);
@@ -172,7 +172,10 @@ int decode_p_tmsi_signature_ie(
       buffer, (P_TMSI_SIGNATURE_IE_MAX_LENGTH - 1), len);
   }
 
-  IES_DECODE_U32(buffer, decoded, *ptmsisignature);
+  // the value is 3 octets long
+  *ptmsisignature = (*(buffer + decoded) << 16) |
+                    (*(buffer + decoded + 1) << 8) | *(buffer + decoded + 2);
+  decoded += 3;
   return decoded;
 }
 
@@ -195,7 +198,10 @@ int encode_p_tmsi_signature_ie(
       buffer, (P_TMSI_SIGNATURE_IE_MAX_LENGTH - 1), len);
   }
 
-  IES_ENCODE_U32(buffer, encoded, ptmsisignature);
+  *(buffer + encoded) = (ptmsisignature >> 16) & 0xff;
+  *(buffer + encoded + 1) = (ptmsisignature >> 8) & 0xff;
+  *(buffer + encoded + 2) = ptmsisignature & 0xff;
+  encoded += 3;
   return encoded;
 }
 
@@ -440,9 +446,16 @@ int decode_voice_domain_preference_and_ue_usage_setting(
   uint8_t ielen = 0;
 
   if (iei_present) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(
       GMM_VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_IEI, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer,
+      (VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_MINIMUM_LENGTH - 1),
+      len);
   }
 
   memset(
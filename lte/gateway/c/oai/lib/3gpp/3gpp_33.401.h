@@ -64,4 +64,11 @@
  */
 #define MAX_EPS_AUTH_VECTORS 1
 
+/* Number of EPS authentication vectors requested in one Authentication
+ * Information Request, TS 29.272 allows up to 5. Vectors beyond the
+ * MAX_EPS_AUTH_VECTORS used by the UE context are kept in the MME's
+ * authentication vector cache for later authentications of the subscriber.
+ */
+#define MAX_EPS_AUTH_VECTORS_PER_AIR 5
+
 #endif /* FILE_3GPP_33_401_SEEN */
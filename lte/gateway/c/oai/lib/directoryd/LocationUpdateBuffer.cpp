@@ -0,0 +1,81 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include "LocationUpdateBuffer.h"
+
+namespace magma {
+
+LocationUpdateBuffer::LocationUpdateBuffer(size_t max_pending):
+  max_pending_(max_pending)
+{
+}
+
+bool LocationUpdateBuffer::add_update(
+  table_id_t table,
+  const std::string &id,
+  const std::string &location)
+{
+  return add(LocationUpdate {table, id, false, location});
+}
+
+bool LocationUpdateBuffer::add_delete(table_id_t table, const std::string &id)
+{
+  return add(LocationUpdate {table, id, true, ""});
+}
+
+bool LocationUpdateBuffer::add(LocationUpdate update)
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto key = std::make_pair(update.table, update.id);
+  auto it = pending_.find(key);
+  if (it != pending_.end()) {
+    it->second = std::move(update);
+    return true;
+  }
+  if (pending_.size() >= max_pending_) {
+    return false;
+  }
+  pending_.emplace(std::move(key), std::move(update));
+  return true;
+}
+
+std::vector<LocationUpdate> LocationUpdateBuffer::take_all()
+{
+  std::map<std::pair<table_id_t, std::string>, LocationUpdate> pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending.swap(pending_);
+  }
+  std::vector<LocationUpdate> updates;
+  updates.reserve(pending.size());
+  for (auto &entry : pending) {
+    updates.push_back(std::move(entry.second));
+  }
+  return updates;
+}
+
+size_t LocationUpdateBuffer::size()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+} // namespace magma
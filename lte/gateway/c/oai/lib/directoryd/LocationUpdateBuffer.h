@@ -0,0 +1,85 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "directoryd.h"
+
+namespace magma {
+
+/**
+ * A location change waiting to be sent to directoryd
+ */
+struct LocationUpdate {
+  table_id_t table;
+  std::string id;
+  bool is_delete;
+  std::string location; // unused for deletes
+};
+
+/**
+ * LocationUpdateBuffer keeps the last location change of each record until
+ * it is taken to be sent. A later change of a record replaces the pending
+ * one: a detach and re-attach only leave the update, an update followed by
+ * a detach only leaves the delete. It is thread safe.
+ */
+class LocationUpdateBuffer {
+ public:
+  explicit LocationUpdateBuffer(size_t max_pending);
+
+  /**
+   * Buffer a location update. Returns false if the change was dropped
+   * because max_pending other records already have pending changes
+   */
+  bool add_update(
+    table_id_t table,
+    const std::string &id,
+    const std::string &location);
+
+  /**
+   * Buffer a location delete, same as add_update
+   */
+  bool add_delete(table_id_t table, const std::string &id);
+
+  /**
+   * Remove and return all pending changes
+   */
+  std::vector<LocationUpdate> take_all();
+
+  size_t size();
+
+ private:
+  bool add(LocationUpdate update);
+
+ private:
+  const size_t max_pending_;
+  std::mutex mutex_;
+  std::map<std::pair<table_id_t, std::string>, LocationUpdate> pending_;
+};
+
+} // namespace magma
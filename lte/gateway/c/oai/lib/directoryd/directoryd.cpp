@@ -19,47 +19,157 @@
  *      contact@openairinterface.org
  */
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 #include <string>
 #include <thread>
 
 #include "DirectorydClient.h"
+#include "LocationUpdateBuffer.h"
 #include "directoryd.h"
+#include "service303.h"
+
+// Location changes are sent to directoryd at most this often
+#define DIRECTORYD_FLUSH_INTERVAL_MS 100
+// Records with a pending change, further records are dropped
+#define DIRECTORYD_MAX_PENDING_UPDATES 65536
 
 static void directoryd_rpc_call_done(const grpc::Status &status);
 
+static magma::LocationUpdateBuffer pending_updates(
+  DIRECTORYD_MAX_PENDING_UPDATES);
+
+static void directoryd_send_updates(void)
+{
+  auto updates = pending_updates.take_all();
+  set_gauge("directoryd_pending_updates", pending_updates.size(), NO_LABELS);
+  for (const auto &update : updates) {
+    if (update.is_delete) {
+      magma::DirectoryServiceClient::DeleteLocation(
+        static_cast<magma::TableID>(update.table),
+        update.id,
+        [&](grpc::Status status, magma::Void response) {
+          directoryd_rpc_call_done(status);
+        });
+    } else {
+      magma::DirectoryServiceClient::UpdateLocation(
+        static_cast<magma::TableID>(update.table),
+        update.id,
+        update.location,
+        [&](grpc::Status status, magma::Void response) {
+          directoryd_rpc_call_done(status);
+        });
+    }
+  }
+}
+
+/*
+ * Sends the buffered location changes every DIRECTORYD_FLUSH_INTERVAL_MS
+ * from its own thread. The thread is joined by directoryd_stop, or at the
+ * latest when the flusher is destroyed at exit, before pending_updates is.
+ * Stopping does not send anything, since the gRPC client may already be
+ * destroyed at exit
+ */
+class DirectorydFlusher {
+ public:
+  ~DirectorydFlusher() { stop(); }
+
+  void start()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable() || stopped_) {
+      return;
+    }
+    thread_ = std::thread([this]() { run(); });
+  }
+
+  void stop()
+  {
+    std::thread thread;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+      thread.swap(thread_);
+    }
+    cv_.notify_one();
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+
+ private:
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait_for(
+        lock,
+        std::chrono::milliseconds(DIRECTORYD_FLUSH_INTERVAL_MS),
+        [this]() { return stopped_; });
+      if (stopped_) {
+        return;
+      }
+      lock.unlock();
+      directoryd_send_updates();
+      lock.lock();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stopped_ = false;
+  std::thread thread_;
+};
+
+static DirectorydFlusher flusher;
+
+/*
+ * Location changes are buffered, so that changes of a UE superseded within
+ * a flush interval are never sent, and the RPCs of a burst of attaches are
+ * sent together by a single thread
+ */
+static void directoryd_buffer_update(
+  table_id_t table,
+  const std::string &id,
+  const std::string *location)
+{
+  flusher.start();
+
+  bool is_buffered = location ?
+                       pending_updates.add_update(table, id, *location) :
+                       pending_updates.add_delete(table, id);
+  if (!is_buffered) {
+    increment_counter("directoryd_updates_dropped", 1, NO_LABELS);
+  }
+  set_gauge("directoryd_pending_updates", pending_updates.size(), NO_LABELS);
+}
+
+void directoryd_stop(void)
+{
+  flusher.stop();
+  // send the changes buffered since the last flush
+  directoryd_send_updates();
+}
+
 bool directoryd_report_location(table_id_t table, char *imsi)
 {
   // Actual GW_ID will be filled in the cloud
-  magma::DirectoryServiceClient::UpdateLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    std::string("GW_ID"),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  std::string location("GW_ID");
+  directoryd_buffer_update(table, "IMSI" + std::string(imsi), &location);
   return true;
 }
 
 bool directoryd_remove_location(table_id_t table, char *imsi)
 {
-  magma::DirectoryServiceClient::DeleteLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  directoryd_buffer_update(table, "IMSI" + std::string(imsi), nullptr);
   return true;
 }
 
 bool directoryd_update_location(table_id_t table, char *imsi, char *location)
 {
-  magma::DirectoryServiceClient::UpdateLocation(
-    static_cast<magma::TableID>(table),
-    "IMSI" + std::string(imsi),
-    std::string(location),
-    [&](grpc::Status status, magma::Void response) {
-      directoryd_rpc_call_done(status);
-    });
+  std::string location_str(location);
+  directoryd_buffer_update(table, "IMSI" + std::string(imsi), &location_str);
   return true;
 }
 
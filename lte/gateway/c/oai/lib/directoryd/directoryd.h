@@ -41,6 +41,12 @@ bool directoryd_remove_location(table_id_t table, char *imsi);
 
 bool directoryd_update_location(table_id_t table, char *imsi, char *location);
 
+/*
+ * Send the buffered location changes and stop the thread sending them.
+ * Changes reported afterwards are no longer sent
+ */
+void directoryd_stop(void);
+
 #ifdef __cplusplus
 }
 #endif
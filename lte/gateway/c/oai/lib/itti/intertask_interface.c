@@ -45,7 +45,7 @@
 
 #include "assertions.h"
 #include "intertask_interface.h"
-#include "intertask_interface_dump.h"
+#include "itti_trace.h"
 
 #include "memory_pools.h"
 
@@ -236,6 +236,53 @@ int itti_free(task_id_t task_id, void *ptr)
   return (result);
 }
 
+void itti_set_memory_pools_limit(uint32_t limit_mb)
+{
+  memory_pools_set_memory_limit(
+    itti_desc.memory_pools_handle, (uint64_t) limit_mb * 1024 * 1024);
+}
+
+int itti_start_trace(
+  uint32_t nb_records,
+  uint32_t payload_size,
+  const char *file_name)
+{
+  const char **task_names = NULL;
+  const char **message_names = NULL;
+
+  if (nb_records == 0) {
+    return 0;
+  }
+  task_names = calloc(itti_desc.task_max, sizeof(char *));
+  message_names = calloc(itti_desc.messages_id_max, sizeof(char *));
+  for (task_id_t task_id = 0; task_id < itti_desc.task_max; task_id++) {
+    task_names[task_id] = itti_desc.tasks_info[task_id].name;
+  }
+  for (MessagesIds message_id = 0; message_id < itti_desc.messages_id_max;
+       message_id++) {
+    message_names[message_id] = itti_desc.messages_info[message_id].name;
+  }
+  // the name tables live as long as the trace
+  return itti_trace_init(
+    nb_records,
+    payload_size,
+    file_name,
+    itti_desc.task_max,
+    task_names,
+    itti_desc.messages_id_max,
+    message_names);
+}
+
+bool itti_memory_pressure(void)
+{
+  return memory_pools_under_pressure(itti_desc.memory_pools_handle);
+}
+
+memory_pools_handle_t itti_get_memory_pools(void)
+{
+  return itti_desc.memory_pools_handle;
+}
+
 static inline message_number_t itti_increment_message_number(void)
 {
   /*
@@ -459,6 +506,14 @@ int itti_send_msg_to_task(
         itti_get_task_name(origin_task_id),
         destination_task_id,
         itti_get_task_name(destination_task_id));
+      itti_trace_message(
+        ITTI_TRACE_DROP,
+        message_number,
+        message_id,
+        origin_task_id,
+        destination_task_id,
+        message->ittiMsgHeader.ittiMsgSize,
+        &message->ittiMsg);
       itti_free(
         origin_task_id,
         message); // In case of issues free the memory allocated for message
@@ -486,6 +541,17 @@ int itti_send_msg_to_task(
       new->msg = message;
       new->message_number = message_number;
       new->message_priority = priority;
+      /*
+       * Record the message before the destination task may free it
+       */
+      itti_trace_message(
+        ITTI_TRACE_SEND,
+        message_number,
+        message_id,
+        origin_task_id,
+        destination_task_id,
+        message->ittiMsgHeader.ittiMsgSize,
+        &message->ittiMsg);
       /*
        * Enqueue message in destination task queue
        */
@@ -640,6 +706,20 @@ int itti_get_events(task_id_t task_id, struct epoll_event **events)
   return itti_desc.threads[thread_id].epoll_nb_events;
 }
 
+static inline void itti_trace_received(
+  task_id_t task_id,
+  const message_list_t *message)
+{
+  itti_trace_message(
+    ITTI_TRACE_RECEIVE,
+    message->message_number,
+    ITTI_MSG_ID(message->msg),
+    ITTI_MSG_ORIGIN_ID(message->msg),
+    task_id,
+    message->msg->ittiMsgHeader.ittiMsgSize,
+    &message->msg->ittiMsg);
+}
+
 static inline void itti_receive_msg_internal_event_fd(
   task_id_t task_id,
   uint8_t polling,
@@ -741,6 +821,7 @@ static inline void itti_receive_msg_internal_event_fd(
 
       AssertFatal(message != NULL, "Message from message queue is NULL!\n");
       *received_msg = message->msg;
+      itti_trace_received(task_id, message);
       result = itti_free(ITTI_MSG_ORIGIN_ID(message->msg), message);
       AssertFatal(
         result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
@@ -764,6 +845,11 @@ void itti_receive_msg(task_id_t task_id, MessageDef **received_msg)
     __sync_or_and_fetch(&itti_desc.vcd_receive_msg, 1L << task_id));
 }
 
+void itti_try_receive_msg(task_id_t task_id, MessageDef **received_msg)
+{
+  itti_receive_msg_internal_event_fd(task_id, 1, received_msg);
+}
+
 void itti_poll_msg(task_id_t task_id, MessageDef **received_msg)
 {
   AssertFatal(
@@ -785,6 +871,7 @@ void itti_poll_msg(task_id_t task_id, MessageDef **received_msg)
       int result;
 
       *received_msg = message->msg;
+      itti_trace_received(task_id, message);
       result = itti_free(ITTI_MSG_ORIGIN_ID(*received_msg), message);
       AssertFatal(
         result == EXIT_SUCCESS, "Failed to free memory (%d)!\n", result);
@@ -959,9 +1046,7 @@ int itti_init(
   thread_id_t thread_max,
   MessagesIds messages_id_max,
   const task_info_t *tasks_info,
-  const message_info_t *messages_info,
-  const char *const messages_definition_xml,
-  const char *const dump_file_name)
+  const message_info_t *messages_info)
 {
   task_id_t task_id;
   thread_id_t thread_id;
@@ -1094,6 +1179,7 @@ int itti_init(
   memory_pools_add_pool(itti_desc.memory_pools_handle, 10000, 1000);
   memory_pools_add_pool(itti_desc.memory_pools_handle, 400, 20050);
   memory_pools_add_pool(itti_desc.memory_pools_handle, 100, 30050);
+  itti_set_memory_pools_limit(ITTI_MEMORY_POOLS_DEFAULT_LIMIT_MB);
   {
     char *statistics = memory_pools_statistics(itti_desc.memory_pools_handle);
 
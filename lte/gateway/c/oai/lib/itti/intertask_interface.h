@@ -40,9 +40,11 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "intertask_interface_conf.h"
 #include "intertask_interface_types.h"
+#include "memory_pools.h"
 
 #define ITTI_MSG_ID(mSGpTR) ((mSGpTR)->ittiMsgHeader.messageId)
 #define ITTI_MSG_ORIGIN_ID(mSGpTR) ((mSGpTR)->ittiMsgHeader.originTaskId)
@@ -148,6 +150,13 @@ int itti_get_events(task_id_t task_id, struct epoll_event **events);
  **/
 void itti_receive_msg(task_id_t task_id, MessageDef **received_msg);
 
+/** \brief Retrieves a message in the queue associated to task_id, without
+ * blocking. Unlike itti_poll_msg, it can be mixed with itti_receive_msg.
+ \param task_id Task ID of the receiving task
+ \param received_msg Pointer to the allocated message, NULL if none is queued
+ **/
+void itti_try_receive_msg(task_id_t task_id, MessageDef **received_msg);
+
 /** \brief Try to retrieves a message in the queue associated to task_id.
  \param task_id Task ID of the receiving task
  \param received_msg Pointer to the allocated message
@@ -238,5 +247,35 @@ void *itti_malloc(
 
 int itti_free(task_id_t task_id, void *ptr);
 
+/** \brief Limit the memory the message pools may grow to. Allocating a
+ * message that doesn't fit under the limit is fatal, so tasks must shed load
+ * once itti_memory_pressure() returns true.
+ * \param limit_mb limit in megabytes, 0 for no limit
+ **/
+void itti_set_memory_pools_limit(uint32_t limit_mb);
+
+/** \brief Start recording the messages exchanged between tasks in per thread
+ * rings, see itti_trace.h. The trace is written to file_name on SIGUSR2 and
+ * when the process exits with a failure.
+ * \param nb_records records kept per thread, 0 to disable the trace
+ * \param payload_size bytes of each message payload kept in the trace
+ * \param file_name file the trace is dumped to
+ * @returns -1 on failure, 0 otherwise
+ **/
+int itti_start_trace(
+  uint32_t nb_records,
+  uint32_t payload_size,
+  const char *file_name);
+
+/** \brief Indicates whether the message pools are close to their limit. Tasks
+ * should refuse new procedures while it returns true.
+ **/
+bool itti_memory_pressure(void);
+
+/** \brief Return the memory pools messages are allocated from, to read their
+ * statistics
+ **/
+memory_pools_handle_t itti_get_memory_pools(void);
+
 #endif /* INTERTASK_INTERFACE_H_ */
 /* @} */
@@ -82,9 +82,7 @@ int itti_init(
   thread_id_t thread_max,
   MessagesIds messages_id_max,
   const task_info_t *tasks_info,
-  const message_info_t *messages_info,
-  const char *const messages_definition_xml,
-  const char *const dump_file_name);
+  const message_info_t *messages_info);
 
 #endif /* INTERTASK_INTERFACE_INIT_H_ */
 /* @} */
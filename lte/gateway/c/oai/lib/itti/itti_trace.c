@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+#define _GNU_SOURCE // required for pthread_getname_np()
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "itti_trace.h"
+
+typedef struct itti_trace_ring_s {
+  /*
+   * Number of records ever written. Only the owning thread writes it, the
+   * dump reads it to know which records are complete
+   */
+  volatile uint64_t head __attribute__((aligned(64)));
+  uint64_t mask;
+  uint32_t tid;
+  char name[16];
+  itti_trace_record_t *records;
+  uint8_t *payloads;
+} itti_trace_ring_t;
+
+typedef struct itti_trace_desc_s {
+  bool enabled;
+  uint32_t nb_records;
+  uint32_t payload_size;
+  char *file_name;
+
+  uint32_t nb_tasks;
+  const char *const *task_names;
+  uint32_t nb_messages;
+  const char *const *message_names;
+
+  volatile uint32_t nb_rings;
+  itti_trace_ring_t *volatile rings[ITTI_TRACE_MAX_THREADS];
+  pthread_mutex_t dump_mutex;
+} itti_trace_desc_t;
+
+typedef struct itti_trace_thread_s {
+  itti_trace_ring_t *ring;
+  bool no_ring; // all rings are taken
+  uint32_t enb_ue_s1ap_id;
+  uint32_t mme_ue_s1ap_id;
+} itti_trace_thread_t;
+
+_Static_assert(
+  sizeof(itti_trace_record_t) == 32,
+  "itti_trace_record_t is part of the trace file format");
+
+static itti_trace_desc_t itti_trace_desc = {
+  .enabled = false,
+  .dump_mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+static __thread itti_trace_thread_t itti_trace_thread;
+
+//------------------------------------------------------------------------------
+static void itti_trace_dump_on_failure(int status, void *arg)
+{
+  if (status != EXIT_SUCCESS) {
+    itti_trace_dump();
+  }
+}
+
+//------------------------------------------------------------------------------
+int itti_trace_init(
+  uint32_t nb_records,
+  uint32_t payload_size,
+  const char *file_name,
+  uint32_t nb_tasks,
+  const char *const *task_names,
+  uint32_t nb_messages,
+  const char *const *message_names)
+{
+  uint32_t size = 1;
+
+  if (itti_trace_desc.enabled || nb_records == 0) {
+    return 0;
+  }
+  if (payload_size > ITTI_TRACE_MAX_PAYLOAD_SIZE || file_name == NULL) {
+    return -1;
+  }
+  while (size < nb_records) {
+    size <<= 1;
+  }
+  itti_trace_desc.nb_records = size;
+  itti_trace_desc.payload_size = payload_size;
+  itti_trace_desc.file_name = strdup(file_name);
+  itti_trace_desc.nb_tasks = nb_tasks;
+  itti_trace_desc.task_names = task_names;
+  itti_trace_desc.nb_messages = nb_messages;
+  itti_trace_desc.message_names = message_names;
+  on_exit(itti_trace_dump_on_failure, NULL);
+  __atomic_store_n(&itti_trace_desc.enabled, true, __ATOMIC_RELEASE);
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static itti_trace_ring_t *itti_trace_new_ring(void)
+{
+  itti_trace_ring_t *ring = NULL;
+  uint32_t index = __sync_fetch_and_add(&itti_trace_desc.nb_rings, 1);
+
+  /*
+   * Slots are never reclaimed: the ring of a thread that exited stays in
+   * the dump. Threads started after the first ITTI_TRACE_MAX_THREADS ones
+   * are not traced
+   */
+  if (index >= ITTI_TRACE_MAX_THREADS) {
+    itti_trace_thread.no_ring = true;
+    return NULL;
+  }
+  ring = calloc(1, sizeof(itti_trace_ring_t));
+  ring->records =
+    calloc(itti_trace_desc.nb_records, sizeof(itti_trace_record_t));
+  if (itti_trace_desc.payload_size) {
+    ring->payloads =
+      calloc(itti_trace_desc.nb_records, itti_trace_desc.payload_size);
+  }
+  ring->mask = itti_trace_desc.nb_records - 1;
+  ring->tid = (uint32_t) syscall(SYS_gettid);
+  pthread_getname_np(pthread_self(), ring->name, sizeof(ring->name));
+  __atomic_store_n(&itti_trace_desc.rings[index], ring, __ATOMIC_RELEASE);
+  itti_trace_thread.ring = ring;
+  return ring;
+}
+
+//------------------------------------------------------------------------------
+void itti_trace_message(
+  itti_trace_event_t event,
+  uint32_t message_number,
+  uint16_t message_id,
+  uint16_t origin_task,
+  uint16_t destination_task,
+  uint32_t size,
+  const void *payload)
+{
+  itti_trace_ring_t *ring = itti_trace_thread.ring;
+  itti_trace_record_t *record = NULL;
+  struct timespec now;
+  uint64_t head;
+
+  if (!__atomic_load_n(&itti_trace_desc.enabled, __ATOMIC_RELAXED)) {
+    return;
+  }
+  if (!ring) {
+    if (itti_trace_thread.no_ring || !(ring = itti_trace_new_ring())) {
+      return;
+    }
+  }
+  if (event == ITTI_TRACE_RECEIVE) {
+    // the UE of the previous message is done with
+    itti_trace_thread.enb_ue_s1ap_id = 0;
+    itti_trace_thread.mme_ue_s1ap_id = 0;
+  }
+  clock_gettime(CLOCK_REALTIME, &now);
+  head = ring->head;
+  /*
+   * The previous head must be visible before the slot is overwritten, so
+   * that a dump copying the slot meanwhile knows the record is being
+   * written. The release store below only orders the stores before it
+   */
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  record = &ring->records[head & ring->mask];
+  record->timestamp_ns =
+    (uint64_t) now.tv_sec * 1000000000 + (uint64_t) now.tv_nsec;
+  record->message_number = message_number;
+  record->size = size;
+  record->enb_ue_s1ap_id = itti_trace_thread.enb_ue_s1ap_id;
+  record->mme_ue_s1ap_id = itti_trace_thread.mme_ue_s1ap_id;
+  record->message_id = message_id;
+  record->origin_task = origin_task;
+  record->destination_task = destination_task;
+  record->event = event;
+  record->payload_length = 0;
+  if (ring->payloads && payload) {
+    record->payload_length = size < itti_trace_desc.payload_size ?
+                               size :
+                               itti_trace_desc.payload_size;
+    memcpy(
+      ring->payloads + (head & ring->mask) * itti_trace_desc.payload_size,
+      payload,
+      record->payload_length);
+  }
+  // publish the record only once it is complete
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+//------------------------------------------------------------------------------
+void itti_trace_set_ue(uint32_t enb_ue_s1ap_id, uint32_t mme_ue_s1ap_id)
+{
+  itti_trace_thread.enb_ue_s1ap_id = enb_ue_s1ap_id;
+  itti_trace_thread.mme_ue_s1ap_id = mme_ue_s1ap_id;
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_write(int fd, const void *buffer, size_t length)
+{
+  const uint8_t *data = buffer;
+
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    data += written;
+    length -= written;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_write_names(
+  int fd,
+  uint32_t nb_names,
+  const char *const *names)
+{
+  for (uint32_t i = 0; i < nb_names; i++) {
+    const char *name = (names && names[i]) ? names[i] : "";
+    uint16_t length = strlen(name);
+
+    if (
+      itti_trace_write(fd, &length, sizeof(length)) < 0 ||
+      itti_trace_write(fd, name, length) < 0) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+static int itti_trace_write_ring(
+  int fd,
+  itti_trace_ring_t *ring,
+  itti_trace_record_t *records,
+  uint8_t *payloads)
+{
+  itti_trace_thread_header_t header = {0};
+  uint32_t payload_size = itti_trace_desc.payload_size;
+  uint64_t capacity = ring->mask + 1;
+  uint64_t first, last, overwritten;
+
+  last = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  first = last > capacity ? last - capacity : 0;
+  for (uint64_t i = first; i < last; i++) {
+    records[i - first] = ring->records[i & ring->mask];
+    if (payloads) {
+      memcpy(
+        payloads + (i - first) * payload_size,
+        ring->payloads + (i & ring->mask) * payload_size,
+        payload_size);
+    }
+  }
+  /*
+   * The owning thread may have overwritten the oldest records while they
+   * were copied, including the slot of the record it is writing now. The
+   * fence keeps the copies above from being reordered after the head read
+   */
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  overwritten = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) + 1;
+  overwritten = overwritten > capacity ? overwritten - capacity : 0;
+  if (overwritten > first) {
+    uint64_t skip = overwritten < last ? overwritten - first : last - first;
+
+    memmove(records, records + skip, (last - first - skip) * sizeof(*records));
+    if (payloads) {
+      memmove(
+        payloads,
+        payloads + skip * payload_size,
+        (last - first - skip) * payload_size);
+    }
+    first += skip;
+  }
+
+  memcpy(header.name, ring->name, sizeof(header.name));
+  header.tid = ring->tid;
+  header.nb_records = last - first;
+  header.nb_lost = first;
+  if (
+    itti_trace_write(fd, &header, sizeof(header)) < 0 ||
+    itti_trace_write(fd, records, header.nb_records * sizeof(*records)) < 0) {
+    return -1;
+  }
+  if (
+    payloads &&
+    itti_trace_write(fd, payloads, header.nb_records * payload_size) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+//------------------------------------------------------------------------------
+int itti_trace_dump_fd(int fd)
+{
+  itti_trace_file_header_t header = {0};
+  itti_trace_record_t *records = NULL;
+  uint8_t *payloads = NULL;
+  int rc = 0;
+
+  if (!__atomic_load_n(&itti_trace_desc.enabled, __ATOMIC_ACQUIRE)) {
+    return -1;
+  }
+  pthread_mutex_lock(&itti_trace_desc.dump_mutex);
+  header.magic = ITTI_TRACE_MAGIC;
+  header.version = ITTI_TRACE_VERSION;
+  header.record_size = sizeof(itti_trace_record_t);
+  header.payload_size = itti_trace_desc.payload_size;
+  header.nb_tasks = itti_trace_desc.nb_tasks;
+  header.nb_messages = itti_trace_desc.nb_messages;
+  header.nb_threads = 0;
+  for (uint32_t i = 0; i < ITTI_TRACE_MAX_THREADS; i++) {
+    if (__atomic_load_n(&itti_trace_desc.rings[i], __ATOMIC_ACQUIRE)) {
+      header.nb_threads++;
+    }
+  }
+  records = malloc(itti_trace_desc.nb_records * sizeof(itti_trace_record_t));
+  if (itti_trace_desc.payload_size) {
+    payloads = malloc(itti_trace_desc.nb_records * itti_trace_desc.payload_size);
+  }
+  if (
+    !records || (itti_trace_desc.payload_size && !payloads) ||
+    itti_trace_write(fd, &header, sizeof(header)) < 0 ||
+    itti_trace_write_names(
+      fd, itti_trace_desc.nb_tasks, itti_trace_desc.task_names) < 0 ||
+    itti_trace_write_names(
+      fd, itti_trace_desc.nb_messages, itti_trace_desc.message_names) < 0) {
+    rc = -1;
+  }
+  for (uint32_t i = 0, written = 0;
+       rc == 0 && i < ITTI_TRACE_MAX_THREADS && written < header.nb_threads;
+       i++) {
+    itti_trace_ring_t *ring =
+      __atomic_load_n(&itti_trace_desc.rings[i], __ATOMIC_ACQUIRE);
+
+    if (ring) {
+      rc = itti_trace_write_ring(fd, ring, records, payloads);
+      written++;
+    }
+  }
+  free(records);
+  free(payloads);
+  pthread_mutex_unlock(&itti_trace_desc.dump_mutex);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+int itti_trace_dump(void)
+{
+  int fd;
+  int rc;
+
+  if (!__atomic_load_n(&itti_trace_desc.enabled, __ATOMIC_ACQUIRE)) {
+    return -1;
+  }
+  fd = open(
+    itti_trace_desc.file_name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    fprintf(
+      stderr,
+      "Failed to open ITTI trace file %s: %s\n",
+      itti_trace_desc.file_name,
+      strerror(errno));
+    return -1;
+  }
+  rc = itti_trace_dump_fd(fd);
+  close(fd);
+  return rc;
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2015, EURECOM (www.eurecom.fr)
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are those
+ * of the authors and should not be interpreted as representing official policies,
+ * either expressed or implied, of the FreeBSD Project.
+ */
+
+/*! \file itti_trace.h
+   \brief Binary flight recorder of the messages exchanged between ITTI tasks.
+
+   Every thread writes fixed size records to its own ring, without locks or
+   formatting, so the trace can stay enabled in production. Rings only keep
+   the last records of each thread; they are written to a file on demand
+   (SIGUSR2) and when the process exits with a failure. The file is decoded
+   offline into sequence charts by scripts/itti_trace_decode.py.
+
+   A ring is allocated the first time a thread records a message and is
+   never freed, so rings of exited threads are still dumped. Only the first
+   ITTI_TRACE_MAX_THREADS threads get a ring, later ones are not traced.
+*/
+
+#ifndef ITTI_TRACE_H_
+#define ITTI_TRACE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ITTI_TRACE_MAGIC 0x52545449 /* "ITTR" */
+#define ITTI_TRACE_VERSION 1
+
+#define ITTI_TRACE_MAX_THREADS 64
+#define ITTI_TRACE_MAX_PAYLOAD_SIZE 255
+
+typedef enum itti_trace_event_e {
+  ITTI_TRACE_SEND = 0,
+  ITTI_TRACE_RECEIVE,
+  ITTI_TRACE_DROP, // destination task has ended
+} itti_trace_event_t;
+
+/* One message event. The layout is part of the file format */
+typedef struct itti_trace_record_s {
+  uint64_t timestamp_ns; // CLOCK_REALTIME
+  uint32_t message_number;
+  uint32_t size; // of the message payload
+  uint32_t enb_ue_s1ap_id;
+  uint32_t mme_ue_s1ap_id;
+  uint16_t message_id;
+  uint16_t origin_task;
+  uint16_t destination_task;
+  uint8_t event;
+  uint8_t payload_length; // bytes of the payload kept with the record
+} itti_trace_record_t;
+
+/*
+ * File layout, all integers in host byte order:
+ *   itti_trace_file_header_t
+ *   nb_tasks task names, then nb_messages message names, each as a uint16_t
+ *     length followed by the characters
+ *   nb_threads times:
+ *     itti_trace_thread_header_t
+ *     nb_records itti_trace_record_t, oldest first
+ *     nb_records payloads of payload_size bytes
+ */
+typedef struct itti_trace_file_header_s {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t record_size;
+  uint32_t payload_size;
+  uint32_t nb_tasks;
+  uint32_t nb_messages;
+  uint32_t nb_threads;
+} itti_trace_file_header_t;
+
+typedef struct itti_trace_thread_header_s {
+  char name[16];
+  uint32_t tid;
+  uint32_t nb_records;
+  uint64_t nb_lost; // records overwritten before the dump
+} itti_trace_thread_header_t;
+
+/** \brief Start recording. Threads get their ring on their first record.
+ * \param nb_records records kept per thread, rounded up to a power of 2,
+ *        0 disables the trace
+ * \param payload_size bytes of each message payload kept with its record,
+ *        at most ITTI_TRACE_MAX_PAYLOAD_SIZE
+ * \param file_name file the trace is dumped to
+ * \param task_names names of the tasks, indexed by task id
+ * \param message_names names of the messages, indexed by message id
+ * \returns 0 on success, -1 on error
+ **/
+int itti_trace_init(
+  uint32_t nb_records,
+  uint32_t payload_size,
+  const char *file_name,
+  uint32_t nb_tasks,
+  const char *const *task_names,
+  uint32_t nb_messages,
+  const char *const *message_names);
+
+/** \brief Record a message event in the ring of the calling thread
+ * \param payload message payload, only read if payloads are kept
+ **/
+void itti_trace_message(
+  itti_trace_event_t event,
+  uint32_t message_number,
+  uint16_t message_id,
+  uint16_t origin_task,
+  uint16_t destination_task,
+  uint32_t size,
+  const void *payload);
+
+/** \brief Set the UE the calling thread is handling. It is stamped on the
+ * messages the thread sends until it receives its next message.
+ **/
+void itti_trace_set_ue(uint32_t enb_ue_s1ap_id, uint32_t mme_ue_s1ap_id);
+
+/** \brief Write the rings of all threads to the trace file. Threads keep
+ * recording during the dump; records they overwrite meanwhile are left out,
+ * as is the oldest record of a full ring, whose slot may be being written.
+ * \returns 0 on success, -1 on error
+ **/
+int itti_trace_dump(void);
+
+/** \brief Write the rings of all threads to the given file descriptor
+ **/
+int itti_trace_dump_fd(int fd);
+
+#endif /* ITTI_TRACE_H_ */
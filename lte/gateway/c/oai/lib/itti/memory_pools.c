@@ -27,6 +27,12 @@
  * either expressed or implied, of the FreeBSD Project.
  */
 
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "assertions.h"
 #include "memory_pools.h"
 #include "dynamic_memory_check.h"
@@ -40,6 +46,11 @@ const static int mp_debug = 0;
     fflush(stdout);                                                            \
   } while (0)
 
+#define MP_WARNING(x, args...)                                                 \
+  do {                                                                         \
+    fprintf(stderr, "[MP][W]" x, ##args);                                      \
+  } while (0)
+
 #define VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(...)
 #define VCD_SIGNAL_DUMPER_DUMP_FUNCTION_BY_NAME(...)
 #define VCD_SIGNAL_DUMPER_FUNCTIONS_ITTI_ENQUEUE_MESSAGE(...)
@@ -53,27 +64,24 @@ uint64_t vcd_mp_free;
 
 #define MEMORY_POOL_ITEM_INFO_NUMBER 2
 
-/*------------------------------------------------------------------------------*/
-typedef int32_t items_group_position_t;
-typedef int32_t items_group_index_t;
-
-typedef union items_group_positions_u {
-  uint64_t all;
-  struct {
-    items_group_position_t put;
-    items_group_position_t get;
-  } ind;
-} items_group_positions_t;
-
-typedef struct items_group_s {
-  items_group_position_t number_plus_one;
-  volatile uint32_t minimum;
-  volatile items_group_positions_t positions;
-  volatile items_group_index_t *indexes;
-} items_group_t;
+/*
+ * Item sizes are rounded up to this granule, which keeps items 8 bytes
+ * aligned and lets the size class of a request be found with one lookup.
+ */
+#define MEMORY_POOL_SIZE_GRANULE 8
 
-/*------------------------------------------------------------------------------*/
-static const items_group_index_t ITEMS_GROUP_INDEX_INVALID = -1;
+/*
+ * Number of free items each thread keeps per pool. Threads allocate from and
+ * free to their own magazine without any lock, and only move half a magazine
+ * at a time from or to the shared free list of the pool.
+ */
+#define MEMORY_POOL_MAGAZINE_SIZE 64
+
+/*
+ * Pools are under pressure once the memory in use reaches this percentage of
+ * the memory limit.
+ */
+#define MEMORY_POOLS_PRESSURE_PERCENT 90
 
 /*------------------------------------------------------------------------------*/
 typedef uint32_t pool_item_start_mark_t;
@@ -94,26 +102,31 @@ typedef struct memory_pool_item_start_s {
   pool_id_t pool_id;
   item_status_t item_status;
   uint16_t info[MEMORY_POOL_ITEM_INFO_NUMBER];
+  uint32_t data_size;
 } memory_pool_item_start_t;
 
-typedef struct memory_pool_item_end_s {
-  pool_item_end_mark_t end_mark;
-} memory_pool_item_end_t;
-
 typedef struct memory_pool_item_s {
   memory_pool_item_start_t start;
   memory_pool_data_t data[0];
-  memory_pool_item_end_t end;
 } memory_pool_item_t;
 
 typedef struct memory_pool_s {
   pool_start_mark_t start_mark;
 
   pool_id_t pool_id;
-  uint32_t item_data_number;
+  uint32_t item_data_size;
   uint32_t pool_item_size;
-  items_group_t items_group_free;
-  memory_pool_item_t *items;
+  uint32_t grow_items_number;
+
+  /*
+   * Shared free list, items are linked through their data
+   */
+  pthread_mutex_t lock;
+  memory_pool_item_t *free_items;
+
+  volatile uint32_t items_total;
+  volatile uint32_t items_in_use;
+  volatile uint32_t items_high_water;
 } memory_pool_t;
 
 typedef struct memory_pools_s {
@@ -122,8 +135,30 @@ typedef struct memory_pools_s {
   uint32_t pools_number;
   uint32_t pools_defined;
   memory_pool_t *pools;
+
+  /*
+   * Smallest pool that fits each size, in MEMORY_POOL_SIZE_GRANULE units
+   */
+  pool_id_t *size_classes;
+  uint32_t size_classes_number;
+
+  volatile uint64_t memory_allocated;
+  uint64_t memory_limit;
+  volatile uint64_t allocation_failures;
+
+  pthread_key_t thread_cache_key;
 } memory_pools_t;
 
+typedef struct magazine_s {
+  uint32_t items_number;
+  memory_pool_item_t *items[MEMORY_POOL_MAGAZINE_SIZE];
+} magazine_t;
+
+typedef struct thread_cache_s {
+  memory_pools_t *memory_pools;
+  magazine_t magazines[0];
+} thread_cache_t;
+
 //------------------------------------------------------------------------------
 static const uint32_t MAX_POOLS_NUMBER = 20;
 static const uint32_t MAX_POOL_ITEMS_NUMBER = 200 * 1000;
@@ -143,122 +178,51 @@ static const pool_start_mark_t POOL_START_MARK =
 static const pools_start_mark_t POOLS_START_MARK =
   CHARS_TO_UINT32('P', 'S', 's', 't');
 
+/*
+ * Magazines of the calling thread, for the first memory pools it used
+ */
+static __thread thread_cache_t *thread_cache = NULL;
+
 /*------------------------------------------------------------------------------*/
-static inline uint32_t items_group_number_items(items_group_t *items_group)
+static inline uint32_t memory_pool_round_size(uint32_t size)
 {
-  return items_group->number_plus_one - 1;
+  return (size + MEMORY_POOL_SIZE_GRANULE - 1) / MEMORY_POOL_SIZE_GRANULE *
+         MEMORY_POOL_SIZE_GRANULE;
 }
 
 //------------------------------------------------------------------------------
-static inline uint32_t items_group_free_items(items_group_t *items_group)
+static inline uint32_t memory_pool_item_total_size(uint32_t data_size)
 {
-  items_group_positions_t positions;
-  uint32_t free_items;
-
-  positions.all = items_group->positions.all;
-  free_items =
-    items_group->number_plus_one + positions.ind.put - positions.ind.get;
-  free_items %= items_group->number_plus_one;
-  return free_items;
+  return sizeof(memory_pool_item_t) + data_size +
+         memory_pool_round_size(sizeof(pool_item_end_mark_t));
 }
 
 //------------------------------------------------------------------------------
-static inline items_group_index_t items_group_get_free_item(
-  items_group_t *items_group)
+static inline pool_item_end_mark_t *memory_pool_item_end_mark(
+  memory_pool_item_t *memory_pool_item)
 {
-  items_group_position_t get_raw;
-  items_group_position_t put;
-  items_group_position_t get;
-  items_group_position_t free_items;
-  items_group_index_t index = ITEMS_GROUP_INDEX_INVALID;
-
-  /*
-   * Get current put position
-   */
-  put = items_group->positions.ind.put % items_group->number_plus_one;
-  /*
-   * Get current get position and increase it
-   */
-  get_raw = __sync_fetch_and_add(&items_group->positions.ind.get, 1);
-  get = get_raw % items_group->number_plus_one;
-
-  if (put == get) {
-    /*
-     * No more item free, restore previous position
-     */
-    __sync_fetch_and_sub(&items_group->positions.ind.get, 1);
-  } else {
-    /*
-     * Get index at current get position
-     */
-    index = items_group->indexes[get];
-
-    if (index <= ITEMS_GROUP_INDEX_INVALID) {
-      /*
-       * Index has not yet been completely freed, restore previous get position
-       */
-      __sync_fetch_and_sub(&items_group->positions.ind.get, 1);
-    } else {
-      if (get_raw == items_group->number_plus_one) {
-        /*
-         * Wrap get position
-         */
-        __sync_fetch_and_sub(
-          &items_group->positions.ind.get, items_group->number_plus_one);
-      }
-
-      free_items = items_group_free_items(items_group);
-
-      /*
-       * Updates minimum free items if needed
-       */
-      while (items_group->minimum > free_items) {
-        items_group->minimum = free_items;
-      }
-
-      /*
-       * Clear index at current get position to indicate that item is free
-       */
-      items_group->indexes[get] = ITEMS_GROUP_INDEX_INVALID;
-    }
-  }
-
-  return (index);
+  return (pool_item_end_mark_t *) (((uint8_t *) memory_pool_item->data) +
+                                   memory_pool_item->start.data_size);
 }
 
 //------------------------------------------------------------------------------
-static inline int items_group_put_free_item(
-  items_group_t *items_group,
-  items_group_index_t index)
+static inline memory_pool_item_t **memory_pool_item_next_free(
+  memory_pool_item_t *memory_pool_item)
 {
-  items_group_position_t put_raw;
-  items_group_position_t put;
-
-  /*
-   * Get current put position and increase it
-   */
-  put_raw = __sync_fetch_and_add(&items_group->positions.ind.put, 1);
-  put = put_raw % items_group->number_plus_one;
-
-  if (put_raw == items_group->number_plus_one) {
-    /*
-     * Wrap position
-     */
-    __sync_fetch_and_sub(
-      &items_group->positions.ind.put, items_group->number_plus_one);
-  }
+  return (memory_pool_item_t **) memory_pool_item->data;
+}
 
-  AssertError(
-    items_group->indexes[put] <= ITEMS_GROUP_INDEX_INVALID,
-    return (EXIT_FAILURE),
-    "Index at current put position (%d) is not marked as free (%d)!\n",
-    put,
-    items_group->number_plus_one);
-  /*
-   * Save freed item index at current put position
-   */
-  items_group->indexes[put] = index;
-  return (EXIT_SUCCESS);
+//------------------------------------------------------------------------------
+static inline void memory_pool_item_init(
+  memory_pool_item_t *memory_pool_item,
+  pool_id_t pool_id,
+  uint32_t data_size)
+{
+  memory_pool_item->start.start_mark = POOL_ITEM_START_MARK;
+  memory_pool_item->start.pool_id = pool_id;
+  memory_pool_item->start.item_status = ITEM_STATUS_FREE;
+  memory_pool_item->start.data_size = data_size;
+  *memory_pool_item_end_mark(memory_pool_item) = POOL_ITEM_END_MARK;
 }
 
 //------------------------------------------------------------------------------
@@ -297,7 +261,6 @@ static inline memory_pool_item_t *memory_pool_item_from_handler(
   /*
    * Sanity check on passed handle
    */
-  //AssertError (memory_pool_item->start.start_mark == POOL_ITEM_START_MARK, memory_pool_item = NULL, "Handle %p is not a valid memory pool item handle, start mark is missing!\n", memory_pool_item);
   AssertFatal(
     memory_pool_item->start.start_mark == POOL_ITEM_START_MARK,
     "Handle %p is not a valid memory pool item handle, start mark is "
@@ -307,15 +270,215 @@ static inline memory_pool_item_t *memory_pool_item_from_handler(
 }
 
 //------------------------------------------------------------------------------
-static inline memory_pool_item_t *memory_pool_item_from_index(
+static inline void memory_pool_item_check(
+  memory_pools_t *memory_pools,
+  memory_pool_item_t *memory_pool_item)
+{
+  pool_id_t pool = memory_pool_item->start.pool_id;
+
+  AssertFatal(
+    pool < memory_pools->pools_defined,
+    "Pool index is invalid (%u/%u)!\n",
+    pool,
+    memory_pools->pools_defined);
+  /*
+   * Sanity check on end marker, must still be present (no write overflow)
+   */
+  AssertFatal(
+    *memory_pool_item_end_mark(memory_pool_item) == POOL_ITEM_END_MARK,
+    "Memory pool item %p is corrupted, end mark is not present for pool "
+    "%u!\n",
+    memory_pool_item,
+    pool);
+  /*
+   * Sanity check on item status, must be allocated
+   */
+  AssertFatal(
+    memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED,
+    "Non allocated (%x) memory pool item %p (pool %u)!\n",
+    memory_pool_item->start.item_status,
+    memory_pool_item,
+    pool);
+}
+
+//------------------------------------------------------------------------------
+static bool memory_pool_grow(
+  memory_pools_t *memory_pools,
   memory_pool_t *memory_pool,
-  items_group_index_t index)
+  uint32_t items_number,
+  bool ignore_limit)
 {
-  void *address;
+  uint64_t chunk_size = (uint64_t) items_number * memory_pool->pool_item_size;
+  uint64_t memory_allocated;
+  uint8_t *items;
+  uint32_t item_index;
+
+  memory_allocated =
+    __sync_add_and_fetch(&memory_pools->memory_allocated, chunk_size);
+  if (
+    !ignore_limit && memory_pools->memory_limit > 0 &&
+    memory_allocated > memory_pools->memory_limit) {
+    __sync_sub_and_fetch(&memory_pools->memory_allocated, chunk_size);
+    return false;
+  }
+  items = calloc(items_number, memory_pool->pool_item_size);
+  if (items == NULL) {
+    __sync_sub_and_fetch(&memory_pools->memory_allocated, chunk_size);
+    return false;
+  }
 
-  address = (void *) memory_pool->items;
-  address += index * memory_pool->pool_item_size;
-  return (address);
+  /*
+   * Chunks are never given back, items of all chunks share the free list
+   */
+  for (item_index = 0; item_index < items_number; item_index++) {
+    memory_pool_item_t *memory_pool_item =
+      (memory_pool_item_t *) (items + item_index * memory_pool->pool_item_size);
+
+    memory_pool_item_init(
+      memory_pool_item, memory_pool->pool_id, memory_pool->item_data_size);
+    *memory_pool_item_next_free(memory_pool_item) = memory_pool->free_items;
+    memory_pool->free_items = memory_pool_item;
+  }
+  memory_pool->items_total += items_number;
+  return true;
+}
+
+//------------------------------------------------------------------------------
+static uint32_t memory_pool_take_free_items(
+  memory_pools_t *memory_pools,
+  memory_pool_t *memory_pool,
+  memory_pool_item_t **items,
+  uint32_t items_number)
+{
+  uint32_t taken = 0;
+
+  pthread_mutex_lock(&memory_pool->lock);
+  while (taken < items_number) {
+    if (
+      memory_pool->free_items == NULL &&
+      !memory_pool_grow(
+        memory_pools, memory_pool, memory_pool->grow_items_number, false)) {
+      break;
+    }
+    items[taken] = memory_pool->free_items;
+    memory_pool->free_items = *memory_pool_item_next_free(items[taken]);
+    taken++;
+  }
+  pthread_mutex_unlock(&memory_pool->lock);
+  return taken;
+}
+
+//------------------------------------------------------------------------------
+static void memory_pool_put_free_items(
+  memory_pool_t *memory_pool,
+  memory_pool_item_t **items,
+  uint32_t items_number)
+{
+  uint32_t item;
+
+  pthread_mutex_lock(&memory_pool->lock);
+  for (item = 0; item < items_number; item++) {
+    *memory_pool_item_next_free(items[item]) = memory_pool->free_items;
+    memory_pool->free_items = items[item];
+  }
+  pthread_mutex_unlock(&memory_pool->lock);
+}
+
+//------------------------------------------------------------------------------
+static void memory_pools_release_thread_cache(void *arg)
+{
+  thread_cache_t *cache = (thread_cache_t *) arg;
+  memory_pools_t *memory_pools = cache->memory_pools;
+  pool_id_t pool;
+
+  /*
+   * Give the items cached by an exiting thread back to the pools
+   */
+  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+    memory_pool_put_free_items(
+      &memory_pools->pools[pool],
+      cache->magazines[pool].items,
+      cache->magazines[pool].items_number);
+  }
+  if (thread_cache == cache) {
+    thread_cache = NULL;
+  }
+  free(cache);
+}
+
+//------------------------------------------------------------------------------
+static inline magazine_t *memory_pools_thread_magazine(
+  memory_pools_t *memory_pools,
+  pool_id_t pool)
+{
+  if (thread_cache == NULL) {
+    thread_cache = calloc(
+      1, sizeof(thread_cache_t) + MAX_POOLS_NUMBER * sizeof(magazine_t));
+    if (thread_cache == NULL) {
+      return NULL;
+    }
+    thread_cache->memory_pools = memory_pools;
+    pthread_setspecific(memory_pools->thread_cache_key, thread_cache);
+  }
+  if (thread_cache->memory_pools != memory_pools) {
+    /*
+     * Only the first memory pools used by a thread are cached
+     */
+    return NULL;
+  }
+  return &thread_cache->magazines[pool];
+}
+
+//------------------------------------------------------------------------------
+static memory_pool_item_t *memory_pool_get_item(
+  memory_pools_t *memory_pools,
+  pool_id_t pool)
+{
+  memory_pool_t *memory_pool = &memory_pools->pools[pool];
+  magazine_t *magazine = memory_pools_thread_magazine(memory_pools, pool);
+  memory_pool_item_t *memory_pool_item = NULL;
+
+  if (magazine == NULL) {
+    memory_pool_take_free_items(memory_pools, memory_pool, &memory_pool_item, 1);
+    return memory_pool_item;
+  }
+  if (magazine->items_number == 0) {
+    magazine->items_number = memory_pool_take_free_items(
+      memory_pools,
+      memory_pool,
+      magazine->items,
+      MEMORY_POOL_MAGAZINE_SIZE / 2);
+  }
+  if (magazine->items_number > 0) {
+    memory_pool_item = magazine->items[--magazine->items_number];
+  }
+  return memory_pool_item;
+}
+
+//------------------------------------------------------------------------------
+static void memory_pool_put_item(
+  memory_pools_t *memory_pools,
+  pool_id_t pool,
+  memory_pool_item_t *memory_pool_item)
+{
+  memory_pool_t *memory_pool = &memory_pools->pools[pool];
+  magazine_t *magazine = memory_pools_thread_magazine(memory_pools, pool);
+
+  if (magazine == NULL) {
+    memory_pool_put_free_items(memory_pool, &memory_pool_item, 1);
+    return;
+  }
+  if (magazine->items_number == MEMORY_POOL_MAGAZINE_SIZE) {
+    /*
+     * Give half of the magazine back, so that other threads can use it
+     */
+    memory_pool_put_free_items(
+      memory_pool,
+      &magazine->items[MEMORY_POOL_MAGAZINE_SIZE / 2],
+      MEMORY_POOL_MAGAZINE_SIZE / 2);
+    magazine->items_number = MEMORY_POOL_MAGAZINE_SIZE / 2;
+  }
+  magazine->items[magazine->items_number++] = memory_pool_item;
 }
 
 //------------------------------------------------------------------------------
@@ -323,6 +486,7 @@ memory_pools_handle_t memory_pools_create(uint32_t pools_number)
 {
   memory_pools_t *memory_pools;
   pool_id_t pool;
+  int result;
 
   AssertFatal(
     pools_number <= MAX_POOLS_NUMBER,
@@ -332,7 +496,7 @@ memory_pools_handle_t memory_pools_create(uint32_t pools_number)
   /*
    * Allocate memory_pools
    */
-  memory_pools = malloc(sizeof(memory_pools_t));
+  memory_pools = calloc(1, sizeof(memory_pools_t));
   AssertFatal(
     memory_pools != NULL, "Memory pools structure allocation failed!\n");
   /*
@@ -355,6 +519,9 @@ memory_pools_handle_t memory_pools_create(uint32_t pools_number)
     for (pool = 0; pool < pools_number; pool++) {
       memory_pools->pools[pool].start_mark = POOL_START_MARK;
     }
+    result = pthread_key_create(
+      &memory_pools->thread_cache_key, memory_pools_release_thread_cache);
+    AssertFatal(result == 0, "Memory pools thread key creation failed!\n");
   }
   return ((memory_pools_handle_t) memory_pools);
 }
@@ -368,9 +535,7 @@ char *memory_pools_statistics(memory_pools_handle_t memory_pools_handle)
   int statistics_len;
   int printed_chars;
   uint32_t allocated_pool_memory;
-  uint32_t allocated_pools_memory = 0;
-  items_group_t *items_group;
-  uint32_t pool_items_size;
+  memory_pool_t *memory_pool;
 
   /*
    * Recover memory_pools
@@ -380,40 +545,40 @@ char *memory_pools_statistics(memory_pools_handle_t memory_pools_handle)
     memory_pools != NULL,
     "Failed to retrieve memory pool for handle %p!\n",
     memory_pools_handle);
-  statistics_len = memory_pools->pools_defined * 200;
+  statistics_len = (memory_pools->pools_defined + 3) * 200;
   statistics = malloc(statistics_len);
   printed_chars = snprintf(
     &statistics[0],
     statistics_len,
-    "Pool:   size, number, minimum,   free, address space and memory used in "
-    "Kbytes\n");
+    "Pool:   size,  total,  in use, high water, memory used in Kbytes\n");
 
   for (pool = 0; pool < memory_pools->pools_defined; pool++) {
-    items_group = &memory_pools->pools[pool].items_group_free;
-    allocated_pool_memory = items_group_number_items(items_group) *
-                            memory_pools->pools[pool].pool_item_size;
-    allocated_pools_memory += allocated_pool_memory;
-    pool_items_size =
-      memory_pools->pools[pool].item_data_number * sizeof(memory_pool_data_t);
+    memory_pool = &memory_pools->pools[pool];
+    allocated_pool_memory =
+      memory_pool->items_total * memory_pool->pool_item_size;
     printed_chars += snprintf(
       &statistics[printed_chars],
       statistics_len - printed_chars,
-      "  %2u: %6u, %6u,  %6u, %6u, [%p-%p] %6u\n",
+      "  %2u: %6u, %6u,  %6u,     %6u, %6u\n",
       pool,
-      pool_items_size,
-      items_group_number_items(items_group),
-      items_group->minimum,
-      items_group_free_items(items_group),
-      memory_pools->pools[pool].items,
-      ((void *) memory_pools->pools[pool].items) + allocated_pool_memory,
+      memory_pool->item_data_size,
+      memory_pool->items_total,
+      memory_pool->items_in_use,
+      memory_pool->items_high_water,
       allocated_pool_memory / (1024));
   }
 
-  printed_chars = snprintf(
+  printed_chars += snprintf(
     &statistics[printed_chars],
     statistics_len - printed_chars,
-    "Pools memory %u Kbytes\n",
-    allocated_pools_memory / (1024));
+    "Allocation failures %" PRIu64 "\n",
+    memory_pools->allocation_failures);
+  printed_chars += snprintf(
+    &statistics[printed_chars],
+    statistics_len - printed_chars,
+    "Pools memory %u Kbytes, limit %u Kbytes\n",
+    (uint32_t)(memory_pools->memory_allocated / (1024)),
+    (uint32_t)(memory_pools->memory_limit / (1024)));
   return (statistics);
 }
 
@@ -426,8 +591,8 @@ int memory_pools_add_pool(
   memory_pools_t *memory_pools;
   memory_pool_t *memory_pool;
   pool_id_t pool;
-  items_group_index_t item_index;
-  memory_pool_item_t *memory_pool_item;
+  uint32_t size_class;
+  uint32_t size_classes_number;
 
   AssertFatal(
     pool_items_number <= MAX_POOL_ITEMS_NUMBER,
@@ -454,6 +619,16 @@ int memory_pools_add_pool(
     memory_pools->pools_defined < memory_pools->pools_number,
     "Can not allocate more memory pool (%d)!\n",
     memory_pools->pools_number);
+  /*
+   * Size classes are ordered, a request that doesn't fit a pool goes to the
+   * next one
+   */
+  AssertFatal(
+    memory_pools->pools_defined == 0 ||
+      memory_pools->pools[memory_pools->pools_defined - 1].item_data_size <
+        pool_item_size,
+    "Memory pools must be added by increasing item size (%u)!\n",
+    pool_item_size);
   /*
    * Select pool
    */
@@ -464,64 +639,58 @@ int memory_pools_add_pool(
    */
   {
     memory_pool->pool_id = pool;
-    /*
-     * Item size in memory_pool_data_t items by excess
-     */
-    memory_pool->item_data_number =
-      (pool_item_size + sizeof(memory_pool_data_t) - 1) /
-      sizeof(memory_pool_data_t);
+    memory_pool->item_data_size = memory_pool_round_size(pool_item_size);
     memory_pool->pool_item_size =
-      (memory_pool->item_data_number * sizeof(memory_pool_data_t)) +
-      sizeof(memory_pool_item_t);
-    memory_pool->items_group_free.number_plus_one = pool_items_number + 1;
-    memory_pool->items_group_free.minimum = pool_items_number;
-    memory_pool->items_group_free.positions.ind.put = pool_items_number;
-    memory_pool->items_group_free.positions.ind.get = 0;
-    /*
-     * Allocate free indexes
-     */
-    memory_pool->items_group_free.indexes = malloc(
-      memory_pool->items_group_free.number_plus_one *
-      sizeof(items_group_index_t));
-    AssertFatal(
-      memory_pool->items_group_free.indexes != NULL,
-      "Memory pool indexes allocation failed!\n");
-
+      memory_pool_item_total_size(memory_pool->item_data_size);
     /*
-     * Initialize free indexes
+     * Once the preallocated items are used, grow by a quarter at a time
      */
-    for (item_index = 0; item_index < pool_items_number; item_index++) {
-      memory_pool->items_group_free.indexes[item_index] = item_index;
+    memory_pool->grow_items_number = pool_items_number / 4;
+    if (memory_pool->grow_items_number < MEMORY_POOL_MAGAZINE_SIZE) {
+      memory_pool->grow_items_number = MEMORY_POOL_MAGAZINE_SIZE;
     }
-
-    /*
-     * Last index is not allocated
-     */
-    memory_pool->items_group_free.indexes[item_index] =
-      ITEMS_GROUP_INDEX_INVALID;
-    /*
-     * Allocate items
-     */
-    memory_pool->items = calloc(pool_items_number, memory_pool->pool_item_size);
+    pthread_mutex_init(&memory_pool->lock, NULL);
     AssertFatal(
-      memory_pool->items != NULL, "Memory pool items allocation failed!\n");
+      memory_pool_grow(memory_pools, memory_pool, pool_items_number, true),
+      "Memory pool items allocation failed!\n");
+  }
 
-    /*
-     * Initialize items
-     */
-    for (item_index = 0; item_index < pool_items_number; item_index++) {
-      memory_pool_item = memory_pool_item_from_index(memory_pool, item_index);
-      memory_pool_item->start.start_mark = POOL_ITEM_START_MARK;
-      memory_pool_item->start.pool_id = pool;
-      memory_pool_item->start.item_status = ITEM_STATUS_FREE;
-      memory_pool_item->data[memory_pool->item_data_number] =
-        POOL_ITEM_END_MARK;
-    }
+  /*
+   * Sizes up to the item size of the new pool that no other pool fits now
+   * map to it
+   */
+  size_classes_number =
+    memory_pool->item_data_size / MEMORY_POOL_SIZE_GRANULE + 1;
+  memory_pools->size_classes =
+    realloc(memory_pools->size_classes, size_classes_number * sizeof(pool_id_t));
+  AssertFatal(
+    memory_pools->size_classes != NULL,
+    "Memory pools size classes allocation failed!\n");
+  for (size_class = memory_pools->size_classes_number;
+       size_class < size_classes_number;
+       size_class++) {
+    memory_pools->size_classes[size_class] = pool;
   }
+  memory_pools->size_classes_number = size_classes_number;
   memory_pools->pools_defined++;
   return (0);
 }
 
+//------------------------------------------------------------------------------
+void memory_pools_set_memory_limit(
+  memory_pools_handle_t memory_pools_handle,
+  uint64_t memory_limit)
+{
+  memory_pools_t *memory_pools;
+
+  memory_pools = memory_pools_from_handler(memory_pools_handle);
+  AssertFatal(
+    memory_pools != NULL,
+    "Failed to retrieve memory pool for handle %p!\n",
+    memory_pools_handle);
+  memory_pools->memory_limit = memory_limit;
+}
+
 //------------------------------------------------------------------------------
 memory_pool_item_handle_t memory_pools_allocate(
   memory_pools_handle_t memory_pools_handle,
@@ -530,10 +699,10 @@ memory_pool_item_handle_t memory_pools_allocate(
   uint16_t info_1)
 {
   memory_pools_t *memory_pools;
-  memory_pool_item_t *memory_pool_item;
-  memory_pool_item_handle_t memory_pool_item_handle = NULL;
-  pool_id_t pool;
-  items_group_index_t item_index = ITEMS_GROUP_INDEX_INVALID;
+  memory_pool_item_t *memory_pool_item = NULL;
+  pool_id_t pool = 0;
+  uint32_t size_class;
+  uint32_t items_in_use;
 
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(
     VCD_SIGNAL_DUMPER_VARIABLE_MP_ALLOC,
@@ -544,78 +713,68 @@ memory_pool_item_handle_t memory_pools_allocate(
   memory_pools = memory_pools_from_handler(memory_pools_handle);
   AssertError(
     memory_pools != NULL,
-    {},
+    return NULL,
     "Failed to retrieve memory pool for handle %p!\n",
     memory_pools_handle);
 
-  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
-    if (
-      (memory_pools->pools[pool].item_data_number *
-       sizeof(memory_pool_data_t)) < item_size) {
-      /*
-       * This memory pool has too small items, skip it
-       */
-      continue;
-    }
-
-    item_index =
-      items_group_get_free_item(&memory_pools->pools[pool].items_group_free);
-
-    if (item_index <= ITEMS_GROUP_INDEX_INVALID) {
-      /*
-       * Allocation failed, skip this pool
-       */
-      continue;
-    } else {
-      /*
-       * Allocation succeed, exit searching loop
-       */
-      break;
+  size_class =
+    (item_size + MEMORY_POOL_SIZE_GRANULE - 1) / MEMORY_POOL_SIZE_GRANULE;
+  if (size_class < memory_pools->size_classes_number) {
+    /*
+     * Start with the smallest pool that fits, and only move on to bigger ones
+     * if it can't grow anymore
+     */
+    for (pool = memory_pools->size_classes[size_class];
+         pool < memory_pools->pools_defined;
+         pool++) {
+      memory_pool_item = memory_pool_get_item(memory_pools, pool);
+      if (memory_pool_item != NULL) {
+        break;
+      }
     }
   }
 
-  if (item_index > ITEMS_GROUP_INDEX_INVALID) {
-    /*
-     * Convert item index into memory_pool_item address
-     */
-    memory_pool_item =
-      memory_pool_item_from_index(&memory_pools->pools[pool], item_index);
+  if (memory_pool_item != NULL) {
     /*
      * Sanity check on item status, must be free
      */
     AssertFatal(
       memory_pool_item->start.item_status == ITEM_STATUS_FREE,
-      "Item status is not set to free (%d) in pool %u, item %d!\n",
+      "Item status is not set to free (%d) in pool %u, item %p!\n",
       memory_pool_item->start.item_status,
       pool,
-      item_index);
+      memory_pool_item);
     memory_pool_item->start.item_status = ITEM_STATUS_ALLOCATED;
     memory_pool_item->start.info[0] = info_0;
     memory_pool_item->start.info[1] = info_1;
-    memory_pool_item_handle = memory_pool_item->data;
+    items_in_use =
+      __sync_add_and_fetch(&memory_pools->pools[pool].items_in_use, 1);
+    if (items_in_use > memory_pools->pools[pool].items_high_water) {
+      memory_pools->pools[pool].items_high_water = items_in_use;
+    }
     MP_DEBUG(
-      " Alloc [%2u][%6d]{%6d}, %3u %3u, %6u, %p, %p, %p\n",
+      " Alloc [%2u]{%6u}, %3u %3u, %6u, %p, %p\n",
       pool,
-      item_index,
-      items_group_free_items(&memory_pools->pools[pool].items_group_free),
+      items_in_use,
       info_0,
       info_1,
       item_size,
-      memory_pools->pools[pool].items,
       memory_pool_item,
-      memory_pool_item_handle);
+      memory_pool_item->data);
   } else {
+    /*
+     * The pools are at their memory limit or the size fits no pool, the
+     * caller has to handle the failure
+     */
+    __sync_fetch_and_add(&memory_pools->allocation_failures, 1);
     MP_DEBUG(
-      " Alloc [--][------]{------}, %3u %3u, %6u, failed!\n",
-      info_0,
-      info_1,
-      item_size);
+      " Alloc [--]{------}, %3u %3u, %6u, failed!\n", info_0, info_1, item_size);
   }
 
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(
     VCD_SIGNAL_DUMPER_VARIABLE_MP_ALLOC,
     __sync_and_and_fetch(&vcd_mp_alloc, ~(1L << info_0)));
-  return memory_pool_item_handle;
+  return memory_pool_item != NULL ? memory_pool_item->data : NULL;
 }
 
 //------------------------------------------------------------------------------
@@ -627,11 +786,7 @@ int memory_pools_free(
   memory_pools_t *memory_pools;
   memory_pool_item_t *memory_pool_item;
   pool_id_t pool;
-  items_group_index_t item_index;
-  uint32_t item_size;
-  uint32_t pool_item_size;
   uint16_t info_1;
-  int result;
 
   /*
    * Recover memory_pools
@@ -655,74 +810,24 @@ int memory_pools_free(
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(
     VCD_SIGNAL_DUMPER_VARIABLE_MP_FREE,
     __sync_or_and_fetch(&vcd_mp_free, 1L << info_1));
-  /*
-   * Recover pool index
-   */
+  memory_pool_item_check(memory_pools, memory_pool_item);
   pool = memory_pool_item->start.pool_id;
-  AssertFatal(
-    pool < memory_pools->pools_defined,
-    "Pool index is invalid (%u/%u)!\n",
-    pool,
-    memory_pools->pools_defined);
-  item_size = memory_pools->pools[pool].item_data_number;
-  pool_item_size = memory_pools->pools[pool].pool_item_size;
-  item_index =
-    (((void *) memory_pool_item) - ((void *) memory_pools->pools[pool].items)) /
-    pool_item_size;
   MP_DEBUG(
-    " Free  [%2u][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
+    " Free  [%2u], %3u %3u,         %p, %p, %u\n",
     pool,
-    item_index,
-    items_group_free_items(&memory_pools->pools[pool].items_group_free),
     memory_pool_item->start.info[0],
     info_1,
     memory_pool_item_handle,
     memory_pool_item,
-    memory_pools->pools[pool].items,
-    ((uint32_t)(item_size * sizeof(memory_pool_data_t))));
-  /*
-   * Sanity check on calculated item index
-   */
-  AssertFatal(
-    memory_pool_item ==
-      memory_pool_item_from_index(&memory_pools->pools[pool], item_index),
-    "Incorrect memory pool item address (%p, %p) for pool %u, item %d!\n",
-    memory_pool_item,
-    memory_pool_item_from_index(&memory_pools->pools[pool], item_index),
-    pool,
-    item_index);
-  /*
-   * Sanity check on end marker, must still be present (no write overflow)
-   */
-  AssertFatal(
-    memory_pool_item->data[item_size] == POOL_ITEM_END_MARK,
-    "Memory pool item is corrupted, end mark is not present for pool %u, item "
-    "%d!\n",
-    pool,
-    item_index);
-  /*
-   * Sanity check on item status, must be allocated
-   */
-  AssertFatal(
-    memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED,
-    "Trying to free a non allocated (%x) memory pool item (pool %u, item "
-    "%d)!\n",
-    memory_pool_item->start.item_status,
-    pool,
-    item_index);
+    memory_pool_item->start.data_size);
   memory_pool_item->start.item_status = ITEM_STATUS_FREE;
-  result = items_group_put_free_item(
-    &memory_pools->pools[pool].items_group_free, item_index);
-  AssertError(
-    result == EXIT_SUCCESS,
-    {},
-    "Failed to free memory pool item (pool %u, item %d)!\n",
-    pool,
-    item_index);
+
+  __sync_fetch_and_sub(&memory_pools->pools[pool].items_in_use, 1);
+  memory_pool_put_item(memory_pools, pool, memory_pool_item);
   VCD_SIGNAL_DUMPER_DUMP_VARIABLE_BY_NAME(
     VCD_SIGNAL_DUMPER_VARIABLE_MP_FREE,
     __sync_and_and_fetch(&vcd_mp_free, ~(1L << info_1)));
-  return (result);
+  return (EXIT_SUCCESS);
 }
 
 //------------------------------------------------------------------------------
@@ -734,10 +839,6 @@ void memory_pools_set_info(
 {
   memory_pools_t *memory_pools;
   memory_pool_item_t *memory_pool_item;
-  pool_id_t pool;
-  items_group_index_t item_index;
-  uint32_t item_size;
-  uint32_t pool_item_size;
 
   AssertFatal(
     index < MEMORY_POOL_ITEM_INFO_NUMBER,
@@ -769,60 +870,95 @@ void memory_pools_set_info(
       memory_pools != NULL,
       "Failed to retrieve memory pool for handle %p!\n",
       memory_pools_handle);
-    /*
-     * Recover pool index
-     */
-    pool = memory_pool_item->start.pool_id;
-    AssertFatal(
-      pool < memory_pools->pools_defined,
-      "Pool index is invalid (%u/%u)!\n",
-      pool,
-      memory_pools->pools_defined);
-    item_size = memory_pools->pools[pool].item_data_number;
-    pool_item_size = memory_pools->pools[pool].pool_item_size;
-    item_index = (((void *) memory_pool_item) -
-                  ((void *) memory_pools->pools[pool].items)) /
-                 pool_item_size;
     MP_DEBUG(
-      " Info  [%2u][%6d]{%6d}, %3u %3u,         %p, %p, %p, %u\n",
-      pool,
-      item_index,
-      items_group_free_items(&memory_pools->pools[pool].items_group_free),
+      " Info  [%2u], %3u %3u,         %p, %p, %u\n",
+      memory_pool_item->start.pool_id,
       memory_pool_item->start.info[0],
       memory_pool_item->start.info[1],
       memory_pool_item_handle,
       memory_pool_item,
-      memory_pools->pools[pool].items,
-      ((uint32_t)(item_size * sizeof(memory_pool_data_t))));
-    /*
-     * Sanity check on calculated item index
-     */
-    AssertFatal(
-      memory_pool_item ==
-        memory_pool_item_from_index(&memory_pools->pools[pool], item_index),
-      "Incorrect memory pool item address (%p, %p) for pool %u, item %d!\n",
-      memory_pool_item,
-      memory_pool_item_from_index(&memory_pools->pools[pool], item_index),
-      pool,
-      item_index);
-    /*
-     * Sanity check on end marker, must still be present (no write overflow)
-     */
-    AssertFatal(
-      memory_pool_item->data[item_size] == POOL_ITEM_END_MARK,
-      "Memory pool item is corrupted, end mark is not present for pool %u, "
-      "item %d!\n",
-      pool,
-      item_index);
-    /*
-     * Sanity check on item status, must be allocated
-     */
-    AssertFatal(
-      memory_pool_item->start.item_status == ITEM_STATUS_ALLOCATED,
-      "Trying to free a non allocated (%x) memory pool item (pool %u, item "
-      "%d)\n",
-      memory_pool_item->start.item_status,
-      pool,
-      item_index);
+      memory_pool_item->start.data_size);
+    memory_pool_item_check(memory_pools, memory_pool_item);
+  }
+}
+
+//------------------------------------------------------------------------------
+uint32_t memory_pools_number(memory_pools_handle_t memory_pools_handle)
+{
+  memory_pools_t *memory_pools;
+
+  memory_pools = memory_pools_from_handler(memory_pools_handle);
+  AssertError(
+    memory_pools != NULL,
+    return 0,
+    "Failed to retrieve memory pools for handle %p!\n",
+    memory_pools_handle);
+  return memory_pools->pools_defined;
+}
+
+//------------------------------------------------------------------------------
+int memory_pools_get_stats(
+  memory_pools_handle_t memory_pools_handle,
+  uint32_t pool,
+  memory_pool_stats_t *stats)
+{
+  memory_pools_t *memory_pools;
+  memory_pool_t *memory_pool;
+
+  memory_pools = memory_pools_from_handler(memory_pools_handle);
+  AssertError(
+    memory_pools != NULL,
+    return (EXIT_FAILURE),
+    "Failed to retrieve memory pools for handle %p!\n",
+    memory_pools_handle);
+  if (pool >= memory_pools->pools_defined) {
+    return (EXIT_FAILURE);
+  }
+  memory_pool = &memory_pools->pools[pool];
+  stats->item_size = memory_pool->item_data_size;
+  stats->items_total = memory_pool->items_total;
+  stats->items_in_use = memory_pool->items_in_use;
+  stats->items_high_water = memory_pool->items_high_water;
+  return (EXIT_SUCCESS);
+}
+
+//------------------------------------------------------------------------------
+uint64_t memory_pools_allocation_failures(
+  memory_pools_handle_t memory_pools_handle)
+{
+  memory_pools_t *memory_pools;
+
+  memory_pools = memory_pools_from_handler(memory_pools_handle);
+  AssertError(
+    memory_pools != NULL,
+    return 0,
+    "Failed to retrieve memory pools for handle %p!\n",
+    memory_pools_handle);
+  return memory_pools->allocation_failures;
+}
+
+//------------------------------------------------------------------------------
+bool memory_pools_under_pressure(memory_pools_handle_t memory_pools_handle)
+{
+  memory_pools_t *memory_pools;
+  memory_pool_t *memory_pool;
+  uint64_t memory_in_use = 0;
+  pool_id_t pool;
+
+  memory_pools = memory_pools_from_handler(memory_pools_handle);
+  AssertError(
+    memory_pools != NULL,
+    return false,
+    "Failed to retrieve memory pools for handle %p!\n",
+    memory_pools_handle);
+  if (memory_pools->memory_limit == 0) {
+    return false;
+  }
+  for (pool = 0; pool < memory_pools->pools_defined; pool++) {
+    memory_pool = &memory_pools->pools[pool];
+    memory_in_use +=
+      (uint64_t) memory_pool->items_in_use * memory_pool->pool_item_size;
   }
+  return memory_in_use * 100 >=
+         memory_pools->memory_limit * MEMORY_POOLS_PRESSURE_PERCENT;
 }
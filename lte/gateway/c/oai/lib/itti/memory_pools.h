@@ -30,11 +30,20 @@
 #ifndef MEMORY_POOLS_H_
 #define MEMORY_POOLS_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 typedef void *memory_pools_handle_t;
 typedef void *memory_pool_item_handle_t;
 
+/* Occupancy of one size class, as returned by memory_pools_get_stats */
+typedef struct memory_pool_stats_s {
+  uint32_t item_size;        // usable bytes of an item
+  uint32_t items_total;      // items currently owned by the pool
+  uint32_t items_in_use;     // items currently allocated
+  uint32_t items_high_water; // highest items_in_use seen
+} memory_pool_stats_t;
+
 memory_pools_handle_t memory_pools_create(uint32_t pools_number);
 
 char *memory_pools_statistics(memory_pools_handle_t memory_pools_handle);
@@ -55,6 +64,31 @@ int memory_pools_free(
   memory_pool_item_handle_t memory_pool_item_handle,
   uint16_t info_0);
 
+/*
+ * Limits how much memory the pools may grow to, in bytes. Allocations that
+ * don't fit under the limit fail and are counted.
+ */
+void memory_pools_set_memory_limit(
+  memory_pools_handle_t memory_pools_handle,
+  uint64_t memory_limit);
+
+uint32_t memory_pools_number(memory_pools_handle_t memory_pools_handle);
+
+int memory_pools_get_stats(
+  memory_pools_handle_t memory_pools_handle,
+  uint32_t pool,
+  memory_pool_stats_t *stats);
+
+/* Number of allocations that failed since the pools were created */
+uint64_t memory_pools_allocation_failures(
+  memory_pools_handle_t memory_pools_handle);
+
+/*
+ * Returns true when the memory in use is close to the memory limit, so that
+ * callers can refuse new work before the pools are exhausted.
+ */
+bool memory_pools_under_pressure(memory_pools_handle_t memory_pools_handle);
+
 void memory_pools_set_info(
   memory_pools_handle_t memory_pools_handle,
   memory_pool_item_handle_t memory_pool_item_handle,
@@ -45,6 +45,7 @@
 #include "bstrlib.h"
 
 #include "intertask_interface.h"
+#include "itti_trace.h"
 #include "timer.h"
 #include "backtrace.h"
 #include "assertions.h"
@@ -129,6 +130,7 @@ int signal_mask(void)
   sigemptyset(&set);
   sigaddset(&set, SIGTIMER);
   sigaddset(&set, SIGUSR1);
+  sigaddset(&set, SIGUSR2);
   sigaddset(&set, SIGABRT);
   sigaddset(&set, SIGSEGV);
   sigaddset(&set, SIGINT);
@@ -150,6 +152,7 @@ int signal_handle(int *end)
   sigemptyset(&set);
   sigaddset(&set, SIGTIMER);
   sigaddset(&set, SIGUSR1);
+  sigaddset(&set, SIGUSR2);
   sigaddset(&set, SIGABRT);
   sigaddset(&set, SIGSEGV);
   sigaddset(&set, SIGINT);
@@ -190,9 +193,15 @@ int signal_handle(int *end)
         *end = 1;
         break;
 
+      case SIGUSR2:
+        SIG_DEBUG("Received SIGUSR2, dumping the ITTI trace\n");
+        itti_trace_dump();
+        break;
+
       case SIGSEGV: /* Fall through */
       case SIGABRT:
         SIG_DEBUG("Received SIGABORT\n");
+        itti_trace_dump();
         backtrace_handle_signal(&info);
         break;
 
@@ -39,7 +39,7 @@ void BaseApplication::event_callback(
     remove_all_flows(ev.get_connection(), messenger);
     install_default_flow(ev.get_connection(), messenger);
   } else if (ev.get_type() == EVENT_ERROR) {
-    handle_error_message(static_cast<const ErrorEvent &>(ev));
+    handle_error_message(static_cast<const ErrorEvent &>(ev), messenger);
   }
 }
 
@@ -69,14 +69,21 @@ void BaseApplication::remove_all_flows(
   return;
 }
 
-void BaseApplication::handle_error_message(const ErrorEvent &ev)
+void BaseApplication::handle_error_message(
+  const ErrorEvent &ev,
+  const OpenflowMessenger &messenger)
 {
+  // Messages sent through the queue can be traced back to their event
+  std::string origin = messenger.get_queued_msg_origin(ev.get_xid());
   // First 16 bits of error message are the type, second 16 bits are the code
   OAILOG_ERROR(
     LOG_GTPV1U,
-    "Openflow error received - type: 0x%02x, code: 0x%02x\n",
+    "Openflow error received - type: 0x%02x, code: 0x%02x, xid: %u%s%s\n",
     ev.get_error_type(),
-    ev.get_error_code());
+    ev.get_error_code(),
+    ev.get_xid(),
+    origin.empty() ? "" : ", from: ",
+    origin.c_str());
   char type_str[50];
   char code_str[50];
   snprintf(type_str, sizeof(type_str), "0x%02x", ev.get_error_type());
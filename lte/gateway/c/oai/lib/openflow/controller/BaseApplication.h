@@ -62,8 +62,11 @@ class BaseApplication : public Application {
    * or bad requests.
    *
    * @param ev (in) - Error event containing type and code of OF error
+   * @param messenger - messenger that knows where queued messages came from
    */
-  void handle_error_message(const ErrorEvent &ev);
+  void handle_error_message(
+    const ErrorEvent &ev,
+    const OpenflowMessenger &messenger);
 };
 
 } // namespace openflow
@@ -91,6 +91,15 @@ SwitchUpEvent::SwitchUpEvent(
 {
 }
 
+FlowStatsReplyEvent::FlowStatsReplyEvent(
+  fluid_base::OFConnection *ofconn,
+  fluid_base::OFHandler &ofhandler,
+  const void *data,
+  const size_t len):
+  DataEvent(ofconn, ofhandler, data, len, EVENT_FLOW_STATS_REPLY)
+{
+}
+
 SwitchDownEvent::SwitchDownEvent(fluid_base::OFConnection *ofconn):
   ControllerEvent(ofconn, EVENT_SWITCH_DOWN)
 {
@@ -101,6 +110,7 @@ ErrorEvent::ErrorEvent(
   const struct ofp_error_msg *error_msg):
   error_type_(ntohs(error_msg->type)),
   error_code_(ntohs(error_msg->code)),
+  xid_(ntohl(error_msg->header.xid)),
   ControllerEvent(ofconn, EVENT_ERROR)
 {
 }
@@ -115,6 +125,11 @@ const uint16_t ErrorEvent::get_error_code() const
   return error_code_;
 }
 
+const uint32_t ErrorEvent::get_xid() const
+{
+  return xid_;
+}
+
 ExternalEvent::ExternalEvent(const ControllerEventType type):
   ControllerEvent(NULL, type)
 {
@@ -38,6 +38,7 @@ enum ControllerEventType {
   EVENT_DELETE_GTP_TUNNEL,
   EVENT_DISCARD_DATA_ON_GTP_TUNNEL,
   EVENT_FORWARD_DATA_ON_GTP_TUNNEL,
+  EVENT_FLOW_STATS_REPLY,
 };
 
 /**
@@ -119,6 +120,19 @@ class SwitchDownEvent : public ControllerEvent {
   SwitchDownEvent(fluid_base::OFConnection *ofconn);
 };
 
+/**
+ * Event triggered when the switch replies to a flow stats request. Large
+ * replies are split over several events
+ */
+class FlowStatsReplyEvent : public DataEvent {
+ public:
+  FlowStatsReplyEvent(
+    fluid_base::OFConnection *ofconn,
+    fluid_base::OFHandler &ofhandler,
+    const void *data,
+    const size_t len);
+};
+
 /**
  * Event triggered when there is an openflow error reported from the switch
  */
@@ -130,10 +144,13 @@ class ErrorEvent : public ControllerEvent {
 
   const uint16_t get_error_type() const;
   const uint16_t get_error_code() const;
+  // transaction id of the message the error is for
+  const uint32_t get_xid() const;
 
  private:
   const uint16_t error_type_;
   const uint16_t error_code_;
+  const uint32_t xid_;
 };
 
 /*
@@ -209,4 +226,18 @@ class HandleDataOnGTPTunnelEvent : public ExternalEvent {
   const uint32_t in_tei_;
 };
 
+/*
+ * Fixed size description of a GTP tunnel event, so that the SPGW can queue
+ * tunnel events to the controller without allocating. The controller turns
+ * it back into the matching tunnel event before dispatching it
+ */
+struct TunnelOp {
+  ControllerEventType type;
+  struct in_addr ue_ip;
+  struct in_addr enb_ip; // only for EVENT_ADD_GTP_TUNNEL
+  uint32_t in_tei;
+  uint32_t out_tei;      // only for EVENT_ADD_GTP_TUNNEL
+  char imsi[16];         // only for EVENT_ADD_GTP_TUNNEL, NUL terminated
+};
+
 } // namespace openflow
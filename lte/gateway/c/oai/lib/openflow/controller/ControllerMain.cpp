@@ -19,6 +19,8 @@
  *      contact@openairinterface.org
  */
 
+#include <string.h>
+
 #include "OpenflowController.h"
 #include "PagingApplication.h"
 #include "BaseApplication.h"
@@ -50,6 +52,10 @@ int start_of_controller(void)
   ctrl.register_for_event(&gtp_app, openflow::EVENT_DELETE_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
   ctrl.register_for_event(&gtp_app, openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
+  // after base_app, which removes all flows when the switch connects
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_SWITCH_UP);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_SWITCH_DOWN);
+  ctrl.register_for_event(&gtp_app, openflow::EVENT_FLOW_STATS_REPLY);
   ctrl.start();
   OAILOG_INFO(LOG_GTPV1U, "Started openflow controller\n");
   return 0;
@@ -63,13 +69,18 @@ int stop_of_controller(void)
 }
 
 /**
- * This callback is called from the event loop itself to dispatch an external
- * event to all registered applications
+ * Queue a tunnel op to the controller, which dispatches it from its event loop
  */
-static void *external_event_callback(std::shared_ptr<void> data)
+static int enqueue_tunnel_op(const openflow::TunnelOp &op)
 {
-  auto external_event = std::static_pointer_cast<openflow::ExternalEvent>(data);
-  ctrl.dispatch_event(*external_event);
+  if (!ctrl.enqueue_tunnel_op(op)) {
+    OAILOG_ERROR(
+      LOG_GTPV1U,
+      "Openflow tunnel op queue is full, dropping op for tei %u\n",
+      op.in_tei);
+    return -1;
+  }
+  return 0;
 }
 
 int openflow_controller_add_gtp_tunnel(
@@ -79,35 +90,43 @@ int openflow_controller_add_gtp_tunnel(
   uint32_t o_tei,
   const char *imsi)
 {
-  auto add_tunnel =
-    std::make_shared<openflow::AddGTPTunnelEvent>(ue, enb, i_tei, o_tei, imsi);
-  ctrl.inject_external_event(add_tunnel, external_event_callback);
-  return 0;
+  openflow::TunnelOp op = {};
+  op.type = openflow::EVENT_ADD_GTP_TUNNEL;
+  op.ue_ip = ue;
+  op.enb_ip = enb;
+  op.in_tei = i_tei;
+  op.out_tei = o_tei;
+  strncpy(op.imsi, imsi, sizeof(op.imsi) - 1);
+  return enqueue_tunnel_op(op);
 }
 
 int openflow_controller_del_gtp_tunnel(struct in_addr ue, uint32_t i_tei)
 {
-  auto del_tunnel = std::make_shared<openflow::DeleteGTPTunnelEvent>(ue, i_tei);
-  ctrl.inject_external_event(del_tunnel, external_event_callback);
-  return 0;
+  openflow::TunnelOp op = {};
+  op.type = openflow::EVENT_DELETE_GTP_TUNNEL;
+  op.ue_ip = ue;
+  op.in_tei = i_tei;
+  return enqueue_tunnel_op(op);
 }
 
 int openflow_controller_discard_data_on_tunnel(
   struct in_addr ue,
   uint32_t i_tei)
 {
-  auto gtp_tunnel = std::make_shared<openflow::HandleDataOnGTPTunnelEvent>(
-    ue, i_tei, openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
-  ctrl.inject_external_event(gtp_tunnel, external_event_callback);
-  return 0;
+  openflow::TunnelOp op = {};
+  op.type = openflow::EVENT_DISCARD_DATA_ON_GTP_TUNNEL;
+  op.ue_ip = ue;
+  op.in_tei = i_tei;
+  return enqueue_tunnel_op(op);
 }
 
 int openflow_controller_forward_data_on_tunnel(
   struct in_addr ue,
   uint32_t i_tei)
 {
-  auto gtp_tunnel = std::make_shared<openflow::HandleDataOnGTPTunnelEvent>(
-    ue, i_tei, openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
-  ctrl.inject_external_event(gtp_tunnel, external_event_callback);
-  return 0;
+  openflow::TunnelOp op = {};
+  op.type = openflow::EVENT_FORWARD_DATA_ON_GTP_TUNNEL;
+  op.ue_ip = ue;
+  op.in_tei = i_tei;
+  return enqueue_tunnel_op(op);
 }
@@ -41,7 +41,10 @@ GTPApplication::GTPApplication(
   const std::string &uplink_mac,
   uint32_t gtp_port_num):
   uplink_mac_(uplink_mac),
-  gtp_port_num_(gtp_port_num)
+  gtp_port_num_(gtp_port_num),
+  flow_stats_xid_(0),
+  ofconn_(NULL),
+  messenger_(NULL)
 {
 }
 
@@ -49,6 +52,7 @@ void GTPApplication::event_callback(
   const ControllerEvent &ev,
   const OpenflowMessenger &messenger)
 {
+  track_tunnel_event(ev);
   if (ev.get_type() == EVENT_ADD_GTP_TUNNEL) {
     auto add_tunnel_event = static_cast<const AddGTPTunnelEvent &>(ev);
     add_uplink_tunnel_flow(add_tunnel_event, messenger);
@@ -67,9 +71,247 @@ void GTPApplication::event_callback(
       static_cast<const HandleDataOnGTPTunnelEvent &>(ev);
     forward_uplink_tunnel_flow(forward_tunnel_flow, messenger);
     forward_downlink_tunnel_flow(forward_tunnel_flow, messenger);
+  } else if (ev.get_type() == EVENT_SWITCH_UP) {
+    replay_tunnel_flows(ev.get_connection(), messenger);
+    // The timer is freed with the connection
+    ofconn_ = ev.get_connection();
+    messenger_ = &messenger;
+    ofconn_->add_timed_callback(
+      reconcile_timer_callback, RECONCILE_INTERVAL_MS, this);
+  } else if (ev.get_type() == EVENT_SWITCH_DOWN) {
+    ofconn_ = NULL;
+    // drop the reply of a request in flight
+    flow_stats_xid_++;
+  } else if (ev.get_type() == EVENT_FLOW_STATS_REPLY) {
+    handle_flow_stats_reply(
+      static_cast<const FlowStatsReplyEvent &>(ev), messenger);
   }
 }
 
+void GTPApplication::track_tunnel_event(const ControllerEvent &ev)
+{
+  if (ev.get_type() == EVENT_ADD_GTP_TUNNEL) {
+    auto &add_tunnel_event = static_cast<const AddGTPTunnelEvent &>(ev);
+    tunnel_flows_.add_tunnel(
+      add_tunnel_event.get_ue_ip(),
+      add_tunnel_event.get_enb_ip(),
+      add_tunnel_event.get_in_tei(),
+      add_tunnel_event.get_out_tei(),
+      add_tunnel_event.get_imsi());
+  } else if (ev.get_type() == EVENT_DELETE_GTP_TUNNEL) {
+    auto &del_tunnel_event = static_cast<const DeleteGTPTunnelEvent &>(ev);
+    tunnel_flows_.remove_tunnel(
+      del_tunnel_event.get_ue_ip(), del_tunnel_event.get_in_tei());
+  } else if (
+    ev.get_type() == EVENT_DISCARD_DATA_ON_GTP_TUNNEL ||
+    ev.get_type() == EVENT_FORWARD_DATA_ON_GTP_TUNNEL) {
+    auto &data_tunnel_event =
+      static_cast<const HandleDataOnGTPTunnelEvent &>(ev);
+    tunnel_flows_.set_discarding(
+      data_tunnel_event.get_in_tei(),
+      ev.get_type() == EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
+  }
+}
+
+void GTPApplication::replay_tunnel_flows(
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  for (const auto &tunnel_pair : tunnel_flows_.get_tunnels()) {
+    const TunnelFlow &tunnel = tunnel_pair.second;
+    AddGTPTunnelEvent add_tunnel_event(
+      tunnel.ue_ip, tunnel.enb_ip, tunnel.in_tei, tunnel.out_tei, tunnel.imsi);
+    add_tunnel_event.set_of_connection(ofconn);
+    add_uplink_tunnel_flow(add_tunnel_event, messenger);
+    if (tunnel_flows_.owns_downlink(tunnel)) {
+      add_downlink_tunnel_flow(add_tunnel_event, messenger);
+    }
+    if (tunnel.discarding) {
+      HandleDataOnGTPTunnelEvent discard_event(
+        tunnel.ue_ip, tunnel.in_tei, EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
+      discard_event.set_of_connection(ofconn);
+      discard_uplink_tunnel_flow(discard_event, messenger);
+      discard_downlink_tunnel_flow(discard_event, messenger);
+    }
+  }
+  messenger.flush_queued_msgs();
+  OAILOG_INFO(
+    LOG_GTPV1U,
+    "Replayed flows of %zu GTP tunnels\n",
+    tunnel_flows_.size());
+}
+
+void *GTPApplication::reconcile_timer_callback(void *arg)
+{
+  static_cast<GTPApplication *>(arg)->request_flow_stats();
+  return NULL;
+}
+
+void GTPApplication::request_flow_stats()
+{
+  if (ofconn_ == NULL) {
+    return;
+  }
+  // A request without a complete reply yet is superseded by this one
+  observed_flows_.clear();
+  of13::FlowStatsRequest flow_stats;
+  flow_stats.table_id(0);
+  flow_stats.out_port(of13::OFPP_ANY);
+  flow_stats.out_group(of13::OFPG_ANY);
+  flow_stats.cookie(0);
+  flow_stats.cookie_mask(0);
+  of13::MultipartRequestFlow request(++flow_stats_xid_, 0, flow_stats);
+  messenger_->send_of_msg(request, ofconn_);
+}
+
+void GTPApplication::handle_flow_stats_reply(
+  const FlowStatsReplyEvent &ev,
+  const OpenflowMessenger &messenger)
+{
+  of13::MultipartReplyFlow reply;
+  if (reply.unpack(const_cast<uint8_t *>(ev.get_data())) != 0) {
+    OAILOG_ERROR(LOG_GTPV1U, "Could not unpack flow stats reply\n");
+    return;
+  }
+  if (reply.xid() != flow_stats_xid_) {
+    return;
+  }
+  std::vector<of13::FlowStats> flows = reply.flow_stats();
+  for (auto &flow : flows) {
+    bool discard = flow.priority() == DEFAULT_PRIORITY + 1;
+    if (
+      flow.table_id() != 0 ||
+      (flow.priority() != DEFAULT_PRIORITY && !discard)) {
+      continue;
+    }
+    of13::Match match = flow.match();
+    auto in_port =
+      static_cast<of13::InPort *>(match.oxm_field(of13::OFPXMT_OFB_IN_PORT));
+    if (in_port == NULL) {
+      continue;
+    }
+    if (in_port->value() == gtp_port_num_) {
+      auto tun_field = static_cast<of13::TUNNELId *>(
+        match.oxm_field(of13::OFPXMT_OFB_TUNNEL_ID));
+      if (tun_field != NULL) {
+        auto &teis = discard ? observed_flows_.discard_uplink_teis :
+                               observed_flows_.uplink_teis;
+        teis.insert(static_cast<uint32_t>(tun_field->value()));
+      }
+    } else if (in_port->value() == of13::OFPP_LOCAL) {
+      auto ipv4_field = static_cast<of13::IPv4Dst *>(
+        match.oxm_field(of13::OFPXMT_OFB_IPV4_DST));
+      if (ipv4_field != NULL) {
+        auto &ips = discard ? observed_flows_.discard_downlink_ips :
+                              observed_flows_.downlink_ips;
+        ips.insert(ipv4_field->value().getIPv4());
+      }
+    }
+  }
+  if (reply.flags() & of13::OFPMPF_REPLY_MORE) {
+    return;
+  }
+  reconcile_tunnel_flows(ev.get_connection(), messenger);
+  observed_flows_.clear();
+}
+
+void GTPApplication::reconcile_tunnel_flows(
+  fluid_base::OFConnection *ofconn,
+  const OpenflowMessenger &messenger)
+{
+  TunnelFlowDiff diff = tunnel_flows_.diff(observed_flows_);
+  if (diff.empty()) {
+    return;
+  }
+  OAILOG_WARNING(
+    LOG_GTPV1U,
+    "Reconciling GTP tunnel flows - missing uplink: %zu, downlink: %zu, "
+    "left over uplink: %zu, downlink: %zu\n",
+    diff.missing_uplinks.size(),
+    diff.missing_downlinks.size(),
+    diff.stale_uplink_teis.size(),
+    diff.stale_downlink_ips.size());
+
+  for (const TunnelFlow *tunnel : diff.missing_uplinks) {
+    AddGTPTunnelEvent add_tunnel_event(
+      tunnel->ue_ip,
+      tunnel->enb_ip,
+      tunnel->in_tei,
+      tunnel->out_tei,
+      tunnel->imsi);
+    add_tunnel_event.set_of_connection(ofconn);
+    add_uplink_tunnel_flow(add_tunnel_event, messenger);
+  }
+  for (const TunnelFlow *tunnel : diff.missing_downlinks) {
+    AddGTPTunnelEvent add_tunnel_event(
+      tunnel->ue_ip,
+      tunnel->enb_ip,
+      tunnel->in_tei,
+      tunnel->out_tei,
+      tunnel->imsi);
+    add_tunnel_event.set_of_connection(ofconn);
+    add_downlink_tunnel_flow(add_tunnel_event, messenger);
+  }
+  for (const TunnelFlow *tunnel : diff.missing_discard_uplinks) {
+    HandleDataOnGTPTunnelEvent discard_event(
+      tunnel->ue_ip, tunnel->in_tei, EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
+    discard_event.set_of_connection(ofconn);
+    discard_uplink_tunnel_flow(discard_event, messenger);
+  }
+  for (const TunnelFlow *tunnel : diff.missing_discard_downlinks) {
+    HandleDataOnGTPTunnelEvent discard_event(
+      tunnel->ue_ip, tunnel->in_tei, EVENT_DISCARD_DATA_ON_GTP_TUNNEL);
+    discard_event.set_of_connection(ofconn);
+    discard_downlink_tunnel_flow(discard_event, messenger);
+  }
+
+  struct in_addr no_ip;
+  no_ip.s_addr = 0;
+  for (uint32_t tei : diff.stale_uplink_teis) {
+    DeleteGTPTunnelEvent del_tunnel_event(no_ip, tei);
+    del_tunnel_event.set_of_connection(ofconn);
+    delete_uplink_tunnel_flow(del_tunnel_event, messenger);
+  }
+  for (uint32_t ip : diff.stale_downlink_ips) {
+    struct in_addr ue_ip;
+    ue_ip.s_addr = ip;
+    DeleteGTPTunnelEvent del_tunnel_event(ue_ip, 0);
+    del_tunnel_event.set_of_connection(ofconn);
+    delete_downlink_tunnel_flow(del_tunnel_event, messenger);
+  }
+  for (uint32_t tei : diff.stale_discard_uplink_teis) {
+    HandleDataOnGTPTunnelEvent forward_event(
+      no_ip, tei, EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
+    forward_event.set_of_connection(ofconn);
+    forward_uplink_tunnel_flow(forward_event, messenger);
+  }
+  for (uint32_t ip : diff.stale_discard_downlink_ips) {
+    struct in_addr ue_ip;
+    ue_ip.s_addr = ip;
+    HandleDataOnGTPTunnelEvent forward_event(
+      ue_ip, 0, EVENT_FORWARD_DATA_ON_GTP_TUNNEL);
+    forward_event.set_of_connection(ofconn);
+    forward_downlink_tunnel_flow(forward_event, messenger);
+  }
+  messenger.flush_queued_msgs();
+}
+
+/*
+ * Helper method to describe a tunnel flow mod, to find the tunnel event
+ * that caused an error reported by OVS
+ */
+static QueuedMsgOrigin tunnel_origin(
+  const char *action,
+  uint32_t in_tei,
+  const struct in_addr &ue_ip)
+{
+  QueuedMsgOrigin origin;
+  origin.action = action;
+  origin.tei = in_tei;
+  origin.ue_ip = ue_ip;
+  return origin;
+}
+
 /*
  * Helper method to add matching for adding/deleting the uplink flow
  */
@@ -126,7 +368,10 @@ void GTPApplication::add_uplink_tunnel_flow(
   uplink_fm.add_instruction(goto_inst);
 
   // Finally, send flow mod
-  messenger.send_of_msg(uplink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    uplink_fm,
+    ev.get_connection(),
+    tunnel_origin("add uplink", ev.get_in_tei(), ev.get_ue_ip()));
   OAILOG_DEBUG(LOG_GTPV1U, "Uplink flow added\n");
 }
 
@@ -142,7 +387,10 @@ void GTPApplication::delete_uplink_tunnel_flow(
 
   add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
 
-  messenger.send_of_msg(uplink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    uplink_fm,
+    ev.get_connection(),
+    tunnel_origin("delete uplink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 /*
@@ -189,7 +437,10 @@ void GTPApplication::add_downlink_tunnel_flow(
   downlink_fm.add_instruction(goto_inst);
 
   // Finally, send flow mod
-  messenger.send_of_msg(downlink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    downlink_fm,
+    ev.get_connection(),
+    tunnel_origin("add downlink", ev.get_in_tei(), ev.get_ue_ip()));
   OAILOG_DEBUG(LOG_GTPV1U, "Downlink flow added\n");
 }
 
@@ -205,7 +456,10 @@ void GTPApplication::delete_downlink_tunnel_flow(
 
   add_downlink_match(downlink_fm, ev.get_ue_ip());
 
-  messenger.send_of_msg(downlink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    downlink_fm,
+    ev.get_connection(),
+    tunnel_origin("delete downlink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 void GTPApplication::discard_uplink_tunnel_flow(
@@ -222,7 +476,10 @@ void GTPApplication::discard_uplink_tunnel_flow(
 
   add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
 
-  messenger.send_of_msg(uplink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    uplink_fm,
+    ev.get_connection(),
+    tunnel_origin("discard uplink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 void GTPApplication::discard_downlink_tunnel_flow(
@@ -239,7 +496,10 @@ void GTPApplication::discard_downlink_tunnel_flow(
 
   add_downlink_match(downlink_fm, ev.get_ue_ip());
 
-  messenger.send_of_msg(downlink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    downlink_fm,
+    ev.get_connection(),
+    tunnel_origin("discard downlink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 void GTPApplication::forward_uplink_tunnel_flow(
@@ -256,7 +516,10 @@ void GTPApplication::forward_uplink_tunnel_flow(
 
   add_uplink_match(uplink_fm, gtp_port_num_, ev.get_in_tei());
 
-  messenger.send_of_msg(uplink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    uplink_fm,
+    ev.get_connection(),
+    tunnel_origin("forward uplink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 void GTPApplication::forward_downlink_tunnel_flow(
@@ -273,7 +536,10 @@ void GTPApplication::forward_downlink_tunnel_flow(
 
   add_downlink_match(downlink_fm, ev.get_ue_ip());
 
-  messenger.send_of_msg(downlink_fm, ev.get_connection());
+  messenger.queue_of_msg(
+    downlink_fm,
+    ev.get_connection(),
+    tunnel_origin("forward downlink", ev.get_in_tei(), ev.get_ue_ip()));
 }
 
 } // namespace openflow
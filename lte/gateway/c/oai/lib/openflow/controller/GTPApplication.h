@@ -24,12 +24,16 @@
 #include <gmp.h> // gross but necessary to link spgw_config.h
 
 #include "OpenflowController.h"
+#include "TunnelFlowTable.h"
 
 namespace openflow {
 
 /**
  * GTPApplication handles external callbacks to add/delete tunnel flows for a
- * UE when it connects
+ * UE when it connects. It keeps a table of the tunnels it installed, which is
+ * replayed when the switch reconnects, e.g. after an OVS restart, and
+ * periodically compared with the switch flow stats to fix flows that went
+ * missing or were left over
  */
 class GTPApplication : public Application {
  public:
@@ -109,10 +113,59 @@ class GTPApplication : public Application {
     const HandleDataOnGTPTunnelEvent &ev,
     const OpenflowMessenger &messenger);
 
+  /*
+   * Keep the tunnel flow table in sync with a tunnel event
+   */
+  void track_tunnel_event(const ControllerEvent &ev);
+
+  /*
+   * Install the flows of all tunnels in the table, in one batch
+   * @param ofconn - connection to the switch that just connected
+   */
+  void replay_tunnel_flows(
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
+  /*
+   * Ask the switch for the table 0 flows, to reconcile them with the tunnel
+   * flow table once the reply is complete
+   */
+  void request_flow_stats();
+
+  /*
+   * Record the tunnel flows of a flow stats reply, and reconcile the flows
+   * with the table on the last part of the reply
+   */
+  void handle_flow_stats_reply(
+    const FlowStatsReplyEvent &ev,
+    const OpenflowMessenger &messenger);
+
+  /*
+   * Add the tunnel flows missing from the switch and remove the flows of
+   * unknown tunnels, so only the difference is sent
+   */
+  void reconcile_tunnel_flows(
+    fluid_base::OFConnection *ofconn,
+    const OpenflowMessenger &messenger);
+
+  static void *reconcile_timer_callback(void *arg);
+
  private:
   static const uint32_t DEFAULT_PRIORITY = 10;
   static const std::string GTP_PORT_MAC;
   static const uint16_t NEXT_TABLE = 1;
+  // The tunnel flows are compared with the switch's flow table this often,
+  // to restore flows lost when OVS restarted without the connection dropping
+  static const int RECONCILE_INTERVAL_MS = 60000;
+
+  TunnelFlowTable tunnel_flows_;
+  // tunnel flows seen in the parts of the flow stats reply received so far
+  ObservedTunnelFlows observed_flows_;
+  // xid of the last flow stats request, older replies are ignored
+  uint32_t flow_stats_xid_;
+  // connection the reconcile timer runs on, NULL while the switch is down
+  fluid_base::OFConnection *ofconn_;
+  const OpenflowMessenger *messenger_;
 
   const std::string uplink_mac_;
   const uint32_t gtp_port_num_;
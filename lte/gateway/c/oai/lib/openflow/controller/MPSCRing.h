@@ -0,0 +1,126 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace openflow {
+
+/**
+ * Bounded lock-free queue with many producers and a single consumer. Items
+ * are copied into preallocated slots, so pushing and popping never allocate.
+ * Each slot has a sequence number telling whether it is free for the push
+ * at a given position, or holds the item for the pop at that position.
+ */
+template<typename T>
+class MPSCRing {
+ public:
+  /**
+   * @param capacity - number of slots, must be a power of two
+   */
+  explicit MPSCRing(size_t capacity):
+    mask_(capacity - 1),
+    slots_(new Slot[capacity]),
+    tail_(0),
+    head_(0)
+  {
+    if (capacity == 0 || (capacity & mask_) != 0) {
+      throw std::invalid_argument("MPSCRing capacity must be a power of two");
+    }
+    for (size_t i = 0; i < capacity; i++) {
+      slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Add an item, can be called from any thread
+   *
+   * @return false if the ring is full
+   */
+  bool push(const T &item)
+  {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot &slot = slots_[pos & mask_];
+      size_t seq = slot.seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(
+              pos, pos + 1, std::memory_order_relaxed)) {
+          slot.item = item;
+          slot.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (diff < 0) {
+        // the consumer has not popped the item from the last lap yet
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  /**
+   * Take the oldest item, must only be called from the consumer thread
+   *
+   * @return false if the ring is empty
+   */
+  bool pop(T &item)
+  {
+    Slot &slot = slots_[head_ & mask_];
+    if (slot.seq.load(std::memory_order_acquire) != head_ + 1) {
+      return false;
+    }
+    item = slot.item;
+    slot.seq.store(head_ + mask_ + 1, std::memory_order_release);
+    head_++;
+    return true;
+  }
+
+  /**
+   * Returns true if pop would fail, must only be called from the consumer
+   * thread. An item that is being pushed concurrently is not counted
+   */
+  bool empty() const
+  {
+    return slots_[head_ & mask_].seq.load(std::memory_order_acquire) !=
+           head_ + 1;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    T item;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  // producers and the consumer work on different cache lines
+  alignas(64) std::atomic<size_t> tail_;
+  alignas(64) size_t head_; // only used by the consumer
+};
+
+} // namespace openflow
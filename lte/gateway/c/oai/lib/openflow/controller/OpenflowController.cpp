@@ -44,8 +44,12 @@ OpenflowController::OpenflowController(
       .supported_version(OF_13_VERSION) // OF 1.3
       .use_hello_elements(true)         // bitmask version negotiation
       .keep_data_ownership(false)),
+  latest_ofconn_(NULL),
   running_(true),
-  messenger_(messenger)
+  messenger_(messenger),
+  tunnel_ops_(TUNNEL_OP_RING_SIZE),
+  tunnel_ops_scheduled_(false),
+  self_(this, [](void *) {})
 {
 }
 
@@ -93,6 +97,13 @@ void OpenflowController::message_callback(
   } else if (type == OFPT_ERROR) {
     dispatch_event(
       ErrorEvent(ofconn, reinterpret_cast<struct ofp_error_msg *>(data)));
+  } else if (type == OFPT_MULTIPART_REPLY_TYPE) {
+    // The multipart type follows the openflow header
+    uint16_t mp_type = ntohs(*reinterpret_cast<uint16_t *>(
+      static_cast<uint8_t *>(data) + sizeof(struct ofp_header)));
+    if (mp_type == of13::OFPMP_FLOW) {
+      dispatch_event(FlowStatsReplyEvent(ofconn, *this, data, len));
+    }
   }
 }
 
@@ -102,6 +113,7 @@ void OpenflowController::connection_callback(
 {
   if (type == OFConnection::EVENT_CLOSED || type == OFConnection::EVENT_DEAD) {
     OAILOG_ERROR(LOG_GTPV1U, "Openflow controller lost connection to switch\n");
+    messenger_->discard_queued_msgs(ofconn);
     dispatch_event(SwitchDownEvent(ofconn));
   }
 }
@@ -130,4 +142,74 @@ void OpenflowController::inject_external_event(
   latest_ofconn_->add_immediate_event(cb, ev);
 }
 
+bool OpenflowController::enqueue_tunnel_op(const TunnelOp &op)
+{
+  if (latest_ofconn_ == NULL) {
+    throw std::runtime_error("Controller not connected to switch\n");
+  }
+  if (!tunnel_ops_.push(op)) {
+    return false;
+  }
+  // Only the first op pushed after a drain started needs to wake up the
+  // event loop, the others are picked up by the same drain
+  if (!tunnel_ops_scheduled_.exchange(true)) {
+    schedule_tunnel_ops_drain();
+  }
+  return true;
+}
+
+void OpenflowController::schedule_tunnel_ops_drain()
+{
+  latest_ofconn_->add_immediate_event(tunnel_ops_callback, self_);
+}
+
+void *OpenflowController::tunnel_ops_callback(std::shared_ptr<void> data)
+{
+  static_cast<OpenflowController *>(data.get())->drain_tunnel_ops();
+  return NULL;
+}
+
+void OpenflowController::drain_tunnel_ops()
+{
+  // Cleared before draining, so that ops pushed after the ring was seen
+  // empty schedule another drain
+  tunnel_ops_scheduled_ = false;
+  TunnelOp op;
+  uint32_t count = 0;
+  while (count < MAX_TUNNEL_OPS_PER_DRAIN && tunnel_ops_.pop(op)) {
+    dispatch_tunnel_op(op);
+    count++;
+  }
+  messenger_->flush_queued_msgs();
+  // Leave the event loop to other events between batches
+  if (!tunnel_ops_.empty() && !tunnel_ops_scheduled_.exchange(true)) {
+    schedule_tunnel_ops_drain();
+  }
+}
+
+void OpenflowController::dispatch_tunnel_op(const TunnelOp &op)
+{
+  switch (op.type) {
+    case EVENT_ADD_GTP_TUNNEL: {
+      AddGTPTunnelEvent ev(
+        op.ue_ip, op.enb_ip, op.in_tei, op.out_tei, op.imsi);
+      ev.set_of_connection(latest_ofconn_);
+      dispatch_event(ev);
+    } break;
+    case EVENT_DELETE_GTP_TUNNEL: {
+      DeleteGTPTunnelEvent ev(op.ue_ip, op.in_tei);
+      ev.set_of_connection(latest_ofconn_);
+      dispatch_event(ev);
+    } break;
+    case EVENT_DISCARD_DATA_ON_GTP_TUNNEL:
+    case EVENT_FORWARD_DATA_ON_GTP_TUNNEL: {
+      HandleDataOnGTPTunnelEvent ev(op.ue_ip, op.in_tei, op.type);
+      ev.set_of_connection(latest_ofconn_);
+      dispatch_event(ev);
+    } break;
+    default:
+      OAILOG_ERROR(LOG_GTPV1U, "Unknown tunnel op type %d\n", op.type);
+  }
+}
+
 } // namespace openflow
@@ -21,12 +21,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 #include <list>
 
 #include <fluid/OFServer.hh>
 
 #include "ControllerEvents.h"
+#include "MPSCRing.h"
 #include "OpenflowMessenger.h"
 
 namespace openflow {
@@ -46,7 +48,8 @@ class Application {
 enum OF_MESSAGE_TYPES {
   OFPT_ERROR = 1,
   OFPT_FEATURES_REPLY_TYPE = 6,
-  OFPT_PACKET_IN_TYPE = 10
+  OFPT_PACKET_IN_TYPE = 10,
+  OFPT_MULTIPART_REPLY_TYPE = 19
 };
 
 class OpenflowController : public fluid_base::OFServer {
@@ -134,11 +137,47 @@ class OpenflowController : public fluid_base::OFServer {
     std::shared_ptr<ExternalEvent> ev,
     void *(*cb)(std::shared_ptr<void>) );
 
+  /**
+   * Queue a GTP tunnel operation from another thread, e.g. the SPGW task.
+   * Operations go through a lock-free ring instead of one event loop callback
+   * each. The event loop drains the ring in batches, dispatches a tunnel
+   * event per operation and flushes the queued flow mods once per batch.
+   *
+   * @param op - the tunnel operation, copied into the ring
+   * @return false if the ring is full
+   */
+  bool enqueue_tunnel_op(const TunnelOp &op);
+
+  /**
+   * Dispatch the tunnel operations waiting in the ring, up to
+   * MAX_TUNNEL_OPS_PER_DRAIN of them. Must be called from the event loop
+   */
+  void drain_tunnel_ops();
+
+ protected:
+  fluid_base::OFConnection *latest_ofconn_;
+
+  /**
+   * Wake up the event loop to drain the tunnel ops ring. Overridden in tests,
+   * which have no switch connection
+   */
+  virtual void schedule_tunnel_ops_drain();
+
  private:
+  static const size_t TUNNEL_OP_RING_SIZE = 16384;
+  static const uint32_t MAX_TUNNEL_OPS_PER_DRAIN = 256;
+
   std::shared_ptr<OpenflowMessenger> messenger_;
   std::unordered_map<uint32_t, std::vector<Application *>> event_listeners;
   bool running_;
-  fluid_base::OFConnection *latest_ofconn_;
+  MPSCRing<TunnelOp> tunnel_ops_;
+  // set while a drain of the tunnel ops ring is scheduled in the event loop
+  std::atomic<bool> tunnel_ops_scheduled_;
+  // passed to the event loop to find the controller, does not own it
+  std::shared_ptr<void> self_;
+
+  void dispatch_tunnel_op(const TunnelOp &op);
+  static void *tunnel_ops_callback(std::shared_ptr<void> data);
 };
 
 } // namespace openflow
@@ -19,10 +19,20 @@
  *      contact@openairinterface.org
  */
 
+#include <arpa/inet.h>
+
 #include "OpenflowMessenger.h"
 
 namespace openflow {
 
+std::string QueuedMsgOrigin::to_string() const
+{
+  char ip_str[INET_ADDRSTRLEN];
+  inet_ntop(AF_INET, &ue_ip, ip_str, INET_ADDRSTRLEN);
+  return std::string(action) + " tunnel flow, tei " + std::to_string(tei) +
+         ", ue ip " + ip_str;
+}
+
 fluid_msg::of13::FlowMod DefaultMessenger::create_default_flow_mod(
   uint8_t table_id,
   fluid_msg::of13::ofp_flow_mod_command command,
@@ -49,11 +59,108 @@ void DefaultMessenger::send_of_msg(
   fluid_msg::OFMsg &of_msg,
   fluid_base::OFConnection *ofconn) const
 {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  // Queued messages go first, so that e.g. a barrier covers them
+  auto it = pending_.find(ofconn);
+  if (it != pending_.end()) {
+    flush_connection_locked(ofconn, it->second);
+  }
   uint8_t *buffer;
   buffer = of_msg.pack();
-  ofconn->send(buffer, of_msg.length());
+  write_msgs(ofconn, buffer, of_msg.length());
   // TODO OF_ERROR_HANDLING - check if OF message successfully installed
   fluid_msg::OFMsg::free_buffer(buffer);
 }
 
+void DefaultMessenger::queue_of_msg(
+  fluid_msg::OFMsg &of_msg,
+  fluid_base::OFConnection *ofconn,
+  const QueuedMsgOrigin &origin) const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  uint32_t xid = next_xid_++;
+  if (next_xid_ == 0) {
+    next_xid_ = FIRST_QUEUED_XID;
+  }
+  of_msg.xid(xid);
+
+  uint8_t *buffer = of_msg.pack();
+  auto &pending = pending_[ofconn];
+  pending.buffer.insert(
+    pending.buffer.end(), buffer, buffer + of_msg.length());
+  pending.count++;
+  fluid_msg::OFMsg::free_buffer(buffer);
+
+  if (origins_.empty()) {
+    origins_.resize(static_cast<size_t>(MAX_TRACKED_ORIGINS));
+  }
+  auto &tracked = origins_[xid % MAX_TRACKED_ORIGINS];
+  tracked.xid = xid;
+  tracked.origin = origin;
+
+  if (++queued_count_ >= MAX_QUEUED_MSGS) {
+    flush_locked();
+  }
+}
+
+void DefaultMessenger::flush_queued_msgs() const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  flush_locked();
+}
+
+void DefaultMessenger::flush_locked() const
+{
+  for (auto &conn_pending : pending_) {
+    flush_connection_locked(conn_pending.first, conn_pending.second);
+  }
+}
+
+void DefaultMessenger::flush_connection_locked(
+  fluid_base::OFConnection *ofconn,
+  PendingMessages &pending) const
+{
+  if (pending.count == 0) {
+    return;
+  }
+  // All queued messages of the connection go out in one write
+  write_msgs(ofconn, pending.buffer.data(), pending.buffer.size());
+  queued_count_ -= pending.count;
+  pending.buffer.clear();
+  pending.count = 0;
+}
+
+void DefaultMessenger::write_msgs(
+  fluid_base::OFConnection *ofconn,
+  uint8_t *data,
+  size_t length) const
+{
+  ofconn->send(data, length);
+}
+
+void DefaultMessenger::discard_queued_msgs(
+  fluid_base::OFConnection *ofconn) const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  auto it = pending_.find(ofconn);
+  if (it == pending_.end()) {
+    return;
+  }
+  queued_count_ -= it->second.count;
+  pending_.erase(it);
+}
+
+std::string DefaultMessenger::get_queued_msg_origin(uint32_t xid) const
+{
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  if (origins_.empty()) {
+    return "";
+  }
+  const auto &tracked = origins_[xid % MAX_TRACKED_ORIGINS];
+  if (tracked.xid != xid || tracked.origin.action == nullptr) {
+    return "";
+  }
+  return tracked.origin.to_string();
+}
+
 } // namespace openflow
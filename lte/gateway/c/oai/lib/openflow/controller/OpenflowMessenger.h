@@ -21,11 +21,29 @@
 
 #pragma once
 
+#include <netinet/in.h>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include <fluid/of10msg.hh>
 #include <fluid/of13msg.hh>
 #include <fluid/OFServer.hh>
 
 namespace openflow {
+/**
+ * The tunnel event a queued message was made for. It is only formatted when
+ * OVS rejects the message, so queueing a message doesn't build any string
+ */
+struct QueuedMsgOrigin {
+  const char *action; // string literal, not copied
+  uint32_t tei;
+  struct in_addr ue_ip;
+
+  std::string to_string() const;
+};
+
 /**
  * Abstract helper class with libfluid message utilities
  */
@@ -48,7 +66,8 @@ class OpenflowMessenger {
   }
 
   /**
-   * Sends a completed flow modification to OVS
+   * Sends a message to OVS right away, after the messages already queued for
+   * the connection
    *
    * @param flow_mod - a flow modification (add/delete) to make
    * @param ofconn - the connection to send the flow mod to
@@ -58,6 +77,42 @@ class OpenflowMessenger {
     fluid_base::OFConnection *ofconn) const
   {
   }
+
+  /**
+   * Queues a message to be sent to OVS with the next flush, so that messages
+   * from many events are written to the connection at once
+   *
+   * @param of_msg - message to queue, its xid is overwritten
+   * @param ofconn - the connection to send the message to
+   * @param origin - what the message was made for, logged if OVS rejects it
+   */
+  virtual void queue_of_msg(
+    fluid_msg::OFMsg &of_msg,
+    fluid_base::OFConnection *ofconn,
+    const QueuedMsgOrigin &origin) const
+  {
+  }
+
+  /**
+   * Writes all queued messages to their connections
+   */
+  virtual void flush_queued_msgs() const {}
+
+  /**
+   * Drops the messages queued for a connection, e.g. when it is closed
+   */
+  virtual void discard_queued_msgs(fluid_base::OFConnection *ofconn) const {}
+
+  /**
+   * Returns the origin a queued message was given, or an empty string if the
+   * message is not known anymore
+   *
+   * @param xid - transaction id of the message, as reported in OVS errors
+   */
+  virtual std::string get_queued_msg_origin(uint32_t xid) const
+  {
+    return "";
+  }
 };
 
 /**
@@ -72,6 +127,58 @@ class DefaultMessenger : public OpenflowMessenger {
 
   void send_of_msg(fluid_msg::OFMsg &of_msg, fluid_base::OFConnection *ofconn)
     const;
+
+  void queue_of_msg(
+    fluid_msg::OFMsg &of_msg,
+    fluid_base::OFConnection *ofconn,
+    const QueuedMsgOrigin &origin) const;
+
+  void flush_queued_msgs() const;
+
+  void discard_queued_msgs(fluid_base::OFConnection *ofconn) const;
+
+  std::string get_queued_msg_origin(uint32_t xid) const;
+
+ protected:
+  // Queued messages are flushed once this many are waiting
+  static const uint32_t MAX_QUEUED_MSGS = 64;
+  // Number of queued messages whose origin is kept for error reporting, a
+  // power of 2
+  static const uint32_t MAX_TRACKED_ORIGINS = 4096;
+  // Queued messages get xids from here on, to tell them from other messages
+  static const uint32_t FIRST_QUEUED_XID = 0x10000;
+
+  /**
+   * Writes packed messages to a connection, called with the queue lock
+   */
+  virtual void write_msgs(
+    fluid_base::OFConnection *ofconn,
+    uint8_t *data,
+    size_t length) const;
+
+ private:
+  struct PendingMessages {
+    std::vector<uint8_t> buffer;
+    uint32_t count = 0;
+  };
+
+  struct TrackedOrigin {
+    uint32_t xid = 0;
+    QueuedMsgOrigin origin = {};
+  };
+
+  mutable std::mutex queue_mutex_;
+  mutable std::unordered_map<fluid_base::OFConnection *, PendingMessages>
+    pending_;
+  mutable uint32_t queued_count_ = 0;
+  mutable uint32_t next_xid_ = FIRST_QUEUED_XID;
+  // Indexed by xid, the oldest origins are overwritten
+  mutable std::vector<TrackedOrigin> origins_;
+
+  void flush_locked() const;
+  void flush_connection_locked(
+    fluid_base::OFConnection *ofconn,
+    PendingMessages &pending) const;
 };
 
 } // namespace openflow
@@ -0,0 +1,161 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <string.h>
+
+#include "TunnelFlowTable.h"
+
+namespace openflow {
+
+void ObservedTunnelFlows::clear()
+{
+  uplink_teis.clear();
+  downlink_ips.clear();
+  discard_uplink_teis.clear();
+  discard_downlink_ips.clear();
+}
+
+bool TunnelFlowDiff::empty() const
+{
+  return missing_uplinks.empty() && missing_downlinks.empty() &&
+         missing_discard_uplinks.empty() &&
+         missing_discard_downlinks.empty() && stale_uplink_teis.empty() &&
+         stale_downlink_ips.empty() && stale_discard_uplink_teis.empty() &&
+         stale_discard_downlink_ips.empty();
+}
+
+void TunnelFlowTable::add_tunnel(
+  const struct in_addr &ue_ip,
+  const struct in_addr &enb_ip,
+  uint32_t in_tei,
+  uint32_t out_tei,
+  const std::string &imsi)
+{
+  auto it = tunnels_.find(in_tei);
+  if (it != tunnels_.end() && it->second.ue_ip.s_addr != ue_ip.s_addr) {
+    // The tei moved to another UE IP, the old downlink flow is left over
+    auto dl = downlinks_.find(it->second.ue_ip.s_addr);
+    if (dl != downlinks_.end() && dl->second == in_tei) {
+      downlinks_.erase(dl);
+    }
+  }
+  TunnelFlow &tunnel = tunnels_[in_tei];
+  tunnel.ue_ip = ue_ip;
+  tunnel.enb_ip = enb_ip;
+  tunnel.in_tei = in_tei;
+  tunnel.out_tei = out_tei;
+  strncpy(tunnel.imsi, imsi.c_str(), sizeof(tunnel.imsi) - 1);
+  tunnel.imsi[sizeof(tunnel.imsi) - 1] = '\0';
+  tunnel.discarding = false;
+  downlinks_[ue_ip.s_addr] = in_tei;
+}
+
+void TunnelFlowTable::remove_tunnel(
+  const struct in_addr &ue_ip,
+  uint32_t in_tei)
+{
+  tunnels_.erase(in_tei);
+  downlinks_.erase(ue_ip.s_addr);
+}
+
+void TunnelFlowTable::set_discarding(uint32_t in_tei, bool discarding)
+{
+  auto it = tunnels_.find(in_tei);
+  if (it != tunnels_.end()) {
+    it->second.discarding = discarding;
+  }
+}
+
+void TunnelFlowTable::clear()
+{
+  tunnels_.clear();
+  downlinks_.clear();
+}
+
+size_t TunnelFlowTable::size() const
+{
+  return tunnels_.size();
+}
+
+const std::unordered_map<uint32_t, TunnelFlow> &TunnelFlowTable::get_tunnels()
+  const
+{
+  return tunnels_;
+}
+
+bool TunnelFlowTable::owns_downlink(const TunnelFlow &tunnel) const
+{
+  auto it = downlinks_.find(tunnel.ue_ip.s_addr);
+  return it != downlinks_.end() && it->second == tunnel.in_tei;
+}
+
+TunnelFlowDiff TunnelFlowTable::diff(const ObservedTunnelFlows &observed) const
+{
+  TunnelFlowDiff diff;
+  std::unordered_set<uint32_t> discard_ips;
+  for (const auto &tunnel_pair : tunnels_) {
+    const TunnelFlow &tunnel = tunnel_pair.second;
+    if (observed.uplink_teis.count(tunnel.in_tei) == 0) {
+      diff.missing_uplinks.push_back(&tunnel);
+    }
+    if (
+      owns_downlink(tunnel) &&
+      observed.downlink_ips.count(tunnel.ue_ip.s_addr) == 0) {
+      diff.missing_downlinks.push_back(&tunnel);
+    }
+    if (!tunnel.discarding) {
+      continue;
+    }
+    if (observed.discard_uplink_teis.count(tunnel.in_tei) == 0) {
+      diff.missing_discard_uplinks.push_back(&tunnel);
+    }
+    if (
+      discard_ips.insert(tunnel.ue_ip.s_addr).second &&
+      observed.discard_downlink_ips.count(tunnel.ue_ip.s_addr) == 0) {
+      diff.missing_discard_downlinks.push_back(&tunnel);
+    }
+  }
+
+  for (uint32_t tei : observed.uplink_teis) {
+    if (tunnels_.count(tei) == 0) {
+      diff.stale_uplink_teis.push_back(tei);
+    }
+  }
+  for (uint32_t ip : observed.downlink_ips) {
+    if (downlinks_.count(ip) == 0) {
+      diff.stale_downlink_ips.push_back(ip);
+    }
+  }
+  for (uint32_t tei : observed.discard_uplink_teis) {
+    auto it = tunnels_.find(tei);
+    if (it == tunnels_.end() || !it->second.discarding) {
+      diff.stale_discard_uplink_teis.push_back(tei);
+    }
+  }
+  for (uint32_t ip : observed.discard_downlink_ips) {
+    if (discard_ips.count(ip) == 0) {
+      diff.stale_discard_downlink_ips.push_back(ip);
+    }
+  }
+  return diff;
+}
+
+} // namespace openflow
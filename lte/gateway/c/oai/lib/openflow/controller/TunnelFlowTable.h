@@ -0,0 +1,128 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <arpa/inet.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace openflow {
+
+/**
+ * State of one GTP tunnel as installed by the GTPApplication, enough to
+ * rebuild all of its flows
+ */
+struct TunnelFlow {
+  struct in_addr ue_ip;
+  struct in_addr enb_ip;
+  uint32_t in_tei;
+  uint32_t out_tei;
+  char imsi[16];   // NUL terminated
+  bool discarding; // discard flows installed on top of the tunnel flows
+};
+
+/**
+ * Tunnel flows found in the switch flow table. IPs are in network order
+ */
+struct ObservedTunnelFlows {
+  std::unordered_set<uint32_t> uplink_teis;
+  std::unordered_set<uint32_t> downlink_ips;
+  std::unordered_set<uint32_t> discard_uplink_teis;
+  std::unordered_set<uint32_t> discard_downlink_ips;
+
+  void clear();
+};
+
+/**
+ * Difference between the tunnel flow table and the flows in the switch. The
+ * tunnel pointers are only valid until the table is modified
+ */
+struct TunnelFlowDiff {
+  std::vector<const TunnelFlow *> missing_uplinks;
+  std::vector<const TunnelFlow *> missing_downlinks;
+  std::vector<const TunnelFlow *> missing_discard_uplinks;
+  std::vector<const TunnelFlow *> missing_discard_downlinks;
+  std::vector<uint32_t> stale_uplink_teis;
+  std::vector<uint32_t> stale_downlink_ips;
+  std::vector<uint32_t> stale_discard_uplink_teis;
+  std::vector<uint32_t> stale_discard_downlink_ips;
+
+  bool empty() const;
+};
+
+/**
+ * TunnelFlowTable mirrors the tunnel flows the GTPApplication installed, so
+ * that they can be replayed when the switch restarts, and compared against
+ * the switch flow table to only fix the flows that differ.
+ * Uplink flows match on the inbound tei and downlink flows on the UE IP, so
+ * the table keeps tunnels by tei and which tunnel owns the downlink flow of
+ * each UE IP. Not thread safe, it is only used from the event loop.
+ */
+class TunnelFlowTable {
+ public:
+  void add_tunnel(
+    const struct in_addr &ue_ip,
+    const struct in_addr &enb_ip,
+    uint32_t in_tei,
+    uint32_t out_tei,
+    const std::string &imsi);
+
+  /**
+   * Remove a tunnel. The downlink flow of the UE IP is removed as well, even
+   * if it belongs to another tunnel, like the delete flow mod does
+   */
+  void remove_tunnel(const struct in_addr &ue_ip, uint32_t in_tei);
+
+  /**
+   * Mark whether data on the tunnel is discarded. Unknown teis are ignored
+   */
+  void set_discarding(uint32_t in_tei, bool discarding);
+
+  void clear();
+
+  size_t size() const;
+
+  const std::unordered_map<uint32_t, TunnelFlow> &get_tunnels() const;
+
+  /**
+   * @return true if the downlink flow for the tunnel's UE IP is the tunnel's
+   */
+  bool owns_downlink(const TunnelFlow &tunnel) const;
+
+  /**
+   * Compare the table with the flows found in the switch
+   * @param observed - tunnel flows in the switch
+   * @return the flows to add and to remove for the switch to match the table
+   */
+  TunnelFlowDiff diff(const ObservedTunnelFlows &observed) const;
+
+ private:
+  // tunnels by inbound tei
+  std::unordered_map<uint32_t, TunnelFlow> tunnels_;
+  // inbound tei of the tunnel owning the downlink flow, by UE IP
+  std::unordered_map<uint32_t, uint32_t> downlinks_;
+};
+
+} // namespace openflow
@@ -19,7 +19,6 @@
  *      contact@openairinterface.org
  */
 #include "lte/protos/mconfig/mconfigs.pb.h"
-#include <thread> // std::thread
 #include "ServiceConfigLoader.h"
 #include "MConfigLoader.h"
 #include "S6aClient.h"
@@ -66,27 +65,19 @@ S6aClient &S6aClient::get_instance()
   return client_instance;
 }
 
-S6aClient::S6aClient()
-{
-  /* Based on relaymode configuration, Create channel
-    If relaymode is set, create channel towards feg
-    otherwise create channel towards subscriberdb
-   */
-
-  if (get_s6a_relay_enabled() == true) {
-    auto channel = ServiceRegistrySingleton::Instance()->GetGrpcChannel(
-      "s6a_proxy", ServiceRegistrySingleton::CLOUD);
-    // Create stub for S6aProxy gRPC service
-    stub_ = S6aProxy::NewStub(channel);
-  } else {
-    auto channel = ServiceRegistrySingleton::Instance()->GetGrpcChannel(
-      "subscriberdb", ServiceRegistrySingleton::LOCAL);
-    // Create stub for subscriberdb gRPC service
-    stub_ = S6aProxy::NewStub(channel);
-  }
+// The NAS procedure timers take care of retransmissions
+const AsyncCallOptions S6aClient::CALL_OPTIONS = {.timeout_sec = 3};
 
-  std::thread resp_loop_thread([&]() { rpc_response_loop(); });
-  resp_loop_thread.detach();
+/* Based on relaymode configuration, create channels
+  If relaymode is set, create channels towards feg
+  otherwise create channels towards subscriberdb
+ */
+S6aClient::S6aClient():
+  stubs_(
+    get_s6a_relay_enabled() ? "s6a_proxy" : "subscriberdb",
+    get_s6a_relay_enabled() ? ServiceRegistrySingleton::CLOUD :
+                              ServiceRegistrySingleton::LOCAL)
+{
 }
 
 void S6aClient::purge_ue(
@@ -95,23 +86,14 @@ void S6aClient::purge_ue(
 {
   S6aClient &client = get_instance();
 
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto resp =
-    new AsyncLocalResponse<PurgeUEAnswer>(std::move(callbk), RESPONSE_TIMEOUT);
-
-  // Create a response reader for the `PurgeUE` RPC call. This reader
-  // stores the client context, the request to pass in, and the queue to add
-  // the response to when done
   PurgeUERequest puRequest;
   puRequest.set_user_name(imsi);
-  auto resp_rdr =
-    client.stub_->AsyncPurgeUE(resp->get_context(), puRequest, &client.queue_);
 
-  // Set the reader for the response. This executes the `PurgeUE`
-  // response using the response reader. When it is done, the callback stored
-  // in `resp` will be called
-  resp->set_response_reader(std::move(resp_rdr));
+  // Make the `PurgeUE` call through the shared client runtime. When it is
+  // answered, the callback will be called on a runtime thread
+  AsyncClientRuntime::get_instance().call(
+    "S6aProxy.PurgeUE", client.stubs_.get(), &S6aProxy::Stub::AsyncPurgeUE,
+    puRequest, std::move(callbk), CALL_OPTIONS);
 }
 
 void S6aClient::authentication_info_req(
@@ -121,22 +103,13 @@ void S6aClient::authentication_info_req(
   S6aClient &client = get_instance();
   AuthenticationInformationRequest proto_msg =
     convert_itti_s6a_authentication_info_req_to_proto_msg(msg);
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto resp = new AsyncLocalResponse<AuthenticationInformationAnswer>(
-    std::move(callbk), RESPONSE_TIMEOUT);
-
-  // Create a response reader for the `authentication_info_req` RPC call.
-  // This reader stores the client context, the request to pass in, and
-  // the queue to add the response to when done
-
-  auto resp_rdr = client.stub_->AsyncAuthenticationInformation(
-    resp->get_context(), proto_msg, &client.queue_);
-
-  // Set the reader for the response. This executes the `Auth_Info_Req`
-  // response using the response reader. When it is done, the callback stored
-  // in `resp` will be called
-  resp->set_response_reader(std::move(resp_rdr));
+  // Make the `AuthenticationInformation` call through the shared client
+  // runtime. When it is answered, the callback will be called on a runtime
+  // thread
+  AsyncClientRuntime::get_instance().call(
+    "S6aProxy.AuthenticationInformation", client.stubs_.get(),
+    &S6aProxy::Stub::AsyncAuthenticationInformation, proto_msg,
+    std::move(callbk), CALL_OPTIONS);
 }
 
 void S6aClient::update_location_request(
@@ -146,22 +119,12 @@ void S6aClient::update_location_request(
   S6aClient &client = get_instance();
   UpdateLocationRequest proto_msg =
     convert_itti_s6a_update_location_request_to_proto_msg(msg);
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto resp = new AsyncLocalResponse<UpdateLocationAnswer>(
-    std::move(callbk), RESPONSE_TIMEOUT);
-
-  // Create a response reader for the `update_location_request` RPC call.
-  // This reader stores the client context, the request to pass in, and
-  // the queue to add the response to when done
-
-  auto resp_rdr = client.stub_->AsyncUpdateLocation(
-    resp->get_context(), proto_msg, &client.queue_);
-
-  // Set the reader for the response. This executes the `Location Update Req`
-  // response using the response reader. When it is done, the callback stored
-  // in `resp` will be called
-  resp->set_response_reader(std::move(resp_rdr));
+  // Make the `UpdateLocation` call through the shared client runtime. When it
+  // is answered, the callback will be called on a runtime thread
+  AsyncClientRuntime::get_instance().call(
+    "S6aProxy.UpdateLocation", client.stubs_.get(),
+    &S6aProxy::Stub::AsyncUpdateLocation, proto_msg, std::move(callbk),
+    CALL_OPTIONS);
 }
 
 } // namespace magma
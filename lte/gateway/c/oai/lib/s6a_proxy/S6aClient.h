@@ -28,7 +28,7 @@
 #include <grpc++/grpc++.h>
 #include "feg/protos/s6a_proxy.grpc.pb.h"
 
-#include "GRPCReceiver.h"
+#include "AsyncClientRuntime.h"
 
 extern "C" {
 #include "intertask_interface.h"
@@ -40,11 +40,10 @@ namespace magma {
 
 /**
  * S6aClient is the main asynchronous client for interacting with s6a_proxy.
- * Responses will come in a queue and call the callback passed
- * To start the client and make sure it receives calls, one must call the
- * rpc_response_loop method defined in the GRPCReceiver base class
+ * Calls are made through the shared AsyncClientRuntime, which calls the
+ * callback passed once the response comes in
  */
-class S6aClient : public GRPCReceiver {
+class S6aClient {
  public:
   /**
    * Proxy a purge gRPC call to s6a_proxy
@@ -74,8 +73,8 @@ class S6aClient : public GRPCReceiver {
  private:
   S6aClient();
   static S6aClient &get_instance();
-  std::unique_ptr<feg::S6aProxy::Stub> stub_;
-  static const uint32_t RESPONSE_TIMEOUT = 3; // seconds
+  StubPool<feg::S6aProxy::Stub> stubs_;
+  static const AsyncCallOptions CALL_OPTIONS;
 };
 
 bool get_s6a_relay_enabled(void);
@@ -66,6 +66,7 @@ bool s6a_purge_ue(const char *imsi)
 static void _s6a_handle_authentication_info_ans(
   const std::string &imsi,
   uint8_t imsi_length,
+  bool is_prefetch,
   const grpc::Status &status,
   feg::AuthenticationInformationAnswer response)
 {
@@ -76,6 +77,7 @@ static void _s6a_handle_authentication_info_ans(
   itti_msg = &message_p->ittiMsg.s6a_auth_info_ans;
   strncpy(itti_msg->imsi, imsi.c_str(), imsi_length);
   itti_msg->imsi_length = imsi_length;
+  itti_msg->is_prefetch = is_prefetch;
 
   if (status.ok()) {
     if (response.error_code() < feg::ErrorCode::COMMAND_UNSUPORTED) {
@@ -108,14 +110,16 @@ static void _s6a_handle_authentication_info_ans(
 bool s6a_authentication_info_req(const s6a_auth_info_req_t *const air_p)
 {
   auto imsi_len = air_p->imsi_length;
+  bool is_prefetch = air_p->is_prefetch;
   std::cout << "[INFO] Sending S6A-AUTHENTICATION_INFORMATION_REQUEST with IMSI: "
               << std::string(air_p->imsi) << std::endl;
 
   magma::S6aClient::authentication_info_req(
     air_p,
-    [imsiStr = std::string(air_p->imsi), imsi_len](
+    [imsiStr = std::string(air_p->imsi), imsi_len, is_prefetch](
       grpc::Status status, feg::AuthenticationInformationAnswer response) {
-      _s6a_handle_authentication_info_ans(imsiStr, imsi_len, status, response);
+      _s6a_handle_authentication_info_ans(
+        imsiStr, imsi_len, is_prefetch, status, response);
     });
   return true;
 }
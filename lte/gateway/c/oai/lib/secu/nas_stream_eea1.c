@@ -41,13 +41,12 @@ int nas_stream_encrypt_eea1(
   uint8_t *const out)
 {
   snow_3g_context_t snow_3g_context;
-  int n;
-  int i = 0;
+  uint32_t n;
+  uint32_t i = 0;
   uint32_t zero_bit = 0;
-  //uint32_t                                byte_length;
+  uint32_t byte_length;
   uint32_t *KS;
   uint32_t K[4], IV[4];
-  uint32_t len = 0;
 
   DevAssert(stream_cipher != NULL);
   DevAssert(stream_cipher->key != NULL);
@@ -55,7 +54,7 @@ int nas_stream_encrypt_eea1(
   DevAssert(out != NULL);
   n = (stream_cipher->blength + 31) / 32;
   zero_bit = stream_cipher->blength & 0x7;
-  //byte_length = stream_cipher->blength >> 3;
+  byte_length = (stream_cipher->blength + 7) >> 3;
   memset(&snow_3g_context, 0, sizeof(snow_3g_context));
   /*
    * Initialisation
@@ -105,27 +104,19 @@ int nas_stream_encrypt_eea1(
    * Exclusive-OR the input data with keystream to generate the output bit
    * stream
    */
-  for (i = 0; i < n * 4; i++) {
+  for (i = 0; i < byte_length; i++) {
     stream_cipher->message[i] ^= *(((uint8_t *) KS) + i);
   }
 
-  int ceil_index = 0;
-
   if (zero_bit > 0) {
-    ceil_index = (stream_cipher->blength + 7) >> 3;
-    stream_cipher->message[ceil_index - 1] =
-      stream_cipher->message[ceil_index - 1] &
+    stream_cipher->message[byte_length - 1] =
+      stream_cipher->message[byte_length - 1] &
       (uint8_t)(0xFF << (8 - zero_bit));
   }
 
   free_wrapper((void **) &KS);
-  len = sizeof(out);
-  memset(out, 0, len);
-  memcpy(out, stream_cipher->message, n * 4);
-
-  if (zero_bit > 0) {
-    out[ceil_index - 1] = stream_cipher->message[ceil_index - 1];
-  }
+  // out may overlap the message when deciphering in place
+  memmove(out, stream_cipher->message, byte_length);
 
   return 0;
 }
@@ -45,7 +45,6 @@ int nas_stream_encrypt_eea2(
   uint8_t *data;
   uint32_t zero_bit = 0;
   uint32_t byte_length;
-  uint32_t len = 0;
 
   DevAssert(stream_cipher != NULL);
   DevAssert(out != NULL);
@@ -80,8 +79,6 @@ int nas_stream_encrypt_eea2(
     data[byte_length - 1] =
       data[byte_length - 1] & (uint8_t)(0xFF << (8 - zero_bit));
 
-  len = sizeof(out);
-  memset(out, 0, len);
   memcpy(out, data, byte_length);
   free_wrapper((void **) &data);
   free_wrapper((void **) &ctx);
@@ -0,0 +1,147 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <iterator>
+#include <utility>
+
+#include "CSFBCallWindow.h"
+
+namespace magma {
+
+CSFBCallWindow::CSFBCallWindow(
+  size_t max_in_flight,
+  size_t max_pending,
+  std::chrono::milliseconds call_timeout,
+  Clock clock):
+  max_in_flight_(max_in_flight),
+  max_pending_(max_pending),
+  call_timeout_(call_timeout),
+  clock_(std::move(clock)),
+  next_id_(0)
+{
+}
+
+CSFBCallWindow::SubmitResult CSFBCallWindow::submit(
+  const std::string &key,
+  Call call)
+{
+  std::vector<StartedCall> started;
+  SubmitResult result = SubmitResult::STARTED;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked(started);
+    if (in_flight_.size() < max_in_flight_) {
+      start_locked(std::move(call), started);
+    } else if (!key.empty() && queued_.count(key)) {
+      // The new call goes to the back, after any other call it may depend
+      // on
+      auto it = queued_.find(key);
+      queue_.erase(it->second);
+      queue_.push_back(PendingCall {key, std::move(call)});
+      it->second = std::prev(queue_.end());
+      result = SubmitResult::COALESCED;
+    } else if (queue_.size() >= max_pending_) {
+      result = SubmitResult::DROPPED;
+    } else {
+      queue_.push_back(PendingCall {key, std::move(call)});
+      if (!key.empty()) {
+        queued_.emplace(key, std::prev(queue_.end()));
+      }
+      result = SubmitResult::QUEUED;
+    }
+  }
+  run(started);
+  return result;
+}
+
+void CSFBCallWindow::finish(uint64_t id)
+{
+  std::vector<StartedCall> started;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Already finished, or timed out and its slot reused
+    if (!in_flight_.erase(id)) {
+      return;
+    }
+    // The finished call's slot is handed over to the oldest queued call
+    start_queued_locked(started);
+  }
+  run(started);
+}
+
+void CSFBCallWindow::start_locked(
+  Call call,
+  std::vector<StartedCall> &started)
+{
+  uint64_t id = next_id_++;
+  in_flight_.emplace(id, clock_() + call_timeout_);
+  started.emplace_back(std::move(call), [this, id]() { finish(id); });
+}
+
+void CSFBCallWindow::start_queued_locked(std::vector<StartedCall> &started)
+{
+  while (in_flight_.size() < max_in_flight_ && !queue_.empty()) {
+    PendingCall &front = queue_.front();
+    if (!front.key.empty()) {
+      queued_.erase(front.key);
+    }
+    start_locked(std::move(front.call), started);
+    queue_.pop_front();
+  }
+}
+
+void CSFBCallWindow::expire_locked(std::vector<StartedCall> &started)
+{
+  auto now = clock_();
+  // Calls have the same timeout, so the oldest ones expire first
+  while (!in_flight_.empty() && in_flight_.begin()->second <= now) {
+    in_flight_.erase(in_flight_.begin());
+  }
+  start_queued_locked(started);
+}
+
+void CSFBCallWindow::run(std::vector<StartedCall> &started)
+{
+  for (auto &call : started) {
+    call.first(std::move(call.second));
+  }
+}
+
+size_t CSFBCallWindow::in_flight()
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_flight_.size();
+}
+
+size_t CSFBCallWindow::pending()
+{
+  std::vector<StartedCall> started;
+  size_t pending;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    expire_locked(started);
+    pending = queue_.size();
+  }
+  run(started);
+  return pending;
+}
+
+} // namespace magma
@@ -0,0 +1,116 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace magma {
+
+/**
+ * CSFBCallWindow bounds the number of SGs calls in flight to the FeG. Calls
+ * submitted while the window is full wait in a FIFO queue and are started
+ * as earlier calls finish, so calls are started in the order they were
+ * submitted. A queued call with the same coalescing key as a new one is
+ * superseded: it is removed from the queue, and its callback is never
+ * called. A call that has not finished call_timeout after it was started
+ * gives its slot back the next time the window is used, so a lost callback
+ * can not shrink the window. It is thread safe.
+ */
+class CSFBCallWindow {
+ public:
+  /**
+   * Starts a call. The call runs done when it finishes. Only the first run
+   * of done counts, and it is ignored once the call has timed out
+   */
+  using Call = std::function<void(std::function<void()> done)>;
+  using Clock = std::function<std::chrono::steady_clock::time_point()>;
+
+  enum class SubmitResult {
+    STARTED,
+    QUEUED,
+    // queued, superseding a queued call with the same key
+    COALESCED,
+    // the queue already holds max_pending calls
+    DROPPED,
+  };
+
+  CSFBCallWindow(
+    size_t max_in_flight,
+    size_t max_pending,
+    std::chrono::milliseconds call_timeout,
+    Clock clock = std::chrono::steady_clock::now);
+
+  /**
+   * Start the call if fewer than max_in_flight calls are in flight, or queue
+   * it otherwise
+   * @param key - coalescing key, calls with an empty key are never coalesced
+   */
+  SubmitResult submit(const std::string &key, Call call);
+
+  size_t in_flight();
+
+  /**
+   * Number of queued calls. Timed out calls give their slots back first
+   */
+  size_t pending();
+
+ private:
+  struct PendingCall {
+    std::string key;
+    Call call;
+  };
+  using StartedCall = std::pair<Call, std::function<void()>>;
+
+  void finish(uint64_t id);
+
+  // The helpers below are called with mutex_ held. Calls they take a slot
+  // for are added to started, to be run once mutex_ is released
+  void start_locked(Call call, std::vector<StartedCall> &started);
+  void start_queued_locked(std::vector<StartedCall> &started);
+  void expire_locked(std::vector<StartedCall> &started);
+
+  static void run(std::vector<StartedCall> &started);
+
+ private:
+  const size_t max_in_flight_;
+  const size_t max_pending_;
+  const std::chrono::milliseconds call_timeout_;
+  const Clock clock_;
+  std::mutex mutex_;
+  uint64_t next_id_;
+  // deadline of each call in flight, by increasing start order
+  std::map<uint64_t, std::chrono::steady_clock::time_point> in_flight_;
+  std::list<PendingCall> queue_;
+  std::unordered_map<std::string, std::list<PendingCall>::iterator> queued_;
+};
+
+} // namespace magma
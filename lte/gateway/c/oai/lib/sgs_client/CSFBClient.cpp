@@ -19,12 +19,12 @@
  *      contact@openairinterface.org
  */
 
-
-#include <thread> // std::thread
+#include <chrono>
 
 #include "CSFBClient.h"
 #include "itti_msg_to_proto_msg.h"
 #include "ServiceRegistrySingleton.h"
+#include "service303.h"
 
 namespace magma {
 
@@ -34,173 +34,213 @@ CSFBClient &CSFBClient::get_instance()
   return client_instance;
 }
 
-CSFBClient::CSFBClient()
+// The SGs timers take care of retransmissions
+const AsyncCallOptions CSFBClient::CALL_OPTIONS = {.timeout_sec = 3};
+
+CSFBClient::CSFBClient():
+  // Create a stub per pooled channel for the CSFB gRPC service
+  stubs_("csfb", ServiceRegistrySingleton::CLOUD),
+  // The runtime answers every call within its deadline, the window timeout
+  // only reclaims the slots of calls whose callback got lost
+  window_(
+    MAX_IN_FLIGHT_CALLS,
+    MAX_PENDING_CALLS,
+    std::chrono::seconds(2 * CALL_OPTIONS.timeout_sec))
+{
+}
+
+bool CSFBClient::is_congested()
+{
+  return get_instance().window_.pending() >= CONGESTION_PENDING_CALLS;
+}
+
+template <typename RequestType>
+void CSFBClient::send(
+  const char *method,
+  const std::string &coalesce_key,
+  std::unique_ptr<grpc::ClientAsyncResponseReader<Void>> (
+    CSFBFedGWService::Stub::*async_method)(
+    grpc::ClientContext *,
+    const RequestType &,
+    grpc::CompletionQueue *),
+  const RequestType &request,
+  std::function<void(grpc::Status, Void)> callback)
 {
-  // Create channel
-  auto channel = ServiceRegistrySingleton::Instance()->GetGrpcChannel(
-    "csfb", ServiceRegistrySingleton::CLOUD);
-  // Create stub for LocalSessionManager gRPC service
-  stub_ = CSFBFedGWService::NewStub(channel);
-  std::thread resp_loop_thread([&]() { rpc_response_loop(); });
-  resp_loop_thread.detach();
+  CSFBClient &client = get_instance();
+  auto submit_time = std::chrono::steady_clock::now();
+  auto result = client.window_.submit(
+    coalesce_key,
+    [&client, method, async_method, request, callback, submit_time](
+      std::function<void()> done) {
+      // Make the call through the shared client runtime. When it is
+      // answered, the callback will be called on a runtime thread
+      AsyncClientRuntime::get_instance().call(
+        method,
+        client.stubs_.get(),
+        async_method,
+        request,
+        [method, callback, done, submit_time](
+          grpc::Status status, Void response) {
+          done();
+          // grpc_client_latency_ms only covers the RPC itself, this also
+          // counts the time spent waiting for the window
+          std::chrono::duration<double, std::milli> latency =
+            std::chrono::steady_clock::now() - submit_time;
+          observe_histogram(
+            "sgs_message_latency_ms",
+            latency.count(),
+            1,
+            "method",
+            method,
+            (size_t) 7,
+            1.,
+            5.,
+            10.,
+            50.,
+            100.,
+            1000.,
+            3000.);
+          callback(status, response);
+        },
+        CALL_OPTIONS);
+    });
+  switch (result) {
+    case CSFBCallWindow::SubmitResult::COALESCED:
+      increment_counter("sgs_messages_coalesced", 1, 1, "method", method);
+      break;
+    case CSFBCallWindow::SubmitResult::DROPPED:
+      increment_counter("sgs_messages_dropped", 1, 1, "method", method);
+      callback(
+        grpc::Status(
+          grpc::StatusCode::RESOURCE_EXHAUSTED,
+          "Too many pending SGs messages"),
+        Void());
+      break;
+    default: break;
+  }
 }
 
 void CSFBClient::location_update_request(
   const itti_sgsap_location_update_req_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   LocationUpdateRequest proto_msg =
     convert_itti_sgsap_location_update_req_to_proto_msg(msg);
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  // Create a response reader for the `CreateSession` RPC call. This reader
-  // stores the client context, the request to pass in, and the queue to add
-  // the response to when done
-  auto response_reader = client.stub_->AsyncLocationUpdateReq(
-    local_response->get_context(), proto_msg, &client.queue_);
-  // Set the reader for the local response. This executes the `CreateSession`
-  // response using the response reader. When it is done, the callback stored in
-  // `local_response` will be called
-  local_response->set_response_reader(std::move(response_reader));
+  // Only the latest location update request of a UE needs to reach the VLR
+  send(
+    "CSFBFedGWService.LocationUpdateReq",
+    "LocationUpdateReq" + proto_msg.imsi(),
+    &CSFBFedGWService::Stub::AsyncLocationUpdateReq, proto_msg,
+    std::move(callback));
 }
 
 void CSFBClient::alert_ack(
   const itti_sgsap_alert_ack_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   AlertAck proto_msg = convert_itti_sgsap_alert_ack_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncAlertAc(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.AlertAc", "",
+    &CSFBFedGWService::Stub::AsyncAlertAc, proto_msg, std::move(callback));
 }
 
 void CSFBClient::alert_reject(
   const itti_sgsap_alert_reject_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   AlertReject proto_msg = convert_itti_sgsap_alert_reject_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncAlertRej(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.AlertRej", "",
+    &CSFBFedGWService::Stub::AsyncAlertRej, proto_msg, std::move(callback));
 }
 
 void CSFBClient::tmsi_reallocation_complete(
   const itti_sgsap_tmsi_reallocation_comp_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   TMSIReallocationComplete proto_msg =
     convert_itti_sgsap_tmsi_reallocation_comp_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncTMSIReallocationComp(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.TMSIReallocationComp", "",
+    &CSFBFedGWService::Stub::AsyncTMSIReallocationComp, proto_msg,
+    std::move(callback));
 }
 
 void CSFBClient::eps_detach_indication(
   const itti_sgsap_eps_detach_ind_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   EPSDetachIndication proto_msg =
     convert_itti_sgsap_eps_detach_ind_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncEPSDetachInd(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.EPSDetachInd", "",
+    &CSFBFedGWService::Stub::AsyncEPSDetachInd, proto_msg, std::move(callback));
 }
 
 void CSFBClient::imsi_detach_indication(
   const itti_sgsap_imsi_detach_ind_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   IMSIDetachIndication proto_msg =
     convert_itti_sgsap_imsi_detach_ind_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncIMSIDetachInd(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.IMSIDetachInd", "",
+    &CSFBFedGWService::Stub::AsyncIMSIDetachInd, proto_msg,
+    std::move(callback));
 }
 
 void CSFBClient::paging_reject(
   const itti_sgsap_paging_reject_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   PagingReject proto_msg = convert_itti_sgsap_paging_reject_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncPagingRej(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.PagingRej", "",
+    &CSFBFedGWService::Stub::AsyncPagingRej, proto_msg, std::move(callback));
 }
 
 void CSFBClient::service_request(
   const itti_sgsap_service_request_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   ServiceRequest proto_msg =
     convert_itti_sgsap_service_request_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncServiceReq(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.ServiceReq", "",
+    &CSFBFedGWService::Stub::AsyncServiceReq, proto_msg, std::move(callback));
 }
 
 void CSFBClient::ue_activity_indication(
   const itti_sgsap_ue_activity_ind_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   UEActivityIndication proto_msg =
     convert_itti_sgsap_ue_activity_indication_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncUEActivityInd(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.UEActivityInd", "UEActivityInd" + proto_msg.imsi(),
+    &CSFBFedGWService::Stub::AsyncUEActivityInd, proto_msg,
+    std::move(callback));
 }
 
 void CSFBClient::ue_unreachable(
   const itti_sgsap_ue_unreachable_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   UEUnreachable proto_msg = convert_itti_sgsap_ue_unreachable_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncUEUnreach(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.UEUnreach", "",
+    &CSFBFedGWService::Stub::AsyncUEUnreach, proto_msg, std::move(callback));
 }
 
 void CSFBClient::send_uplink_unitdata(
   const itti_sgsap_uplink_unitdata_t *msg,
   std::function<void(grpc::Status, Void)> callback)
 {
-  CSFBClient &client = get_instance();
   UplinkUnitdata proto_msg =
     convert_itti_sgsap_uplink_unitdata_to_proto_msg(msg);
-  auto local_response =
-    new AsyncLocalResponse<Void>(std::move(callback), RESPONSE_TIMEOUT);
-  auto response_reader = client.stub_->AsyncUplink(
-    local_response->get_context(), proto_msg, &client.queue_);
-  local_response->set_response_reader(std::move(response_reader));
+  send(
+    "CSFBFedGWService.Uplink", "",
+    &CSFBFedGWService::Stub::AsyncUplink, proto_msg, std::move(callback));
 }
 
 } // namespace magma
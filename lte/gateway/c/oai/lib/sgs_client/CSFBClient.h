@@ -21,7 +21,8 @@
 
 #pragma once
 
-#include "GRPCReceiver.h"
+#include "AsyncClientRuntime.h"
+#include "CSFBCallWindow.h"
 
 #include <gmp.h>
 #include <grpc++/grpc++.h>
@@ -39,9 +40,18 @@ using namespace feg;
 /**
  * CSFBClient is the main client for sending message to FeG
  * FeG will forward the message to MSC then respond instantly with Void
+ * At most MAX_IN_FLIGHT_CALLS messages are sent at a time, the others wait in
+ * a CSFBCallWindow. A location update request or UE activity indication still
+ * waiting there is replaced by a newer one for the same IMSI
  */
-class CSFBClient : public GRPCReceiver {
+class CSFBClient {
  public:
+  /**
+   * Returns true while so many messages are waiting to be sent that new
+   * location update procedures should not be started
+   */
+  static bool is_congested();
+
   /**
    * Send SGsAP-ALERT-ACK
    */
@@ -126,8 +136,24 @@ class CSFBClient : public GRPCReceiver {
  private:
   CSFBClient();
   static CSFBClient &get_instance();
-  std::unique_ptr<CSFBFedGWService::Stub> stub_;
-  static const uint32_t RESPONSE_TIMEOUT = 3; // seconds
+  template <typename RequestType>
+  static void send(
+    const char *method,
+    const std::string &coalesce_key,
+    std::unique_ptr<grpc::ClientAsyncResponseReader<Void>> (
+      CSFBFedGWService::Stub::*async_method)(
+      grpc::ClientContext *,
+      const RequestType &,
+      grpc::CompletionQueue *),
+    const RequestType &request,
+    std::function<void(grpc::Status, Void)> callback);
+
+  StubPool<CSFBFedGWService::Stub> stubs_;
+  CSFBCallWindow window_;
+  static const AsyncCallOptions CALL_OPTIONS;
+  static const size_t MAX_IN_FLIGHT_CALLS = 64;
+  static const size_t MAX_PENDING_CALLS = 4096;
+  static const size_t CONGESTION_PENDING_CALLS = 1024;
 };
 
 } // namespace magma
@@ -115,3 +115,8 @@ void send_uplink_unitdata(const itti_sgsap_uplink_unitdata_t *msg)
 {
   magma::CSFBClient::send_uplink_unitdata(msg, empty_callback);
 }
+
+bool csfb_client_is_congested(void)
+{
+  return magma::CSFBClient::is_congested();
+}
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <gmp.h>
+#include <stdbool.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -54,6 +55,12 @@ void send_ue_unreachable(const itti_sgsap_ue_unreachable_t *msg);
 
 void send_uplink_unitdata(const itti_sgsap_uplink_unitdata_t *msg);
 
+/*
+ * Returns true while too many SGs messages are waiting to be sent to the FeG,
+ * new location update procedures should then be rejected locally
+ */
+bool csfb_client_is_congested(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,9 +63,7 @@ int main(int argc, char *argv[])
     THREAD_MAX,
     MESSAGES_ID_MAX,
     tasks_info,
-    messages_info,
-    NULL,
-    NULL));
+    messages_info));
 
   /*
    * Parse the command line for options and set the mme_config accordingly.
@@ -97,6 +95,11 @@ int main(int argc, char *argv[])
   // Intialize loggers and configured log levels.
   OAILOG_LOG_CONFIGURE(&mme_config.log_config);
   MSC_INIT(MSC_MME, THREAD_MAX + TASK_MAX);
+  itti_set_memory_pools_limit(mme_config.itti_config.pool_memory_limit_mb);
+  CHECK_INIT_RETURN(itti_start_trace(
+    mme_config.itti_config.trace_records,
+    mme_config.itti_config.trace_payload_size,
+    bdata(mme_config.itti_config.trace_file)));
   CHECK_INIT_RETURN(service303_init(&(mme_config.service303_config)));
 
   // Service started, but not healthy yet
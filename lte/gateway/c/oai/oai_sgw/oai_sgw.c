@@ -84,9 +84,7 @@ int main(int argc, char *argv[])
     THREAD_MAX,
     MESSAGES_ID_MAX,
     tasks_info,
-    messages_info,
-    NULL,
-    NULL));
+    messages_info));
   OAILOG_LOG_CONFIGURE(&spgw_config.sgw_config.log_config);
 
   MSC_INIT(MSC_SP_GW, THREAD_MAX + TASK_MAX);
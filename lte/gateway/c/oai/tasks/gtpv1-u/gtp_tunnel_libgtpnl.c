@@ -30,23 +30,66 @@
 #include <libgtpnl/gtp.h>
 #include <libgtpnl/gtpnl.h>
 #include <libmnl/libmnl.h>
+#include <linux/gtp.h>
 #include <errno.h>
 
 #include "log.h"
 #include "common_defs.h"
+#include "intertask_interface.h"
+#include "service303.h"
 #include "gtpv1u.h"
 #include "gtpv1u_sgw_defs.h"
 
 extern struct gtp_tunnel_ops gtp_tunnel_ops;
 
+// Largest NEWPDP/DELPDP request, header and 6 u32 attributes
+#define GTP_NL_MSG_MAX_LEN 128
+#define GTP_NL_BATCH_SIZE 8192
+// Low enough for the acks to fit in the socket receive buffer
+#define GTP_NL_MAX_IN_FLIGHT 256
+#define GTP_NL_MAX_BATCH_REQUESTS (GTP_NL_MAX_IN_FLIGHT / 4)
+// Power of 2 above the requests in flight plus the ones of the next batch, so
+// a slot is never reused while its request still waits for an ack
+#define GTP_NL_REQUEST_RING_SIZE 512
+#if GTP_NL_REQUEST_RING_SIZE < GTP_NL_MAX_IN_FLIGHT + GTP_NL_MAX_BATCH_REQUESTS
+#error "GTP_NL_REQUEST_RING_SIZE is too small"
+#endif
+
+// A tunnel request waiting for its ack, to tell which tunnel an error is for
+typedef struct gtp_nl_request_s {
+  uint32_t seq;
+  bool is_waiting_ack;
+  uint8_t cmd;
+  uint32_t i_tei;
+  uint32_t o_tei;
+} gtp_nl_request_t;
+
 static struct {
   int genl_id;
   struct mnl_socket *nl;
   bool is_enabled;
+  uint32_t ifindex;
+
+  /*
+   * Tunnel requests are put one after the other in batch and sent to the
+   * kernel in one message by libgtpnl_flush. The kernel handles them while
+   * they are sent, so their acks are read right after, without waiting for
+   * the ones still missing unless the window is full. Failed requests are
+   * reported to the SPGW task in GTPV1U_TUNNEL_FAILURE_IND.
+   */
+  char batch[GTP_NL_BATCH_SIZE];
+  uint32_t batch_len;
+  uint32_t batch_num_requests;
+  uint32_t seq;
+  uint32_t num_in_flight;
+  uint64_t num_unmatched_acks;
+  gtp_nl_request_t requests[GTP_NL_REQUEST_RING_SIZE];
 } gtp_nl;
 
 #define GTP_DEVNAME "gtp0"
 
+int libgtpnl_flush(void);
+
 int libgtpnl_init(
   struct in_addr *ue_net,
   uint32_t mask,
@@ -90,6 +133,7 @@ int libgtpnl_init(
     return RETURNerror;
   }
   gtp_nl.is_enabled = true;
+  gtp_nl.ifindex = if_nametoindex(GTP_DEVNAME);
 
   gtp_nl.nl = genl_socket_open();
   if (gtp_nl.nl == NULL) {
@@ -157,6 +201,7 @@ int libgtpnl_uninit(void)
 {
   if (!gtp_nl.is_enabled) return -1;
 
+  libgtpnl_flush();
   return gtp_dev_destroy(GTP_DEVNAME);
 }
 
@@ -168,58 +213,202 @@ int libgtpnl_reset(void)
   return rv;
 }
 
+//------------------------------------------------------------------------------
+static gtp_nl_request_t *libgtpnl_get_request(uint32_t seq)
+{
+  return &gtp_nl.requests[seq & (GTP_NL_REQUEST_RING_SIZE - 1)];
+}
+
+//------------------------------------------------------------------------------
+// Tells the SPGW task that a tunnel change it already considers done failed
+static void libgtpnl_report_failure(
+  const gtp_nl_request_t *const request,
+  int error)
+{
+  OAILOG_ERROR(
+    LOG_GTPV1U,
+    "Cannot %s GTP tunnel " TEID_FMT " <-> " TEID_FMT ": %s\n",
+    (request->cmd == GTP_CMD_NEWPDP) ? "add" : "delete",
+    request->i_tei,
+    request->o_tei,
+    strerror(error));
+
+  MessageDef *message_p =
+    itti_alloc_new_message(TASK_GTPV1_U, GTPV1U_TUNNEL_FAILURE_IND);
+  if (message_p == NULL) {
+    return;
+  }
+  Gtpv1uTunnelFailureInd *failure_p =
+    &message_p->ittiMsg.gtpv1uTunnelFailureInd;
+  failure_p->is_delete = (request->cmd == GTP_CMD_DELPDP);
+  failure_p->sgw_S1u_teid = request->i_tei;
+  failure_p->enb_S1u_teid = request->o_tei;
+  failure_p->error = error;
+  itti_send_msg_to_task(TASK_SPGW_APP, INSTANCE_DEFAULT, message_p);
+}
+
+//------------------------------------------------------------------------------
+static void libgtpnl_handle_ack(const struct nlmsghdr *nlh)
+{
+  const struct nlmsgerr *err = mnl_nlmsg_get_payload(nlh);
+  gtp_nl_request_t *request = libgtpnl_get_request(nlh->nlmsg_seq);
+
+  if (!request->is_waiting_ack || (request->seq != nlh->nlmsg_seq)) {
+    // e.g. the ack of a request given up on after a receive error
+    gtp_nl.num_unmatched_acks++;
+    increment_counter("gtp_tunnel_unmatched_acks", 1, NO_LABELS);
+    OAILOG_WARNING(
+      LOG_GTPV1U,
+      "No GTP tunnel request for ack %u (%" PRIu64 " so far)\n",
+      nlh->nlmsg_seq,
+      gtp_nl.num_unmatched_acks);
+    return;
+  }
+  request->is_waiting_ack = false;
+  if (gtp_nl.num_in_flight) {
+    gtp_nl.num_in_flight--;
+  }
+  if (err->error < 0) {
+    libgtpnl_report_failure(request, -err->error);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Reads acks until at most max_in_flight requests are left without one.
+// Acks that already arrived are always read, without waiting for more.
+static void libgtpnl_read_acks(uint32_t max_in_flight)
+{
+  char buf[MNL_SOCKET_BUFFER_SIZE];
+
+  while (gtp_nl.num_in_flight) {
+    int flags = (gtp_nl.num_in_flight > max_in_flight) ? 0 : MSG_DONTWAIT;
+    ssize_t len = recv(mnl_socket_get_fd(gtp_nl.nl), buf, sizeof(buf), flags);
+
+    if (len < 0) {
+      if ((errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+        OAILOG_ERROR(
+          LOG_GTPV1U, "Cannot read GTP tunnel acks: %s\n", strerror(errno));
+        // acks were lost, do not wait for them. The ones that still come are
+        // counted as unmatched.
+        for (uint32_t i = 0; i < GTP_NL_REQUEST_RING_SIZE; i++) {
+          gtp_nl.requests[i].is_waiting_ack = false;
+        }
+        gtp_nl.num_in_flight = 0;
+      }
+      return;
+    }
+
+    int remaining = (int) len;
+    struct nlmsghdr *nlh = (struct nlmsghdr *) buf;
+    while (mnl_nlmsg_ok(nlh, remaining)) {
+      if (nlh->nlmsg_type == NLMSG_ERROR) {
+        libgtpnl_handle_ack(nlh);
+      }
+      nlh = mnl_nlmsg_next(nlh, &remaining);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+int libgtpnl_flush(void)
+{
+  int rc = RETURNok;
+
+  if (!gtp_nl.is_enabled) return RETURNok;
+
+  if (gtp_nl.batch_num_requests) {
+    libgtpnl_read_acks(GTP_NL_MAX_IN_FLIGHT - gtp_nl.batch_num_requests);
+    if (mnl_socket_sendto(gtp_nl.nl, gtp_nl.batch, gtp_nl.batch_len) < 0) {
+      int error = errno;
+      OAILOG_ERROR(
+        LOG_GTPV1U,
+        "Cannot send %u GTP tunnel requests: %s\n",
+        gtp_nl.batch_num_requests,
+        strerror(error));
+      // none of them reached the kernel
+      for (uint32_t i = 0; i < gtp_nl.batch_num_requests; i++) {
+        gtp_nl_request_t *request =
+          libgtpnl_get_request(gtp_nl.seq - gtp_nl.batch_num_requests + 1 + i);
+        request->is_waiting_ack = false;
+        libgtpnl_report_failure(request, error);
+      }
+      rc = RETURNerror;
+    } else {
+      gtp_nl.num_in_flight += gtp_nl.batch_num_requests;
+    }
+    gtp_nl.batch_len = 0;
+    gtp_nl.batch_num_requests = 0;
+  }
+  libgtpnl_read_acks(GTP_NL_MAX_IN_FLIGHT);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+// Appends a tunnel request to the batch, as libgtpnl would build it
+static int libgtpnl_batch_request(
+  uint8_t cmd,
+  uint16_t flags,
+  const struct in_addr *ue,
+  const struct in_addr *enb,
+  uint32_t i_tei,
+  uint32_t o_tei)
+{
+  if (
+    (gtp_nl.batch_len + GTP_NL_MSG_MAX_LEN > GTP_NL_BATCH_SIZE) ||
+    (gtp_nl.batch_num_requests == GTP_NL_MAX_BATCH_REQUESTS)) {
+    libgtpnl_flush();
+  }
+
+  uint32_t seq = ++gtp_nl.seq;
+  struct nlmsghdr *nlh = genl_nlmsg_build_hdr(
+    gtp_nl.batch + gtp_nl.batch_len,
+    gtp_nl.genl_id,
+    flags | NLM_F_ACK,
+    seq,
+    cmd);
+  mnl_attr_put_u32(nlh, GTPA_VERSION, GTP_V1);
+  mnl_attr_put_u32(nlh, GTPA_LINK, gtp_nl.ifindex);
+  if (enb) mnl_attr_put_u32(nlh, GTPA_PEER_ADDRESS, enb->s_addr);
+  if (ue) mnl_attr_put_u32(nlh, GTPA_MS_ADDRESS, ue->s_addr);
+  mnl_attr_put_u32(nlh, GTPA_I_TEI, i_tei);
+  mnl_attr_put_u32(nlh, GTPA_O_TEI, o_tei);
+  gtp_nl.batch_len += nlh->nlmsg_len;
+  gtp_nl.batch_num_requests++;
+
+  gtp_nl_request_t *request = libgtpnl_get_request(seq);
+  request->seq = seq;
+  request->is_waiting_ack = true;
+  request->cmd = cmd;
+  request->i_tei = i_tei;
+  request->o_tei = o_tei;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
 int libgtpnl_add_tunnel(
   struct in_addr ue,
   struct in_addr enb,
   uint32_t i_tei,
   uint32_t o_tei,
-  Imsi_t imsi)
+  __attribute__((unused)) Imsi_t imsi)
 {
-  struct gtp_tunnel *t;
-  int ret;
-
   if (!gtp_nl.is_enabled) return RETURNok;
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL) return RETURNerror;
-
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  gtp_tunnel_set_ms_ip4(t, &ue);
-  gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
-
-  ret = gtp_add_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
-
-  return ret;
+  return libgtpnl_batch_request(
+    GTP_CMD_NEWPDP, NLM_F_EXCL, &ue, &enb, i_tei, o_tei);
 }
 
+//------------------------------------------------------------------------------
 int libgtpnl_del_tunnel(
   __attribute__((unused)) struct in_addr ue,
   uint32_t i_tei,
   uint32_t o_tei)
 {
-  struct gtp_tunnel *t;
-  int ret;
-
   if (!gtp_nl.is_enabled) return RETURNok;
 
-  t = gtp_tunnel_alloc();
-  if (t == NULL) return RETURNerror;
-
-  gtp_tunnel_set_ifidx(t, if_nametoindex(GTP_DEVNAME));
-  gtp_tunnel_set_version(t, 1);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_ms_ip4(t, &ue);
-  // looking at kernel/drivers/net/gtp.c: not needed gtp_tunnel_set_sgsn_ip4(t, &enb);
-  gtp_tunnel_set_i_tei(t, i_tei);
-  gtp_tunnel_set_o_tei(t, o_tei);
-
-  ret = gtp_del_tunnel(gtp_nl.genl_id, gtp_nl.nl, t);
-  gtp_tunnel_free(t);
-
-  return ret;
+  // looking at kernel/drivers/net/gtp.c: the UE and eNB addresses are not
+  // needed to delete a tunnel
+  return libgtpnl_batch_request(GTP_CMD_DELPDP, 0, NULL, NULL, i_tei, o_tei);
 }
 
 static const struct gtp_tunnel_ops libgtpnl_ops = {
@@ -228,6 +417,7 @@ static const struct gtp_tunnel_ops libgtpnl_ops = {
   .reset = libgtpnl_reset,
   .add_tunnel = libgtpnl_add_tunnel,
   .del_tunnel = libgtpnl_del_tunnel,
+  .flush = libgtpnl_flush,
 };
 
 const struct gtp_tunnel_ops *gtp_tunnel_ops_init_libgtpnl(void)
@@ -76,6 +76,13 @@
  * int (*forward_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
  *         @ue: UE IP address
  *         @i_tei: RX GTP Tunnel ID
+ *
+ * int (*flush)(void);
+ *     Implementations that batch tunnel changes send the pending ones. Called
+ *     by the SPGW task once its message queue is empty. add_tunnel and
+ *     del_tunnel then only fail for changes that cannot be queued, a change
+ *     the datapath rejects later is reported to the SPGW task in
+ *     GTPV1U_TUNNEL_FAILURE_IND.
  */
 struct gtp_tunnel_ops {
   int (
@@ -91,6 +98,7 @@ struct gtp_tunnel_ops {
   int (*del_tunnel)(struct in_addr ue, uint32_t i_tei, uint32_t o_tei);
   int (*discard_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
   int (*forward_data_on_tunnel)(struct in_addr ue, uint32_t i_tei);
+  int (*flush)(void);
 };
 
 uint32_t gtpv1u_new_teid(void);
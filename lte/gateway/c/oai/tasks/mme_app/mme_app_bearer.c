@@ -1820,7 +1820,6 @@ static bool mme_app_construct_guti(
     "from MME Conf: %u, %u \n",
     s_tmsi_p->m_tmsi,
     s_tmsi_p->mme_code);
-  mme_config_read_lock(&mme_config);
   /*
    * Check number of MMEs in the pool.
    * At present it is assumed that one MME is supported in MME pool but in case there are more
@@ -1856,7 +1855,6 @@ static bool mme_app_construct_guti(
     guti_p->gummei.mme_gid = mme_config.gummei.gummei[num_mme].mme_gid;
     is_guti_valid = true;
   }
-  mme_config_unlock(&mme_config);
   return is_guti_valid;
 }
 
@@ -1972,6 +1970,15 @@ int mme_app_handle_initial_paging_request(const char *imsi)
     mme_ue_context_dump_coll_keys();
     OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNerror);
   }
+  // The UE is already being paged, the paging timer takes care of
+  // retransmissions until it answers
+  if (ue_context_p->paging_response_timer.id != MME_APP_TIMER_INACTIVE_ID) {
+    OAILOG_DEBUG(
+      LOG_MME_APP,
+      "Paging already in progress for IMSI%s, ignoring paging request\n",
+      imsi);
+    OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNok);
+  }
   return mme_app_paging_request_helper(
     ue_context_p, true, true /* s-tmsi */, CN_DOMAIN_PS);
 }
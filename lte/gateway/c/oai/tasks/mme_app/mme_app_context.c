@@ -46,6 +46,7 @@
 #include "common_types.h"
 #include "conversions.h"
 #include "intertask_interface.h"
+#include "itti_trace.h"
 #include "mme_config.h"
 #include "enum_string.h"
 #include "mme_app_ue_context.h"
@@ -435,6 +436,7 @@ ue_mm_context_t *mme_ue_context_exists_mme_ue_s1ap_id(
     (void **) &ue_context_p);
   if (ue_context_p) {
     lock_ue_contexts(ue_context_p);
+    itti_trace_set_ue(ue_context_p->enb_ue_s1ap_id, mme_ue_s1ap_id);
     OAILOG_TRACE(
       LOG_MME_APP,
       "UE  " MME_UE_S1AP_ID_FMT " fetched MM state %s, ECM state %s\n ",
@@ -74,10 +74,8 @@ void mme_app_send_delete_session_request(
   OAI_GCC_DIAG_ON(pointer - to - int - cast);
   S11_DELETE_SESSION_REQUEST(message_p).sender_fteid_for_cp.interface_type =
     S11_MME_GTP_C;
-  mme_config_read_lock(&mme_config);
   S11_DELETE_SESSION_REQUEST(message_p).sender_fteid_for_cp.ipv4_address =
     mme_config.ipv4.s11;
-  mme_config_unlock(&mme_config);
   S11_DELETE_SESSION_REQUEST(message_p).sender_fteid_for_cp.ipv4 = 1;
   S11_DELETE_SESSION_REQUEST(message_p).indication_flags.oi = 1;
 
@@ -85,10 +83,8 @@ void mme_app_send_delete_session_request(
    * S11 stack specific parameter. Not used in standalone epc mode
    */
   S11_DELETE_SESSION_REQUEST(message_p).trxn = NULL;
-  mme_config_read_lock(&mme_config);
   S11_DELETE_SESSION_REQUEST(message_p).peer_ip =
     ue_context_p->pdn_contexts[cid]->s_gw_address_s11_s4.address.ipv4_address;
-  mme_config_unlock(&mme_config);
 
   MSC_LOG_TX_MESSAGE(
     MSC_MMEAPP_MME,
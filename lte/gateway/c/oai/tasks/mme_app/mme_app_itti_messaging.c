@@ -241,10 +241,8 @@ int mme_app_send_s11_create_session_req(
   session_request_p->sender_fteid_for_cp.teid = (teid_t) ue_mm_context;
   OAI_GCC_DIAG_ON(pointer - to - int - cast);
   session_request_p->sender_fteid_for_cp.interface_type = S11_MME_GTP_C;
-  mme_config_read_lock(&mme_config);
   session_request_p->sender_fteid_for_cp.ipv4_address.s_addr =
     mme_config.ipv4.s11.s_addr;
-  mme_config_unlock(&mme_config);
   session_request_p->sender_fteid_for_cp.ipv4 = 1;
 
   //ue_mm_context->mme_teid_s11 = session_request_p->sender_fteid_for_cp.teid;
@@ -64,9 +64,7 @@ static inline void mme_app_itti_ue_context_mod_for_csfb(
      (ue_context_p->sgs_context->csfb_service_type == CSFB_SERVICE_MT_CALL))) {
     S1AP_UE_CONTEXT_MODIFICATION_REQUEST(message_p).presencemask =
       S1AP_UE_CONTEXT_MOD_LAI_PRESENT;
-    mme_config_read_lock(&mme_config);
     S1AP_UE_CONTEXT_MODIFICATION_REQUEST(message_p).lai = mme_config.lai;
-    mme_config_unlock(&mme_config);
     S1AP_UE_CONTEXT_MODIFICATION_REQUEST(message_p).presencemask |=
       S1AP_UE_CONTEXT_MOD_CSFB_INDICATOR_PRESENT;
     S1AP_UE_CONTEXT_MODIFICATION_REQUEST(message_p).cs_fallback_indicator =
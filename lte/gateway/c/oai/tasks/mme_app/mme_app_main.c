@@ -52,6 +52,7 @@
 #include "service303.h"
 #include "common_defs.h"
 #include "mme_app_edns_emulation.h"
+#include "directoryd.h"
 #include "nas_proc.h"
 
 mme_app_desc_t mme_app_desc = {.rw_lock = PTHREAD_RWLOCK_INITIALIZER, 0};
@@ -597,6 +598,7 @@ static bool _is_mme_app_healthy(void)
 void mme_app_exit(void)
 {
   timer_remove(mme_app_desc.statistic_timer_id, NULL);
+  directoryd_stop();
   mme_app_edns_exit();
   hashtable_uint64_ts_destroy(
     mme_app_desc.mme_ue_contexts.imsi_ue_context_htbl);
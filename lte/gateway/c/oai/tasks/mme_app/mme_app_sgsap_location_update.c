@@ -41,6 +41,8 @@
 #include "mme_app_sgs_fsm.h"
 #include "mme_app_itti_messaging.h"
 #include "mme_app_sgs_messages.h"
+#include "csfb_client_api.h"
+#include "service303.h"
 
 /**********************************************************************************
  **                                                                              **
@@ -389,7 +391,6 @@ int mme_app_handle_nas_cs_domain_location_update_req(
   }
 
   //Store granted service type based on attach type & addition updt type
-  mme_config_read_lock(&mme_config);
   if (itti_nas_location_update_req->msg_type == ATTACH_REQUEST) {
     if (ue_context->attach_type == EPS_ATTACH_TYPE_COMBINED_EPS_IMSI) {
       if (
@@ -418,7 +419,6 @@ int mme_app_handle_nas_cs_domain_location_update_req(
       ue_context->granted_service = GRANTED_SERVICE_EPS_ONLY;
     }
   }
-  mme_config_unlock(&mme_config);
 
 /*TODO CSFB, currently from HSS access_mode is rceived as PACKET_ONLY
  * For testing purpose we are commenting, later we will modify code as below
@@ -446,12 +446,28 @@ int mme_app_handle_nas_cs_domain_location_update_req(
         OAILOG_FUNC_RETURN(LOG_MME_APP, RETURNerror);
       }
     }
-    /*Send SGSAP Location Update Request message to SGS task*/
-    send_itti_sgsap_location_update_req(ue_context);
-    OAILOG_DEBUG(
-      LOG_MME_APP,
-      "Sending Location Update message to SGS task with IMSI" IMSI_64_FMT "\n",
-      ue_context->imsi);
+    if (csfb_client_is_congested()) {
+      /* The FeG is not keeping up with the SGs messages, fail the procedure
+       * now as on Ts6-1 expiry instead of queueing one more request, the UE
+       * gets EPS only service
+       */
+      OAILOG_WARNING(
+        LOG_MME_APP,
+        "SGs is congested, rejecting Location Update for UE %d\n",
+        itti_nas_location_update_req->ue_id);
+      increment_counter("sgs_location_update_congested", 1, NO_LABELS);
+      ue_context->sgs_context->sgs_state = SGS_NULL;
+      send_cs_domain_loc_updt_fail_to_nas(
+        SGS_MSC_NOT_REACHABLE, NULL, ue_context->mme_ue_s1ap_id);
+    } else {
+      /*Send SGSAP Location Update Request message to SGS task*/
+      send_itti_sgsap_location_update_req(ue_context);
+      OAILOG_DEBUG(
+        LOG_MME_APP,
+        "Sending Location Update message to SGS task with IMSI" IMSI_64_FMT
+        "\n",
+        ue_context->imsi);
+    }
   } else {
     //Ignore the the messae as Location Update procedure is already triggered
     OAILOG_WARNING(
@@ -514,7 +530,6 @@ int send_itti_sgsap_location_update_req(ue_mm_context_t *ue_context)
     }
   }
   //New LAI - Retrieve from conf
-  mme_config_read_lock(&mme_config);
   sgsap_location_update_req->newlaicsfb.mccdigit2 = mme_config.lai.mccdigit2;
   sgsap_location_update_req->newlaicsfb.mccdigit1 = mme_config.lai.mccdigit1;
   sgsap_location_update_req->newlaicsfb.mncdigit3 = mme_config.lai.mncdigit3;
@@ -522,7 +537,6 @@ int send_itti_sgsap_location_update_req(ue_mm_context_t *ue_context)
   sgsap_location_update_req->newlaicsfb.mncdigit2 = mme_config.lai.mncdigit2;
   sgsap_location_update_req->newlaicsfb.mncdigit1 = mme_config.lai.mncdigit1;
   sgsap_location_update_req->newlaicsfb.lac = mme_config.lai.lac;
-  mme_config_unlock(&mme_config);
 
   //IMEISV
   sgsap_location_update_req->presencemask |= SGSAP_IMEISV;
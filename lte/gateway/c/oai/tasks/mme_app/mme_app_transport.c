@@ -75,7 +75,8 @@ int mme_app_handle_nas_dl_req(itti_nas_dl_data_req_t *const nas_dl_req_pP)
 
   S1AP_NAS_DL_DATA_REQ(message_p).enb_ue_s1ap_id = enb_ue_s1ap_id;
   S1AP_NAS_DL_DATA_REQ(message_p).mme_ue_s1ap_id = nas_dl_req_pP->ue_id;
-  S1AP_NAS_DL_DATA_REQ(message_p).nas_msg = bstrcpy(nas_dl_req_pP->nas_msg);
+  S1AP_NAS_DL_DATA_REQ(message_p).nas_msg = nas_dl_req_pP->nas_msg;
+  nas_dl_req_pP->nas_msg = NULL;
 
   MSC_LOG_TX_MESSAGE(
     MSC_MMEAPP_MME,
@@ -56,12 +56,13 @@
 #include "intertask_interface.h"
 #include "common_types.h"
 #include "common_defs.h"
+#include "conversions.h"
 #include "mme_config.h"
 #include "spgw_config.h"
 #include "3gpp_33.401.h"
 #include "intertask_interface_conf.h"
 
-struct mme_config_s mme_config = {.rw_lock = PTHREAD_RWLOCK_INITIALIZER, 0};
+struct mme_config_s mme_config = {0};
 
 //------------------------------------------------------------------------------
 int mme_config_find_mnc_length(
@@ -173,6 +174,10 @@ void s6a_config_init(s6a_config_t *s6a_conf)
 void itti_config_init(itti_config_t *itti_conf)
 {
   itti_conf->queue_size = ITTI_QUEUE_MAX_ELEMENTS;
+  itti_conf->pool_memory_limit_mb = ITTI_MEMORY_POOLS_DEFAULT_LIMIT_MB;
+  itti_conf->trace_records = ITTI_TRACE_DEFAULT_RECORDS;
+  itti_conf->trace_payload_size = 0;
+  itti_conf->trace_file = bfromcstr(ITTI_TRACE_DEFAULT_FILE);
   itti_conf->log_file = NULL;
 }
 
@@ -223,6 +228,89 @@ void served_tai_config_init(served_tai_t *served_tai)
   served_tai->plmn_mnc[0] = PLMN_MNC;
   served_tai->plmn_mnc_len[0] = PLMN_MNC_LEN;
   served_tai->tac[0] = PLMN_TAC;
+  mme_config_build_served_tai_lookup(served_tai);
+}
+
+//------------------------------------------------------------------------------
+static int _compare_uint16(const void *a, const void *b)
+{
+  uint16_t x = *(const uint16_t *) a;
+  uint16_t y = *(const uint16_t *) b;
+  return (x > y) - (x < y);
+}
+
+static int _compare_uint32(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t *) a;
+  uint32_t y = *(const uint32_t *) b;
+  return (x > y) - (x < y);
+}
+
+// sort the first n elements and remove duplicates, returns the new count
+static int _sort_unique(
+  void *base,
+  int n,
+  size_t size,
+  int (*compare)(const void *, const void *))
+{
+  int unique = 0;
+  qsort(base, n, size, compare);
+  for (int i = 0; i < n; i++) {
+    if (
+      (unique == 0) ||
+      compare((char *) base + (unique - 1) * size, (char *) base + i * size)) {
+      memmove((char *) base + unique * size, (char *) base + i * size, size);
+      unique++;
+    }
+  }
+  return unique;
+}
+
+void mme_config_build_served_tai_lookup(served_tai_t *served_tai)
+{
+  int n = served_tai->nb_tai;
+
+  free_wrapper((void **) &served_tai->plmn_keys);
+  free_wrapper((void **) &served_tai->tacs);
+  served_tai->plmn_keys = calloc(n, sizeof(*served_tai->plmn_keys));
+  served_tai->tacs = calloc(n, sizeof(*served_tai->tacs));
+  AssertFatal(
+    (n == 0) || (served_tai->plmn_keys && served_tai->tacs),
+    "Failed to allocate served TAI lookup tables");
+
+  for (int i = 0; i < n; i++) {
+    served_tai->plmn_keys[i] = MCC_MNC_TO_PLMN_KEY(
+      served_tai->plmn_mcc[i],
+      served_tai->plmn_mnc[i],
+      served_tai->plmn_mnc_len[i]);
+    served_tai->tacs[i] = served_tai->tac[i];
+  }
+  served_tai->nb_plmn_keys = _sort_unique(
+    served_tai->plmn_keys, n, sizeof(*served_tai->plmn_keys), _compare_uint32);
+  served_tai->nb_tacs = _sort_unique(
+    served_tai->tacs, n, sizeof(*served_tai->tacs), _compare_uint16);
+}
+
+bool mme_config_is_served_plmn(
+  const served_tai_t *served_tai,
+  uint32_t plmn_key)
+{
+  return bsearch(
+           &plmn_key,
+           served_tai->plmn_keys,
+           served_tai->nb_plmn_keys,
+           sizeof(*served_tai->plmn_keys),
+           _compare_uint32) != NULL;
+}
+
+bool mme_config_is_served_tac(const served_tai_t *served_tai, uint16_t tac)
+{
+  return bsearch(
+           &tac,
+           served_tai->tacs,
+           served_tai->nb_tacs,
+           sizeof(*served_tai->tacs),
+           _compare_uint16) != NULL;
 }
 
 void service303_config_init(service303_data_t *service303_conf)
@@ -236,8 +324,6 @@ void mme_config_init(mme_config_t *config)
 {
   memset(config, 0, sizeof(*config));
 
-  pthread_rwlock_init(&config->rw_lock, NULL);
-
   config->config_file = NULL;
   config->max_enbs = 2;
   config->max_ues = 2;
@@ -261,7 +347,6 @@ void mme_config_init(mme_config_t *config)
 //------------------------------------------------------------------------------
 void mme_config_exit(void)
 {
-  pthread_rwlock_destroy(&mme_config.rw_lock);
   bdestroy_wrapper(&mme_config.log_config.output);
   bdestroy_wrapper(&mme_config.realm);
   bdestroy_wrapper(&mme_config.config_file);
@@ -272,12 +357,15 @@ void mme_config_exit(void)
   bdestroy_wrapper(&mme_config.ipv4.if_name_s1_mme);
   bdestroy_wrapper(&mme_config.ipv4.if_name_s11);
   bdestroy_wrapper(&mme_config.s6a_config.conf_file);
+  bdestroy_wrapper(&mme_config.itti_config.trace_file);
   bdestroy_wrapper(&mme_config.itti_config.log_file);
 
   free_wrapper((void **) &mme_config.served_tai.plmn_mcc);
   free_wrapper((void **) &mme_config.served_tai.plmn_mnc);
   free_wrapper((void **) &mme_config.served_tai.plmn_mnc_len);
   free_wrapper((void **) &mme_config.served_tai.tac);
+  free_wrapper((void **) &mme_config.served_tai.plmn_keys);
+  free_wrapper((void **) &mme_config.served_tai.tacs);
 
   for (int i = 0; i < mme_config.e_dns_emulation.nb_sgw_entries; i++) {
     bdestroy_wrapper(&mme_config.e_dns_emulation.sgw_id[i]);
@@ -593,6 +681,32 @@ int mme_config_parse_file(mme_config_t *config_pP)
             &aint))) {
         config_pP->itti_config.queue_size = (uint32_t) aint;
       }
+      if ((config_setting_lookup_int(
+            setting,
+            MME_CONFIG_STRING_INTERTASK_INTERFACE_POOL_MEMORY_LIMIT,
+            &aint))) {
+        config_pP->itti_config.pool_memory_limit_mb = (uint32_t) aint;
+      }
+      if ((config_setting_lookup_int(
+            setting,
+            MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_RECORDS,
+            &aint))) {
+        config_pP->itti_config.trace_records = (uint32_t) aint;
+      }
+      if ((config_setting_lookup_int(
+            setting,
+            MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_PAYLOAD_SIZE,
+            &aint))) {
+        config_pP->itti_config.trace_payload_size = (uint32_t) aint;
+      }
+      if ((config_setting_lookup_string(
+            setting,
+            MME_CONFIG_STRING_INTERTASK_INTERFACE_TRACE_FILE,
+            (const char **) &astring))) {
+        if (astring != NULL) {
+          bassigncstr(config_pP->itti_config.trace_file, astring);
+        }
+      }
     }
     // S6A SETTING
     setting =
@@ -761,6 +875,11 @@ int mme_config_parse_file(mme_config_t *config_pP)
               config_pP->served_tai.plmn_mnc[i];
             config_pP->served_tai.plmn_mnc[i] = swap16;
 
+            swap16 = config_pP->served_tai.plmn_mnc_len[i - 1];
+            config_pP->served_tai.plmn_mnc_len[i - 1] =
+              config_pP->served_tai.plmn_mnc_len[i];
+            config_pP->served_tai.plmn_mnc_len[i] = swap16;
+
             swap16 = config_pP->served_tai.tac[i - 1];
             config_pP->served_tai.tac[i - 1] = config_pP->served_tai.tac[i];
             config_pP->served_tai.tac[i] = swap16;
@@ -798,6 +917,7 @@ int mme_config_parse_file(mme_config_t *config_pP)
             TRACKING_AREA_IDENTITY_LIST_TYPE_ONE_PLMN_NON_CONSECUTIVE_TACS;
         }
       }
+      mme_config_build_served_tai_lookup(&config_pP->served_tai);
     }
 
     // GUMMEI SETTING
@@ -1354,6 +1474,22 @@ void mme_config_display(mme_config_t *config_pP)
     LOG_CONFIG,
     "    queue size .......: %u (bytes)\n",
     config_pP->itti_config.queue_size);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "    pool memory limit : %u (Mbytes)\n",
+    config_pP->itti_config.pool_memory_limit_mb);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "    trace records ....: %u (per thread)\n",
+    config_pP->itti_config.trace_records);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "    trace payload ....: %u (bytes)\n",
+    config_pP->itti_config.trace_payload_size);
+  OAILOG_INFO(
+    LOG_CONFIG,
+    "    trace file .......: %s\n",
+    bdata(config_pP->itti_config.trace_file));
   OAILOG_INFO(
     LOG_CONFIG,
     "    log file .........: %s\n",
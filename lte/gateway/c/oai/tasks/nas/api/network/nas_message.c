@@ -280,6 +280,7 @@ int nas_message_encrypt(
  **    Others:  None                                       **
  **                                                                        **
  ** Outputs:   outbuf:  Output buffer containing plain NAS message **
+ **       outbuf may be inbuf to decrypt in place    **
  **    header:  Security protected header applied          **
  **      Return:  The number of bytes in the output buffer   **
  **       if the input buffer has been successfully  **
@@ -374,7 +375,7 @@ int nas_message_decrypt(
     /*
      * The input buffer contains a plain NAS message
      */
-    memcpy(outbuf, inbuf, length);
+    memmove(outbuf, inbuf, length);
   }
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
@@ -392,7 +393,9 @@ int nas_message_decrypt(
        security:  security context
        Others:  None
 
-   Outputs:   msg:   L3 NAS message structure to be filled
+   Outputs:   buffer:  A security protected message is deciphered
+         in place
+       msg:   L3 NAS message structure to be filled
        Return:  The number of bytes in the buffer if the
          data have been successfully decoded;
          A negative error code otherwise.
@@ -400,7 +403,7 @@ int nas_message_decrypt(
 
 */
 int nas_message_decode(
-  const unsigned char *const buffer,
+  unsigned char *const buffer,
   nas_message_t *msg,
   size_t length,
   void *security,
@@ -898,7 +901,8 @@ static int _nas_message_plain_decode(
  **      emm_security_context: security context                       **
  **    Others:  None                                       **
  **                                                                        **
- ** Outputs:   msg:   Decoded NAS message                        **
+ ** Outputs:   buffer:  The deciphered NAS message                 **
+ **      msg:   Decoded NAS message                        **
  **      Return:  The number of bytes in the buffer if the   **
  **       data have been successfully decoded;       **
  **       A negative error code otherwise.           **
@@ -915,27 +919,23 @@ static int _nas_message_protected_decode(
 {
   OAILOG_FUNC_IN(LOG_NAS);
   int bytes = TLV_BUFFER_TOO_SHORT;
-  unsigned char *const plain_msg = (unsigned char *) calloc(1, length);
 
-  if (plain_msg) {
-    /*
-     * Decrypt the security protected NAS message
-     */
-    header->protocol_discriminator = _nas_message_decrypt(
-      plain_msg,
-      buffer,
-      header->security_header_type,
-      header->message_authentication_code,
-      header->sequence_number,
-      length,
-      emm_security_context,
-      status);
-    /*
-     * Decode the decrypted message as plain NAS message
-     */
-    bytes = _nas_message_plain_decode(plain_msg, header, msg, length);
-    free_wrapper((void **) &plain_msg);
-  }
+  /*
+   * Decrypt the security protected NAS message in place
+   */
+  header->protocol_discriminator = _nas_message_decrypt(
+    buffer,
+    buffer,
+    header->security_header_type,
+    header->message_authentication_code,
+    header->sequence_number,
+    length,
+    emm_security_context,
+    status);
+  /*
+   * Decode the decrypted message as plain NAS message
+   */
+  bytes = _nas_message_plain_decode(buffer, header, msg, length);
 
   OAILOG_FUNC_RETURN(LOG_NAS, bytes);
 }
@@ -1164,7 +1164,6 @@ static int _nas_message_decrypt(
   OAILOG_FUNC_IN(LOG_NAS);
   nas_stream_cipher_t stream_cipher = {0};
   uint32_t count = 0;
-  uint32_t len = 0;
   uint8_t direction = SECU_DIRECTION_UPLINK;
   int size = 0;
   nas_message_security_header_t header = {0};
@@ -1180,9 +1179,7 @@ static int _nas_message_decrypt(
         "0x%02x\n",
         length,
         security_header_type);
-      len = sizeof(dest);
-      memset(dest, 0, len);
-      memcpy(dest, src, length);
+      memmove(dest, src, length);
       DECODE_U8(dest, *(uint8_t *) (&header), size);
       OAILOG_FUNC_RETURN(LOG_NAS, header.protocol_discriminator);
       //LOG_FUNC_RETURN (LOG_NAS, length);
@@ -1289,9 +1286,7 @@ static int _nas_message_decrypt(
               direction,
               emm_security_context->ul_count.seq_num,
               emm_security_context->dl_count.seq_num);
-            len = sizeof(dest);
-            memset(dest, 0, len);
-            memcpy(dest, src, length);
+            memmove(dest, src, length);
             /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -1305,9 +1300,7 @@ static int _nas_message_decrypt(
               LOG_NAS,
               "Unknown Cyphering protection algorithm %d\n",
               emm_security_context->selected_algorithms.encryption);
-            len = sizeof(dest);
-            memset(dest, 0, len);
-            memcpy(dest, src, length);
+            memmove(dest, src, length);
             /*
            * Decode the first octet (security header type or EPS bearer identity,
            * * * * and protocol discriminator)
@@ -78,6 +78,7 @@
 #include "service303.h"
 #include "mme_app_defs.h"
 #include "EmmCommon.h"
+#include "emm_auth_vector_cache.h"
 
 /****************************************************************************/
 /****************  E X T E R N A L    D E F I N I T I O N S  ****************/
@@ -115,6 +116,14 @@ static int _start_authentication_information_procedure(
   nas_emm_auth_proc_t *const auth_proc,
   const_bstring auts);
 static int _auth_info_proc_success_cb(struct emm_context_s *emm_ctx);
+static void _get_visited_plmn(
+  const struct emm_context_s *emm_context,
+  plmn_t *visited_plmn);
+static void _set_auth_vector(
+  struct emm_context_s *emm_ctx,
+  int destination_index,
+  const eutran_vector_t *vector);
+static bool _take_cached_auth_vector(struct emm_context_s *emm_context);
 static int _auth_info_proc_failure_cb(struct emm_context_s *emm_ctx);
 
 static int _authentication_check_imsi_5_4_2_5__1(
@@ -310,7 +319,9 @@ int emm_proc_authentication(
     auth_proc->emm_com_proc.emm_proc.base_proc.time_out = NULL;
 
     bool run_auth_info_proc = false;
-    if (!IS_EMM_CTXT_VALID_AUTH_VECTORS(emm_context)) {
+    if (
+      !IS_EMM_CTXT_VALID_AUTH_VECTORS(emm_context) &&
+      !_take_cached_auth_vector(emm_context)) {
       // Ask upper layer to fetch new security context
       nas_auth_info_proc_t *auth_info_proc =
         get_nas_cn_procedure_auth_info(emm_context);
@@ -388,12 +399,7 @@ static int _start_authentication_information_procedure(
   auth_info_proc->resync = auth_info_proc->request_sent;
 
   plmn_t visited_plmn = {0};
-  visited_plmn.mcc_digit1 = emm_context->originating_tai.mcc_digit1;
-  visited_plmn.mcc_digit2 = emm_context->originating_tai.mcc_digit2;
-  visited_plmn.mcc_digit3 = emm_context->originating_tai.mcc_digit3;
-  visited_plmn.mnc_digit1 = emm_context->originating_tai.mnc_digit1;
-  visited_plmn.mnc_digit2 = emm_context->originating_tai.mnc_digit2;
-  visited_plmn.mnc_digit3 = emm_context->originating_tai.mnc_digit3;
+  _get_visited_plmn(emm_context, &visited_plmn);
 
   bool is_initial_req = !(auth_info_proc->request_sent);
   auth_info_proc->request_sent = true;
@@ -408,12 +414,97 @@ static int _start_authentication_information_procedure(
     &emm_context->_imsi,
     is_initial_req,
     &visited_plmn,
-    MAX_EPS_AUTH_VECTORS,
-    auts);
+    MAX_EPS_AUTH_VECTORS_PER_AIR,
+    auts,
+    false);
 
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
 }
 
+//------------------------------------------------------------------------------
+static void _get_visited_plmn(
+  const struct emm_context_s *emm_context,
+  plmn_t *visited_plmn)
+{
+  visited_plmn->mcc_digit1 = emm_context->originating_tai.mcc_digit1;
+  visited_plmn->mcc_digit2 = emm_context->originating_tai.mcc_digit2;
+  visited_plmn->mcc_digit3 = emm_context->originating_tai.mcc_digit3;
+  visited_plmn->mnc_digit1 = emm_context->originating_tai.mnc_digit1;
+  visited_plmn->mnc_digit2 = emm_context->originating_tai.mnc_digit2;
+  visited_plmn->mnc_digit3 = emm_context->originating_tai.mnc_digit3;
+}
+
+//------------------------------------------------------------------------------
+static void _set_auth_vector(
+  struct emm_context_s *emm_ctx,
+  int destination_index,
+  const eutran_vector_t *vector)
+{
+  memcpy(
+    emm_ctx->_vector[destination_index].kasme, vector->kasme, AUTH_KASME_SIZE);
+  memcpy(
+    emm_ctx->_vector[destination_index].autn, vector->autn, AUTH_AUTN_SIZE);
+  memcpy(
+    emm_ctx->_vector[destination_index].rand, vector->rand, AUTH_RAND_SIZE);
+  memcpy(
+    emm_ctx->_vector[destination_index].xres,
+    vector->xres.data,
+    vector->xres.size);
+  emm_ctx->_vector[destination_index].xres_size = vector->xres.size;
+  emm_ctx_set_attribute_valid(
+    emm_ctx, EMM_CTXT_MEMBER_AUTH_VECTOR0 + destination_index);
+}
+
+//------------------------------------------------------------------------------
+/*
+ * Use a vector left over from an earlier Authentication Information Answer,
+ * instead of asking the HSS. When the last cached vector is used, the cache
+ * is refilled in the background.
+ */
+static bool _take_cached_auth_vector(struct emm_context_s *emm_context)
+{
+  OAILOG_FUNC_IN(LOG_NAS_EMM);
+  mme_ue_s1ap_id_t ue_id =
+    PARENT_STRUCT(emm_context, struct ue_mm_context_s, emm_context)
+      ->mme_ue_s1ap_id;
+  plmn_t visited_plmn = {0};
+  eutran_vector_t vector = {0};
+
+  if (!IS_EMM_CTXT_VALID_IMSI(emm_context)) {
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, false);
+  }
+  _get_visited_plmn(emm_context, &visited_plmn);
+  if (!emm_auth_vector_cache_take(
+        emm_context->_imsi64, &visited_plmn, &vector)) {
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, false);
+  }
+
+  ksi_t eksi = 0;
+  if (emm_context->_security.eksi < KSI_NO_KEY_AVAILABLE) {
+    REQUIREMENT_3GPP_24_301(R10_5_4_2_4__2);
+    eksi = (emm_context->_security.eksi + 1) % (EKSI_MAX_VALUE + 1);
+  }
+  _set_auth_vector(emm_context, eksi % MAX_EPS_AUTH_VECTORS, &vector);
+  emm_ctx_set_attribute_present(emm_context, EMM_CTXT_MEMBER_AUTH_VECTORS);
+  OAILOG_INFO(
+    LOG_NAS_EMM,
+    "EMM-PROC  - Using cached auth vector for ue_id " MME_UE_S1AP_ID_FMT "\n",
+    ue_id);
+
+  if (emm_auth_vector_cache_start_prefetch(
+        emm_context->_imsi64, &visited_plmn)) {
+    nas_itti_auth_info_req(
+      ue_id,
+      &emm_context->_imsi,
+      true,
+      &visited_plmn,
+      MAX_EPS_AUTH_VECTORS_PER_AIR,
+      NULL,
+      true);
+  }
+  OAILOG_FUNC_RETURN(LOG_NAS_EMM, true);
+}
+
 //------------------------------------------------------------------------------
 static int _start_authentication_information_procedure_synch(
   struct emm_context_s *emm_context,
@@ -466,29 +557,15 @@ static int _auth_info_proc_success_cb(struct emm_context_s *emm_ctx)
     }
 
     /*
-     * Copy provided vector to user context
+     * Copy provided vector to user context, the others are cached
      */
-    for (int i = 0; i < auth_info_proc->nb_vectors; i++) {
-      AssertFatal(MAX_EPS_AUTH_VECTORS > i, " TOO many vectors");
+    int nb_used_vectors = auth_info_proc->nb_vectors;
+    if (nb_used_vectors > MAX_EPS_AUTH_VECTORS) {
+      nb_used_vectors = MAX_EPS_AUTH_VECTORS;
+    }
+    for (int i = 0; i < nb_used_vectors; i++) {
       int destination_index = (i + eksi) % MAX_EPS_AUTH_VECTORS;
-      memcpy(
-        emm_ctx->_vector[destination_index].kasme,
-        auth_info_proc->vector[i]->kasme,
-        AUTH_KASME_SIZE);
-      memcpy(
-        emm_ctx->_vector[destination_index].autn,
-        auth_info_proc->vector[i]->autn,
-        AUTH_AUTN_SIZE);
-      memcpy(
-        emm_ctx->_vector[destination_index].rand,
-        auth_info_proc->vector[i]->rand,
-        AUTH_RAND_SIZE);
-      memcpy(
-        emm_ctx->_vector[destination_index].xres,
-        auth_info_proc->vector[i]->xres.data,
-        auth_info_proc->vector[i]->xres.size);
-      emm_ctx->_vector[destination_index].xres_size =
-        auth_info_proc->vector[i]->xres.size;
+      _set_auth_vector(emm_ctx, destination_index, auth_info_proc->vector[i]);
       OAILOG_INFO(LOG_NAS_EMM, "EMM-PROC  - Received Vector %u:\n", i);
       OAILOG_INFO(
         LOG_NAS_EMM,
@@ -507,8 +584,14 @@ static int _auth_info_proc_success_cb(struct emm_context_s *emm_ctx)
         "EMM-PROC  - Received KASME .: " KASME_FORMAT " " KASME_FORMAT "\n",
         KASME_DISPLAY_1(emm_ctx->_vector[destination_index].kasme),
         KASME_DISPLAY_2(emm_ctx->_vector[destination_index].kasme));
-      emm_ctx_set_attribute_valid(
-        emm_ctx, EMM_CTXT_MEMBER_AUTH_VECTOR0 + destination_index);
+    }
+    if (IS_EMM_CTXT_VALID_IMSI(emm_ctx)) {
+      plmn_t visited_plmn = {0};
+      _get_visited_plmn(emm_ctx, &visited_plmn);
+      for (int i = nb_used_vectors; i < auth_info_proc->nb_vectors; i++) {
+        emm_auth_vector_cache_add(
+          emm_ctx->_imsi64, &visited_plmn, 1, auth_info_proc->vector[i]);
+      }
     }
 
     nas_emm_auth_proc_t *auth_proc =
@@ -674,6 +757,11 @@ int emm_proc_authentication_failure(
   nas_emm_auth_proc_t *auth_proc =
     get_nas_common_procedure_authentication(emm_ctx);
 
+  if (IS_EMM_CTXT_VALID_IMSI(emm_ctx)) {
+    // the UE may have rejected a cached vector, do not use the others
+    emm_auth_vector_cache_invalidate(emm_ctx->_imsi64);
+  }
+
   if (auth_proc) {
     // Stop timer T3460
     REQUIREMENT_3GPP_24_301(R10_5_4_2_4__3);
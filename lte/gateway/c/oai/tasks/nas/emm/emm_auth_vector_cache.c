@@ -0,0 +1,382 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "common_defs.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
+#include "mme_default_values.h"
+#include "service303.h"
+#include "TrackingAreaIdentity.h"
+#include "emm_auth_vector_cache.h"
+
+typedef struct auth_vector_cache_entry_s {
+  plmn_t visited_plmn;
+  uint8_t nb_vectors;
+  eutran_vector_t vectors[MAX_EPS_AUTH_VECTORS_PER_AIR]; // oldest first
+  time_t expiry[MAX_EPS_AUTH_VECTORS_PER_AIR];
+  time_t prefetch_deadline; // 0 if no prefetch is outstanding
+  bool discard_prefetch;
+} auth_vector_cache_entry_t;
+
+typedef struct expired_keys_s {
+  time_t now;
+  time_t next_expiry;
+  int num_keys;
+  hash_key_t keys[AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS];
+} expired_keys_t;
+
+static hash_table_t *auth_vector_cache = NULL;
+
+// No entry becomes unused before then, so a full cache isn't swept earlier
+static time_t next_sweep = 0;
+
+//------------------------------------------------------------------------------
+static time_t _now(void)
+{
+  struct timespec ts = {0};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec;
+}
+
+//------------------------------------------------------------------------------
+static void _drop_expired_vectors(auth_vector_cache_entry_t *entry, time_t now)
+{
+  int expired = 0;
+  while ((expired < entry->nb_vectors) && (entry->expiry[expired] <= now)) {
+    expired++;
+  }
+  if (expired > 0) {
+    entry->nb_vectors -= expired;
+    memmove(
+      entry->vectors,
+      &entry->vectors[expired],
+      entry->nb_vectors * sizeof(eutran_vector_t));
+    memmove(
+      entry->expiry,
+      &entry->expiry[expired],
+      entry->nb_vectors * sizeof(time_t));
+  }
+  if (entry->prefetch_deadline && (entry->prefetch_deadline <= now)) {
+    entry->prefetch_deadline = 0;
+    entry->discard_prefetch = false;
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool _is_entry_unused(const auth_vector_cache_entry_t *entry)
+{
+  return (entry->nb_vectors == 0) && (entry->prefetch_deadline == 0);
+}
+
+//------------------------------------------------------------------------------
+// Time at which the entry becomes unused, unless it is updated
+static time_t _entry_expiry(const auth_vector_cache_entry_t *entry)
+{
+  time_t expiry = entry->prefetch_deadline;
+  if (
+    (entry->nb_vectors > 0) && (entry->expiry[entry->nb_vectors - 1] > expiry)) {
+    expiry = entry->expiry[entry->nb_vectors - 1];
+  }
+  return expiry;
+}
+
+//------------------------------------------------------------------------------
+static void _schedule_sweep(const auth_vector_cache_entry_t *entry)
+{
+  time_t expiry = _entry_expiry(entry);
+  if (expiry < next_sweep) {
+    next_sweep = expiry;
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool _collect_expired_entry(
+  hash_key_t key,
+  void *element,
+  void *parameter,
+  void **result)
+{
+  auth_vector_cache_entry_t *entry = (auth_vector_cache_entry_t *) element;
+  expired_keys_t *expired_keys = (expired_keys_t *) parameter;
+
+  _drop_expired_vectors(entry, expired_keys->now);
+  if (_is_entry_unused(entry)) {
+    expired_keys->keys[expired_keys->num_keys++] = key;
+  } else if (_entry_expiry(entry) < expired_keys->next_expiry) {
+    expired_keys->next_expiry = _entry_expiry(entry);
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void _remove_expired_entries(void)
+{
+  // only used from the NAS task, too big for its stack
+  static expired_keys_t expired_keys;
+  time_t now = _now();
+
+  if (now < next_sweep) {
+    return;
+  }
+  expired_keys.now = now;
+  expired_keys.next_expiry = now + AUTH_VECTOR_CACHE_TTL_S;
+  expired_keys.num_keys = 0;
+  hashtable_apply_callback_on_elements(
+    auth_vector_cache, _collect_expired_entry, &expired_keys, NULL);
+  for (int i = 0; i < expired_keys.num_keys; i++) {
+    hashtable_free(auth_vector_cache, expired_keys.keys[i]);
+  }
+  next_sweep = expired_keys.next_expiry;
+  OAILOG_DEBUG(
+    LOG_NAS_EMM,
+    "Removed %d expired entries from the auth vector cache\n",
+    expired_keys.num_keys);
+}
+
+//------------------------------------------------------------------------------
+static auth_vector_cache_entry_t *_get_entry(imsi64_t imsi64)
+{
+  auth_vector_cache_entry_t *entry = NULL;
+  if (!auth_vector_cache) {
+    return NULL;
+  }
+  if (
+    hashtable_get(
+      auth_vector_cache, (const hash_key_t) imsi64, (void **) &entry) !=
+    HASH_TABLE_OK) {
+    return NULL;
+  }
+  _drop_expired_vectors(entry, _now());
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+static auth_vector_cache_entry_t *_get_or_create_entry(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn)
+{
+  auth_vector_cache_entry_t *entry = _get_entry(imsi64);
+  if (entry) {
+    return entry;
+  }
+  if (!auth_vector_cache) {
+    return NULL;
+  }
+  if (auth_vector_cache->num_elements >= AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS) {
+    _remove_expired_entries();
+    if (auth_vector_cache->num_elements >= AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS) {
+      increment_counter("auth_vector_cache", 1, 1, "result", "full");
+      return NULL;
+    }
+  }
+  entry = calloc(1, sizeof(auth_vector_cache_entry_t));
+  if (!entry) {
+    return NULL;
+  }
+  entry->visited_plmn = *visited_plmn;
+  if (
+    hashtable_insert(auth_vector_cache, (const hash_key_t) imsi64, entry) !=
+    HASH_TABLE_OK) {
+    free_wrapper((void **) &entry);
+    return NULL;
+  }
+  return entry;
+}
+
+//------------------------------------------------------------------------------
+static void _remove_entry_if_unused(
+  imsi64_t imsi64,
+  auth_vector_cache_entry_t *entry)
+{
+  if (_is_entry_unused(entry)) {
+    hashtable_free(auth_vector_cache, (const hash_key_t) imsi64);
+  }
+}
+
+//------------------------------------------------------------------------------
+int emm_auth_vector_cache_init(void)
+{
+  bstring b = bfromcstr("emm_auth_vector_cache");
+  auth_vector_cache =
+    hashtable_create(AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS, NULL, NULL, b);
+  bdestroy_wrapper(&b);
+  next_sweep = 0;
+  if (!auth_vector_cache) {
+    OAILOG_ERROR(LOG_NAS_EMM, "Failed to create the auth vector cache\n");
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void emm_auth_vector_cache_exit(void)
+{
+  if (auth_vector_cache) {
+    hashtable_destroy(auth_vector_cache);
+    auth_vector_cache = NULL;
+  }
+}
+
+//------------------------------------------------------------------------------
+void emm_auth_vector_cache_add(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn,
+  uint8_t nb_vectors,
+  const eutran_vector_t *vectors)
+{
+  if (nb_vectors == 0) {
+    return;
+  }
+  auth_vector_cache_entry_t *entry =
+    _get_or_create_entry(imsi64, visited_plmn);
+  if (!entry) {
+    return;
+  }
+  if (!PLMNS_ARE_EQUAL(entry->visited_plmn, *visited_plmn)) {
+    entry->visited_plmn = *visited_plmn;
+    entry->nb_vectors = 0;
+  }
+  if (nb_vectors > MAX_EPS_AUTH_VECTORS_PER_AIR) {
+    vectors += nb_vectors - MAX_EPS_AUTH_VECTORS_PER_AIR;
+    nb_vectors = MAX_EPS_AUTH_VECTORS_PER_AIR;
+  }
+  // older vectors have lower sequence numbers, drop them first
+  int overflow = entry->nb_vectors + nb_vectors - MAX_EPS_AUTH_VECTORS_PER_AIR;
+  if (overflow > 0) {
+    entry->nb_vectors -= overflow;
+    memmove(
+      entry->vectors,
+      &entry->vectors[overflow],
+      entry->nb_vectors * sizeof(eutran_vector_t));
+    memmove(
+      entry->expiry,
+      &entry->expiry[overflow],
+      entry->nb_vectors * sizeof(time_t));
+  }
+  time_t expiry = _now() + AUTH_VECTOR_CACHE_TTL_S;
+  for (int i = 0; i < nb_vectors; i++) {
+    entry->vectors[entry->nb_vectors] = vectors[i];
+    entry->expiry[entry->nb_vectors] = expiry;
+    entry->nb_vectors++;
+  }
+  _schedule_sweep(entry);
+  OAILOG_DEBUG(
+    LOG_NAS_EMM,
+    "Cached %u auth vector(s) for IMSI " IMSI_64_FMT ", %u available\n",
+    nb_vectors,
+    imsi64,
+    entry->nb_vectors);
+}
+
+//------------------------------------------------------------------------------
+bool emm_auth_vector_cache_take(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn,
+  eutran_vector_t *vector)
+{
+  auth_vector_cache_entry_t *entry = _get_entry(imsi64);
+  if (
+    !entry || (entry->nb_vectors == 0) ||
+    !PLMNS_ARE_EQUAL(entry->visited_plmn, *visited_plmn)) {
+    increment_counter("auth_vector_cache", 1, 1, "result", "miss");
+    return false;
+  }
+  *vector = entry->vectors[0];
+  entry->nb_vectors--;
+  memmove(
+    entry->vectors,
+    &entry->vectors[1],
+    entry->nb_vectors * sizeof(eutran_vector_t));
+  memmove(entry->expiry, &entry->expiry[1], entry->nb_vectors * sizeof(time_t));
+  increment_counter("auth_vector_cache", 1, 1, "result", "hit");
+  OAILOG_DEBUG(
+    LOG_NAS_EMM,
+    "Took cached auth vector for IMSI " IMSI_64_FMT ", %u left\n",
+    imsi64,
+    entry->nb_vectors);
+  _remove_entry_if_unused(imsi64, entry);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool emm_auth_vector_cache_start_prefetch(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn)
+{
+  auth_vector_cache_entry_t *entry =
+    _get_or_create_entry(imsi64, visited_plmn);
+  if (!entry || (entry->nb_vectors > 0) || entry->prefetch_deadline) {
+    return false;
+  }
+  entry->visited_plmn = *visited_plmn;
+  entry->prefetch_deadline = _now() + AUTH_VECTOR_PREFETCH_TIMEOUT_S;
+  entry->discard_prefetch = false;
+  _schedule_sweep(entry);
+  return true;
+}
+
+//------------------------------------------------------------------------------
+bool emm_auth_vector_cache_prefetch_answer(
+  imsi64_t imsi64,
+  bool success,
+  uint8_t nb_vectors,
+  const eutran_vector_t *vectors)
+{
+  auth_vector_cache_entry_t *entry = _get_entry(imsi64);
+  if (!entry || !entry->prefetch_deadline) {
+    return false;
+  }
+  bool discard = entry->discard_prefetch;
+  entry->prefetch_deadline = 0;
+  entry->discard_prefetch = false;
+  if (success && !discard) {
+    emm_auth_vector_cache_add(
+      imsi64, &entry->visited_plmn, nb_vectors, vectors);
+  } else {
+    OAILOG_DEBUG(
+      LOG_NAS_EMM,
+      "Dropped prefetched auth vectors for IMSI " IMSI_64_FMT "\n",
+      imsi64);
+    _remove_entry_if_unused(imsi64, entry);
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+void emm_auth_vector_cache_invalidate(imsi64_t imsi64)
+{
+  auth_vector_cache_entry_t *entry = _get_entry(imsi64);
+  if (!entry) {
+    return;
+  }
+  entry->nb_vectors = 0;
+  if (entry->prefetch_deadline) {
+    entry->discard_prefetch = true;
+  }
+  _remove_entry_if_unused(imsi64, entry);
+}
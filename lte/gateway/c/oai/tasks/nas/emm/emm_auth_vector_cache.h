@@ -0,0 +1,88 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#ifndef FILE_EMM_AUTH_VECTOR_CACHE_SEEN
+#define FILE_EMM_AUTH_VECTOR_CACHE_SEEN
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common_types.h"
+#include "3gpp_23.003.h"
+
+/*
+ * Per IMSI cache of the EPS authentication vectors fetched from the HSS but
+ * not used yet. It outlives UE contexts, so that a subscriber that attaches
+ * again is authenticated without an S6a round trip. Vectors are only valid
+ * for the serving network they were requested for, and expire after
+ * AUTH_VECTOR_CACHE_TTL_S. The cache is only accessed from the NAS task.
+ */
+int emm_auth_vector_cache_init(void);
+void emm_auth_vector_cache_exit(void);
+
+/*
+ * Keep vectors received for a subscriber, oldest first. Vectors already
+ * cached for another serving network are dropped
+ */
+void emm_auth_vector_cache_add(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn,
+  uint8_t nb_vectors,
+  const eutran_vector_t *vectors);
+
+/*
+ * Remove the oldest vector cached for the subscriber and serving network.
+ * Returns false if there is none
+ */
+bool emm_auth_vector_cache_take(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn,
+  eutran_vector_t *vector);
+
+/*
+ * Returns true if the caller should send an Authentication Information
+ * Request to refill the subscriber's cache, that is the cache ran out of
+ * vectors and no prefetch is outstanding. The prefetch is then marked
+ * outstanding until its answer is passed to
+ * emm_auth_vector_cache_prefetch_answer or AUTH_VECTOR_PREFETCH_TIMEOUT_S
+ */
+bool emm_auth_vector_cache_start_prefetch(
+  imsi64_t imsi64,
+  const plmn_t *visited_plmn);
+
+/*
+ * Cache the vectors of an Authentication Information Answer to a request sent
+ * with is_prefetch set. Returns false if the prefetch is no longer
+ * outstanding, the answer is then dropped
+ */
+bool emm_auth_vector_cache_prefetch_answer(
+  imsi64_t imsi64,
+  bool success,
+  uint8_t nb_vectors,
+  const eutran_vector_t *vectors);
+
+/*
+ * Drop the subscriber's vectors, e.g. after the UE rejected one of them. The
+ * answer of an outstanding prefetch is discarded as well, as it may have been
+ * generated with the sequence number the UE rejected
+ */
+void emm_auth_vector_cache_invalidate(imsi64_t imsi64);
+
+#endif /* FILE_EMM_AUTH_VECTOR_CACHE_SEEN */
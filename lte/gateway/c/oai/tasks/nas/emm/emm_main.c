@@ -51,6 +51,7 @@
 #include "3gpp_24.008.h"
 #include "common_defs.h"
 #include "emm_main.h"
+#include "emm_auth_vector_cache.h"
 #include "log.h"
 #include "mme_config.h"
 
@@ -91,6 +92,7 @@ void emm_main_initialize(mme_config_t *mme_config_p)
     OAILOG_ERROR(
       LOG_NAS_EMM, "EMM-MAIN  - Failed to get MME configuration data");
   }
+  emm_auth_vector_cache_init();
   OAILOG_FUNC_OUT(LOG_NAS_EMM);
 }
 
@@ -111,6 +113,7 @@ void emm_main_initialize(mme_config_t *mme_config_p)
 void emm_main_cleanup(void)
 {
   OAILOG_FUNC_IN(LOG_NAS_EMM);
+  emm_auth_vector_cache_exit();
   OAILOG_FUNC_OUT(LOG_NAS_EMM);
 }
 
@@ -34,6 +34,143 @@
 #include "TLVEncoder.h"
 #include "TLVDecoder.h"
 #include "AttachRequest.h"
+#include "nas_ie_table.h"
+
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  oldptmsisignature,
+  decode_p_tmsi_signature_ie)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  additionalguti,
+  decode_eps_mobile_identity)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  lastvisitedregisteredtai,
+  decode_tracking_area_identity)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  drxparameter,
+  decode_drx_parameter_ie)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  msnetworkcapability,
+  decode_ms_network_capability_ie)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  oldlocationareaidentification,
+  decode_location_area_identification_ie)
+NAS_OPTIONAL_IE_DECODER(attach_request_msg, tmsistatus, decode_tmsi_status)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  mobilestationclassmark2,
+  decode_mobile_station_classmark_2_ie)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  supportedcodecs,
+  decode_supported_codec_list)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  additionalupdatetype,
+  decode_additional_update_type)
+NAS_OPTIONAL_IE_DECODER(attach_request_msg, oldgutitype, decode_guti_type)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  voicedomainpreferenceandueusagesetting,
+  decode_voice_domain_preference_and_ue_usage_setting)
+NAS_OPTIONAL_IE_DECODER(
+  attach_request_msg,
+  msnetworkfeaturesupport,
+  decode_ms_network_feature_support_ie)
+
+static const nas_optional_ie_t attach_request_ies[] = {
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_OLD_PTMSI_SIGNATURE_IEI,
+    oldptmsisignature,
+    true,
+    ATTACH_REQUEST_OLD_PTMSI_SIGNATURE_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_ADDITIONAL_GUTI_IEI,
+    additionalguti,
+    ATTACH_REQUEST_ADDITIONAL_GUTI_IEI,
+    ATTACH_REQUEST_ADDITIONAL_GUTI_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
+    lastvisitedregisteredtai,
+    ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
+    ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_DRX_PARAMETER_IEI,
+    drxparameter,
+    true,
+    ATTACH_REQUEST_DRX_PARAMETER_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_MS_NETWORK_CAPABILITY_IEI,
+    msnetworkcapability,
+    true,
+    ATTACH_REQUEST_MS_NETWORK_CAPABILITY_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI,
+    oldlocationareaidentification,
+    true,
+    ATTACH_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_TMSI_STATUS_IEI,
+    tmsistatus,
+    true,
+    ATTACH_REQUEST_TMSI_STATUS_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI,
+    mobilestationclassmark2,
+    true,
+    ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_2_PRESENT),
+  // decode_mobile_station_classmark_3_ie is not implemented
+  NAS_SKIPPED_IE(
+    ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_3_IEI,
+    nas_skip_tlv_ie,
+    0),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_SUPPORTED_CODECS_IEI,
+    supportedcodecs,
+    true,
+    ATTACH_REQUEST_SUPPORTED_CODECS_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
+    additionalupdatetype,
+    ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
+    ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_OLD_GUTI_TYPE_IEI,
+    oldgutitype,
+    ATTACH_REQUEST_OLD_GUTI_TYPE_IEI,
+    ATTACH_REQUEST_OLD_GUTI_TYPE_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_IEI,
+    voicedomainpreferenceandueusagesetting,
+    true,
+    ATTACH_REQUEST_VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_PRESENT),
+  NAS_OPTIONAL_IE(
+    attach_request_msg,
+    ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_IEI,
+    msnetworkfeaturesupport,
+    ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_IEI,
+    ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_PRESENT),
+};
+
+static nas_optional_ies_t attach_request_optional_ies =
+  NAS_OPTIONAL_IES(attach_request_ies);
 
 int decode_attach_request(
   attach_request_msg *attach_request,
@@ -103,267 +240,16 @@ int decode_attach_request(
   /*
    * Decoding optional fields
    */
-  while (len - decoded > 0) {
-    uint8_t ieiDecoded = *(buffer + decoded);
-
-    /*
-     * Type | value iei are below 0x80 so just return the first 4 bits
-     */
-    if (ieiDecoded >= 0x80) ieiDecoded = ieiDecoded & 0xf0;
-
-    switch (ieiDecoded) {
-      case ATTACH_REQUEST_OLD_PTMSI_SIGNATURE_IEI:
-        if (
-          (decoded_result = decode_p_tmsi_signature_ie(
-             &attach_request->oldptmsisignature,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_OLD_PTMSI_SIGNATURE_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_ADDITIONAL_GUTI_IEI:
-        if (
-          (decoded_result = decode_eps_mobile_identity(
-             &attach_request->additionalguti,
-             ATTACH_REQUEST_ADDITIONAL_GUTI_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |= ATTACH_REQUEST_ADDITIONAL_GUTI_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI:
-        if (
-          (decoded_result = decode_tracking_area_identity(
-             &attach_request->lastvisitedregisteredtai,
-             ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_LAST_VISITED_REGISTERED_TAI_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_DRX_PARAMETER_IEI:
-        if (
-          (decoded_result = decode_drx_parameter_ie(
-             &attach_request->drxparameter,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |= ATTACH_REQUEST_DRX_PARAMETER_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_MS_NETWORK_CAPABILITY_IEI:
-        if (
-          (decoded_result = decode_ms_network_capability_ie(
-             &attach_request->msnetworkcapability,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_MS_NETWORK_CAPABILITY_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI:
-        if (
-          (decoded_result = decode_location_area_identification_ie(
-             &attach_request->oldlocationareaidentification,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_TMSI_STATUS_IEI:
-        if (
-          (decoded_result = decode_tmsi_status(
-             &attach_request->tmsistatus,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |= ATTACH_REQUEST_TMSI_STATUS_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI:
-        if (
-          (decoded_result = decode_mobile_station_classmark_2_ie(
-             &attach_request->mobilestationclassmark2,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_2_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_3_IEI:
-        if (
-          (decoded_result = decode_mobile_station_classmark_3_ie(
-             &attach_request->mobilestationclassmark3,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_3_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_SUPPORTED_CODECS_IEI:
-        if (
-          (decoded_result = decode_supported_codec_list(
-             &attach_request->supportedcodecs,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |= ATTACH_REQUEST_SUPPORTED_CODECS_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI:
-        if (
-          (decoded_result = decode_additional_update_type(
-             &attach_request->additionalupdatetype,
-             ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_ADDITIONAL_UPDATE_TYPE_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_OLD_GUTI_TYPE_IEI:
-        if (
-          (decoded_result = decode_guti_type(
-             &attach_request->oldgutitype,
-             ATTACH_REQUEST_OLD_GUTI_TYPE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |= ATTACH_REQUEST_OLD_GUTI_TYPE_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_IEI:
-        if (
-          (decoded_result = decode_voice_domain_preference_and_ue_usage_setting(
-             &attach_request->voicedomainpreferenceandueusagesetting,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_VOICE_DOMAIN_PREFERENCE_AND_UE_USAGE_SETTING_PRESENT;
-        break;
-
-      case ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_IEI:
-        if (
-          (decoded_result = decode_ms_network_feature_support_ie(
-             &attach_request->msnetworkfeaturesupport,
-             ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0) {
-          //         return decoded_result;
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
-        }
-
-        decoded += decoded_result;
-        /* Set corresponding mask to 1 in presencemask */
-        attach_request->presencemask |=
-          ATTACH_REQUEST_MS_NETWORK_FEATURE_SUPPORT_PRESENT;
-        break;
-      default:
-        errorCodeDecoder = TLV_UNEXPECTED_IEI;
-        {
-          OAILOG_FUNC_RETURN(LOG_NAS_EMM, TLV_UNEXPECTED_IEI);
-        }
-    }
+  if (
+    (decoded_result = nas_decode_optional_ies(
+       &attach_request_optional_ies,
+       attach_request,
+       &attach_request->presencemask,
+       buffer + decoded,
+       len - decoded)) < 0) {
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded_result);
   }
+  decoded += decoded_result;
 
   OAILOG_FUNC_RETURN(LOG_NAS_EMM, decoded);
 }
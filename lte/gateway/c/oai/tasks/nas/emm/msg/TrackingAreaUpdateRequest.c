@@ -32,6 +32,192 @@
 #include "TLVEncoder.h"
 #include "TLVDecoder.h"
 #include "TrackingAreaUpdateRequest.h"
+#include "nas_ie_table.h"
+
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  noncurrentnativenaskeysetidentifier,
+  decode_nas_key_set_identifier)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  gprscipheringkeysequencenumber,
+  decode_ciphering_key_sequence_number_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  oldptmsisignature,
+  decode_p_tmsi_signature_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  additionalguti,
+  decode_eps_mobile_identity)
+NAS_OPTIONAL_IE_DECODER(tracking_area_update_request_msg, nonceue, decode_nonce)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  uenetworkcapability,
+  decode_ue_network_capability)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  lastvisitedregisteredtai,
+  decode_tracking_area_identity)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  drxparameter,
+  decode_drx_parameter_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  ueradiocapabilityinformationupdateneeded,
+  decode_ue_radio_capability_information_update_needed)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  epsbearercontextstatus,
+  decode_eps_bearer_context_status)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  msnetworkcapability,
+  decode_ms_network_capability_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  oldlocationareaidentification,
+  decode_location_area_identification_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  tmsistatus,
+  decode_tmsi_status)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  mobilestationclassmark2,
+  decode_mobile_station_classmark_2_ie)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  supportedcodecs,
+  decode_supported_codec_list)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  additionalupdatetype,
+  decode_additional_update_type)
+NAS_OPTIONAL_IE_DECODER(
+  tracking_area_update_request_msg,
+  oldgutitype,
+  decode_guti_type)
+
+static const nas_optional_ie_t tracking_area_update_request_ies[] = {
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_IEI,
+    noncurrentnativenaskeysetidentifier,
+    TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_IEI,
+    gprscipheringkeysequencenumber,
+    TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_IEI,
+    oldptmsisignature,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_IEI,
+    additionalguti,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_NONCEUE_IEI,
+    nonceue,
+    TRACKING_AREA_UPDATE_REQUEST_NONCEUE_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_NONCEUE_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_IEI,
+    uenetworkcapability,
+    TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
+    lastvisitedregisteredtai,
+    TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_IEI,
+    drxparameter,
+    TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_IEI,
+    ueradiocapabilityinformationupdateneeded,
+    TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_IEI,
+    epsbearercontextstatus,
+    TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_IEI,
+    msnetworkcapability,
+    TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI,
+    oldlocationareaidentification,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_IEI,
+    tmsistatus,
+    TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI,
+    mobilestationclassmark2,
+    TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_PRESENT),
+  // decode_mobile_station_classmark_3_ie is not implemented
+  NAS_SKIPPED_IE(
+    TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_3_IEI,
+    nas_skip_tlv_ie,
+    0),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_IEI,
+    supportedcodecs,
+    TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
+    additionalupdatetype,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_PRESENT),
+  NAS_OPTIONAL_IE(
+    tracking_area_update_request_msg,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_IEI,
+    oldgutitype,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_IEI,
+    TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_PRESENT),
+  // not decoded as it is not used for CSFB
+  NAS_SKIPPED_IE(
+    TRACKING_AREA_UPDATE_REQUEST_VOICE_DOMAIN_PREFERENCE_IEI,
+    nas_skip_tlv_ie,
+    TRACKING_AREA_UPDATE_REQUEST_VOICE_DOMAIN_PREFERENCE),
+};
+
+static nas_optional_ies_t tracking_area_update_request_optional_ies =
+  NAS_OPTIONAL_IES(tracking_area_update_request_ies);
+
 
 int decode_tracking_area_update_request(
   tracking_area_update_request_msg *tracking_area_update_request,
@@ -79,336 +265,16 @@ int decode_tracking_area_update_request(
   /*
    * Decoding optional fields
    */
-  while (len - decoded > 0) {
-    uint8_t ieiDecoded = *(buffer + decoded);
-
-    /*
-     * Type | value iei are below 0x80 so just return the first 4 bits
-     */
-    if (ieiDecoded >= 0x80) ieiDecoded = ieiDecoded & 0xf0;
-
-    switch (ieiDecoded) {
-      case TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_IEI:
-        if (
-          (decoded_result = decode_nas_key_set_identifier(
-             &tracking_area_update_request->noncurrentnativenaskeysetidentifier,
-             TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_NONCURRENT_NATIVE_NAS_KEY_SET_IDENTIFIER_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_IEI:
-        if (
-          (decoded_result = decode_ciphering_key_sequence_number_ie(
-             &tracking_area_update_request->gprscipheringkeysequencenumber,
-             TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_GPRS_CIPHERING_KEY_SEQUENCE_NUMBER_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_IEI:
-        if (
-          (decoded_result = decode_p_tmsi_signature_ie(
-             &tracking_area_update_request->oldptmsisignature,
-             TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_OLD_PTMSI_SIGNATURE_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_IEI:
-        if (
-          (decoded_result = decode_eps_mobile_identity(
-             &tracking_area_update_request->additionalguti,
-             TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_GUTI_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_NONCEUE_IEI:
-        if (
-          (decoded_result = decode_nonce(
-             &tracking_area_update_request->nonceue,
-             TRACKING_AREA_UPDATE_REQUEST_NONCEUE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_NONCEUE_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_IEI:
-        if (
-          (decoded_result = decode_ue_network_capability(
-             &tracking_area_update_request->uenetworkcapability,
-             TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_UE_NETWORK_CAPABILITY_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI:
-        if (
-          (decoded_result = decode_tracking_area_identity(
-             &tracking_area_update_request->lastvisitedregisteredtai,
-             TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_LAST_VISITED_REGISTERED_TAI_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_IEI:
-        if (
-          (decoded_result = decode_drx_parameter_ie(
-             &tracking_area_update_request->drxparameter,
-             TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_DRX_PARAMETER_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_IEI:
-        if (
-          (decoded_result = decode_ue_radio_capability_information_update_needed(
-             &tracking_area_update_request
-                ->ueradiocapabilityinformationupdateneeded,
-             TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_UE_RADIO_CAPABILITY_INFORMATION_UPDATE_NEEDED_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_IEI:
-        if (
-          (decoded_result = decode_eps_bearer_context_status(
-             &tracking_area_update_request->epsbearercontextstatus,
-             TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_EPS_BEARER_CONTEXT_STATUS_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_IEI:
-        if (
-          (decoded_result = decode_ms_network_capability_ie(
-             &tracking_area_update_request->msnetworkcapability,
-             TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_MS_NETWORK_CAPABILITY_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI:
-        if (
-          (decoded_result = decode_location_area_identification_ie(
-             &tracking_area_update_request->oldlocationareaidentification,
-             TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_OLD_LOCATION_AREA_IDENTIFICATION_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_IEI:
-        if (
-          (decoded_result = decode_tmsi_status(
-             &tracking_area_update_request->tmsistatus,
-             TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_TMSI_STATUS_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI:
-        if (
-          (decoded_result = decode_mobile_station_classmark_2_ie(
-             &tracking_area_update_request->mobilestationclassmark2,
-             TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_2_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_3_IEI:
-        if (
-          (decoded_result = decode_mobile_station_classmark_3_ie(
-             &tracking_area_update_request->mobilestationclassmark3,
-             TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_3_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_3_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_IEI:
-        if (
-          (decoded_result = decode_supported_codec_list(
-             &tracking_area_update_request->supportedcodecs,
-             TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_SUPPORTED_CODECS_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI:
-        if (
-          (decoded_result = decode_additional_update_type(
-             &tracking_area_update_request->additionalupdatetype,
-             TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_ADDITIONAL_UPDATE_TYPE_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_IEI:
-        if (
-          (decoded_result = decode_guti_type(
-             &tracking_area_update_request->oldgutitype,
-             TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_OLD_GUTI_TYPE_PRESENT;
-        break;
-
-      case TRACKING_AREA_UPDATE_REQUEST_VOICE_DOMAIN_PREFERENCE_IEI:
-        //Not decoding as we do not use this IE in CSFB
-
-        decoded += 3; //IEI,Length and Usage setting flag
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        tracking_area_update_request->presencemask |=
-          TRACKING_AREA_UPDATE_REQUEST_VOICE_DOMAIN_PREFERENCE;
-        break;
-
-      default: errorCodeDecoder = TLV_UNEXPECTED_IEI; return TLV_UNEXPECTED_IEI;
-    }
-  }
+  if (
+    (decoded_result = nas_decode_optional_ies(
+       &tracking_area_update_request_optional_ies,
+       tracking_area_update_request,
+       &tracking_area_update_request->presencemask,
+       buffer + decoded,
+       len - decoded)) < 0)
+    return decoded_result;
+
+  decoded += decoded_result;
 
   return decoded;
 }
@@ -705,9 +705,10 @@ static int _emm_as_data_ind(emm_as_data_t *msg, int *emm_cause)
   if (EMM_AS_DATA_DELIVERED_TRUE == msg->delivered) {
     if (blength(msg->nas_msg) > 0) {
       /*
-       * Process the received NAS message
+       * Process the received NAS message, it is deciphered in place
        */
-      bstring plain_msg = bstrcpy(msg->nas_msg);
+      bstring plain_msg = msg->nas_msg;
+      msg->nas_msg = NULL;
 
       if (plain_msg) {
         nas_message_security_header_t header = {0};
@@ -733,10 +734,10 @@ static int _emm_as_data_ind(emm_as_data_t *msg, int *emm_cause)
         }
 
         int bytes = nas_message_decrypt(
-          msg->nas_msg->data,
+          plain_msg->data,
           plain_msg->data,
           &header,
-          blength(msg->nas_msg),
+          blength(plain_msg),
           security,
           &decode_status);
 
@@ -750,6 +751,7 @@ static int _emm_as_data_ind(emm_as_data_t *msg, int *emm_cause)
            * Failed to decrypt the message
            */
           *emm_cause = EMM_CAUSE_PROTOCOL_ERROR;
+          bdestroy_wrapper(&plain_msg);
           unlock_ue_contexts(ue_mm_context);
           OAILOG_FUNC_RETURN(LOG_NAS_EMM, bytes);
         } else if (
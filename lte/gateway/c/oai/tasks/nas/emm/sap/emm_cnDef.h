@@ -65,11 +65,11 @@ typedef struct emm_cn_auth_res_s {
   /* UE identifier */
   mme_ue_s1ap_id_t ue_id;
 
-  /* For future use: nb of vectors provided */
+  /* Nb of vectors provided */
   uint8_t nb_vectors;
 
-  /* Consider only one E-UTRAN vector for the moment... */
-  eutran_vector_t *vector[MAX_EPS_AUTH_VECTORS];
+  /* Vectors beyond MAX_EPS_AUTH_VECTORS go to the auth vector cache */
+  eutran_vector_t *vector[MAX_EPS_AUTH_VECTORS_PER_AIR];
 } emm_cn_auth_res_t;
 
 typedef struct emm_cn_auth_fail_s {
@@ -33,6 +33,64 @@
 #include "TLVEncoder.h"
 #include "TLVDecoder.h"
 #include "PdnConnectivityRequest.h"
+#include "nas_ie_table.h"
+
+static int skip_device_properties(
+  void *ie,
+  uint8_t iei,
+  uint8_t *buffer,
+  uint32_t len)
+{
+  // Skip this IE. Not supported. It is relevant for delay tolerant devices such as IoT devices.
+  OAILOG_INFO(
+    LOG_NAS_ESM,
+    "ESM-MSG - Device Properties IE in PDN Connectivity Request is not "
+    "supported. Skipping this IE. IE = %x\n",
+    *buffer);
+  return nas_skip_type1_ie(ie, iei, buffer, len);
+}
+
+NAS_OPTIONAL_IE_DECODER(
+  pdn_connectivity_request_msg,
+  esminformationtransferflag,
+  decode_esm_information_transfer_flag)
+NAS_OPTIONAL_IE_DECODER(
+  pdn_connectivity_request_msg,
+  accesspointname,
+  decode_access_point_name_ie)
+NAS_OPTIONAL_IE_DECODER(
+  pdn_connectivity_request_msg,
+  protocolconfigurationoptions,
+  decode_protocol_configuration_options_ie)
+
+static const nas_optional_ie_t pdn_connectivity_request_ies[] = {
+  NAS_OPTIONAL_IE(
+    pdn_connectivity_request_msg,
+    PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_IEI,
+    esminformationtransferflag,
+    PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_IEI,
+    PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_PRESENT),
+  NAS_OPTIONAL_IE(
+    pdn_connectivity_request_msg,
+    PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_IEI,
+    accesspointname,
+    true,
+    PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_PRESENT),
+  NAS_OPTIONAL_IE(
+    pdn_connectivity_request_msg,
+    PDN_CONNECTIVITY_REQUEST_PROTOCOL_CONFIGURATION_OPTIONS_IEI,
+    protocolconfigurationoptions,
+    true,
+    PDN_CONNECTIVITY_REQUEST_PROTOCOL_CONFIGURATION_OPTIONS_PRESENT),
+  // also covers PDN_CONNECTIVITY_REQUEST_DEVICE_PROPERTIES_LOW_PRIO_IEI
+  NAS_SKIPPED_IE(
+    PDN_CONNECTIVITY_REQUEST_DEVICE_PROPERTIES_IEI,
+    skip_device_properties,
+    0),
+};
+
+static nas_optional_ies_t pdn_connectivity_request_optional_ies =
+  NAS_OPTIONAL_IES(pdn_connectivity_request_ies);
 
 int decode_pdn_connectivity_request(
   pdn_connectivity_request_msg *pdn_connectivity_request,
@@ -70,80 +128,16 @@ int decode_pdn_connectivity_request(
   /*
    * Decoding optional fields
    */
-  while (len - decoded > 0) {
-    uint8_t ieiDecoded = *(buffer + decoded);
-
-    /*
-     * Type | value iei are below 0x80 so just return the first 4 bits
-     */
-    if (ieiDecoded >= 0x80) ieiDecoded = ieiDecoded & 0xf0;
-
-    switch (ieiDecoded) {
-      case PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_IEI:
-        if (
-          (decoded_result = decode_esm_information_transfer_flag(
-             &pdn_connectivity_request->esminformationtransferflag,
-             PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_IEI,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        pdn_connectivity_request->presencemask |=
-          PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_PRESENT;
-        break;
-
-      case PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_IEI:
-        if (
-          (decoded_result = decode_access_point_name_ie(
-             &pdn_connectivity_request->accesspointname,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        pdn_connectivity_request->presencemask |=
-          PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_PRESENT;
-        break;
-
-      case PDN_CONNECTIVITY_REQUEST_PROTOCOL_CONFIGURATION_OPTIONS_IEI:
-        if (
-          (decoded_result = decode_protocol_configuration_options_ie(
-             &pdn_connectivity_request->protocolconfigurationoptions,
-             true,
-             buffer + decoded,
-             len - decoded)) <= 0)
-          return decoded_result;
-
-        decoded += decoded_result;
-        /*
-       * Set corresponding mask to 1 in presencemask
-       */
-        pdn_connectivity_request->presencemask |=
-          PDN_CONNECTIVITY_REQUEST_PROTOCOL_CONFIGURATION_OPTIONS_PRESENT;
-        break;
-
-      case PDN_CONNECTIVITY_REQUEST_DEVICE_PROPERTIES_IEI:
-      case PDN_CONNECTIVITY_REQUEST_DEVICE_PROPERTIES_LOW_PRIO_IEI:
-        // Skip this IE. Not supported. It is relevant for delay tolerant devices such as IoT devices.
-        OAILOG_INFO(
-          LOG_NAS_ESM,
-          "ESM-MSG - Device Properties IE in PDN Connectivity Request is not "
-          "supported. Skipping this IE. IE = %x\n",
-          ieiDecoded);
-        decoded += 1; // Device Properties is 1 byte
-        break;
-
-      default: errorCodeDecoder = TLV_UNEXPECTED_IEI; return TLV_UNEXPECTED_IEI;
-    }
-  }
+  if (
+    (decoded_result = nas_decode_optional_ies(
+       &pdn_connectivity_request_optional_ies,
+       pdn_connectivity_request,
+       &pdn_connectivity_request->presencemask,
+       buffer + decoded,
+       len - decoded)) < 0)
+    return decoded_result;
+
+  decoded += decoded_result;
 
   return decoded;
 }
@@ -41,8 +41,13 @@ int decode_eps_bearer_context_status(
   uint8_t ielen = 0;
 
   if (iei > 0) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, EPS_BEARER_CONTEXT_STATUS_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (EPS_BEARER_CONTEXT_STATUS_MINIMUM_LENGTH - 1), len);
   }
 
   ielen = *(buffer + decoded);
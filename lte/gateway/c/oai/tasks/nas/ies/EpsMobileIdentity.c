@@ -64,8 +64,13 @@ int decode_eps_mobile_identity(
   uint8_t ielen = 0;
 
   if (iei > 0) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, EPS_MOBILE_IDENTITY_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (EPS_MOBILE_IDENTITY_MINIMUM_LENGTH - 1), len);
   }
 
   ielen = *(buffer + decoded);
@@ -73,13 +78,16 @@ int decode_eps_mobile_identity(
   CHECK_LENGTH_DECODER(len - decoded, ielen);
   uint8_t typeofidentity = *(buffer + decoded) & 0x7;
 
+  // the GUTI and IMEI decoders read a fixed number of octets
   if (typeofidentity == EPS_MOBILE_IDENTITY_IMSI) {
     decoded_rc =
       decode_imsi_eps_mobile_identity(&epsmobileidentity->imsi, buffer, ielen);
   } else if (typeofidentity == EPS_MOBILE_IDENTITY_GUTI) {
+    CHECK_LENGTH_DECODER(ielen, EPS_MOBILE_IDENTITY_GUTI_LENGTH);
     decoded_rc = decode_guti_eps_mobile_identity(
       &epsmobileidentity->guti, buffer + decoded);
   } else if (typeofidentity == EPS_MOBILE_IDENTITY_IMEI) {
+    CHECK_LENGTH_DECODER(ielen, EPS_MOBILE_IDENTITY_IMEI_LENGTH);
     decoded_rc = decode_imei_eps_mobile_identity(
       &epsmobileidentity->imei, buffer + decoded);
   }
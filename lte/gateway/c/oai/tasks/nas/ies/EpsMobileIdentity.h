@@ -24,6 +24,9 @@
 
 #define EPS_MOBILE_IDENTITY_MINIMUM_LENGTH 3
 #define EPS_MOBILE_IDENTITY_MAXIMUM_LENGTH 13
+// length of the value of a GUTI and an IMEI
+#define EPS_MOBILE_IDENTITY_GUTI_LENGTH 11
+#define EPS_MOBILE_IDENTITY_IMEI_LENGTH 8
 
 typedef struct guti_eps_mobile_identity_s {
   uint8_t spare : 4;
@@ -36,8 +36,12 @@ int decode_nonce(nonce_t *nonce, uint8_t iei, uint8_t *buffer, uint32_t len)
   int decoded = 0;
 
   if (iei > 0) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(buffer, NONCE_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (NONCE_MINIMUM_LENGTH - 1), len);
   }
   //IES_DECODE_U32(*nonce, *(buffer + decoded));
   IES_DECODE_U32(buffer, decoded, *nonce);
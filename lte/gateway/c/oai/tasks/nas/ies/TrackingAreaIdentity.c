@@ -41,8 +41,13 @@ int decode_tracking_area_identity(
   int decoded = 0;
 
   if (iei > 0) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, TRACKING_AREA_IDENTITY_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (TRACKING_AREA_IDENTITY_MINIMUM_LENGTH - 1), len);
   }
 
   tai->mcc_digit2 = (*(buffer + decoded) >> 4) & 0xf;
@@ -42,8 +42,13 @@ int decode_ue_network_capability(
   uint8_t ielen = 0;
 
   if (iei > 0) {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, UE_NETWORK_CAPABILITY_MINIMUM_LENGTH, len);
     CHECK_IEI_DECODER(iei, *buffer);
     decoded++;
+  } else {
+    CHECK_PDU_POINTER_AND_LENGTH_DECODER(
+      buffer, (UE_NETWORK_CAPABILITY_MINIMUM_LENGTH - 1), len);
   }
 
   DECODE_U8(buffer + decoded, ielen, decoded);
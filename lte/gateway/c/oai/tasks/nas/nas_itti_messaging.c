@@ -296,7 +296,8 @@ void nas_itti_auth_info_req(
   const bool is_initial_reqP,
   plmn_t *const visited_plmnP,
   const uint8_t num_vectorsP,
-  const_bstring const auts_pP)
+  const_bstring const auts_pP,
+  const bool is_prefetchP)
 {
   OAILOG_FUNC_IN(LOG_NAS);
   MessageDef *message_p = NULL;
@@ -316,6 +317,7 @@ void nas_itti_auth_info_req(
 
   auth_info_req->visited_plmn = *visited_plmnP;
   auth_info_req->nb_of_vectors = num_vectorsP;
+  auth_info_req->is_prefetch = is_prefetchP;
 
   if (is_initial_reqP) {
     auth_info_req->re_synchronization = 0;
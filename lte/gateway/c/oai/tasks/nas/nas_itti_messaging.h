@@ -70,7 +70,8 @@ void nas_itti_auth_info_req(
   const bool is_initial_reqP,
   plmn_t *const visited_plmnP,
   const uint8_t num_vectorsP,
-  const_bstring const auts_pP);
+  const_bstring const auts_pP,
+  const bool is_prefetchP);
 
 void nas_itti_establish_rej(
   const mme_ue_s1ap_id_t ue_idP,
@@ -48,6 +48,7 @@
 #include "nas_proc.h"
 #include "emm_proc.h"
 #include "emm_main.h"
+#include "emm_auth_vector_cache.h"
 #include "emm_sap.h"
 #include "esm_main.h"
 #include "msc.h"
@@ -420,6 +421,22 @@ int nas_proc_authentication_info_answer(s6a_auth_info_ans_t *aia)
 
   OAILOG_DEBUG(LOG_NAS_EMM, "Handling imsi " IMSI_64_FMT "\n", imsi64);
 
+  if (aia->is_prefetch) {
+    // vectors were prefetched for a later authentication of the subscriber
+    if (!emm_auth_vector_cache_prefetch_answer(
+          imsi64,
+          (aia->result.present == S6A_RESULT_BASE) &&
+            (aia->result.choice.base == DIAMETER_SUCCESS),
+          aia->auth_info.nb_of_vectors,
+          aia->auth_info.eutran_vector)) {
+      OAILOG_DEBUG(
+        LOG_NAS_EMM,
+        "Dropped late prefetch answer for imsi " IMSI_64_FMT "\n",
+        imsi64);
+    }
+    OAILOG_FUNC_RETURN(LOG_NAS_EMM, RETURNok);
+  }
+
   ue_mm_context = mme_ue_context_exists_imsi(
     &mme_app_desc.mme_ue_contexts, (const hash_key_t) imsi64);
   if (ue_mm_context) {
@@ -441,12 +458,12 @@ int nas_proc_authentication_info_answer(s6a_auth_info_ans_t *aia)
     (aia->result.present == S6A_RESULT_BASE) &&
     (aia->result.choice.base == DIAMETER_SUCCESS)) {
     /*
-      * Check that list is not empty and contain at most MAX_EPS_AUTH_VECTORS elements
+      * Check that list is not empty and contain at most MAX_EPS_AUTH_VECTORS_PER_AIR elements
       */
     DevCheck(
-      aia->auth_info.nb_of_vectors <= MAX_EPS_AUTH_VECTORS,
+      aia->auth_info.nb_of_vectors <= MAX_EPS_AUTH_VECTORS_PER_AIR,
       aia->auth_info.nb_of_vectors,
-      MAX_EPS_AUTH_VECTORS,
+      MAX_EPS_AUTH_VECTORS_PER_AIR,
       0);
     DevCheck(
       aia->auth_info.nb_of_vectors > 0, aia->auth_info.nb_of_vectors, 1, 0);
@@ -728,7 +745,8 @@ int nas_proc_downlink_unitdata(itti_sgsap_downlink_unitdata_t *dl_unitdata)
 
   nas_emm_attach_proc_t *attach_proc = get_nas_specific_procedure_attach(ctxt);
   emm_as->nas_info = EMM_AS_NAS_DL_NAS_TRANSPORT;
-  emm_as->nas_msg = bstrcpy(dl_unitdata->nas_msg_container);
+  emm_as->nas_msg = dl_unitdata->nas_msg_container;
+  dl_unitdata->nas_msg_container = NULL;
   /*
    * Set the UE identifier
    */
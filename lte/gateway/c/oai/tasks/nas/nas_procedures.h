@@ -314,7 +314,7 @@ typedef struct nas_auth_info_proc_s {
   failure_cb_t failure_notif;
   bool request_sent;
   uint8_t nb_vectors;
-  eutran_vector_t *vector[MAX_EPS_AUTH_VECTORS];
+  eutran_vector_t *vector[MAX_EPS_AUTH_VECTORS_PER_AIR];
   int nas_cause;
   struct nas_timer_s timer_s6a;
   mme_ue_s1ap_id_t ue_id;
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+#include <stdint.h>
+
+#include "common_defs.h"
+#include "assertions.h"
+#include "TLVDecoder.h"
+#include "nas_ie_table.h"
+
+//------------------------------------------------------------------------------
+static void nas_optional_ies_index(nas_optional_ies_t *table)
+{
+  for (int i = 0; i < table->nb_ies; i++) {
+    uint8_t iei = table->ies[i].iei;
+    int nb_octets = 1;
+
+    if (iei >= 0x80) {
+      // the lower 4 bits of the octet are the value of the IE
+      DevAssert((iei & 0x0f) == 0);
+      nb_octets = 16;
+    }
+    for (int value = 0; value < nb_octets; value++) {
+      DevAssert(table->index[iei | value] == 0);
+      table->index[iei | value] = i + 1;
+    }
+  }
+  table->indexed = true;
+}
+
+//------------------------------------------------------------------------------
+int nas_decode_optional_ies(
+  nas_optional_ies_t *table,
+  void *msg,
+  uint32_t *presencemask,
+  uint8_t *buffer,
+  uint32_t len)
+{
+  uint32_t decoded = 0;
+
+  if (!table->indexed) {
+    nas_optional_ies_index(table);
+  }
+  while (len - decoded > 0) {
+    uint8_t index = table->index[*(buffer + decoded)];
+
+    if (!index) {
+      errorCodeDecoder = TLV_UNEXPECTED_IEI;
+      return TLV_UNEXPECTED_IEI;
+    }
+    const nas_optional_ie_t *ie = &table->ies[index - 1];
+    if (*presencemask & ie->present) {
+      // decoding it again would overwrite, and leak, the first occurrence
+      errorCodeDecoder = TLV_UNEXPECTED_IEI;
+      return TLV_UNEXPECTED_IEI;
+    }
+    int decoded_result = ie->decode(
+      (uint8_t *) msg + ie->offset,
+      ie->iei_arg,
+      buffer + decoded,
+      len - decoded);
+    if (decoded_result < 0) {
+      return decoded_result;
+    }
+    if (decoded_result == 0 || decoded_result > len - decoded) {
+      errorCodeDecoder = TLV_VALUE_DOESNT_MATCH;
+      return TLV_VALUE_DOESNT_MATCH;
+    }
+    decoded += decoded_result;
+    *presencemask |= ie->present;
+  }
+  return decoded;
+}
+
+//------------------------------------------------------------------------------
+int nas_skip_tlv_ie(void *ie, uint8_t iei, uint8_t *buffer, uint32_t len)
+{
+  CHECK_LENGTH_DECODER(len, 2);
+  CHECK_LENGTH_DECODER(len, 2 + *(buffer + 1));
+  return 2 + *(buffer + 1);
+}
+
+//------------------------------------------------------------------------------
+int nas_skip_type1_ie(void *ie, uint8_t iei, uint8_t *buffer, uint32_t len)
+{
+  return 1;
+}
@@ -0,0 +1,112 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#ifndef FILE_NAS_IE_TABLE_SEEN
+#define FILE_NAS_IE_TABLE_SEEN
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Table driven decoding of the optional IEs of a NAS message. A message lists
+ * its optional IEs once, with the field, presence bit and decoder of each,
+ * and nas_decode_optional_ies dispatches every IEI found in the buffer
+ * through a 256 entry index built from the list on first use. The tables
+ * are only used from the NAS task.
+ *
+ * Only the uplink messages with many optional IEs use a table: Attach
+ * Request, Tracking Area Update Request and PDN Connectivity Request. The
+ * other messages keep their own decoders.
+ */
+typedef int (*nas_ie_decoder_t)(
+  void *ie,
+  uint8_t iei,
+  uint8_t *buffer,
+  uint32_t len);
+
+typedef struct nas_optional_ie_s {
+  uint8_t iei;     // type 1 IEs only use the upper 4 bits of their octet
+  uint8_t iei_arg; // passed to the decoder, the IEI or true
+  size_t offset;   // of the IE in the message
+  nas_ie_decoder_t decode;
+  uint32_t present; // presencemask bit
+} nas_optional_ie_t;
+
+typedef struct nas_optional_ies_s {
+  const nas_optional_ie_t *ies;
+  int nb_ies;
+  bool indexed;
+  uint8_t index[256]; // 1 + position in ies for every IEI octet, 0 if unknown
+} nas_optional_ies_t;
+
+/*
+ * Define the nas_ie_decoder_t of a field of a message, which calls the
+ * decoder of the IE with the field's own type. A message defines one for
+ * each of its NAS_OPTIONAL_IE entries, before its table
+ */
+#define NAS_OPTIONAL_IE_DECODER(type, field, decoder)                          \
+  static int type##_##field##_decoder(                                         \
+    void *ie, uint8_t iei, uint8_t *buffer, uint32_t len)                      \
+  {                                                                            \
+    return decoder(                                                            \
+      (__typeof__(((type *) 0)->field) *) ie, iei, buffer, len);               \
+  }
+#define NAS_OPTIONAL_IE(type, iEI, field, iEIaRG, present)                     \
+  {                                                                            \
+    iEI, iEIaRG, offsetof(type, field), type##_##field##_decoder, present      \
+  }
+#define NAS_SKIPPED_IE(iEI, skip, present)                                     \
+  {                                                                            \
+    iEI, iEI, 0, skip, present                                                 \
+  }
+#define NAS_OPTIONAL_IES(ies)                                                  \
+  {                                                                            \
+    ies, sizeof(ies) / sizeof(ies[0]), false, { 0 }                            \
+  }
+
+/*
+ * Decode the optional IEs at the end of a NAS message. Unknown and repeated
+ * IEs are rejected
+ * @param table - the optional IEs of the message
+ * @param msg - the message to decode the IEs into
+ * @param presencemask - presencemask of the message
+ * @param buffer - the optional IEs
+ * @param len - length of buffer
+ * @return the number of decoded bytes, or a negative TLV error code
+ */
+int nas_decode_optional_ies(
+  nas_optional_ies_t *table,
+  void *msg,
+  uint32_t *presencemask,
+  uint8_t *buffer,
+  uint32_t len);
+
+/*
+ * Skip a type 4 (TLV) IE that is not supported
+ */
+int nas_skip_tlv_ie(void *ie, uint8_t iei, uint8_t *buffer, uint32_t len);
+
+/*
+ * Skip a type 1 IE, IEI and value in one octet, that is not supported
+ */
+int nas_skip_type1_ie(void *ie, uint8_t iei, uint8_t *buffer, uint32_t len);
+
+#endif /* FILE_NAS_IE_TABLE_SEEN */
@@ -374,9 +374,7 @@ int s11_mme_init(const mme_config_t *const mme_config_p)
 
   DevAssert(
     NW_OK == nwGtpv2cSetLogLevel(s11_mme_stack_handle, NW_LOG_LEVEL_DEBG));
-  mme_config_read_lock(&mme_config);
   s11_send_init_udp(&mme_config.ipv4.s11, mme_config.ipv4.port_s11);
-  mme_config_unlock(&mme_config);
 
   bstring b = bfromcstr("s11_mme_teid_2_gtv2c_teid_handle");
   s11_mme_teid_2_gtv2c_teid_handle = hashtable_ts_create(
@@ -23,10 +23,11 @@ extern "C" {
 #define ASN1C_ENVIRONMENT_VERSION 924    /* Compile-time version */
 int get_asn1c_environment_version(void); /* Run-time version */
 
-#define CALLOC(nmemb, size) calloc(nmemb, size)
-#define MALLOC(size) malloc(size)
-#define REALLOC(oldptr, size) realloc(oldptr, size)
-#define FREEMEM(ptr) free(ptr)
+#include "s1ap_arena.h"
+#define CALLOC(nmemb, size) s1ap_arena_calloc(nmemb, size)
+#define MALLOC(size) s1ap_arena_malloc(size)
+#define REALLOC(oldptr, size) s1ap_arena_realloc(oldptr, size)
+#define FREEMEM(ptr) s1ap_arena_free(ptr)
 
 #define asn_debug_indent 0
 #define ASN_DEBUG_INDENT_ADD(i)                                                \
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_arena.c
+  \brief Bump allocator for the memory of decoded S1AP PDUs
+*/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "s1ap_arena.h"
+
+// Most decoded PDUs fit in the first chunk, which is kept across resets
+#define ARENA_CHUNK_SIZE 16384
+#define ARENA_ALIGNMENT 16
+
+typedef struct arena_chunk_s {
+  struct arena_chunk_s *next;
+  size_t size;
+  size_t used;
+  uint8_t *data;
+} arena_chunk_t;
+
+// Each allocation is preceded by its size, for REALLOC
+typedef union arena_header_u {
+  size_t size;
+  uint8_t align[ARENA_ALIGNMENT];
+} arena_header_t;
+
+typedef struct s1ap_arena_s {
+  bool active;
+  arena_chunk_t *chunks; // most recent first
+} s1ap_arena_t;
+
+static __thread s1ap_arena_t arena = {0};
+
+//------------------------------------------------------------------------------
+static arena_chunk_t *arena_new_chunk(size_t size)
+{
+  arena_chunk_t *chunk = malloc(sizeof(arena_chunk_t) + ARENA_ALIGNMENT + size);
+
+  if (!chunk) {
+    return NULL;
+  }
+  chunk->size = size;
+  chunk->used = 0;
+  chunk->data = (uint8_t *) (((uintptr_t)(chunk + 1) + ARENA_ALIGNMENT - 1) &
+                             ~(uintptr_t)(ARENA_ALIGNMENT - 1));
+  chunk->next = arena.chunks;
+  arena.chunks = chunk;
+  return chunk;
+}
+
+//------------------------------------------------------------------------------
+static bool arena_owns(const void *ptr)
+{
+  for (arena_chunk_t *chunk = arena.chunks; chunk; chunk = chunk->next) {
+    if (
+      (const uint8_t *) ptr >= chunk->data &&
+      (const uint8_t *) ptr < chunk->data + chunk->used) {
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+static void *arena_alloc(size_t size)
+{
+  size_t needed = sizeof(arena_header_t) +
+                  ((size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1));
+  arena_chunk_t *chunk = arena.chunks;
+
+  if (!chunk || chunk->size - chunk->used < needed) {
+    chunk = arena_new_chunk(
+      needed > ARENA_CHUNK_SIZE ? needed : ARENA_CHUNK_SIZE);
+    if (!chunk) {
+      return NULL;
+    }
+  }
+  arena_header_t *header = (arena_header_t *) (chunk->data + chunk->used);
+  chunk->used += needed;
+  header->size = size;
+  return header + 1;
+}
+
+//------------------------------------------------------------------------------
+void *s1ap_arena_calloc(size_t nmemb, size_t size)
+{
+  if (!arena.active) {
+    return calloc(nmemb, size);
+  }
+  if (size && nmemb > SIZE_MAX / size) {
+    return NULL;
+  }
+  void *ptr = arena_alloc(nmemb * size);
+  if (ptr) {
+    memset(ptr, 0, nmemb * size);
+  }
+  return ptr;
+}
+
+//------------------------------------------------------------------------------
+void *s1ap_arena_malloc(size_t size)
+{
+  if (!arena.active) {
+    return malloc(size);
+  }
+  return arena_alloc(size);
+}
+
+//------------------------------------------------------------------------------
+void *s1ap_arena_realloc(void *ptr, size_t size)
+{
+  if (!ptr || !arena_owns(ptr)) {
+    // heap memory stays on the heap
+    return ptr || !arena.active ? realloc(ptr, size) : arena_alloc(size);
+  }
+  size_t old_size = ((arena_header_t *) ptr - 1)->size;
+  if (size <= old_size) {
+    ((arena_header_t *) ptr - 1)->size = size;
+    return ptr;
+  }
+  void *new_ptr = arena_alloc(size);
+  if (new_ptr) {
+    memcpy(new_ptr, ptr, old_size);
+  }
+  return new_ptr;
+}
+
+//------------------------------------------------------------------------------
+void s1ap_arena_free(void *ptr)
+{
+  if (ptr && !arena_owns(ptr)) {
+    free(ptr);
+  }
+}
+
+//------------------------------------------------------------------------------
+void s1ap_arena_enter(void)
+{
+  arena.active = true;
+}
+
+//------------------------------------------------------------------------------
+void s1ap_arena_leave(void)
+{
+  arena.active = false;
+}
+
+//------------------------------------------------------------------------------
+void s1ap_arena_reset(void)
+{
+  arena_chunk_t *chunk = arena.chunks;
+
+  if (!chunk) {
+    return;
+  }
+  // keep the oldest chunk, unless it was allocated for a large block
+  while (chunk->next) {
+    arena_chunk_t *next = chunk->next;
+    free(chunk);
+    chunk = next;
+  }
+  if (chunk->size > ARENA_CHUNK_SIZE) {
+    free(chunk);
+    chunk = NULL;
+  } else {
+    chunk->used = 0;
+  }
+  arena.chunks = chunk;
+}
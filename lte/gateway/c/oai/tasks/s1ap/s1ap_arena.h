@@ -0,0 +1,60 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_arena.h
+  \brief Bump allocator for the memory of decoded S1AP PDUs
+*/
+
+#ifndef FILE_S1AP_ARENA_SEEN
+#define FILE_S1AP_ARENA_SEEN
+
+#include <stddef.h>
+
+/*
+ * The asn1c runtime allocates through these functions (see CALLOC, MALLOC,
+ * REALLOC and FREEMEM in asn_internal.h). Between s1ap_arena_enter and
+ * s1ap_arena_leave, the calling thread allocates from its arena. Memory
+ * from the arena is never freed one by one, FREEMEM ignores it, and all of
+ * it is released together by s1ap_arena_reset. Outside of the arena, the
+ * functions are the libc ones.
+ */
+void *s1ap_arena_calloc(size_t nmemb, size_t size);
+void *s1ap_arena_malloc(size_t size);
+void *s1ap_arena_realloc(void *ptr, size_t size);
+void s1ap_arena_free(void *ptr);
+
+/*
+ * Allocate from the arena of the calling thread until s1ap_arena_leave
+ */
+void s1ap_arena_enter(void);
+
+/*
+ * Allocate from the heap again. Memory allocated from the arena stays valid
+ * until the next s1ap_arena_reset
+ */
+void s1ap_arena_leave(void);
+
+/*
+ * Release all the memory allocated from the arena of the calling thread
+ */
+void s1ap_arena_reset(void);
+
+#endif /* FILE_S1AP_ARENA_SEEN */
@@ -50,6 +50,7 @@
 #include "s1ap_mme_handlers.h"
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_nas_procedures.h"
+#include "s1ap_mme_paging.h"
 #include "s1ap_mme_retransmission.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "service303.h"
@@ -57,6 +58,7 @@
 #include "mme_config.h"
 #include "timer.h"
 #include "itti_free_defined_msg.h"
+#include "itti_trace.h"
 
 #if S1AP_DEBUG_LIST
 #define eNB_LIST_OUT(x, args...)                                               \
@@ -141,8 +143,9 @@ void *s1ap_mme_thread(__attribute__((unused)) void *args)
          */
         if (
           s1ap_mme_decode_pdu(
-            &message, SCTP_DATA_IND(received_message_p).payload, &message_id) <
-          0) {
+            &message,
+            &SCTP_DATA_IND(received_message_p).payload,
+            &message_id) < 0) {
           // TODO: Notify eNB of failure with right cause
           OAILOG_ERROR(LOG_S1AP, "Failed to decode new buffer\n");
         } else {
@@ -157,7 +160,7 @@ void *s1ap_mme_thread(__attribute__((unused)) void *args)
         }
 
         /*
-         * Free received PDU array
+         * Free received PDU array, unless a handler took it
          */
         bdestroy_wrapper(&SCTP_DATA_IND(received_message_p).payload);
       } break;
@@ -269,6 +272,8 @@ void *s1ap_mme_thread(__attribute__((unused)) void *args)
                 mme_ue_s1ap_id);
               increment_counter(
                 "ue_context_release_command_timer_expired", 1, NO_LABELS);
+              itti_trace_set_ue(
+                ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
               s1ap_mme_handle_ue_context_rel_comp_timer_expiry(ue_ref_p);
             }
           } else if (timer_arg.timer_class == S1AP_ENB_TIMER) {
@@ -396,6 +401,7 @@ void s1ap_mme_exit(void)
   if (hashtable_ts_destroy(&g_s1ap_mme_id2assoc_id_coll) != HASH_TABLE_OK) {
     OAI_FPRINTF_ERR("An error occured while destroying assoc_id hash table");
   }
+  s1ap_mme_paging_templates_free();
   OAILOG_DEBUG(LOG_S1AP, "Cleaning S1AP: DONE\n");
 }
 
@@ -673,6 +679,7 @@ void s1ap_notified_new_ue_mme_s1ap_id_association(
       s1ap_is_ue_enb_id_in_list(enb_ref, enb_ue_s1ap_id);
     if (ue_ref) {
       ue_ref->mme_ue_s1ap_id = mme_ue_s1ap_id;
+      itti_trace_set_ue(enb_ue_s1ap_id, mme_ue_s1ap_id);
       hashtable_rc_t h_rc = hashtable_ts_insert(
         &g_s1ap_mme_id2assoc_id_coll,
         (const hash_key_t) mme_ue_s1ap_id,
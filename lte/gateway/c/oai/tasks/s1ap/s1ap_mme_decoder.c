@@ -29,6 +29,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <inttypes.h>
+#include <string.h>
 #include <pthread.h>
 
 #include "bstrlib.h"
@@ -37,6 +38,7 @@
 #include "assertions.h"
 #include "common_defs.h"
 #include "intertask_interface.h"
+#include "s1ap_arena.h"
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme.h"
@@ -224,9 +226,520 @@ static int s1ap_mme_decode_unsuccessfull_outcome(
   return ret;
 }
 
-int s1ap_mme_decode_pdu(
+/*
+ * Fast path for the UE associated messages that make up most of the
+ * signalling. Instead of decoding the whole PDU, the aligned PER framing is
+ * parsed directly: every protocol IE is an open type, so IEs can be located
+ * and skipped from their length. The UE S1AP IDs are read in place and the
+ * NAS-PDU points into the received buffer, which stays valid until the
+ * message is freed. The other IEs are decoded one by one with asn1c, or
+ * deferred until a handler asks for them with s1ap_mme_decode_deferred_ie.
+ * Anything unexpected makes the caller fall back to the full decoder.
+ */
+typedef int (*s1ap_ie_convert_t)(void *ie, void *decoded);
+
+typedef enum s1ap_lazy_ie_kind_e {
+  LAZY_IE_MME_UE_S1AP_ID,
+  LAZY_IE_ENB_UE_S1AP_ID,
+  LAZY_IE_OCTET_STRING,
+  LAZY_IE_ASN,          // decoded with asn1c with the message
+  LAZY_IE_ASN_DEFERRED, // decoded with asn1c on demand
+} s1ap_lazy_ie_kind_t;
+
+typedef struct s1ap_lazy_ie_s {
+  S1ap_ProtocolIE_ID_t id;
+  s1ap_lazy_ie_kind_t kind;
+  size_t offset; // of the IE in message->msg
+  asn_TYPE_descriptor_t *td;
+  size_t size;
+  s1ap_ie_convert_t convert; // for lists, NULL to copy the decoded IE
+  uint16_t present;          // presenceMask bit, 0 for mandatory IEs
+} s1ap_lazy_ie_t;
+
+typedef struct s1ap_lazy_procedure_s {
+  uint8_t direction;
+  S1ap_ProcedureCode_t procedure_code;
+  MessagesIds message_id;
+  size_t presence_offset;
+  const s1ap_lazy_ie_t *ies;
+  int nb_ies;
+} s1ap_lazy_procedure_t;
+
+#define LAZY_IE_ID(ie_id, kind, type, field)                                   \
+  {                                                                            \
+    S1ap_ProtocolIE_ID_id_##ie_id, kind, offsetof(type, field), NULL, 0, NULL, \
+      0                                                                        \
+  }
+#define LAZY_IE(ie_id, kind, type, field, asn_type, convert, present)          \
+  {                                                                            \
+    S1ap_ProtocolIE_ID_id_##ie_id, kind, offsetof(type, field),                \
+      &asn_DEF_##asn_type, sizeof(asn_type##_t), (s1ap_ie_convert_t) convert,  \
+      present                                                                  \
+  }
+
+static const s1ap_lazy_ie_t uplink_nas_transport_ies[] = {
+  LAZY_IE_ID(
+    MME_UE_S1AP_ID,
+    LAZY_IE_MME_UE_S1AP_ID,
+    S1ap_UplinkNASTransportIEs_t,
+    mme_ue_s1ap_id),
+  LAZY_IE_ID(
+    eNB_UE_S1AP_ID,
+    LAZY_IE_ENB_UE_S1AP_ID,
+    S1ap_UplinkNASTransportIEs_t,
+    eNB_UE_S1AP_ID),
+  LAZY_IE_ID(
+    NAS_PDU, LAZY_IE_OCTET_STRING, S1ap_UplinkNASTransportIEs_t, nas_pdu),
+  LAZY_IE(
+    EUTRAN_CGI,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_UplinkNASTransportIEs_t,
+    eutran_cgi,
+    S1ap_EUTRAN_CGI,
+    NULL,
+    0),
+  LAZY_IE(
+    TAI,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_UplinkNASTransportIEs_t,
+    tai,
+    S1ap_TAI,
+    NULL,
+    0),
+  LAZY_IE(
+    GW_TransportLayerAddress,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_UplinkNASTransportIEs_t,
+    gW_TransportLayerAddress,
+    S1ap_TransportLayerAddress,
+    NULL,
+    S1AP_UPLINKNASTRANSPORTIES_GW_TRANSPORTLAYERADDRESS_PRESENT),
+};
+
+static const s1ap_lazy_ie_t ue_context_release_request_ies[] = {
+  LAZY_IE_ID(
+    MME_UE_S1AP_ID,
+    LAZY_IE_MME_UE_S1AP_ID,
+    S1ap_UEContextReleaseRequestIEs_t,
+    mme_ue_s1ap_id),
+  LAZY_IE_ID(
+    eNB_UE_S1AP_ID,
+    LAZY_IE_ENB_UE_S1AP_ID,
+    S1ap_UEContextReleaseRequestIEs_t,
+    eNB_UE_S1AP_ID),
+  LAZY_IE(
+    Cause,
+    LAZY_IE_ASN,
+    S1ap_UEContextReleaseRequestIEs_t,
+    cause,
+    S1ap_Cause,
+    NULL,
+    0),
+  LAZY_IE(
+    GWContextReleaseIndication,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_UEContextReleaseRequestIEs_t,
+    gwContextReleaseIndication,
+    S1ap_GWContextReleaseIndication,
+    NULL,
+    S1AP_UECONTEXTRELEASEREQUESTIES_GWCONTEXTRELEASEINDICATION_PRESENT),
+};
+
+static const s1ap_lazy_ie_t ue_context_release_complete_ies[] = {
+  LAZY_IE_ID(
+    MME_UE_S1AP_ID,
+    LAZY_IE_MME_UE_S1AP_ID,
+    S1ap_UEContextReleaseCompleteIEs_t,
+    mme_ue_s1ap_id),
+  LAZY_IE_ID(
+    eNB_UE_S1AP_ID,
+    LAZY_IE_ENB_UE_S1AP_ID,
+    S1ap_UEContextReleaseCompleteIEs_t,
+    eNB_UE_S1AP_ID),
+  LAZY_IE(
+    CriticalityDiagnostics,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_UEContextReleaseCompleteIEs_t,
+    criticalityDiagnostics,
+    S1ap_CriticalityDiagnostics,
+    NULL,
+    S1AP_UECONTEXTRELEASECOMPLETEIES_CRITICALITYDIAGNOSTICS_PRESENT),
+};
+
+static const s1ap_lazy_ie_t initial_context_setup_response_ies[] = {
+  LAZY_IE_ID(
+    MME_UE_S1AP_ID,
+    LAZY_IE_MME_UE_S1AP_ID,
+    S1ap_InitialContextSetupResponseIEs_t,
+    mme_ue_s1ap_id),
+  LAZY_IE_ID(
+    eNB_UE_S1AP_ID,
+    LAZY_IE_ENB_UE_S1AP_ID,
+    S1ap_InitialContextSetupResponseIEs_t,
+    eNB_UE_S1AP_ID),
+  LAZY_IE(
+    E_RABSetupListCtxtSURes,
+    LAZY_IE_ASN,
+    S1ap_InitialContextSetupResponseIEs_t,
+    e_RABSetupListCtxtSURes,
+    S1ap_E_RABSetupListCtxtSURes,
+    s1ap_decode_s1ap_e_rabsetuplistctxtsures,
+    0),
+  LAZY_IE(
+    E_RABFailedToSetupListCtxtSURes,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_InitialContextSetupResponseIEs_t,
+    e_RABFailedToSetupListCtxtSURes,
+    S1ap_E_RABList,
+    s1ap_decode_s1ap_e_rablist,
+    S1AP_INITIALCONTEXTSETUPRESPONSEIES_E_RABFAILEDTOSETUPLISTCTXTSURES_PRESENT),
+  LAZY_IE(
+    CriticalityDiagnostics,
+    LAZY_IE_ASN_DEFERRED,
+    S1ap_InitialContextSetupResponseIEs_t,
+    criticalityDiagnostics,
+    S1ap_CriticalityDiagnostics,
+    NULL,
+    S1AP_INITIALCONTEXTSETUPRESPONSEIES_CRITICALITYDIAGNOSTICS_PRESENT),
+};
+
+#define LAZY_PROCEDURE(direction, procedure, message_id, type, ies)            \
+  {                                                                            \
+    S1AP_PDU_PR_##direction, S1ap_ProcedureCode_id_##procedure, message_id,    \
+      offsetof(type, presenceMask), ies, sizeof(ies) / sizeof(ies[0])          \
+  }
+
+static const s1ap_lazy_procedure_t lazy_procedures[] = {
+  LAZY_PROCEDURE(
+    initiatingMessage,
+    uplinkNASTransport,
+    S1AP_UPLINK_NAS_LOG,
+    S1ap_UplinkNASTransportIEs_t,
+    uplink_nas_transport_ies),
+  LAZY_PROCEDURE(
+    initiatingMessage,
+    UEContextReleaseRequest,
+    S1AP_UE_CONTEXT_RELEASE_REQ_LOG,
+    S1ap_UEContextReleaseRequestIEs_t,
+    ue_context_release_request_ies),
+  LAZY_PROCEDURE(
+    successfulOutcome,
+    UEContextRelease,
+    S1AP_UE_CONTEXT_RELEASE_LOG,
+    S1ap_UEContextReleaseCompleteIEs_t,
+    ue_context_release_complete_ies),
+  LAZY_PROCEDURE(
+    successfulOutcome,
+    InitialContextSetup,
+    S1AP_INITIAL_CONTEXT_SETUP_LOG,
+    S1ap_InitialContextSetupResponseIEs_t,
+    initial_context_setup_response_ies),
+};
+
+#define S1AP_MAX_DEFERRED_IES 4
+
+typedef struct s1ap_deferred_ie_s {
+  const s1ap_lazy_ie_t *ie;
+  const uint8_t *value;
+  uint32_t length;
+} s1ap_deferred_ie_t;
+
+// IEs of the last decoded message that are not decoded yet
+static __thread struct {
+  const s1ap_message *message;
+  bstring *raw; // the received buffer the IEs point into
+  int nb_ies;
+  s1ap_deferred_ie_t ies[S1AP_MAX_DEFERRED_IES];
+} deferred;
+
+typedef struct s1ap_aper_reader_s {
+  const uint8_t *buffer;
+  uint32_t size; // in octets
+  uint32_t bit;  // offset of the next bit to read
+  bool failed;
+} s1ap_aper_reader_t;
+
+//------------------------------------------------------------------------------
+static uint64_t s1ap_aper_get_bits(s1ap_aper_reader_t *aper, int nb_bits)
+{
+  uint64_t value = 0;
+
+  if (aper->bit + nb_bits > aper->size * 8) {
+    aper->failed = true;
+    return 0;
+  }
+  for (int i = 0; i < nb_bits; i++) {
+    value = (value << 1) |
+            ((aper->buffer[aper->bit / 8] >> (7 - aper->bit % 8)) & 1);
+    aper->bit++;
+  }
+  return value;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_align(s1ap_aper_reader_t *aper)
+{
+  // asn1c rejects non zero padding bits
+  if (aper->bit % 8 && s1ap_aper_get_bits(aper, 8 - aper->bit % 8)) {
+    aper->failed = true;
+  }
+}
+
+//------------------------------------------------------------------------------
+static uint32_t s1ap_aper_get_length(s1ap_aper_reader_t *aper)
+{
+  s1ap_aper_align(aper);
+  uint32_t length = s1ap_aper_get_bits(aper, 8);
+  if (length & 0x80) {
+    if (length & 0x40) {
+      // fragmented, left to asn1c
+      aper->failed = true;
+      return 0;
+    }
+    length = ((length & 0x3F) << 8) | s1ap_aper_get_bits(aper, 8);
+  }
+  return length;
+}
+
+//------------------------------------------------------------------------------
+// Read an open type, leaving the reader after its contents
+static const uint8_t *s1ap_aper_get_open_type(
+  s1ap_aper_reader_t *aper,
+  uint32_t *length)
+{
+  *length = s1ap_aper_get_length(aper);
+  if (aper->failed || aper->bit / 8 + *length > aper->size) {
+    aper->failed = true;
+    return NULL;
+  }
+  const uint8_t *value = &aper->buffer[aper->bit / 8];
+  aper->bit += 8 * *length;
+  return value;
+}
+
+//------------------------------------------------------------------------------
+static uint64_t s1ap_aper_get_large_integer(
+  const uint8_t *value,
+  uint32_t length,
+  int length_bits,
+  bool *failed)
+{
+  s1ap_aper_reader_t aper = {value, length, 0, false};
+  int nb_octets = s1ap_aper_get_bits(&aper, length_bits) + 1;
+  s1ap_aper_align(&aper);
+  uint64_t integer = s1ap_aper_get_bits(&aper, 8 * nb_octets);
+  *failed = *failed || aper.failed;
+  return integer;
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_mme_decode_lazy_ie(
   s1ap_message *message,
-  const_bstring const raw,
+  const s1ap_lazy_ie_t *ie,
+  const uint8_t *value,
+  uint32_t length)
+{
+  void *decoded = NULL;
+  void *field = (uint8_t *) &message->msg + ie->offset;
+
+  asn_dec_rval_t dec_ret =
+    aper_decode(NULL, ie->td, &decoded, value, length, 0, 0);
+  if (dec_ret.code != RC_OK || !decoded) {
+    OAILOG_ERROR(LOG_S1AP, "Decoding of IE %d failed\n", (int) ie->id);
+    return RETURNerror;
+  }
+  if (ie->convert) {
+    if (ie->convert(field, decoded) < 0) {
+      OAILOG_ERROR(
+        LOG_S1AP, "Decoding of encapsulated IE %d failed\n", (int) ie->id);
+    }
+  } else {
+    memcpy(field, decoded, ie->size);
+  }
+  // the IE is in the arena with the rest of the message
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_mme_decode_lazy(
+  s1ap_message *message,
+  bstring *const raw,
+  MessagesIds *message_id)
+{
+  s1ap_aper_reader_t aper = {bdata(*raw), blength(*raw), 0, false};
+  const s1ap_lazy_procedure_t *procedure = NULL;
+  uint32_t seen = 0;
+  uint32_t length = 0;
+  bool failed = false;
+
+  deferred.message = NULL;
+  deferred.nb_ies = 0;
+  // S1AP-PDU extension bit and choice, procedure code and criticality
+  if (s1ap_aper_get_bits(&aper, 1)) {
+    return RETURNerror;
+  }
+  uint8_t direction = s1ap_aper_get_bits(&aper, 2) + 1;
+  s1ap_aper_align(&aper);
+  S1ap_ProcedureCode_t procedure_code = s1ap_aper_get_bits(&aper, 8);
+  S1ap_Criticality_t criticality = s1ap_aper_get_bits(&aper, 2);
+  for (int i = 0; i < sizeof(lazy_procedures) / sizeof(lazy_procedures[0]);
+       i++) {
+    if (
+      lazy_procedures[i].direction == direction &&
+      lazy_procedures[i].procedure_code == procedure_code) {
+      procedure = &lazy_procedures[i];
+    }
+  }
+  if (!procedure || criticality > S1ap_Criticality_notify || aper.failed) {
+    return RETURNerror;
+  }
+
+  // message: extension bit and number of protocol IEs
+  const uint8_t *value = s1ap_aper_get_open_type(&aper, &length);
+  if (aper.failed) {
+    return RETURNerror;
+  }
+  aper = (s1ap_aper_reader_t){value, length, 0, false};
+  if (s1ap_aper_get_bits(&aper, 1)) {
+    return RETURNerror;
+  }
+  s1ap_aper_align(&aper);
+  uint32_t nb_ies = s1ap_aper_get_bits(&aper, 16);
+
+  memset(&message->msg, 0, sizeof(message->msg));
+  uint16_t *presence_mask =
+    (uint16_t *) ((uint8_t *) &message->msg + procedure->presence_offset);
+  for (uint32_t i = 0; i < nb_ies && !aper.failed; i++) {
+    const s1ap_lazy_ie_t *ie = NULL;
+    int index = 0;
+
+    s1ap_aper_align(&aper);
+    S1ap_ProtocolIE_ID_t id = s1ap_aper_get_bits(&aper, 16);
+    if (s1ap_aper_get_bits(&aper, 2) > S1ap_Criticality_notify) {
+      return RETURNerror;
+    }
+    value = s1ap_aper_get_open_type(&aper, &length);
+    for (index = 0; index < procedure->nb_ies; index++) {
+      if (procedure->ies[index].id == id) {
+        ie = &procedure->ies[index];
+        break;
+      }
+    }
+    if (aper.failed || !ie || (seen & (1 << index))) {
+      // unknown or repeated IE
+      return RETURNerror;
+    }
+    seen |= 1 << index;
+    *presence_mask |= ie->present;
+
+    void *field = (uint8_t *) &message->msg + ie->offset;
+    switch (ie->kind) {
+      case LAZY_IE_MME_UE_S1AP_ID:
+        *(S1ap_MME_UE_S1AP_ID_t *) field =
+          s1ap_aper_get_large_integer(value, length, 2, &failed);
+        break;
+      case LAZY_IE_ENB_UE_S1AP_ID:
+        *(S1ap_ENB_UE_S1AP_ID_t *) field =
+          s1ap_aper_get_large_integer(value, length, 2, &failed);
+        break;
+      case LAZY_IE_OCTET_STRING: {
+        s1ap_aper_reader_t octets = {value, length, 0, false};
+        OCTET_STRING_t *string = field;
+        uint32_t size = 0;
+        string->buf = (uint8_t *) s1ap_aper_get_open_type(&octets, &size);
+        string->size = size;
+        failed = failed || octets.failed;
+      } break;
+      case LAZY_IE_ASN:
+        failed = failed ||
+                 s1ap_mme_decode_lazy_ie(message, ie, value, length) !=
+                   RETURNok;
+        break;
+      case LAZY_IE_ASN_DEFERRED:
+        if (deferred.nb_ies == S1AP_MAX_DEFERRED_IES) {
+          return RETURNerror;
+        }
+        deferred.ies[deferred.nb_ies++] =
+          (s1ap_deferred_ie_t){.ie = ie, .value = value, .length = length};
+        break;
+    }
+    if (failed) {
+      return RETURNerror;
+    }
+  }
+  for (int index = 0; index < procedure->nb_ies; index++) {
+    if (!procedure->ies[index].present && !(seen & (1 << index))) {
+      // missing mandatory IE
+      return RETURNerror;
+    }
+  }
+  if (aper.failed) {
+    return RETURNerror;
+  }
+
+  message->direction = direction;
+  message->procedureCode = procedure_code;
+  message->criticality = criticality;
+  *message_id = procedure->message_id;
+  deferred.message = message;
+  deferred.raw = raw;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_decode_deferred_ie(s1ap_message *message, S1ap_ProtocolIE_ID_t id)
+{
+  if (deferred.message != message) {
+    // the message was fully decoded
+    return RETURNok;
+  }
+  for (int i = 0; i < deferred.nb_ies; i++) {
+    if (deferred.ies[i].ie && deferred.ies[i].ie->id == id) {
+      const s1ap_lazy_ie_t *ie = deferred.ies[i].ie;
+      if (!*deferred.raw) {
+        // the received buffer was taken with the NAS-PDU
+        return RETURNerror;
+      }
+      deferred.ies[i].ie = NULL;
+      s1ap_arena_enter();
+      int rc = s1ap_mme_decode_lazy_ie(
+        message, ie, deferred.ies[i].value, deferred.ies[i].length);
+      s1ap_arena_leave();
+      return rc;
+    }
+  }
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+bstring s1ap_mme_take_nas_pdu(
+  s1ap_message *message,
+  const OCTET_STRING_t *const nas_pdu)
+{
+  if (deferred.message == message && *deferred.raw) {
+    bstring raw = *deferred.raw;
+    if (
+      nas_pdu->buf >= raw->data &&
+      nas_pdu->buf + nas_pdu->size <= raw->data + raw->slen) {
+      /*
+       * The NAS-PDU points into the received buffer: move it to the start
+       * of the buffer and hand the buffer over, instead of allocating a new
+       * one for it
+       */
+      memmove(raw->data, nas_pdu->buf, nas_pdu->size);
+      raw->slen = nas_pdu->size;
+      raw->data[raw->slen] = '\0';
+      *deferred.raw = NULL;
+      return raw;
+    }
+  }
+  return blk2bstr(nas_pdu->buf, nas_pdu->size);
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_mme_decode_full(
+  s1ap_message *message,
+  const_bstring raw,
   MessagesIds *message_id)
 {
   int ret = -1;
@@ -234,10 +747,15 @@ int s1ap_mme_decode_pdu(
   S1AP_PDU_t pdu = {(S1AP_PDU_PR_NOTHING)};
   S1AP_PDU_t *pdu_p = &pdu;
   asn_dec_rval_t dec_ret = {(RC_OK)};
-  DevAssert(raw != NULL);
   memset((void *) pdu_p, 0, sizeof(S1AP_PDU_t));
   dec_ret = aper_decode(
-    NULL, &asn_DEF_S1AP_PDU, (void **) &pdu_p, bdata(raw), blength(raw), 0, 0);
+    NULL,
+    &asn_DEF_S1AP_PDU,
+    (void **) &pdu_p,
+    bdata(raw),
+    blength(raw),
+    0,
+    0);
 
   if (dec_ret.code != RC_OK) {
     OAILOG_ERROR(LOG_S1AP, "Failed to decode PDU\n");
@@ -269,51 +787,40 @@ int s1ap_mme_decode_pdu(
         (int) pdu_p->present);
       break;
   }
-  ASN_STRUCT_FREE_CONTENTS_ONLY(asn_DEF_S1AP_PDU, pdu_p);
+  return ret;
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_decode_pdu(
+  s1ap_message *message,
+  bstring *const raw,
+  MessagesIds *message_id)
+{
+  int ret = -1;
+
+  DevAssert(raw != NULL && *raw != NULL);
+  /*
+   * Everything the runtime allocates for the PDU and its IEs comes from the
+   * arena, and is released at once by the next decode or by
+   * s1ap_free_mme_decode_pdu
+   */
+  s1ap_arena_reset();
+  s1ap_arena_enter();
+  if (s1ap_mme_decode_lazy(message, raw, message_id) == RETURNok) {
+    s1ap_arena_leave();
+    return RETURNok;
+  }
+  deferred.message = NULL;
+  ret = s1ap_mme_decode_full(message, *raw, message_id);
+  s1ap_arena_leave();
 
   return ret;
 }
 
 int s1ap_free_mme_decode_pdu(s1ap_message *message, MessagesIds message_id)
 {
-  switch (message_id) {
-    case S1AP_UPLINK_NAS_LOG:
-      return free_s1ap_uplinknastransport(
-        &message->msg.s1ap_UplinkNASTransportIEs);
-    case S1AP_S1_SETUP_LOG:
-      return free_s1ap_s1setuprequest(&message->msg.s1ap_S1SetupRequestIEs);
-    case S1AP_INITIAL_UE_MESSAGE_LOG:
-      return free_s1ap_initialuemessage(&message->msg.s1ap_InitialUEMessageIEs);
-    case S1AP_UE_CONTEXT_RELEASE_REQ_LOG:
-      return free_s1ap_uecontextreleaserequest(
-        &message->msg.s1ap_UEContextReleaseRequestIEs);
-    case S1AP_UE_CAPABILITY_IND_LOG:
-      return free_s1ap_uecapabilityinfoindication(
-        &message->msg.s1ap_UECapabilityInfoIndicationIEs);
-    case S1AP_NAS_NON_DELIVERY_IND_LOG:
-      return free_s1ap_nasnondeliveryindication_(
-        &message->msg.s1ap_NASNonDeliveryIndication_IEs);
-    case S1AP_UE_CONTEXT_RELEASE_LOG:
-      return free_s1ap_uecontextreleasecomplete(
-        &message->msg.s1ap_UEContextReleaseCompleteIEs);
-    case S1AP_INITIAL_CONTEXT_SETUP_LOG:
-      if (message->direction == S1AP_PDU_PR_successfulOutcome) {
-        return free_s1ap_initialcontextsetupresponse(
-          &message->msg.s1ap_InitialContextSetupResponseIEs);
-      } else {
-        return free_s1ap_initialcontextsetupfailure(
-          &message->msg.s1ap_InitialContextSetupFailureIEs);
-      }
-    case S1AP_UE_CONTEXT_MODIFICATION_LOG:
-      if (message->direction == S1AP_PDU_PR_successfulOutcome) {
-        return free_s1ap_uecontextmodificationresponse(
-          &message->msg.s1ap_UEContextModificationResponseIEs);
-      } else {
-        return free_s1ap_uecontextmodificationfailure(
-          &message->msg.s1ap_UEContextModificationFailureIEs);
-      }
-    case S1AP_ENB_RESET_LOG:
-      return free_s1ap_reset(&message->msg.s1ap_ResetIEs);
-    default: DevAssert(false);
-  }
+  // The decoded IEs are in the arena, there is no need to walk them
+  deferred.message = NULL;
+  s1ap_arena_reset();
+  return RETURNok;
 }
@@ -25,10 +25,41 @@
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
 
+/*
+ * Decode a received S1AP PDU
+ * @param message - the decoded message
+ * @param raw - the received PDU. Handlers may take it over with
+ *              s1ap_mme_take_nas_pdu, which sets it to NULL
+ * @param messages_id - id of the decoded message
+ * @return RETURNok, or -1 if the PDU could not be decoded
+ */
 int s1ap_mme_decode_pdu(
   s1ap_message *message,
-  const_bstring const raw,
+  bstring *const raw,
   MessagesIds *messages_id) __attribute__((warn_unused_result));
 int s1ap_free_mme_decode_pdu(s1ap_message *message, MessagesIds messages_id);
 
+/*
+ * Decode an IE of the last decoded message that was left undecoded by the
+ * fast path for UE associated messages. Does nothing if the IE is already
+ * decoded.
+ * @param message - the decoded message
+ * @param id - protocol IE id of the IE
+ * @return RETURNok, or RETURNerror if the IE could not be decoded
+ */
+int s1ap_mme_decode_deferred_ie(s1ap_message *message, S1ap_ProtocolIE_ID_t id);
+
+/*
+ * Take the NAS-PDU of the last decoded message as a bstring. When the NAS-PDU
+ * still points into the received PDU, the received buffer is handed over
+ * with the NAS-PDU moved to its start rather than copied to a new buffer.
+ * Deferred IEs can not be decoded afterwards, and nas_pdu must not be used.
+ * @param message - the decoded message
+ * @param nas_pdu - the NAS-PDU IE of the message
+ * @return the NAS-PDU, owned by the caller
+ */
+bstring s1ap_mme_take_nas_pdu(
+  s1ap_message *message,
+  const OCTET_STRING_t *const nas_pdu);
+
 #endif /* FILE_S1AP_MME_DECODER_SEEN */
@@ -41,6 +41,7 @@
 #include "assertions.h"
 #include "conversions.h"
 #include "intertask_interface.h"
+#include "itti_trace.h"
 #include "timer.h"
 #include "dynamic_memory_check.h"
 #include "mme_config.h"
@@ -48,6 +49,7 @@
 #include "s1ap_ies_defs.h"
 #include "s1ap_mme_encoder.h"
 #include "s1ap_mme_nas_procedures.h"
+#include "s1ap_mme_paging.h"
 #include "s1ap_mme_itti_messaging.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_ta.h"
@@ -420,9 +422,7 @@ int s1ap_mme_handle_s1_setup_request(
 
   OAILOG_MESSAGE_FINISH((void *) context);
 
-  mme_config_read_lock(&mme_config);
   max_enb_connected = mme_config.max_enbs;
-  mme_config_unlock(&mme_config);
 
   if (nb_enb_associated == max_enb_connected) {
     OAILOG_ERROR(
@@ -499,7 +499,7 @@ int s1ap_mme_handle_s1_setup_request(
 //------------------------------------------------------------------------------
 static int s1ap_generate_s1_setup_response(enb_description_t *enb_association)
 {
-  int i, j;
+  int i;
   int enc_rval = 0;
   S1ap_S1SetupResponseIEs_t *s1_setup_response_p = NULL;
   S1ap_ServedGUMMEIsItem_t *servedGUMMEI = NULL;
@@ -514,37 +514,16 @@ static int s1ap_generate_s1_setup_response(enb_description_t *enb_association)
   servedGUMMEI = calloc(1, sizeof *servedGUMMEI);
   // Generating response
   s1_setup_response_p = &message.msg.s1ap_S1SetupResponseIEs;
-  mme_config_read_lock(&mme_config);
   s1_setup_response_p->relativeMMECapacity = mme_config.relative_capacity;
 
   /*
-   * Use the gummei parameters provided by configuration
-   * that should be sorted
+   * Use the served PLMNs of the configuration, each listed once
    */
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    bool plmn_added = false;
-    for (j = 0; j < i; j++) {
-      if (
-        (mme_config.served_tai.plmn_mcc[j] ==
-         mme_config.served_tai.plmn_mcc[i]) &&
-        (mme_config.served_tai.plmn_mnc[j] ==
-         mme_config.served_tai.plmn_mnc[i]) &&
-        (mme_config.served_tai.plmn_mnc_len[j] ==
-         mme_config.served_tai.plmn_mnc_len[i])) {
-        plmn_added = true;
-        break;
-      }
-    }
-    if (false == plmn_added) {
-      S1ap_PLMNidentity_t *plmn = NULL;
-      plmn = calloc(1, sizeof(*plmn));
-      MCC_MNC_TO_PLMNID(
-        mme_config.served_tai.plmn_mcc[i],
-        mme_config.served_tai.plmn_mnc[i],
-        mme_config.served_tai.plmn_mnc_len[i],
-        plmn);
-      ASN_SEQUENCE_ADD(&servedGUMMEI->servedPLMNs.list, plmn);
-    }
+  for (i = 0; i < mme_config.served_tai.nb_plmn_keys; i++) {
+    S1ap_PLMNidentity_t *plmn = NULL;
+    plmn = calloc(1, sizeof(*plmn));
+    PLMN_KEY_TO_PLMNID(mme_config.served_tai.plmn_keys[i], plmn);
+    ASN_SEQUENCE_ADD(&servedGUMMEI->servedPLMNs.list, plmn);
   }
 
   for (i = 0; i < mme_config.gummei.nb; i++) {
@@ -560,7 +539,6 @@ static int s1ap_generate_s1_setup_response(enb_description_t *enb_association)
     ASN_SEQUENCE_ADD(&servedGUMMEI->servedMMECs.list, mmec);
   }
 
-  mme_config_unlock(&mme_config);
   /*
    * The MME is only serving E-UTRAN RAT, so the list contains only one element
    */
@@ -635,6 +613,7 @@ int s1ap_mme_handle_ue_cap_indication(
       (uint32_t) ue_cap_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
+  itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
 
   if (ue_ref_p->enb_ue_s1ap_id != ue_cap_p->eNB_UE_S1AP_ID) {
     OAILOG_DEBUG(
@@ -741,6 +720,7 @@ int s1ap_mme_handle_initial_context_setup_response(
       (uint32_t) initialContextSetupResponseIEs_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
+  itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
 
   if (
     ue_ref_p->enb_ue_s1ap_id !=
@@ -934,6 +914,7 @@ int s1ap_mme_handle_ue_context_release_request(
       ueContextReleaseRequest_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     if (
       ue_ref_p->enb_ue_s1ap_id ==
       (ueContextReleaseRequest_p->eNB_UE_S1AP_ID & ENB_UE_S1AP_ID_MASK)) {
@@ -1243,6 +1224,7 @@ int s1ap_handle_ue_context_release_command(
       ue_context_release_command_pP->mme_ue_s1ap_id);
     rc = RETURNok;
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     /*
      * Check the cause. If it is implicit detach or sctp reset/shutdown no need to send UE context release command to
      * eNB. Free UE context locally.
@@ -1289,6 +1271,7 @@ int s1ap_handle_ue_context_mod_req(
       ue_context_mod_req_pP->mme_ue_s1ap_id);
     rc = RETURNok;
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     rc = s1ap_mme_generate_ue_context_modification(
       ue_ref_p, ue_context_mod_req_pP);
   }
@@ -1339,6 +1322,7 @@ int s1ap_mme_handle_ue_context_release_complete(
       ueContextReleaseComplete_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
   }
+  itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
 
   /*
    * eNB has sent a release complete message. We can safely remove UE context.
@@ -1457,6 +1441,7 @@ int s1ap_mme_handle_initial_context_setup_failure(
       (uint32_t) initialContextSetupFailureIEs_p->eNB_UE_S1AP_ID);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
+  itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
 
   if (
     ue_ref_p->enb_ue_s1ap_id !=
@@ -1590,6 +1575,7 @@ int s1ap_mme_handle_ue_context_modification_response(
       ueContextModification_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     if (
       ue_ref_p->enb_ue_s1ap_id ==
       (ueContextModification_p->eNB_UE_S1AP_ID & ENB_UE_S1AP_ID_MASK)) {
@@ -1689,6 +1675,7 @@ int s1ap_mme_handle_ue_context_modification_failure(
       ueContextModification_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     if (
       ue_ref_p->enb_ue_s1ap_id ==
       (ueContextModification_p->eNB_UE_S1AP_ID & ENB_UE_S1AP_ID_MASK)) {
@@ -1827,6 +1814,7 @@ int s1ap_mme_handle_path_switch_request(
      * * * * TODO
      */
   } else {
+    itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
     if (ue_ref_p->enb_ue_s1ap_id != enb_ue_s1ap_id) {
       /*
        * Received unique UE eNB ID mismatch with the one known in MME.
@@ -2236,6 +2224,7 @@ int s1ap_mme_handle_erab_setup_response(
       (mme_ue_s1ap_id_t) s1ap_E_RABSetupResponseIEs_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
+  itti_trace_set_ue(ue_ref_p->enb_ue_s1ap_id, ue_ref_p->mme_ue_s1ap_id);
 
   if (
     ue_ref_p->enb_ue_s1ap_id != s1ap_E_RABSetupResponseIEs_p->eNB_UE_S1AP_ID) {
@@ -2631,79 +2620,16 @@ int s1ap_handle_paging_request(const itti_s1ap_paging_request_t *paging_request)
 {
   OAILOG_FUNC_IN(LOG_S1AP);
   DevAssert(paging_request != NULL);
-  // ue_description_t* ue_ref_p = NULL;
-  S1ap_PagingIEs_t *paging_message = NULL;
-  s1ap_message message = {0};
-  imsi64_t imsi64;
-
-  IMSI_STRING_TO_IMSI64((char *) paging_request->imsi, &imsi64);
-  paging_message = &message.msg.s1ap_PagingIEs;
-
-  paging_message->presenceMask = 0;   // no optional fields
-  paging_message->pagingDRX = 0;      // unused
-  paging_message->pagingPriority = 0; // unused
-
-  UE_ID_INDEX_TO_BIT_STRING(
-    (uint16_t)(imsi64 % 1024), &paging_message->ueIdentityIndexValue);
-  if (paging_request->domain_indicator == CN_DOMAIN_PS) {
-    paging_message->cnDomain = S1ap_CNDomain_ps;
-  } else if (paging_request->domain_indicator == CN_DOMAIN_CS) {
-    paging_message->cnDomain = S1ap_CNDomain_cs;
-  }
-
-  // Set UE Paging Identity
-  if (paging_request->paging_id == S1AP_PAGING_ID_STMSI) {
-    paging_message->uePagingID.present = S1ap_UEPagingID_PR_s_TMSI;
-    MME_CODE_TO_OCTET_STRING(
-      paging_request->mme_code, &paging_message->uePagingID.choice.s_TMSI.mMEC);
-    M_TMSI_TO_OCTET_STRING(
-      paging_request->m_tmsi, &paging_message->uePagingID.choice.s_TMSI.m_TMSI);
-    paging_message->uePagingID.choice.s_TMSI.iE_Extensions = NULL;
-  } else if (paging_request->paging_id == S1AP_PAGING_ID_IMSI) {
-    paging_message->uePagingID.present = S1ap_UEPagingID_PR_iMSI;
-    IMSI_TO_OCTET_STRING(
-      paging_request->imsi,
-      paging_request->imsi_length,
-      &paging_message->uePagingID.choice.iMSI);
-  }
-  // Set TAI list
-  mme_config_read_lock(&mme_config);
-
-  for (int i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    S1ap_TAIItem_t *tai_item = calloc(1, sizeof(S1ap_TAIItem_t));
-    MCC_MNC_TO_PLMNID(
-      mme_config.served_tai.plmn_mcc[i],
-      mme_config.served_tai.plmn_mnc[i],
-      mme_config.served_tai.plmn_mnc_len[i],
-      &tai_item->tAI.pLMNidentity);
-    TAC_TO_ASN1(mme_config.served_tai.tac[i], &tai_item->tAI.tAC);
-    tai_item->iE_Extensions = NULL;
-    tai_item->tAI.iE_Extensions = NULL;
-    ASN_SEQUENCE_ADD(&paging_message->taiList, tai_item);
-  }
-
-  mme_config_unlock(&mme_config);
-
-  uint8_t *buffer = NULL;
-  uint32_t length = 0;
+  bstring b = NULL;
 
-  message.procedureCode = S1ap_ProcedureCode_id_Paging;
-  message.direction = S1AP_PDU_PR_initiatingMessage;
-
-  // Encode message
-  int enc_rval = s1ap_mme_encode_pdu(&message, &buffer, &length);
-  if (enc_rval < 0) {
+  if (s1ap_mme_generate_paging(paging_request, &b) != RETURNok) {
     OAILOG_ERROR(
       LOG_S1AP,
       "Failed to encode paging message for IMSI %s\n",
       paging_request->imsi);
-    free_s1ap_paging(paging_message);
-    return RETURNerror;
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
-  bstring b = blk2bstr(buffer, length);
-  free(buffer);
-
   // Send message
   int rc = s1ap_mme_itti_send_sctp_request(
     &b,
@@ -2723,6 +2649,5 @@ int s1ap_handle_paging_request(const itti_s1ap_paging_request_t *paging_request)
       "Sent paging message over sctp for IMSI %s\n",
       paging_request->imsi);
   }
-  free_s1ap_paging(paging_message);
   OAILOG_FUNC_RETURN(LOG_S1AP, rc);
 }
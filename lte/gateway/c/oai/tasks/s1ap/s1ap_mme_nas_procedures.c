@@ -39,14 +39,17 @@
 #include "msc.h"
 #include "conversions.h"
 #include "intertask_interface.h"
+#include "itti_trace.h"
 #include "asn1_conversions.h"
 #include "s1ap_common.h"
 #include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
 #include "s1ap_mme_encoder.h"
 #include "s1ap_mme.h"
 #include "s1ap_mme_handlers.h"
 #include "s1ap_mme_nas_procedures.h"
 #include "s1ap_mme_retransmission.h"
+#include "s1ap_mme_templates.h"
 #include "s1ap_mme_itti_messaging.h"
 
 #include "s1ap_mme.h"
@@ -117,6 +120,19 @@ int s1ap_mme_handle_initial_ue_message(
     ecgi_t ecgi = {.plmn = {0}, .cell_identity = {0}};
     csg_id_t csg_id = 0;
 
+    if (itti_memory_pressure()) {
+      // Shed new UEs while messages are close to exhausting the ITTI pools,
+      // the UE retries once the eNB gives up on this attempt
+      OAILOG_WARNING(
+        LOG_S1AP,
+        "S1AP:Initial UE Message- Dropped under ITTI memory pressure, "
+        "eNBUeS1APId:" ENB_UE_S1AP_ID_FMT "\n",
+        enb_ue_s1ap_id);
+      increment_counter(
+        "initial_ue_message_dropped", 1, 1, "cause", "memory_pressure");
+      OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+    }
+
     /*
      * This UE eNB Id has currently no known s1 association.
      * * * * Create new UE context by associating new mme_ue_s1ap_id.
@@ -132,6 +148,7 @@ int s1ap_mme_handle_initial_ue_message(
         enb_ue_s1ap_id);
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
+    itti_trace_set_ue(enb_ue_s1ap_id, INVALID_MME_UE_S1AP_ID);
 
     ue_ref->s1_ue_state = S1AP_UE_WAITING_CSR;
 
@@ -295,6 +312,7 @@ int s1ap_mme_handle_uplink_nas_transport(
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
   }
+  itti_trace_set_ue(ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
 
   if (S1AP_UE_CONNECTED != ue_ref->s1_ue_state) {
     OAILOG_WARNING(
@@ -316,6 +334,18 @@ int s1ap_mme_handle_uplink_nas_transport(
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
 
+  // TAI and CGI are only decoded once the UE is known
+  if (
+    s1ap_mme_decode_deferred_ie(message, S1ap_ProtocolIE_ID_id_TAI) !=
+      RETURNok ||
+    s1ap_mme_decode_deferred_ie(message, S1ap_ProtocolIE_ID_id_EUTRAN_CGI) !=
+      RETURNok) {
+    OAILOG_WARNING(
+      LOG_S1AP,
+      "Received S1AP UPLINK_NAS_TRANSPORT with undecodable TAI or CGI\n");
+    OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
+  }
+
   // TAI mandatory IE
   OCTET_STRING_TO_TAC(&uplinkNASTransport_p->tai.tAC, tai.tac);
   DevAssert(uplinkNASTransport_p->tai.pLMNidentity.size == 3);
@@ -341,8 +371,7 @@ int s1ap_mme_handle_uplink_nas_transport(
     (enb_ue_s1ap_id_t) uplinkNASTransport_p->eNB_UE_S1AP_ID,
     uplinkNASTransport_p->nas_pdu.size);
 
-  bstring b = blk2bstr(
-    uplinkNASTransport_p->nas_pdu.buf, uplinkNASTransport_p->nas_pdu.size);
+  bstring b = s1ap_mme_take_nas_pdu(message, &uplinkNASTransport_p->nas_pdu);
   s1ap_mme_itti_nas_uplink_ind(
     uplinkNASTransport_p->mme_ue_s1ap_id, &b, &tai, &ecgi);
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
@@ -402,6 +431,7 @@ int s1ap_mme_handle_nas_non_delivery(
       (mme_ue_s1ap_id_t) nasNonDeliveryIndication_p->mme_ue_s1ap_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   }
+  itti_trace_set_ue(ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
 
   if (ue_ref->s1_ue_state != S1AP_UE_CONNECTED) {
     OAILOG_DEBUG(
@@ -426,8 +456,6 @@ int s1ap_generate_downlink_nas_transport(
   STOLEN_REF bstring *payload)
 {
   ue_description_t *ue_ref = NULL;
-  uint8_t *buffer_p = NULL;
-  uint32_t length = 0;
   void *id = NULL;
 
   OAILOG_FUNC_IN(LOG_S1AP);
@@ -464,33 +492,18 @@ int s1ap_generate_downlink_nas_transport(
       ue_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
+    itti_trace_set_ue(ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
     /*
      * We have fount the UE in the list.
-     * * * * Create new IE list message and encode it.
+     * * * * Encode the message with the UE informations found in ue_ref
      */
-    S1ap_DownlinkNASTransportIEs_t *downlinkNasTransport = NULL;
-    s1ap_message message = {0};
+    bstring b = NULL;
 
-    message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
-    message.direction = S1AP_PDU_PR_initiatingMessage;
     ue_ref->s1_ue_state = S1AP_UE_CONNECTED;
-    downlinkNasTransport = &message.msg.s1ap_DownlinkNASTransportIEs;
-    /*
-     * Setting UE informations with the ones fount in ue_ref
-     */
-    downlinkNasTransport->mme_ue_s1ap_id = ue_ref->mme_ue_s1ap_id;
-    downlinkNasTransport->eNB_UE_S1AP_ID = ue_ref->enb_ue_s1ap_id;
-    /*eNB
-     * Fill in the NAS pdu
-     */
-    OCTET_STRING_fromBuf(
-      &downlinkNasTransport->nas_pdu,
-      (char *) bdata(*payload),
-      blength(*payload));
+    int rc = s1ap_mme_generate_downlink_nas_transport_pdu(
+      ue_ref->mme_ue_s1ap_id, ue_ref->enb_ue_s1ap_id, *payload, &b);
     bdestroy_wrapper(payload);
-
-    if (s1ap_mme_encode_pdu(&message, &buffer_p, &length) < 0) {
-      free_s1ap_downlinknastransport(downlinkNasTransport);
+    if (rc != RETURNok) {
       OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
     }
 
@@ -500,8 +513,8 @@ int s1ap_generate_downlink_nas_transport(
       " MME_UE_S1AP_ID = " MME_UE_S1AP_ID_FMT
       " eNB_UE_S1AP_ID = " ENB_UE_S1AP_ID_FMT "\n",
       ue_id,
-      (mme_ue_s1ap_id_t) downlinkNasTransport->mme_ue_s1ap_id,
-      (enb_ue_s1ap_id_t) downlinkNasTransport->eNB_UE_S1AP_ID);
+      ue_ref->mme_ue_s1ap_id,
+      ue_ref->enb_ue_s1ap_id);
     MSC_LOG_TX_MESSAGE(
       MSC_S1AP_MME,
       MSC_S1AP_ENB,
@@ -511,17 +524,14 @@ int s1ap_generate_downlink_nas_transport(
       " mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT " enb_ue_s1ap_id" ENB_UE_S1AP_ID_FMT
       " nas length %u",
       ue_id,
-      (mme_ue_s1ap_id_t) downlinkNasTransport->mme_ue_s1ap_id,
-      (enb_ue_s1ap_id_t) downlinkNasTransport->eNB_UE_S1AP_ID,
-      length);
-    bstring b = blk2bstr(buffer_p, length);
-    free(buffer_p);
+      ue_ref->mme_ue_s1ap_id,
+      ue_ref->enb_ue_s1ap_id,
+      blength(b));
     s1ap_mme_itti_send_sctp_request(
       &b,
       ue_ref->enb->sctp_assoc_id,
       ue_ref->sctp_stream_send,
       ue_ref->mme_ue_s1ap_id);
-    free_s1ap_downlinknastransport(downlinkNasTransport);
   }
 
   OAILOG_FUNC_RETURN(LOG_S1AP, RETURNok);
@@ -565,6 +575,7 @@ int s1ap_generate_s1ap_e_rab_setup_req(
       ue_id);
     OAILOG_FUNC_RETURN(LOG_S1AP, RETURNerror);
   } else {
+    itti_trace_set_ue(ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
     /*
      * We have found the UE in the list.
      * Create new IE list message and encode it.
@@ -748,14 +759,9 @@ void s1ap_handle_conn_est_cnf(
    * At least one bearer has been established. We can now send s1ap initial context setup request
    * message to eNB.
    */
-  uint8_t *buffer_p = NULL;
-  uint32_t length = 0;
   ue_description_t *ue_ref = NULL;
-  S1ap_InitialContextSetupRequestIEs_t *initialContextSetupRequest_p = NULL;
-  S1ap_E_RABToBeSetupItemCtxtSUReq_t
-    *e_RABToBeSetup[conn_est_cnf_pP->no_of_e_rabs];
-  S1ap_NAS_PDU_t *nas_pdu = NULL;
-  s1ap_message message = {0}; // yes, alloc on stack
+  uint32_t nas_length = 0;
+  bstring b = NULL;
 
   OAILOG_FUNC_IN(LOG_S1AP);
   DevAssert(conn_est_cnf_pP != NULL);
@@ -770,6 +776,7 @@ void s1ap_handle_conn_est_cnf(
     // There are some race conditions were NAS T3450 timer is stopped and removed at same time
     OAILOG_FUNC_OUT(LOG_S1AP);
   }
+  itti_trace_set_ue(ue_ref->enb_ue_s1ap_id, ue_ref->mme_ue_s1ap_id);
 
   /*
    * Start the outcome response timer.
@@ -783,123 +790,6 @@ void s1ap_handle_conn_est_cnf(
    * Insert the timer in the MAP of mme_ue_s1ap_id <-> timer_id
    */
   //     s1ap_timer_insert(ue_ref->mme_ue_s1ap_id, ue_ref->outcome_response_timer_id);
-  message.procedureCode = S1ap_ProcedureCode_id_InitialContextSetup;
-  message.direction = S1AP_PDU_PR_initiatingMessage;
-  initialContextSetupRequest_p =
-    &message.msg.s1ap_InitialContextSetupRequestIEs;
-  initialContextSetupRequest_p->mme_ue_s1ap_id =
-    (unsigned long) ue_ref->mme_ue_s1ap_id;
-  initialContextSetupRequest_p->eNB_UE_S1AP_ID =
-    (unsigned long) ue_ref->enb_ue_s1ap_id;
-
-  /*
-   * Only add capability information if it's not empty.
-   */
-  if (conn_est_cnf_pP->ue_radio_capability) {
-    OAILOG_DEBUG(LOG_S1AP, "UE radio capability found, adding to message\n");
-    initialContextSetupRequest_p->presenceMask |=
-      S1AP_INITIALCONTEXTSETUPREQUESTIES_UERADIOCAPABILITY_PRESENT;
-    OCTET_STRING_fromBuf(
-      &initialContextSetupRequest_p->ueRadioCapability,
-      (const char *) conn_est_cnf_pP->ue_radio_capability->data,
-      conn_est_cnf_pP->ue_radio_capability->slen);
-  }
-
-  /*
-   * uEaggregateMaximumBitrateDL and uEaggregateMaximumBitrateUL expressed in term of bits/sec
-   */
-  asn_uint642INTEGER(
-    &initialContextSetupRequest_p->uEaggregateMaximumBitrate
-       .uEaggregateMaximumBitRateDL,
-    conn_est_cnf_pP->ue_ambr.br_dl);
-  asn_uint642INTEGER(
-    &initialContextSetupRequest_p->uEaggregateMaximumBitrate
-       .uEaggregateMaximumBitRateUL,
-    conn_est_cnf_pP->ue_ambr.br_ul);
-
-  for (int item = 0; item < conn_est_cnf_pP->no_of_e_rabs; item++) {
-    // Free happens in free_s1ap_initialcontextsetuprequest
-    e_RABToBeSetup[item] = calloc(1, sizeof *e_RABToBeSetup[item]);
-    memset((void *) e_RABToBeSetup[item], 0, sizeof(*e_RABToBeSetup[item]));
-    e_RABToBeSetup[item]->e_RAB_ID = conn_est_cnf_pP->e_rab_id[item]; //5;
-    e_RABToBeSetup[item]->e_RABlevelQoSParameters.qCI =
-      conn_est_cnf_pP->e_rab_level_qos_qci[item];
-
-    if (conn_est_cnf_pP->nas_pdu[item] != NULL) {
-      // NAS PDU is optional in rab_setup
-      nas_pdu = calloc(1, sizeof *nas_pdu);
-      nas_pdu->size = blength(conn_est_cnf_pP->nas_pdu[item]);
-      nas_pdu->buf = malloc(blength(conn_est_cnf_pP->nas_pdu[item]));
-      memcpy(
-        nas_pdu->buf,
-        (void *) conn_est_cnf_pP->nas_pdu[item]->data,
-        blength(conn_est_cnf_pP->nas_pdu[item]));
-      e_RABToBeSetup[item]->nAS_PDU = nas_pdu;
-    }
-
-    e_RABToBeSetup[item]
-      ->e_RABlevelQoSParameters.allocationRetentionPriority.priorityLevel =
-      conn_est_cnf_pP->e_rab_level_qos_priority_level[item];
-    e_RABToBeSetup[item]
-      ->e_RABlevelQoSParameters.allocationRetentionPriority
-      .pre_emptionCapability =
-      conn_est_cnf_pP->e_rab_level_qos_preemption_capability[item];
-    e_RABToBeSetup[item]
-      ->e_RABlevelQoSParameters.allocationRetentionPriority
-      .pre_emptionVulnerability =
-      conn_est_cnf_pP->e_rab_level_qos_preemption_vulnerability[item];
-    /*
-     * Set the GTP-TEID. This is the S1-U S-GW TEID
-     */
-    INT32_TO_OCTET_STRING(
-      conn_est_cnf_pP->gtp_teid[item], &(e_RABToBeSetup[item]->gTP_TEID));
-    // S-GW IP address(es) for user-plane
-    e_RABToBeSetup[item]->transportLayerAddress.buf = calloc(
-      blength(conn_est_cnf_pP->transport_layer_address[item]), sizeof(uint8_t));
-    memcpy(
-      e_RABToBeSetup[item]->transportLayerAddress.buf,
-      conn_est_cnf_pP->transport_layer_address[item]->data,
-      blength(conn_est_cnf_pP->transport_layer_address[item]));
-    e_RABToBeSetup[item]->transportLayerAddress.size =
-      blength(conn_est_cnf_pP->transport_layer_address[item]);
-    e_RABToBeSetup[item]->transportLayerAddress.bits_unused = 0;
-    ASN_SEQUENCE_ADD(
-      &initialContextSetupRequest_p->e_RABToBeSetupListCtxtSUReq,
-      e_RABToBeSetup[item]);
-  }
-
-  if (
-    (conn_est_cnf_pP->presencemask & S1AP_CSFB_INDICATOR_PRESENT) ==
-    S1AP_CSFB_INDICATOR_PRESENT) {
-    initialContextSetupRequest_p->presenceMask |=
-      S1AP_INITIALCONTEXTSETUPREQUESTIES_CSFALLBACKINDICATOR_PRESENT;
-    initialContextSetupRequest_p->csFallbackIndicator =
-      conn_est_cnf_pP->cs_fallback_indicator;
-  }
-
-  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
-    .buf = calloc(2, sizeof(uint8_t));
-  memcpy(
-    initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
-      .buf,
-    (uint8_t *) &conn_est_cnf_pP
-      ->ue_security_capabilities_encryption_algorithms,
-    2);
-  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
-    .size = 2;
-  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
-    .bits_unused = 0;
-  initialContextSetupRequest_p->ueSecurityCapabilities
-    .integrityProtectionAlgorithms.buf = calloc(2, sizeof(uint8_t));
-  memcpy(
-    initialContextSetupRequest_p->ueSecurityCapabilities
-      .integrityProtectionAlgorithms.buf,
-    (uint8_t *) &conn_est_cnf_pP->ue_security_capabilities_integrity_algorithms,
-    2);
-  initialContextSetupRequest_p->ueSecurityCapabilities
-    .integrityProtectionAlgorithms.size = 2;
-  initialContextSetupRequest_p->ueSecurityCapabilities
-    .integrityProtectionAlgorithms.bits_unused = 0;
   OAILOG_DEBUG(
     LOG_S1AP,
     "security_capabilities_encryption_algorithms 0x%04X\n",
@@ -909,36 +799,29 @@ void s1ap_handle_conn_est_cnf(
     "security_capabilities_integrity_algorithms 0x%04X\n",
     conn_est_cnf_pP->ue_security_capabilities_integrity_algorithms);
 
-  if (conn_est_cnf_pP->kenb) {
-    initialContextSetupRequest_p->securityKey.buf =
-      calloc(AUTH_KENB_SIZE, sizeof(uint8_t));
-    memcpy(
-      initialContextSetupRequest_p->securityKey.buf,
-      conn_est_cnf_pP->kenb,
-      AUTH_KENB_SIZE);
-    initialContextSetupRequest_p->securityKey.size = AUTH_KENB_SIZE;
-  } else {
-    OAILOG_DEBUG(LOG_S1AP, "No kenb\n");
-    initialContextSetupRequest_p->securityKey.buf = NULL;
-    initialContextSetupRequest_p->securityKey.size = 0;
-  }
-
-  initialContextSetupRequest_p->securityKey.bits_unused = 0;
-
-  if (s1ap_mme_encode_pdu(&message, &buffer_p, &length) < 0) {
-    free_s1ap_initialcontextsetuprequest(initialContextSetupRequest_p);
+  if (
+    s1ap_mme_generate_initial_context_setup_pdu(
+      conn_est_cnf_pP,
+      ue_ref->mme_ue_s1ap_id,
+      ue_ref->enb_ue_s1ap_id,
+      &b) != RETURNok) {
     // TODO: handle something
     OAILOG_ERROR(
       LOG_S1AP, "Failed to encode initial context setup request message\n");
     OAILOG_FUNC_OUT(LOG_S1AP);
   }
+  for (int item = 0; item < conn_est_cnf_pP->no_of_e_rabs; item++) {
+    if (conn_est_cnf_pP->nas_pdu[item] != NULL) {
+      nas_length = blength(conn_est_cnf_pP->nas_pdu[item]);
+    }
+  }
 
   OAILOG_NOTICE(
     LOG_S1AP,
     "Send S1AP_INITIAL_CONTEXT_SETUP_REQUEST message MME_UE_S1AP_ID "
     "= " MME_UE_S1AP_ID_FMT " eNB_UE_S1AP_ID = " ENB_UE_S1AP_ID_FMT "\n",
-    (mme_ue_s1ap_id_t) initialContextSetupRequest_p->mme_ue_s1ap_id,
-    (enb_ue_s1ap_id_t) initialContextSetupRequest_p->eNB_UE_S1AP_ID);
+    ue_ref->mme_ue_s1ap_id,
+    ue_ref->enb_ue_s1ap_id);
   MSC_LOG_TX_MESSAGE(
     MSC_S1AP_MME,
     MSC_S1AP_ENB,
@@ -946,12 +829,9 @@ void s1ap_handle_conn_est_cnf(
     0,
     "0 InitialContextSetup/initiatingMessage mme_ue_s1ap_id " MME_UE_S1AP_ID_FMT
     " enb_ue_s1ap_id " ENB_UE_S1AP_ID_FMT " nas length %u",
-    (mme_ue_s1ap_id_t) initialContextSetupRequest_p->mme_ue_s1ap_id,
-    (enb_ue_s1ap_id_t) initialContextSetupRequest_p->eNB_UE_S1AP_ID,
-    nas_pdu == NULL ? 0 : nas_pdu->size);
-  bstring b = blk2bstr(buffer_p, length);
-  free(buffer_p);
-  free_s1ap_initialcontextsetuprequest(initialContextSetupRequest_p);
+    ue_ref->mme_ue_s1ap_id,
+    ue_ref->enb_ue_s1ap_id,
+    nas_length);
   s1ap_mme_itti_send_sctp_request(
     &b,
     ue_ref->enb->sctp_assoc_id,
@@ -0,0 +1,338 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_paging.c
+  \brief Paging message generation from pre-encoded templates
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "dynamic_memory_check.h"
+#include "mme_config.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_paging.h"
+
+#define UE_ID_INDEX_BITS 10
+#define PAGING_ID_MAX_OCTETS 8
+#define PAGING_ID_MAX_BITS (UE_ID_INDEX_BITS + 8 * PAGING_ID_MAX_OCTETS)
+#define STMSI_OCTETS 5
+#define IMSI_MIN_OCTETS 3
+
+/*
+ * The fields of a paging PDU that change from one UE to the next
+ */
+typedef struct s1ap_paging_identity_s {
+  uint16_t ue_index; // UE identity index value, IMSI mod 1024
+  // MMEC followed by M-TMSI for S-TMSI paging, or the IMSI octets
+  uint8_t id[PAGING_ID_MAX_OCTETS];
+  uint8_t id_length;
+} s1ap_paging_identity_t;
+
+/*
+ * A paging PDU encoded with all identity bits cleared, along with the bit
+ * offsets of the identity bits in the PDU, in the order they are encoded
+ */
+typedef struct s1ap_paging_template_s {
+  bool built;
+  uint8_t *buffer; // NULL if the template could not be built
+  uint32_t length;
+  int nb_bits;
+  uint32_t bit_offset[PAGING_ID_MAX_BITS];
+} s1ap_paging_template_t;
+
+/*
+ * Templates per CN domain, for S-TMSI paging at index 0 and for IMSI paging
+ * at index octets - IMSI_MIN_OCTETS + 1. The encoded size of the identity
+ * only depends on its number of octets, so this covers all paging requests.
+ */
+#define NB_PAGING_TEMPLATES                                                    \
+  (PAGING_ID_MAX_OCTETS - IMSI_MIN_OCTETS + 2)
+static s1ap_paging_template_t paging_templates[2][NB_PAGING_TEMPLATES];
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_get_identity(
+  const itti_s1ap_paging_request_t *paging_request,
+  s1ap_paging_identity_t *identity)
+{
+  imsi64_t imsi64;
+
+  IMSI_STRING_TO_IMSI64((char *) paging_request->imsi, &imsi64);
+  identity->ue_index = (uint16_t)(imsi64 % 1024);
+  if (paging_request->paging_id == S1AP_PAGING_ID_STMSI) {
+    identity->id[0] = paging_request->mme_code;
+    INT32_TO_BUFFER(paging_request->m_tmsi, &identity->id[1]);
+    identity->id_length = STMSI_OCTETS;
+  } else {
+    OCTET_STRING_t imsi = {0};
+    IMSI_TO_OCTET_STRING(
+      paging_request->imsi, paging_request->imsi_length, &imsi);
+    identity->id_length = imsi.size;
+    memcpy(identity->id, imsi.buf, imsi.size);
+    free_wrapper((void **) &imsi.buf);
+  }
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_paging_encode(
+  const s1ap_paging_identity_t *identity,
+  uint8_t paging_id,
+  s1ap_cn_domain_t domain_indicator,
+  uint8_t **buffer,
+  uint32_t *length)
+{
+  s1ap_message message = {0};
+  S1ap_PagingIEs_t *paging_message = &message.msg.s1ap_PagingIEs;
+
+  paging_message->presenceMask = 0;   // no optional fields
+  paging_message->pagingDRX = 0;      // unused
+  paging_message->pagingPriority = 0; // unused
+
+  UE_ID_INDEX_TO_BIT_STRING(
+    identity->ue_index, &paging_message->ueIdentityIndexValue);
+  if (domain_indicator == CN_DOMAIN_PS) {
+    paging_message->cnDomain = S1ap_CNDomain_ps;
+  } else if (domain_indicator == CN_DOMAIN_CS) {
+    paging_message->cnDomain = S1ap_CNDomain_cs;
+  }
+
+  // Set UE Paging Identity
+  if (paging_id == S1AP_PAGING_ID_STMSI) {
+    paging_message->uePagingID.present = S1ap_UEPagingID_PR_s_TMSI;
+    OCTET_STRING_fromBuf(
+      &paging_message->uePagingID.choice.s_TMSI.mMEC,
+      (const char *) &identity->id[0],
+      1);
+    OCTET_STRING_fromBuf(
+      &paging_message->uePagingID.choice.s_TMSI.m_TMSI,
+      (const char *) &identity->id[1],
+      4);
+    paging_message->uePagingID.choice.s_TMSI.iE_Extensions = NULL;
+  } else {
+    paging_message->uePagingID.present = S1ap_UEPagingID_PR_iMSI;
+    OCTET_STRING_fromBuf(
+      &paging_message->uePagingID.choice.iMSI,
+      (const char *) identity->id,
+      identity->id_length);
+  }
+  // Set TAI list
+  for (int i = 0; i < mme_config.served_tai.nb_tai; i++) {
+    S1ap_TAIItem_t *tai_item = calloc(1, sizeof(S1ap_TAIItem_t));
+    MCC_MNC_TO_PLMNID(
+      mme_config.served_tai.plmn_mcc[i],
+      mme_config.served_tai.plmn_mnc[i],
+      mme_config.served_tai.plmn_mnc_len[i],
+      &tai_item->tAI.pLMNidentity);
+    TAC_TO_ASN1(mme_config.served_tai.tac[i], &tai_item->tAI.tAC);
+    tai_item->iE_Extensions = NULL;
+    tai_item->tAI.iE_Extensions = NULL;
+    ASN_SEQUENCE_ADD(&paging_message->taiList, tai_item);
+  }
+
+  message.procedureCode = S1ap_ProcedureCode_id_Paging;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+
+  int rc = s1ap_mme_encode_pdu(&message, buffer, length);
+  free_s1ap_paging(paging_message);
+  return rc;
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_paging_identity_bit(
+  const s1ap_paging_identity_t *identity,
+  int bit)
+{
+  if (bit < UE_ID_INDEX_BITS) {
+    return (identity->ue_index >> (UE_ID_INDEX_BITS - 1 - bit)) & 1;
+  }
+  bit -= UE_ID_INDEX_BITS;
+  return (identity->id[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_patch(
+  const s1ap_paging_template_t *paging_template,
+  const s1ap_paging_identity_t *identity,
+  uint8_t *pdu)
+{
+  for (int i = 0; i < paging_template->nb_bits; i++) {
+    if (s1ap_paging_identity_bit(identity, i)) {
+      uint32_t offset = paging_template->bit_offset[i];
+      pdu[offset / 8] |= 0x80 >> (offset % 8);
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_paging_build_template(
+  s1ap_paging_template_t *paging_template,
+  uint8_t paging_id,
+  s1ap_cn_domain_t domain_indicator,
+  uint8_t id_length)
+{
+  s1ap_paging_identity_t zeros = {.ue_index = 0, .id_length = id_length};
+  s1ap_paging_identity_t ones = {.ue_index = 0x3FF, .id_length = id_length};
+  s1ap_paging_identity_t check = {.ue_index = 0x2A5, .id_length = id_length};
+  uint8_t *zeros_buffer = NULL;
+  uint8_t *ones_buffer = NULL;
+  uint8_t *check_buffer = NULL;
+  uint32_t zeros_length = 0;
+  uint32_t ones_length = 0;
+  uint32_t check_length = 0;
+
+  paging_template->built = true;
+  memset(ones.id, 0xFF, id_length);
+  for (int i = 0; i < id_length; i++) {
+    check.id[i] = 0xA5 ^ (uint8_t)(i * 0x3C);
+  }
+  if (
+    s1ap_paging_encode(
+      &zeros, paging_id, domain_indicator, &zeros_buffer, &zeros_length) < 0 ||
+    s1ap_paging_encode(
+      &ones, paging_id, domain_indicator, &ones_buffer, &ones_length) < 0 ||
+    zeros_length != ones_length) {
+    goto done;
+  }
+
+  // The identity is the only difference between the two encodings, so the
+  // bits that differ are where the identity bits are encoded
+  paging_template->nb_bits = 0;
+  for (uint32_t offset = 0; offset < zeros_length * 8; offset++) {
+    uint8_t mask = 0x80 >> (offset % 8);
+    if ((zeros_buffer[offset / 8] & mask) == (ones_buffer[offset / 8] & mask)) {
+      continue;
+    }
+    if (paging_template->nb_bits == PAGING_ID_MAX_BITS) {
+      goto done;
+    }
+    paging_template->bit_offset[paging_template->nb_bits++] = offset;
+  }
+  if (paging_template->nb_bits != UE_ID_INDEX_BITS + 8 * id_length) {
+    goto done;
+  }
+
+  // Make sure patching gives the same PDU as the encoder before using it
+  if (
+    s1ap_paging_encode(
+      &check, paging_id, domain_indicator, &check_buffer, &check_length) < 0 ||
+    check_length != zeros_length) {
+    goto done;
+  }
+  uint8_t *patched_buffer = malloc(zeros_length);
+  memcpy(patched_buffer, zeros_buffer, zeros_length);
+  s1ap_paging_patch(paging_template, &check, patched_buffer);
+  bool same = memcmp(patched_buffer, check_buffer, check_length) == 0;
+  free(patched_buffer);
+  if (!same) {
+    goto done;
+  }
+  paging_template->buffer = zeros_buffer;
+  paging_template->length = zeros_length;
+  zeros_buffer = NULL;
+
+done:
+  if (!paging_template->buffer) {
+    OAILOG_WARNING(
+      LOG_S1AP,
+      "Could not build paging template for paging id %u, %u octets, paging "
+      "messages will be encoded one by one\n",
+      paging_id,
+      id_length);
+  }
+  free(zeros_buffer);
+  free(ones_buffer);
+  free(check_buffer);
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_generate_paging(
+  const itti_s1ap_paging_request_t *paging_request,
+  bstring *pdu)
+{
+  s1ap_paging_identity_t identity = {0};
+  s1ap_paging_template_t *paging_template = NULL;
+
+  s1ap_paging_get_identity(paging_request, &identity);
+  if (
+    paging_request->domain_indicator == CN_DOMAIN_PS ||
+    paging_request->domain_indicator == CN_DOMAIN_CS) {
+    int index = 0;
+    if (paging_request->paging_id != S1AP_PAGING_ID_STMSI) {
+      index = identity.id_length - IMSI_MIN_OCTETS + 1;
+    }
+    if (index >= 0 && index < NB_PAGING_TEMPLATES) {
+      paging_template =
+        &paging_templates[paging_request->domain_indicator][index];
+      if (!paging_template->built) {
+        s1ap_paging_build_template(
+          paging_template,
+          paging_request->paging_id,
+          paging_request->domain_indicator,
+          identity.id_length);
+      }
+    }
+  }
+
+  if (paging_template && paging_template->buffer) {
+    *pdu = blk2bstr(paging_template->buffer, paging_template->length);
+    s1ap_paging_patch(paging_template, &identity, (*pdu)->data);
+    return RETURNok;
+  }
+
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+  if (
+    s1ap_paging_encode(
+      &identity,
+      paging_request->paging_id,
+      paging_request->domain_indicator,
+      &buffer,
+      &length) < 0) {
+    return RETURNerror;
+  }
+  *pdu = blk2bstr(buffer, length);
+  free(buffer);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+void s1ap_mme_paging_templates_free(void)
+{
+  for (int domain = 0; domain < 2; domain++) {
+    for (int i = 0; i < NB_PAGING_TEMPLATES; i++) {
+      free(paging_templates[domain][i].buffer);
+      memset(
+        &paging_templates[domain][i], 0, sizeof(s1ap_paging_template_t));
+    }
+  }
+}
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_paging.h
+  \brief Paging message generation from pre-encoded templates
+*/
+
+#ifndef FILE_S1AP_MME_PAGING_SEEN
+#define FILE_S1AP_MME_PAGING_SEEN
+
+#include "bstrlib.h"
+#include "s1ap_messages_types.h"
+
+/*
+ * Generate the S1AP paging PDU for a paging request. The PDU is copied from
+ * a template encoded once per kind of UE paging identity and CN domain, and
+ * only the UE identity bits are patched into the copy. The served TAI list
+ * is part of the templates, so it is only encoded when a template is built.
+ * @param paging_request - the paging request to generate the PDU for
+ * @param pdu - set to the encoded PDU, to be destroyed by the caller
+ * @return RETURNok, or RETURNerror if the PDU could not be encoded
+ */
+int s1ap_mme_generate_paging(
+  const itti_s1ap_paging_request_t *paging_request,
+  bstring *pdu);
+
+/*
+ * Free all paging templates. They are built again on the next paging
+ */
+void s1ap_mme_paging_templates_free(void);
+
+#endif /* FILE_S1AP_MME_PAGING_SEEN */
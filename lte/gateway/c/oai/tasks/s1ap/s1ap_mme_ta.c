@@ -43,37 +43,18 @@
 
 static int s1ap_mme_compare_plmn(const S1ap_PLMNidentity_t *const plmn)
 {
-  int i = 0;
-  uint16_t mcc = 0;
-  uint16_t mnc = 0;
-  uint16_t mnc_len = 0;
-
   DevAssert(plmn != NULL);
-  TBCD_TO_MCC_MNC(plmn, mcc, mnc, mnc_len);
-  mme_config_read_lock(&mme_config);
-
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    OAILOG_TRACE(
-      LOG_S1AP,
-      "Comparing plmn_mcc %d/%d, plmn_mnc %d/%d plmn_mnc_len %d/%d\n",
-      mme_config.served_tai.plmn_mcc[i],
-      mcc,
-      mme_config.served_tai.plmn_mnc[i],
-      mnc,
-      mme_config.served_tai.plmn_mnc_len[i],
-      mnc_len);
-
-    if (
-      (mme_config.served_tai.plmn_mcc[i] == mcc) &&
-      (mme_config.served_tai.plmn_mnc[i] == mnc) &&
-      (mme_config.served_tai.plmn_mnc_len[i] == mnc_len))
-      /*
-       * There is a matching plmn
-       */
-      return TA_LIST_AT_LEAST_ONE_MATCH;
+  if (plmn->size != 3) {
+    // malformed PLMN identity from the eNB
+    return TA_LIST_NO_MATCH;
   }
+  /*
+   * The served PLMNs are kept in their TBCD encoding, so the received
+   * octets are looked up without decoding them
+   */
+  if (mme_config_is_served_plmn(&mme_config.served_tai, TBCD_TO_PLMN_KEY(plmn)))
+    return TA_LIST_AT_LEAST_ONE_MATCH;
 
-  mme_config_unlock(&mme_config);
   return TA_LIST_NO_MATCH;
 }
 
@@ -105,25 +86,13 @@ static int s1ap_mme_compare_plmns(S1ap_BPLMNs_t *b_plmns)
 */
 static int s1ap_mme_compare_tac(const S1ap_TAC_t *const tac)
 {
-  int i = 0;
   uint16_t tac_value = 0;
 
   DevAssert(tac != NULL);
   OCTET_STRING_TO_TAC(tac, tac_value);
-  mme_config_read_lock(&mme_config);
-
-  for (i = 0; i < mme_config.served_tai.nb_tai; i++) {
-    OAILOG_TRACE(
-      LOG_S1AP,
-      "Comparing config tac %d, received tac = %d\n",
-      mme_config.served_tai.tac[i],
-      tac_value);
-
-    if (mme_config.served_tai.tac[i] == tac_value)
-      return TA_LIST_AT_LEAST_ONE_MATCH;
-  }
+  if (mme_config_is_served_tac(&mme_config.served_tai, tac_value))
+    return TA_LIST_AT_LEAST_ONE_MATCH;
 
-  mme_config_unlock(&mme_config);
   return TA_LIST_NO_MATCH;
 }
 
@@ -0,0 +1,779 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_templates.c
+  \brief Template encoders for the most frequent UE associated S1AP messages
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bstrlib.h"
+
+#include "log.h"
+#include "assertions.h"
+#include "common_defs.h"
+#include "conversions.h"
+#include "dynamic_memory_check.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_encoder.h"
+#include "s1ap_mme_templates.h"
+
+/*
+ * The templates write the aligned PER encoding of S1AP-PDU directly. All
+ * protocol IEs are open types, so each IE starts on an octet boundary and
+ * is preceded by its length, and the layout of a message only depends on
+ * which IEs are present. The first time a template is used, it is checked
+ * against the asn1c encoder with sample messages. If it does not give the
+ * same PDUs, messages are encoded with asn1c from then on.
+ */
+
+// Longest length with a two octet length determinant, longer ones would
+// have to be fragmented and are left to asn1c
+#define APER_MAX_LENGTH 16383
+#define MAX_BIT_RATE 10000000000ULL
+#define MAX_TRANSPORT_LAYER_ADDRESS_BITS 160
+
+// Octets of a PDU without its variable length fields
+#define DL_NAS_OVERHEAD 32
+#define ICS_OVERHEAD 128
+#define ICS_E_RAB_OVERHEAD 32
+
+typedef enum s1ap_template_state_e {
+  TEMPLATE_UNCHECKED = 0,
+  TEMPLATE_VALID,
+  TEMPLATE_INVALID,
+} s1ap_template_state_t;
+
+static s1ap_template_state_t dl_nas_template_state = TEMPLATE_UNCHECKED;
+static s1ap_template_state_t ics_template_state = TEMPLATE_UNCHECKED;
+
+/*
+ * Aligned PER writer over a zeroed buffer
+ */
+typedef struct s1ap_aper_s {
+  uint8_t *buffer;
+  uint32_t size; // in octets
+  uint32_t bit;  // offset of the next bit to write
+  bool failed;
+} s1ap_aper_t;
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_put_bits(s1ap_aper_t *aper, uint64_t value, int nb_bits)
+{
+  if (aper->bit + nb_bits > aper->size * 8) {
+    aper->failed = true;
+    return;
+  }
+  for (int i = nb_bits - 1; i >= 0; i--) {
+    if ((value >> i) & 1) {
+      aper->buffer[aper->bit / 8] |= 0x80 >> (aper->bit % 8);
+    }
+    aper->bit++;
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_align(s1ap_aper_t *aper)
+{
+  aper->bit = (aper->bit + 7) & ~7u;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_put_octets(
+  s1ap_aper_t *aper,
+  const uint8_t *data,
+  uint32_t length)
+{
+  s1ap_aper_align(aper);
+  if (aper->bit / 8 + length > aper->size) {
+    aper->failed = true;
+    return;
+  }
+  memcpy(&aper->buffer[aper->bit / 8], data, length);
+  aper->bit += 8 * length;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_put_length(s1ap_aper_t *aper, uint32_t length)
+{
+  s1ap_aper_align(aper);
+  if (length < 128) {
+    s1ap_aper_put_bits(aper, length, 8);
+  } else if (length <= APER_MAX_LENGTH) {
+    s1ap_aper_put_bits(aper, 0x8000 | length, 16);
+  } else {
+    aper->failed = true;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Constrained integer with a range larger than 64K, encoded as its number of
+// octets followed by the aligned octets
+static void s1ap_aper_put_large_integer(
+  s1ap_aper_t *aper,
+  uint64_t value,
+  int max_octets)
+{
+  int nb_octets = 1;
+  int length_bits = 0;
+
+  while (nb_octets < 8 && (value >> (8 * nb_octets))) {
+    nb_octets++;
+  }
+  while ((1 << length_bits) < max_octets) {
+    length_bits++;
+  }
+  if (nb_octets > max_octets) {
+    aper->failed = true;
+    return;
+  }
+  s1ap_aper_put_bits(aper, nb_octets - 1, length_bits);
+  s1ap_aper_align(aper);
+  s1ap_aper_put_bits(aper, value, 8 * nb_octets);
+}
+
+//------------------------------------------------------------------------------
+// The length of an open type is only known once its value is encoded, so two
+// octets are reserved for it and the value is moved back if one is enough
+static uint32_t s1ap_aper_open_type_begin(s1ap_aper_t *aper)
+{
+  s1ap_aper_align(aper);
+  uint32_t start = aper->bit / 8;
+  aper->bit += 16;
+  return start;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_open_type_end(s1ap_aper_t *aper, uint32_t start)
+{
+  s1ap_aper_align(aper);
+  if (aper->failed || aper->bit > aper->size * 8) {
+    aper->failed = true;
+    return;
+  }
+  uint32_t length = aper->bit / 8 - start - 2;
+  if (length < 128) {
+    memmove(&aper->buffer[start + 1], &aper->buffer[start + 2], length);
+    aper->buffer[start] = length;
+    aper->bit -= 8;
+    aper->buffer[aper->bit / 8] = 0;
+  } else if (length <= APER_MAX_LENGTH) {
+    aper->buffer[start] = 0x80 | (length >> 8);
+    aper->buffer[start + 1] = length & 0xFF;
+  } else {
+    aper->failed = true;
+  }
+}
+
+//------------------------------------------------------------------------------
+static uint32_t s1ap_aper_ie_begin(
+  s1ap_aper_t *aper,
+  S1ap_ProtocolIE_ID_t id,
+  S1ap_Criticality_t criticality)
+{
+  s1ap_aper_align(aper);
+  s1ap_aper_put_bits(aper, id, 16);
+  s1ap_aper_put_bits(aper, criticality, 2);
+  return s1ap_aper_open_type_begin(aper);
+}
+
+//------------------------------------------------------------------------------
+static uint32_t s1ap_aper_initiating_message_begin(
+  s1ap_aper_t *aper,
+  e_S1ap_ProcedureCode procedure_code,
+  S1ap_Criticality_t criticality,
+  uint16_t nb_ies)
+{
+  // S1AP-PDU extension bit and choice index of initiatingMessage
+  s1ap_aper_put_bits(aper, 0, 3);
+  s1ap_aper_align(aper);
+  s1ap_aper_put_bits(aper, procedure_code, 8);
+  s1ap_aper_put_bits(aper, criticality, 2);
+  uint32_t start = s1ap_aper_open_type_begin(aper);
+  // message extension bit, then the number of protocol IEs
+  s1ap_aper_put_bits(aper, 0, 1);
+  s1ap_aper_align(aper);
+  s1ap_aper_put_bits(aper, nb_ies, 16);
+  return start;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_aper_put_ue_ids(
+  s1ap_aper_t *aper,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id)
+{
+  uint32_t ie = s1ap_aper_ie_begin(
+    aper, S1ap_ProtocolIE_ID_id_MME_UE_S1AP_ID, S1ap_Criticality_reject);
+  s1ap_aper_put_large_integer(aper, mme_ue_s1ap_id, 4);
+  s1ap_aper_open_type_end(aper, ie);
+
+  ie = s1ap_aper_ie_begin(
+    aper, S1ap_ProtocolIE_ID_id_eNB_UE_S1AP_ID, S1ap_Criticality_reject);
+  s1ap_aper_put_large_integer(aper, enb_ue_s1ap_id, 3);
+  s1ap_aper_open_type_end(aper, ie);
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_aper_finish(s1ap_aper_t *aper, bstring b, bstring *pdu)
+{
+  if (aper->failed || aper->bit > aper->size * 8) {
+    bdestroy_wrapper(&b);
+    return RETURNerror;
+  }
+  b->slen = aper->bit / 8;
+  b->data[b->slen] = '\0';
+  *pdu = b;
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static bstring s1ap_aper_alloc(s1ap_aper_t *aper, uint32_t size)
+{
+  bstring b = bfromcstralloc(size + 1, "");
+  memset(b->data, 0, b->mlen);
+  aper->buffer = b->data;
+  aper->size = b->mlen - 1;
+  aper->bit = 0;
+  aper->failed = false;
+  return b;
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_dl_nas_encode_template(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const uint8_t *nas_pdu,
+  uint32_t nas_length,
+  bstring *pdu)
+{
+  s1ap_aper_t aper;
+  bstring b = s1ap_aper_alloc(&aper, DL_NAS_OVERHEAD + nas_length);
+
+  uint32_t message = s1ap_aper_initiating_message_begin(
+    &aper,
+    S1ap_ProcedureCode_id_downlinkNASTransport,
+    S1ap_Criticality_ignore,
+    3);
+  s1ap_aper_put_ue_ids(&aper, mme_ue_s1ap_id, enb_ue_s1ap_id);
+  uint32_t ie = s1ap_aper_ie_begin(
+    &aper, S1ap_ProtocolIE_ID_id_NAS_PDU, S1ap_Criticality_reject);
+  s1ap_aper_put_length(&aper, nas_length);
+  s1ap_aper_put_octets(&aper, nas_pdu, nas_length);
+  s1ap_aper_open_type_end(&aper, ie);
+  s1ap_aper_open_type_end(&aper, message);
+  return s1ap_aper_finish(&aper, b, pdu);
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_dl_nas_encode(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const uint8_t *nas_pdu,
+  uint32_t nas_length,
+  bstring *pdu)
+{
+  s1ap_message message = {0};
+  S1ap_DownlinkNASTransportIEs_t *downlinkNasTransport =
+    &message.msg.s1ap_DownlinkNASTransportIEs;
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  message.procedureCode = S1ap_ProcedureCode_id_downlinkNASTransport;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  downlinkNasTransport->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  downlinkNasTransport->eNB_UE_S1AP_ID = enb_ue_s1ap_id;
+  OCTET_STRING_fromBuf(
+    &downlinkNasTransport->nas_pdu, (const char *) nas_pdu, nas_length);
+
+  int rc = s1ap_mme_encode_pdu(&message, &buffer, &length);
+  free_s1ap_downlinknastransport(downlinkNasTransport);
+  if (rc < 0) {
+    return RETURNerror;
+  }
+  *pdu = blk2bstr(buffer, length);
+  free(buffer);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_ics_put_e_rab(
+  s1ap_aper_t *aper,
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  int item)
+{
+  const_bstring tla = conn_est_cnf->transport_layer_address[item];
+  const_bstring nas_pdu = conn_est_cnf->nas_pdu[item];
+  uint8_t teid[4];
+
+  if (
+    conn_est_cnf->e_rab_id[item] > 15 || blength(tla) == 0 ||
+    blength(tla) * 8 > MAX_TRANSPORT_LAYER_ADDRESS_BITS) {
+    aper->failed = true;
+    return;
+  }
+  uint32_t ie = s1ap_aper_ie_begin(
+    aper,
+    S1ap_ProtocolIE_ID_id_E_RABToBeSetupItemCtxtSUReq,
+    S1ap_Criticality_reject);
+  // extension bit, then presence of nAS-PDU and iE-Extensions
+  s1ap_aper_put_bits(aper, nas_pdu ? 2 : 0, 3);
+  // e-RAB-ID, extensible
+  s1ap_aper_put_bits(aper, conn_est_cnf->e_rab_id[item], 5);
+  // e-RABlevelQoSParameters: extension bit, no GBR nor extensions, QCI
+  s1ap_aper_put_bits(aper, 0, 3);
+  s1ap_aper_align(aper);
+  s1ap_aper_put_bits(aper, conn_est_cnf->e_rab_level_qos_qci[item], 8);
+  // allocationRetentionPriority: extension bit, no extensions, priority,
+  // pre-emption capability and vulnerability
+  s1ap_aper_put_bits(aper, 0, 2);
+  s1ap_aper_put_bits(aper, conn_est_cnf->e_rab_level_qos_priority_level[item], 4);
+  s1ap_aper_put_bits(
+    aper, conn_est_cnf->e_rab_level_qos_preemption_capability[item], 1);
+  s1ap_aper_put_bits(
+    aper, conn_est_cnf->e_rab_level_qos_preemption_vulnerability[item], 1);
+  // transportLayerAddress: extension bit, size in bits - 1, then the bits
+  s1ap_aper_put_bits(aper, 0, 1);
+  s1ap_aper_put_bits(aper, blength(tla) * 8 - 1, 8);
+  s1ap_aper_put_octets(aper, tla->data, blength(tla));
+  INT32_TO_BUFFER(conn_est_cnf->gtp_teid[item], teid);
+  s1ap_aper_put_octets(aper, teid, sizeof(teid));
+  if (nas_pdu) {
+    s1ap_aper_put_length(aper, blength(nas_pdu));
+    s1ap_aper_put_octets(aper, nas_pdu->data, blength(nas_pdu));
+  }
+  s1ap_aper_open_type_end(aper, ie);
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_ics_encode_template(
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  bstring *pdu)
+{
+  s1ap_aper_t aper;
+  uint32_t size = ICS_OVERHEAD + blength(conn_est_cnf->ue_radio_capability);
+  bool csfb = (conn_est_cnf->presencemask & S1AP_CSFB_INDICATOR_PRESENT) != 0;
+  uint16_t nb_ies = 6;
+  uint8_t algorithms[2];
+
+  if (
+    conn_est_cnf->no_of_e_rabs == 0 ||
+    conn_est_cnf->ue_ambr.br_dl > MAX_BIT_RATE ||
+    conn_est_cnf->ue_ambr.br_ul > MAX_BIT_RATE) {
+    return RETURNerror;
+  }
+  for (int item = 0; item < conn_est_cnf->no_of_e_rabs; item++) {
+    size += ICS_E_RAB_OVERHEAD +
+            blength(conn_est_cnf->transport_layer_address[item]) +
+            blength(conn_est_cnf->nas_pdu[item]);
+  }
+  if (conn_est_cnf->ue_radio_capability) {
+    nb_ies++;
+  }
+  if (csfb) {
+    nb_ies++;
+  }
+
+  bstring b = s1ap_aper_alloc(&aper, size);
+  uint32_t message = s1ap_aper_initiating_message_begin(
+    &aper,
+    S1ap_ProcedureCode_id_InitialContextSetup,
+    S1ap_Criticality_reject,
+    nb_ies);
+  s1ap_aper_put_ue_ids(&aper, mme_ue_s1ap_id, enb_ue_s1ap_id);
+
+  // uEaggregateMaximumBitrate: extension bit, no extensions, DL and UL
+  uint32_t ie = s1ap_aper_ie_begin(
+    &aper,
+    S1ap_ProtocolIE_ID_id_uEaggregateMaximumBitrate,
+    S1ap_Criticality_reject);
+  s1ap_aper_put_bits(&aper, 0, 2);
+  s1ap_aper_put_large_integer(&aper, conn_est_cnf->ue_ambr.br_dl, 5);
+  s1ap_aper_put_large_integer(&aper, conn_est_cnf->ue_ambr.br_ul, 5);
+  s1ap_aper_open_type_end(&aper, ie);
+
+  ie = s1ap_aper_ie_begin(
+    &aper,
+    S1ap_ProtocolIE_ID_id_E_RABToBeSetupListCtxtSUReq,
+    S1ap_Criticality_reject);
+  s1ap_aper_align(&aper);
+  s1ap_aper_put_bits(&aper, conn_est_cnf->no_of_e_rabs - 1, 8);
+  for (int item = 0; item < conn_est_cnf->no_of_e_rabs; item++) {
+    s1ap_ics_put_e_rab(&aper, conn_est_cnf, item);
+  }
+  s1ap_aper_open_type_end(&aper, ie);
+
+  // ueSecurityCapabilities: extension bit, no extensions, then both
+  // algorithm bit strings with their extension bit, as copied from memory
+  ie = s1ap_aper_ie_begin(
+    &aper,
+    S1ap_ProtocolIE_ID_id_UESecurityCapabilities,
+    S1ap_Criticality_reject);
+  s1ap_aper_put_bits(&aper, 0, 2);
+  memcpy(
+    algorithms,
+    &conn_est_cnf->ue_security_capabilities_encryption_algorithms,
+    sizeof(algorithms));
+  s1ap_aper_put_bits(&aper, 0, 1);
+  s1ap_aper_put_bits(&aper, algorithms[0], 8);
+  s1ap_aper_put_bits(&aper, algorithms[1], 8);
+  memcpy(
+    algorithms,
+    &conn_est_cnf->ue_security_capabilities_integrity_algorithms,
+    sizeof(algorithms));
+  s1ap_aper_put_bits(&aper, 0, 1);
+  s1ap_aper_put_bits(&aper, algorithms[0], 8);
+  s1ap_aper_put_bits(&aper, algorithms[1], 8);
+  s1ap_aper_open_type_end(&aper, ie);
+
+  ie = s1ap_aper_ie_begin(
+    &aper, S1ap_ProtocolIE_ID_id_SecurityKey, S1ap_Criticality_reject);
+  s1ap_aper_put_octets(&aper, conn_est_cnf->kenb, AUTH_KENB_SIZE);
+  s1ap_aper_open_type_end(&aper, ie);
+
+  if (conn_est_cnf->ue_radio_capability) {
+    ie = s1ap_aper_ie_begin(
+      &aper, S1ap_ProtocolIE_ID_id_UERadioCapability, S1ap_Criticality_ignore);
+    s1ap_aper_put_length(&aper, blength(conn_est_cnf->ue_radio_capability));
+    s1ap_aper_put_octets(
+      &aper,
+      conn_est_cnf->ue_radio_capability->data,
+      blength(conn_est_cnf->ue_radio_capability));
+    s1ap_aper_open_type_end(&aper, ie);
+  }
+
+  if (csfb) {
+    // cs-fallback-high-priority is an extension of the enumeration
+    ie = s1ap_aper_ie_begin(
+      &aper, S1ap_ProtocolIE_ID_id_CSFallbackIndicator, S1ap_Criticality_reject);
+    if (conn_est_cnf->cs_fallback_indicator == CSFB_REQUIRED) {
+      s1ap_aper_put_bits(&aper, 0, 1);
+    } else if (conn_est_cnf->cs_fallback_indicator == CSFB_HIGH_PRIORITY) {
+      s1ap_aper_put_bits(&aper, 1, 1);
+      s1ap_aper_put_bits(&aper, 0, 7);
+    } else {
+      aper.failed = true;
+    }
+    s1ap_aper_open_type_end(&aper, ie);
+  }
+
+  s1ap_aper_open_type_end(&aper, message);
+  return s1ap_aper_finish(&aper, b, pdu);
+}
+
+//------------------------------------------------------------------------------
+static int s1ap_ics_encode(
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  bstring *pdu)
+{
+  S1ap_InitialContextSetupRequestIEs_t *initialContextSetupRequest_p = NULL;
+  S1ap_E_RABToBeSetupItemCtxtSUReq_t *e_RABToBeSetup = NULL;
+  S1ap_NAS_PDU_t *nas_pdu = NULL;
+  s1ap_message message = {0}; // yes, alloc on stack
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  message.procedureCode = S1ap_ProcedureCode_id_InitialContextSetup;
+  message.direction = S1AP_PDU_PR_initiatingMessage;
+  initialContextSetupRequest_p =
+    &message.msg.s1ap_InitialContextSetupRequestIEs;
+  initialContextSetupRequest_p->mme_ue_s1ap_id = (unsigned long) mme_ue_s1ap_id;
+  initialContextSetupRequest_p->eNB_UE_S1AP_ID = (unsigned long) enb_ue_s1ap_id;
+
+  /*
+   * Only add capability information if it's not empty.
+   */
+  if (conn_est_cnf->ue_radio_capability) {
+    OAILOG_DEBUG(LOG_S1AP, "UE radio capability found, adding to message\n");
+    initialContextSetupRequest_p->presenceMask |=
+      S1AP_INITIALCONTEXTSETUPREQUESTIES_UERADIOCAPABILITY_PRESENT;
+    OCTET_STRING_fromBuf(
+      &initialContextSetupRequest_p->ueRadioCapability,
+      (const char *) conn_est_cnf->ue_radio_capability->data,
+      conn_est_cnf->ue_radio_capability->slen);
+  }
+
+  /*
+   * uEaggregateMaximumBitrateDL and uEaggregateMaximumBitrateUL expressed in term of bits/sec
+   */
+  asn_uint642INTEGER(
+    &initialContextSetupRequest_p->uEaggregateMaximumBitrate
+       .uEaggregateMaximumBitRateDL,
+    conn_est_cnf->ue_ambr.br_dl);
+  asn_uint642INTEGER(
+    &initialContextSetupRequest_p->uEaggregateMaximumBitrate
+       .uEaggregateMaximumBitRateUL,
+    conn_est_cnf->ue_ambr.br_ul);
+
+  for (int item = 0; item < conn_est_cnf->no_of_e_rabs; item++) {
+    // Free happens in free_s1ap_initialcontextsetuprequest
+    e_RABToBeSetup = calloc(1, sizeof *e_RABToBeSetup);
+    e_RABToBeSetup->e_RAB_ID = conn_est_cnf->e_rab_id[item]; //5;
+    e_RABToBeSetup->e_RABlevelQoSParameters.qCI =
+      conn_est_cnf->e_rab_level_qos_qci[item];
+
+    if (conn_est_cnf->nas_pdu[item] != NULL) {
+      // NAS PDU is optional in rab_setup
+      nas_pdu = calloc(1, sizeof *nas_pdu);
+      nas_pdu->size = blength(conn_est_cnf->nas_pdu[item]);
+      nas_pdu->buf = malloc(blength(conn_est_cnf->nas_pdu[item]));
+      memcpy(
+        nas_pdu->buf,
+        (void *) conn_est_cnf->nas_pdu[item]->data,
+        blength(conn_est_cnf->nas_pdu[item]));
+      e_RABToBeSetup->nAS_PDU = nas_pdu;
+    }
+
+    e_RABToBeSetup->e_RABlevelQoSParameters.allocationRetentionPriority
+      .priorityLevel = conn_est_cnf->e_rab_level_qos_priority_level[item];
+    e_RABToBeSetup->e_RABlevelQoSParameters.allocationRetentionPriority
+      .pre_emptionCapability =
+      conn_est_cnf->e_rab_level_qos_preemption_capability[item];
+    e_RABToBeSetup->e_RABlevelQoSParameters.allocationRetentionPriority
+      .pre_emptionVulnerability =
+      conn_est_cnf->e_rab_level_qos_preemption_vulnerability[item];
+    /*
+     * Set the GTP-TEID. This is the S1-U S-GW TEID
+     */
+    INT32_TO_OCTET_STRING(
+      conn_est_cnf->gtp_teid[item], &(e_RABToBeSetup->gTP_TEID));
+    // S-GW IP address(es) for user-plane
+    e_RABToBeSetup->transportLayerAddress.buf = calloc(
+      blength(conn_est_cnf->transport_layer_address[item]), sizeof(uint8_t));
+    memcpy(
+      e_RABToBeSetup->transportLayerAddress.buf,
+      conn_est_cnf->transport_layer_address[item]->data,
+      blength(conn_est_cnf->transport_layer_address[item]));
+    e_RABToBeSetup->transportLayerAddress.size =
+      blength(conn_est_cnf->transport_layer_address[item]);
+    e_RABToBeSetup->transportLayerAddress.bits_unused = 0;
+    ASN_SEQUENCE_ADD(
+      &initialContextSetupRequest_p->e_RABToBeSetupListCtxtSUReq,
+      e_RABToBeSetup);
+  }
+
+  if (
+    (conn_est_cnf->presencemask & S1AP_CSFB_INDICATOR_PRESENT) ==
+    S1AP_CSFB_INDICATOR_PRESENT) {
+    initialContextSetupRequest_p->presenceMask |=
+      S1AP_INITIALCONTEXTSETUPREQUESTIES_CSFALLBACKINDICATOR_PRESENT;
+    initialContextSetupRequest_p->csFallbackIndicator =
+      conn_est_cnf->cs_fallback_indicator;
+  }
+
+  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
+    .buf = calloc(2, sizeof(uint8_t));
+  memcpy(
+    initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
+      .buf,
+    (uint8_t *) &conn_est_cnf->ue_security_capabilities_encryption_algorithms,
+    2);
+  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
+    .size = 2;
+  initialContextSetupRequest_p->ueSecurityCapabilities.encryptionAlgorithms
+    .bits_unused = 0;
+  initialContextSetupRequest_p->ueSecurityCapabilities
+    .integrityProtectionAlgorithms.buf = calloc(2, sizeof(uint8_t));
+  memcpy(
+    initialContextSetupRequest_p->ueSecurityCapabilities
+      .integrityProtectionAlgorithms.buf,
+    (uint8_t *) &conn_est_cnf->ue_security_capabilities_integrity_algorithms,
+    2);
+  initialContextSetupRequest_p->ueSecurityCapabilities
+    .integrityProtectionAlgorithms.size = 2;
+  initialContextSetupRequest_p->ueSecurityCapabilities
+    .integrityProtectionAlgorithms.bits_unused = 0;
+
+  initialContextSetupRequest_p->securityKey.buf =
+    calloc(AUTH_KENB_SIZE, sizeof(uint8_t));
+  memcpy(
+    initialContextSetupRequest_p->securityKey.buf,
+    conn_est_cnf->kenb,
+    AUTH_KENB_SIZE);
+  initialContextSetupRequest_p->securityKey.size = AUTH_KENB_SIZE;
+  initialContextSetupRequest_p->securityKey.bits_unused = 0;
+
+  int rc = s1ap_mme_encode_pdu(&message, &buffer, &length);
+  free_s1ap_initialcontextsetuprequest(initialContextSetupRequest_p);
+  if (rc < 0) {
+    return RETURNerror;
+  }
+  *pdu = blk2bstr(buffer, length);
+  free(buffer);
+  return RETURNok;
+}
+
+//------------------------------------------------------------------------------
+static bool s1ap_same_pdu(int rc1, bstring pdu1, int rc2, bstring pdu2)
+{
+  bool same = rc1 == RETURNok && rc2 == RETURNok && biseq(pdu1, pdu2) == 1;
+  bdestroy_wrapper(&pdu1);
+  bdestroy_wrapper(&pdu2);
+  return same;
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_dl_nas_check_template(void)
+{
+  // IDs and NAS PDUs of all encoded sizes
+  const mme_ue_s1ap_id_t mme_ids[] = {0, 0x1234, 0xFFFFFFFF};
+  const enb_ue_s1ap_id_t enb_ids[] = {0, 0x56, 0xFFFFFF};
+  const uint32_t nas_lengths[] = {1, 127, 300};
+  uint8_t nas_pdu[300];
+
+  for (int i = 0; i < sizeof(nas_pdu); i++) {
+    nas_pdu[i] = (uint8_t) (i * 7 + 1);
+  }
+  dl_nas_template_state = TEMPLATE_VALID;
+  for (int i = 0; i < 3; i++) {
+    bstring template_pdu = NULL;
+    bstring pdu = NULL;
+    int template_rc = s1ap_dl_nas_encode_template(
+      mme_ids[i], enb_ids[i], nas_pdu, nas_lengths[i], &template_pdu);
+    int rc =
+      s1ap_dl_nas_encode(mme_ids[i], enb_ids[i], nas_pdu, nas_lengths[i], &pdu);
+    if (!s1ap_same_pdu(template_rc, template_pdu, rc, pdu)) {
+      OAILOG_WARNING(
+        LOG_S1AP,
+        "Downlink NAS transport template does not match the encoder, "
+        "messages will be encoded one by one\n");
+      dl_nas_template_state = TEMPLATE_INVALID;
+      return;
+    }
+  }
+}
+
+//------------------------------------------------------------------------------
+static void s1ap_ics_check_template(void)
+{
+  itti_mme_app_connection_establishment_cnf_t samples[2];
+  uint8_t data[300];
+
+  for (int i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t) (i * 13 + 5);
+  }
+  memset(samples, 0, sizeof(samples));
+  // Attach with a NAS PDU, radio capability and CS fallback
+  samples[0].ue_ambr.br_dl = MAX_BIT_RATE;
+  samples[0].ue_ambr.br_ul = 0x12345;
+  samples[0].no_of_e_rabs = 2;
+  for (int item = 0; item < 2; item++) {
+    samples[0].e_rab_id[item] = 5 + item;
+    samples[0].e_rab_level_qos_qci[item] = 9 - item;
+    samples[0].e_rab_level_qos_priority_level[item] = 15 - item;
+    samples[0].e_rab_level_qos_preemption_capability[item] = item;
+    samples[0].e_rab_level_qos_preemption_vulnerability[item] = 1 - item;
+    samples[0].gtp_teid[item] = 0x89ABCDEF + item;
+  }
+  samples[0].transport_layer_address[0] = blk2bstr(data, 4);
+  samples[0].transport_layer_address[1] = blk2bstr(data, 20);
+  samples[0].nas_pdu[0] = blk2bstr(data, 200);
+  samples[0].ue_security_capabilities_encryption_algorithms = 0xE000;
+  samples[0].ue_security_capabilities_integrity_algorithms = 0x00C0;
+  memcpy(samples[0].kenb, data, AUTH_KENB_SIZE);
+  samples[0].ue_radio_capability = blk2bstr(data, 300);
+  samples[0].presencemask = S1AP_CSFB_INDICATOR_PRESENT;
+  samples[0].cs_fallback_indicator = CSFB_HIGH_PRIORITY;
+  // Service request, without any optional IE
+  samples[1].ue_ambr.br_dl = 100;
+  samples[1].ue_ambr.br_ul = 0;
+  samples[1].no_of_e_rabs = 1;
+  samples[1].e_rab_id[0] = 15;
+  samples[1].e_rab_level_qos_qci[0] = 255;
+  samples[1].transport_layer_address[0] = blk2bstr(data, 16);
+  samples[1].nas_pdu[0] = blk2bstr(data, 12);
+
+  ics_template_state = TEMPLATE_VALID;
+  for (int i = 0; i < 2; i++) {
+    bstring template_pdu = NULL;
+    bstring pdu = NULL;
+    int template_rc = s1ap_ics_encode_template(
+      &samples[i], 0x10000 + i, 0x100 + i, &template_pdu);
+    int rc = s1ap_ics_encode(&samples[i], 0x10000 + i, 0x100 + i, &pdu);
+    if (!s1ap_same_pdu(template_rc, template_pdu, rc, pdu)) {
+      OAILOG_WARNING(
+        LOG_S1AP,
+        "Initial context setup template does not match the encoder, "
+        "messages will be encoded one by one\n");
+      ics_template_state = TEMPLATE_INVALID;
+      break;
+    }
+  }
+  for (int i = 0; i < 2; i++) {
+    for (int item = 0; item < BEARERS_PER_UE; item++) {
+      bdestroy_wrapper(&samples[i].transport_layer_address[item]);
+      bdestroy_wrapper(&samples[i].nas_pdu[item]);
+    }
+    bdestroy_wrapper(&samples[i].ue_radio_capability);
+  }
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_generate_downlink_nas_transport_pdu(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const_bstring nas_pdu,
+  bstring *pdu)
+{
+  if (dl_nas_template_state == TEMPLATE_UNCHECKED) {
+    s1ap_dl_nas_check_template();
+  }
+  if (
+    dl_nas_template_state == TEMPLATE_VALID &&
+    s1ap_dl_nas_encode_template(
+      mme_ue_s1ap_id,
+      enb_ue_s1ap_id,
+      nas_pdu->data,
+      blength(nas_pdu),
+      pdu) == RETURNok) {
+    return RETURNok;
+  }
+  return s1ap_dl_nas_encode(
+    mme_ue_s1ap_id, enb_ue_s1ap_id, nas_pdu->data, blength(nas_pdu), pdu);
+}
+
+//------------------------------------------------------------------------------
+int s1ap_mme_generate_initial_context_setup_pdu(
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  bstring *pdu)
+{
+  if (ics_template_state == TEMPLATE_UNCHECKED) {
+    s1ap_ics_check_template();
+  }
+  if (
+    ics_template_state == TEMPLATE_VALID &&
+    s1ap_ics_encode_template(
+      conn_est_cnf, mme_ue_s1ap_id, enb_ue_s1ap_id, pdu) == RETURNok) {
+    return RETURNok;
+  }
+  return s1ap_ics_encode(conn_est_cnf, mme_ue_s1ap_id, enb_ue_s1ap_id, pdu);
+}
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under 
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.  
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+
+/*! \file s1ap_mme_templates.h
+  \brief Template encoders for the most frequent UE associated S1AP messages
+*/
+
+#ifndef FILE_S1AP_MME_TEMPLATES_SEEN
+#define FILE_S1AP_MME_TEMPLATES_SEEN
+
+#include "bstrlib.h"
+#include "common_types.h"
+#include "intertask_interface.h"
+
+/*
+ * Generate a downlink NAS transport PDU. The aligned PER layout of the
+ * message is fixed apart from the UE S1AP IDs and the NAS PDU, so those are
+ * written directly into the PDU, without building asn1c IE structures.
+ * @param mme_ue_s1ap_id - MME UE S1AP ID of the UE
+ * @param enb_ue_s1ap_id - eNB UE S1AP ID of the UE
+ * @param nas_pdu - the NAS message to transport
+ * @param pdu - set to the encoded PDU, to be destroyed by the caller
+ * @return RETURNok, or RETURNerror if the PDU could not be encoded
+ */
+int s1ap_mme_generate_downlink_nas_transport_pdu(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  const_bstring nas_pdu,
+  bstring *pdu);
+
+/*
+ * Generate an initial context setup request PDU for a connection
+ * establishment confirm, the same way as the downlink NAS transport PDU
+ * @param conn_est_cnf - E-RABs, security and radio capability of the UE
+ * @param mme_ue_s1ap_id - MME UE S1AP ID of the UE
+ * @param enb_ue_s1ap_id - eNB UE S1AP ID of the UE
+ * @param pdu - set to the encoded PDU, to be destroyed by the caller
+ * @return RETURNok, or RETURNerror if the PDU could not be encoded
+ */
+int s1ap_mme_generate_initial_context_setup_pdu(
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  bstring *pdu);
+
+#endif /* FILE_S1AP_MME_TEMPLATES_SEEN */
@@ -191,7 +191,8 @@ static inline int s6a_parse_authentication_info_avp(
 
     switch (hdr->avp_code) {
       case AVP_CODE_E_UTRAN_VECTOR: {
-        DevAssert(MAX_EPS_AUTH_VECTORS > authentication_info->nb_of_vectors);
+        DevAssert(
+          MAX_EPS_AUTH_VECTORS_PER_AIR > authentication_info->nb_of_vectors);
         CHECK_FCT(s6a_parse_e_utran_vector(
           avp,
           &authentication_info
@@ -216,12 +217,7 @@ static inline int s6a_parse_authentication_info_avp(
   return RETURNok;
 }
 
-int s6a_aia_cb(
-  struct msg **msg,
-  struct avp *paramavp,
-  struct session *sess,
-  void *opaque,
-  enum disp_action *act)
+static int _s6a_handle_aia(struct msg **msg, bool is_prefetch)
 {
   struct msg *ans = NULL;
   struct msg *qry = NULL;
@@ -240,6 +236,7 @@ int s6a_aia_cb(
   DevAssert(qry);
   message_p = itti_alloc_new_message(TASK_S6A, S6A_AUTH_INFO_ANS);
   s6a_auth_info_ans_p = &message_p->ittiMsg.s6a_auth_info_ans;
+  s6a_auth_info_ans_p->is_prefetch = is_prefetch;
   OAILOG_DEBUG(
     LOG_S6A, "Received S6A Authentication Information Answer (AIA)\n");
   CHECK_FCT(fd_msg_search_avp(qry, s6a_fd_cnf.dataobj_s6a_user_name, &avp));
@@ -354,6 +351,27 @@ err:
   return RETURNok;
 }
 
+int s6a_aia_cb(
+  struct msg **msg,
+  struct avp *paramavp,
+  struct session *sess,
+  void *opaque,
+  enum disp_action *act)
+{
+  return _s6a_handle_aia(msg, false);
+}
+
+/*
+ * Answers to prefetch requests are not dispatched to s6a_aia_cb, so that NAS
+ * can tell them apart from the answers for a UE context of the same IMSI
+ */
+static void _s6a_prefetch_aia_cb(void *data, struct msg **msg)
+{
+  _s6a_handle_aia(msg, true);
+  fd_msg_free(*msg);
+  *msg = NULL;
+}
+
 int s6a_generate_authentication_info_req(s6a_auth_info_req_t *air_p)
 {
   struct avp *avp;
@@ -397,7 +415,6 @@ int s6a_generate_authentication_info_req(s6a_auth_info_req_t *air_p)
    * Add Origin_Host & Origin_Realm
    */
   CHECK_FCT(fd_msg_add_origin(msg, 0));
-  mme_config_read_lock(&mme_config);
   /*
    * Destination Host
    */
@@ -423,7 +440,6 @@ int s6a_generate_authentication_info_req(s6a_auth_info_req_t *air_p)
     CHECK_FCT(fd_msg_avp_setvalue(avp, &value));
     CHECK_FCT(fd_msg_avp_add(msg, MSG_BRW_LAST_CHILD, avp));
   }
-  mme_config_unlock(&mme_config);
   /*
    * Adding the User-Name (IMSI)
    */
@@ -508,6 +524,7 @@ int s6a_generate_authentication_info_req(s6a_auth_info_req_t *air_p)
 
     CHECK_FCT(fd_msg_avp_add(msg, MSG_BRW_LAST_CHILD, avp));
   }
-  CHECK_FCT(fd_msg_send(&msg, NULL, NULL));
+  CHECK_FCT(fd_msg_send(
+    &msg, air_p->is_prefetch ? _s6a_prefetch_aia_cb : NULL, NULL));
   return RETURNok;
 }
@@ -95,11 +95,6 @@ int s6a_fd_new_peer(void)
   struct peer_info info = {0};
 #endif
 
-  if (mme_config_read_lock(&mme_config)) {
-    OAILOG_ERROR(LOG_S6A, "Failed to lock configuration for reading\n");
-    return RETURNerror;
-  }
-
   if (fd_g_config->cnf_diamid) {
     free(fd_g_config->cnf_diamid);
     fd_g_config->cnf_diamid_len = 0;
@@ -120,11 +115,6 @@ int s6a_fd_new_peer(void)
   bstring hss_name = bstrcpy(mme_config.s6a_config.hss_host_name);
   bconchar(hss_name, '.');
   bconcat(hss_name, mme_config.realm);
-
-  if (mme_config_unlock(&mme_config)) {
-    OAILOG_ERROR(LOG_S6A, "Failed to unlock configuration\n");
-    return RETURNerror;
-  }
 #if FD_CONF_FILE_NO_CONNECT_PEERS_CONFIGURED
   info.pi_diamid = bdata(hss_name);
   info.pi_diamidlen = blength(hss_name);
@@ -221,7 +221,6 @@ int s6a_generate_purge_ue_req(s6a_purge_ue_req_t *pur_pP)
    * Add Origin_Host & Origin_Realm
    */
   CHECK_FCT(fd_msg_add_origin(msg_p, 0));
-  mme_config_read_lock(&mme_config);
   /*
    * Destination Host
    */
@@ -248,7 +247,6 @@ int s6a_generate_purge_ue_req(s6a_purge_ue_req_t *pur_pP)
     CHECK_FCT(fd_msg_avp_setvalue(avp_p, &value));
     CHECK_FCT(fd_msg_avp_add(msg_p, MSG_BRW_LAST_CHILD, avp_p));
   }
-  mme_config_unlock(&mme_config);
   /*
    * Adding the User-Name (IMSI)
    */
@@ -239,7 +239,6 @@ int s6a_generate_update_location(s6a_update_location_req_t *ulr_pP)
    * Add Origin_Host & Origin_Realm
    */
   CHECK_FCT(fd_msg_add_origin(msg_p, 0));
-  mme_config_read_lock(&mme_config);
   /*
    * Destination Host
    */
@@ -266,7 +265,6 @@ int s6a_generate_update_location(s6a_update_location_req_t *ulr_pP)
     CHECK_FCT(fd_msg_avp_setvalue(avp_p, &value));
     CHECK_FCT(fd_msg_avp_add(msg_p, MSG_BRW_LAST_CHILD, avp_p));
   }
-  mme_config_unlock(&mme_config);
   /*
    * Adding the User-Name (IMSI)
    */
@@ -34,6 +34,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/sctp.h>
@@ -55,6 +56,17 @@
 #define SCTP_RC_NORMAL_READ 0
 #define SCTP_RC_DISCONNECT 1
 
+#define SCTP_SEND_WOULD_BLOCK 1
+
+// A message waiting for its association's socket to become writable
+typedef struct sctp_queued_msg_s {
+  struct sctp_queued_msg_s *next;
+  bstring payload;
+  uint16_t stream;
+  uint32_t mme_ue_s1ap_id;
+  task_id_t origin_task_id; ///< Task to notify if the message is dropped
+} sctp_queued_msg_t;
+
 typedef struct sctp_association_s {
   struct sctp_association_s *next_assoc; ///< Next association in the list
   struct sctp_association_s
@@ -71,6 +83,14 @@ typedef struct sctp_association_s {
 
   struct sockaddr *peer_addresses; ///< A list of peer addresses
   int nb_peer_addresses;
+
+  /*
+   * Messages that could not be sent without blocking, in sending order.
+   * They are flushed by the receiver thread when the socket is writable.
+   */
+  sctp_queued_msg_t *send_queue_head;
+  sctp_queued_msg_t *send_queue_tail;
+  uint32_t send_queue_depth;
 } sctp_association_t;
 
 typedef struct sctp_descriptor_s {
@@ -79,8 +99,18 @@ typedef struct sctp_descriptor_s {
   struct sctp_association_s *available_connections_tail;
 
   uint32_t number_of_connections;
+  // Messages queued on all associations, under lock
+  uint32_t send_queue_depth;
   uint16_t nb_instreams;
   uint16_t nb_outstreams;
+
+  /*
+   * The list is modified by the receiver thread and read by TASK_SCTP,
+   * the send queues are written by both.
+   */
+  pthread_mutex_t lock;
+  // Wakes up the receiver thread when a send queue stops being empty
+  int wakeup_fd[2];
 } sctp_descriptor_t;
 
 typedef struct sctp_arg_s {
@@ -98,7 +128,13 @@ void *sctp_receiver_thread(void *args_p);
 static int sctp_send_msg(
   sctp_assoc_id_t sctp_assoc_id,
   uint16_t stream,
+  uint32_t mme_ue_s1ap_id,
+  task_id_t origin_task_id,
   STOLEN_REF bstring *payload);
+static void sctp_flush_send_queue(sctp_association_t *assoc_desc);
+static void sctp_free_send_queue(
+  sctp_association_t *assoc_desc,
+  bool notify_senders);
 
 // Association list related local functions prototypes
 static sctp_association_t *sctp_is_assoc_in_list(sctp_assoc_id_t assoc_id);
@@ -168,10 +204,12 @@ static int sctp_remove_assoc_from_list(sctp_assoc_id_t assoc_id)
 {
   sctp_association_t *assoc_desc = NULL;
 
+  pthread_mutex_lock(&sctp_desc.lock);
   /*
    * Association not in the list
    */
   if ((assoc_desc = sctp_is_assoc_in_list(assoc_id)) == NULL) {
+    pthread_mutex_unlock(&sctp_desc.lock);
     return -1;
   }
 
@@ -211,8 +249,10 @@ static int sctp_remove_assoc_from_list(sctp_assoc_id_t assoc_id)
       OAILOG_DEBUG(
         LOG_SCTP, "sctp_freepaddrs(%p) failed\n", assoc_desc->peer_addresses);
   }
+  sctp_free_send_queue(assoc_desc, true);
   free_wrapper((void **) &assoc_desc);
   sctp_desc.number_of_connections--;
+  pthread_mutex_unlock(&sctp_desc.lock);
   return 0;
 }
 
@@ -272,17 +312,78 @@ static void sctp_dump_list(void)
 #endif
 }
 
+//------------------------------------------------------------------------------
+// The gauge is aggregated over all associations, so that no series is left
+// behind when an association goes away. Called with the lock.
+static void sctp_update_send_queue_gauge(void)
+{
+  set_gauge("sctp_send_queue_depth", sctp_desc.send_queue_depth, NO_LABELS);
+}
+
+//------------------------------------------------------------------------------
+// Returns 0 if sent, SCTP_SEND_WOULD_BLOCK if the socket is full, -1 on error
+static int sctp_send_payload(
+  sctp_association_t *assoc_desc,
+  uint16_t stream,
+  const_bstring payload)
+{
+  OAILOG_DEBUG(
+    LOG_SCTP,
+    "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
+    assoc_desc->sd,
+    assoc_desc->assoc_id,
+    bdata(payload),
+    blength(payload),
+    stream,
+    assoc_desc->ppid);
+
+  /*
+   * Send message_p on specified stream of the sd association
+   */
+  if (
+    sctp_sendmsg(
+      assoc_desc->sd,
+      (const void *) bdata(payload),
+      (size_t) blength(payload),
+      NULL,
+      0,
+      htonl(assoc_desc->ppid),
+      0,
+      stream,
+      0,
+      0) < 0) {
+    if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
+      return SCTP_SEND_WOULD_BLOCK;
+    }
+    OAILOG_ERROR(LOG_SCTP, "send: %s:%d\n", strerror(errno), errno);
+    return -1;
+  }
+  OAILOG_DEBUG(
+    LOG_SCTP,
+    "Successfully sent %d bytes on stream %d\n",
+    blength(payload),
+    stream);
+  assoc_desc->messages_sent++;
+  return 0;
+}
+
 //------------------------------------------------------------------------------
 static int sctp_send_msg(
   sctp_assoc_id_t sctp_assoc_id,
   uint16_t stream,
+  uint32_t mme_ue_s1ap_id,
+  task_id_t origin_task_id,
   STOLEN_REF bstring *payload)
 {
   sctp_association_t *assoc_desc = NULL;
+  sctp_queued_msg_t *msg = NULL;
+  int rc = 0;
 
   DevAssert(*payload);
 
+  pthread_mutex_lock(&sctp_desc.lock);
   if ((assoc_desc = sctp_is_assoc_in_list(sctp_assoc_id)) == NULL) {
+    pthread_mutex_unlock(&sctp_desc.lock);
     OAILOG_DEBUG(
       LOG_SCTP,
       "This assoc id has not been fount in list (%d)\n",
@@ -291,6 +392,7 @@ static int sctp_send_msg(
   }
 
   if (assoc_desc->sd == -1) {
+    pthread_mutex_unlock(&sctp_desc.lock);
     /*
      * The socket is invalid may be closed.
      */
@@ -301,47 +403,123 @@ static int sctp_send_msg(
     return -1;
   }
 
-  OAILOG_DEBUG(
-    LOG_SCTP,
-    "[%d][%d] Sending buffer %p of %d bytes on stream %d with ppid %d\n",
-    assoc_desc->sd,
-    sctp_assoc_id,
-    bdata(*payload),
-    blength(*payload),
-    stream,
-    assoc_desc->ppid);
-
   /*
-   * Send message_p on specified stream of the sd association
+   * Messages already waiting go first, so that the peer receives them in
+   * order. Otherwise try to send right away, the socket never blocks.
    */
-  if (
-    sctp_sendmsg(
-      assoc_desc->sd,
-      (const void *) bdata(*payload),
-      (size_t) blength(*payload),
-      NULL,
-      0,
-      htonl(assoc_desc->ppid),
-      0,
-      stream,
-      0,
-      0) < 0) {
-    bdestroy(*payload);
-    OAILOG_ERROR(LOG_SCTP, "send: %s:%d\n", strerror(errno), errno);
+  if (assoc_desc->send_queue_head == NULL) {
+    rc = sctp_send_payload(assoc_desc, stream, *payload);
+    if (rc != SCTP_SEND_WOULD_BLOCK) {
+      pthread_mutex_unlock(&sctp_desc.lock);
+      bdestroy_wrapper(payload);
+      return rc;
+    }
+  }
+
+  if (assoc_desc->send_queue_depth >= SCTP_MAX_SEND_QUEUE_DEPTH) {
+    pthread_mutex_unlock(&sctp_desc.lock);
+    OAILOG_WARNING(
+      LOG_SCTP,
+      "Send queue of assoc id %d is full, dropping message\n",
+      sctp_assoc_id);
+    increment_counter("sctp_send_queue_full", 1, NO_LABELS);
+    bdestroy_wrapper(payload);
     return -1;
   }
-  OAILOG_DEBUG(
-    LOG_SCTP,
-    "Successfully sent %d bytes on stream %d\n",
-    blength(*payload),
-    stream);
-  bdestroy(*payload);
-  *payload = NULL;
 
-  assoc_desc->messages_sent++;
+  msg = calloc(1, sizeof(sctp_queued_msg_t));
+  msg->payload = *payload;
+  msg->stream = stream;
+  msg->mme_ue_s1ap_id = mme_ue_s1ap_id;
+  msg->origin_task_id = origin_task_id;
+  *payload = NULL;
+  if (assoc_desc->send_queue_tail == NULL) {
+    assoc_desc->send_queue_head = msg;
+    /*
+     * Let the receiver thread wait for the socket to become writable. If the
+     * pipe is full, a wake up is already pending.
+     */
+    if (write(sctp_desc.wakeup_fd[1], "", 1) < 0 && errno != EAGAIN) {
+      OAILOG_ERROR(LOG_SCTP, "write: %s:%d\n", strerror(errno), errno);
+    }
+  } else {
+    assoc_desc->send_queue_tail->next = msg;
+  }
+  assoc_desc->send_queue_tail = msg;
+  assoc_desc->send_queue_depth++;
+  sctp_desc.send_queue_depth++;
+  sctp_update_send_queue_gauge();
+  pthread_mutex_unlock(&sctp_desc.lock);
   return 0;
 }
 
+//------------------------------------------------------------------------------
+// Sends queued messages until the socket is full again. Called with the lock.
+static void sctp_flush_send_queue(sctp_association_t *assoc_desc)
+{
+  sctp_queued_msg_t *msg = NULL;
+
+  while ((msg = assoc_desc->send_queue_head) != NULL) {
+    int rc = sctp_send_payload(assoc_desc, msg->stream, msg->payload);
+
+    if (rc == SCTP_SEND_WOULD_BLOCK) {
+      break;
+    } else if (rc < 0) {
+      sctp_itti_send_lower_layer_conf(
+        msg->origin_task_id,
+        assoc_desc->assoc_id,
+        msg->stream,
+        msg->mme_ue_s1ap_id,
+        false);
+    }
+    assoc_desc->send_queue_head = msg->next;
+    if (assoc_desc->send_queue_head == NULL) {
+      assoc_desc->send_queue_tail = NULL;
+    }
+    assoc_desc->send_queue_depth--;
+    sctp_desc.send_queue_depth--;
+    bdestroy_wrapper(&msg->payload);
+    free_wrapper((void **) &msg);
+  }
+  sctp_update_send_queue_gauge();
+}
+
+//------------------------------------------------------------------------------
+// Drops the queued messages. Called with the lock, or once TASK_SCTP exits
+// and nobody waits for confirmations anymore.
+static void sctp_free_send_queue(
+  sctp_association_t *assoc_desc,
+  bool notify_senders)
+{
+  sctp_queued_msg_t *msg = NULL;
+
+  if (assoc_desc->send_queue_depth) {
+    OAILOG_DEBUG(
+      LOG_SCTP,
+      "Dropping %u queued messages of assoc id %d\n",
+      assoc_desc->send_queue_depth,
+      assoc_desc->assoc_id);
+    sctp_desc.send_queue_depth -= assoc_desc->send_queue_depth;
+    assoc_desc->send_queue_depth = 0;
+    sctp_update_send_queue_gauge();
+  }
+  while ((msg = assoc_desc->send_queue_head) != NULL) {
+    assoc_desc->send_queue_head = msg->next;
+    if (notify_senders) {
+      // the sender learns about the dropped message like about a failed send
+      sctp_itti_send_lower_layer_conf(
+        msg->origin_task_id,
+        assoc_desc->assoc_id,
+        msg->stream,
+        msg->mme_ue_s1ap_id,
+        false);
+    }
+    bdestroy_wrapper(&msg->payload);
+    free_wrapper((void **) &msg);
+  }
+  assoc_desc->send_queue_tail = NULL;
+}
+
 //------------------------------------------------------------------------------
 static int sctp_create_new_listener(sctp_init_t *init_p)
 {
@@ -627,6 +805,11 @@ void *sctp_receiver_thread(void *args_p)
    */
   fd_set read_fds;
 
+  /*
+   * sockets of associations with queued messages
+   */
+  fd_set write_fds;
+
   if (args_p == NULL) {
     pthread_exit(NULL);
   }
@@ -640,12 +823,24 @@ void *sctp_receiver_thread(void *args_p)
   FD_ZERO(&master);
   FD_ZERO(&read_fds);
   FD_SET(sctp_arg_p.sd, &master);
-  fdmax = sctp_arg_p.sd; /* so far, it's this one */
+  FD_SET(sctp_desc.wakeup_fd[0], &master);
+  fdmax = sctp_arg_p.sd > sctp_desc.wakeup_fd[0] ? sctp_arg_p.sd :
+                                                   sctp_desc.wakeup_fd[0];
 
   while (1) {
     memcpy(&read_fds, &master, sizeof(master));
+    FD_ZERO(&write_fds);
+    pthread_mutex_lock(&sctp_desc.lock);
+    for (sctp_association_t *assoc_desc = sctp_desc.available_connections_head;
+         assoc_desc;
+         assoc_desc = assoc_desc->next_assoc) {
+      if (assoc_desc->send_queue_head && FD_ISSET(assoc_desc->sd, &master)) {
+        FD_SET(assoc_desc->sd, &write_fds);
+      }
+    }
+    pthread_mutex_unlock(&sctp_desc.lock);
 
-    if (select(fdmax + 1, &read_fds, NULL, NULL, NULL) == -1) {
+    if (select(fdmax + 1, &read_fds, &write_fds, NULL, NULL) == -1) {
       OAILOG_ERROR(
         LOG_SCTP, "[%d] Select() error: %s\n", sctp_arg_p.sd, strerror(errno));
       free_wrapper((void **) &args_p);
@@ -655,8 +850,29 @@ void *sctp_receiver_thread(void *args_p)
     }
 
     for (i = 0; i <= fdmax; i++) {
+      if (FD_ISSET(i, &write_fds)) {
+        pthread_mutex_lock(&sctp_desc.lock);
+        for (sctp_association_t *assoc_desc =
+               sctp_desc.available_connections_head;
+             assoc_desc;
+             assoc_desc = assoc_desc->next_assoc) {
+          if (assoc_desc->sd == i) {
+            sctp_flush_send_queue(assoc_desc);
+          }
+        }
+        pthread_mutex_unlock(&sctp_desc.lock);
+      }
+
       if (FD_ISSET(i, &read_fds)) {
-        if (i == sctp_arg_p.sd) {
+        if (i == sctp_desc.wakeup_fd[0]) {
+          /*
+           * A send queue got its first message, the write set is rebuilt
+           * on the next iteration
+           */
+          char buf[64];
+          while (read(i, buf, sizeof(buf)) > 0)
+            ;
+        } else if (i == sctp_arg_p.sd) {
           /*
            * There is data to read on listener socket. This means we have to accept
            * * * * the connection.
@@ -673,6 +889,11 @@ void *sctp_receiver_thread(void *args_p)
             args_p = NULL;
             pthread_exit(NULL);
           } else {
+            /*
+             * Sends never block TASK_SCTP, they are queued instead
+             */
+            fcntl(
+              clientsock, F_SETFL, fcntl(clientsock, F_GETFL) | O_NONBLOCK);
             FD_SET(clientsock, &master); /* add to master set */
 
             if (clientsock > fdmax) {
@@ -755,6 +976,8 @@ static void *sctp_intertask_interface(__attribute__((unused)) void *args_p)
           sctp_send_msg(
             SCTP_DATA_REQ(received_message_p).assoc_id,
             SCTP_DATA_REQ(received_message_p).stream,
+            SCTP_DATA_REQ(received_message_p).mme_ue_s1ap_id,
+            received_message_p->ittiMsgHeader.originTaskId,
             &SCTP_DATA_REQ(received_message_p).payload) < 0) {
           sctp_itti_send_lower_layer_conf(
             received_message_p->ittiMsgHeader.originTaskId,
@@ -810,7 +1033,10 @@ sctp_association_t *add_new_association(
   struct sctp_assoc_change *sctp_assoc_changed)
 {
   sctp_association_t *new_association = NULL;
+
+  pthread_mutex_lock(&sctp_desc.lock);
   if ((new_association = sctp_add_new_peer()) == NULL) {
+    pthread_mutex_unlock(&sctp_desc.lock);
     OAILOG_ERROR(LOG_SCTP, "Failed to allocate new sctp peer \n");
     return NULL;
   }
@@ -824,6 +1050,7 @@ sctp_association_t *add_new_association(
   sctp_get_localaddresses(sd, NULL, NULL);
   sctp_get_peeraddresses(
     sd, &new_association->peer_addresses, &new_association->nb_peer_addresses);
+  pthread_mutex_unlock(&sctp_desc.lock);
 
   if (
     sctp_itti_send_new_association(
@@ -893,6 +1120,13 @@ int sctp_init(const mme_config_t *mme_config_p)
    */
   sctp_desc.nb_instreams = mme_config_p->sctp_config.in_streams;
   sctp_desc.nb_outstreams = mme_config_p->sctp_config.out_streams;
+  pthread_mutex_init(&sctp_desc.lock, NULL);
+  if (pipe(sctp_desc.wakeup_fd) < 0) {
+    OAILOG_ERROR(LOG_SCTP, "pipe: %s:%d\n", strerror(errno), errno);
+    return -1;
+  }
+  fcntl(sctp_desc.wakeup_fd[0], F_SETFL, O_NONBLOCK);
+  fcntl(sctp_desc.wakeup_fd[1], F_SETFL, O_NONBLOCK);
 
   if (itti_create_task(TASK_SCTP, &sctp_intertask_interface, NULL) < 0) {
     OAILOG_ERROR(LOG_SCTP, "create task failed\n");
@@ -932,8 +1166,12 @@ static void sctp_exit(void)
           "sctp_freepaddrs(%p) failed\n",
           sctp_assoc_p->peer_addresses);
     }
+    sctp_free_send_queue(sctp_assoc_p, false);
     free_wrapper((void **) &sctp_assoc_p);
     sctp_desc.number_of_connections--;
+    sctp_assoc_p = next_sctp_assoc_p;
   }
+  close(sctp_desc.wakeup_fd[0]);
+  close(sctp_desc.wakeup_fd[1]);
   OAI_FPRINTF_INFO("TASK_SCTP terminated\n");
 }
@@ -20,20 +20,60 @@
  */
 #define SERVICE303
 
+#include <stdio.h>
+
+#include "intertask_interface.h"
 #include "mme_app_desc.h"
 #include "service303.h"
 
 static void service303_mme_statistics_read(void)
 {
-  size_t label = 0;
-  set_gauge("enb_connected", mme_app_desc.nb_enb_connected, label);
-  set_gauge("ue_registered", mme_app_desc.nb_ue_attached, label);
-  set_gauge("ue_connected", mme_app_desc.nb_ue_connected, label);
+  set_gauge("enb_connected", mme_app_desc.nb_enb_connected, NO_LABELS);
+  set_gauge("ue_registered", mme_app_desc.nb_ue_attached, NO_LABELS);
+  set_gauge("ue_connected", mme_app_desc.nb_ue_connected, NO_LABELS);
+  return;
+}
+
+static void service303_itti_statistics_read(void)
+{
+  memory_pools_handle_t memory_pools = itti_get_memory_pools();
+  memory_pool_stats_t stats;
+  char item_size[16];
+  uint32_t pool;
+  uint64_t allocation_failures;
+  // failures already added to the counter by the previous reads
+  static uint64_t allocation_failures_reported = 0;
+
+  for (pool = 0; pool < memory_pools_number(memory_pools); pool++) {
+    if (memory_pools_get_stats(memory_pools, pool, &stats) != EXIT_SUCCESS) {
+      continue;
+    }
+    snprintf(item_size, sizeof(item_size), "%u", stats.item_size);
+    set_gauge(
+      "itti_pool_items_total", stats.items_total, 1, "item_size", item_size);
+    set_gauge(
+      "itti_pool_items_in_use", stats.items_in_use, 1, "item_size", item_size);
+    set_gauge(
+      "itti_pool_items_high_water",
+      stats.items_high_water,
+      1,
+      "item_size",
+      item_size);
+  }
+  allocation_failures = memory_pools_allocation_failures(memory_pools);
+  if (allocation_failures > allocation_failures_reported) {
+    increment_counter(
+      "itti_pool_allocation_failures",
+      allocation_failures - allocation_failures_reported,
+      NO_LABELS);
+    allocation_failures_reported = allocation_failures;
+  }
   return;
 }
 
 void service303_statistics_read(void)
 {
   service303_mme_statistics_read();
+  service303_itti_statistics_read();
   return;
 }
@@ -321,19 +321,22 @@ int pgw_pcef_emulation_init(const pgw_config_t *const pgw_config_p)
     return RETURNerror;
   }
 
+  // All rules known at startup are installed in a single transaction
+  sdf_id_t sdf_ids[SDF_ID_MAX] = {0};
+  int num_sdf_ids = 0;
   for (int i = 0; i < (SDF_ID_MAX - 1); i++) {
     if (pgw_config_p->pcef.preload_static_sdf_identifiers[i]) {
-      pgw_pcef_emulation_apply_rule(
-        pgw_config_p->pcef.preload_static_sdf_identifiers[i], pgw_config_p);
+      sdf_ids[num_sdf_ids++] =
+        pgw_config_p->pcef.preload_static_sdf_identifiers[i];
     } else
       break;
   }
 
   if (pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier) {
-    pgw_pcef_emulation_apply_rule(
-      pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier,
-      pgw_config_p);
+    sdf_ids[num_sdf_ids++] =
+      pgw_config_p->pcef.automatic_push_dedicated_bearer_sdf_identifier;
   }
+  pgw_pcef_emulation_apply_rules(sdf_ids, num_sdf_ids, pgw_config_p);
 
   return rc;
 }
@@ -352,31 +355,98 @@ void pgw_pcef_emulation_apply_rule(
   const sdf_id_t sdf_id,
   const pgw_config_t *const pgw_config_p)
 {
+  pgw_pcef_emulation_apply_rules(&sdf_id, 1, pgw_config_p);
+}
+
+//------------------------------------------------------------------------------
+// Installs the SDF filters of all given PCC rules with one iptables-restore
+// run: the mangle table is committed once, and either all filters are
+// installed or none. The outcome comes back in ASYNC_SYSTEM_BATCH_RESULT.
+void pgw_pcef_emulation_apply_rules(
+  const sdf_id_t *const sdf_ids,
+  const int num_sdf_ids,
+  const pgw_config_t *const pgw_config_p)
+{
+  static uint32_t next_batch_id = 0;
   pcc_rule_t *pcc_rule = NULL;
-  hashtable_rc_t hrc = hashtable_ts_get(
-    pgw_app.deactivated_predefined_pcc_rules, sdf_id, (void **) &pcc_rule);
+  bstring ruleset = bfromcstralloc(1024, "*mangle\n");
+  int num_rules = 0;
 
-  if (HASH_TABLE_OK == hrc) {
-    if (!pcc_rule->is_activated) {
+  next_batch_id++;
+  for (int i = 0; i < num_sdf_ids; i++) {
+    hashtable_rc_t hrc = hashtable_ts_get(
+      pgw_app.deactivated_predefined_pcc_rules,
+      sdf_ids[i],
+      (void **) &pcc_rule);
+
+    if ((HASH_TABLE_OK == hrc) && (!pcc_rule->is_activated)) {
       OAILOG_INFO(LOG_SPGW_APP, "Loading PCC rule %s\n", bdata(pcc_rule->name));
       pcc_rule->is_activated = true;
+      pcc_rule->batch_id = next_batch_id;
       for (int sdff_i = 0;
            sdff_i < pcc_rule->sdf_template.number_of_packet_filters;
            sdff_i++) {
         pgw_pcef_emulation_apply_sdf_filter(
           &pcc_rule->sdf_template.sdf_filter[sdff_i],
           pcc_rule->sdf_id,
-          pgw_config_p);
+          pgw_config_p,
+          ruleset);
       }
+      num_rules++;
     }
   }
+
+  if (num_rules) {
+    bcatcstr(ruleset, "COMMIT\n");
+    async_system_batch(
+      TASK_SPGW_APP, next_batch_id, "iptables-restore --noflush", &ruleset);
+  } else {
+    bdestroy_wrapper(&ruleset);
+  }
+}
+
+//------------------------------------------------------------------------------
+static bool pgw_pcef_emulation_deactivate_batch(
+  __attribute__((unused)) const hash_key_t keyP,
+  void *const pcc_rule_p,
+  void *batch_id_p,
+  __attribute__((unused)) void **unused_resultP)
+{
+  pcc_rule_t *pcc_rule = (pcc_rule_t *) pcc_rule_p;
+
+  if (
+    (pcc_rule->is_activated) &&
+    (pcc_rule->batch_id == *(uint32_t *) batch_id_p)) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP, "Failed to load PCC rule %s\n", bdata(pcc_rule->name));
+    pcc_rule->is_activated = false;
+  }
+  return false;
 }
 
 //------------------------------------------------------------------------------
+void pgw_pcef_emulation_handle_batch_result(
+  const itti_async_system_batch_result_t *const batch_result)
+{
+  uint32_t batch_id = batch_result->batch_id;
+
+  if (batch_result->rc) {
+    // Nothing of the transaction was applied, the rules can be loaded again
+    hashtable_ts_apply_callback_on_elements(
+      pgw_app.deactivated_predefined_pcc_rules,
+      pgw_pcef_emulation_deactivate_batch,
+      &batch_id,
+      NULL);
+  }
+}
+
+//------------------------------------------------------------------------------
+// Appends the iptables-restore lines marking the traffic of the SDF filter
 void pgw_pcef_emulation_apply_sdf_filter(
   sdf_filter_t *const sdf_f,
   const sdf_id_t sdf_id,
-  const pgw_config_t *const pgw_config_p)
+  const pgw_config_t *const pgw_config_p,
+  bstring ruleset)
 {
   if (
     (TRAFFIC_FLOW_TEMPLATE_BIDIRECTIONAL == sdf_f->direction) ||
@@ -384,54 +454,32 @@ void pgw_pcef_emulation_apply_sdf_filter(
     bstring filter = pgw_pcef_emulation_packet_filter_2_iptable_string(
       &sdf_f->packetfiltercontents, sdf_f->direction);
 
-    bstring marking_command = NULL;
-    if (
-      (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG |
-       TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) &
-      sdf_f->packetfiltercontents.flags) {
-      marking_command = bformat(
-        "iptables -I POSTROUTING -t mangle  %s -j MARK --set-mark %d",
-        bdata(filter),
-        sdf_id);
-    } else {
-      //marking_command = bformat("iptables -I PREROUTING -t mangle --in-interface %s --dest %"PRIu8".%"PRIu8".%"PRIu8".%"PRIu8"/%"PRIu8" %s -j MARK --set-mark %d",
-      marking_command = bformat(
-        "iptables -I POSTROUTING -t mangle  --dest %" PRIu8 ".%" PRIu8
-        ".%" PRIu8 ".%" PRIu8 "/%" PRIu8 " %s -j MARK --set-mark %d",
-        NIPADDR(pgw_config_p->ue_pool_addr[0].s_addr),
-        pgw_config_p->ue_pool_mask[0],
-        bdata(filter),
-        sdf_id);
-    }
-    bdestroy_wrapper(&filter);
-    async_system_command(TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
-
-    // for UE <-> PGW traffic
-    filter = pgw_pcef_emulation_packet_filter_2_iptable_string(
-      &sdf_f->packetfiltercontents, sdf_f->direction);
-
-    marking_command = NULL;
-    if (
-      (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG |
-       TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) &
-      sdf_f->packetfiltercontents.flags) {
-      marking_command = bformat(
-        "iptables -I OUTPUT -t mangle  %s -j MARK --set-mark %d",
-        bdata(filter),
-        sdf_id);
-    } else {
-      marking_command = bformat(
-        "iptables -I OUTPUT -t mangle  --dest %" PRIu8 ".%" PRIu8 ".%" PRIu8
-        ".%" PRIu8 "/%" PRIu8 " %s -j MARK --set-mark %d",
-        NIPADDR(pgw_config_p->ue_pool_addr[0].s_addr),
-        pgw_config_p->ue_pool_mask[0],
-        bdata(filter),
-        sdf_id);
+    // POSTROUTING for forwarded traffic, OUTPUT for UE <-> PGW traffic
+    const char *chains[] = {"POSTROUTING", "OUTPUT"};
+    for (int i = 0; i < 2; i++) {
+      if (
+        (TRAFFIC_FLOW_TEMPLATE_IPV4_REMOTE_ADDR_FLAG |
+         TRAFFIC_FLOW_TEMPLATE_IPV6_REMOTE_ADDR_FLAG) &
+        sdf_f->packetfiltercontents.flags) {
+        bformata(
+          ruleset,
+          "-I %s %s -j MARK --set-mark %d\n",
+          chains[i],
+          bdata(filter),
+          sdf_id);
+      } else {
+        bformata(
+          ruleset,
+          "-I %s --dest %" PRIu8 ".%" PRIu8 ".%" PRIu8 ".%" PRIu8 "/%" PRIu8
+          " %s -j MARK --set-mark %d\n",
+          chains[i],
+          NIPADDR(pgw_config_p->ue_pool_addr[0].s_addr),
+          pgw_config_p->ue_pool_mask[0],
+          bdata(filter),
+          sdf_id);
+      }
     }
     bdestroy_wrapper(&filter);
-    async_system_command(TASK_ASYNC_SYSTEM, false, bdata(marking_command));
-    bdestroy_wrapper(&marking_command);
   }
 }
 
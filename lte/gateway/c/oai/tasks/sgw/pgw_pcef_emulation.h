@@ -88,20 +88,29 @@ typedef struct pcc_rule_s {
   sdf_template_t sdf_template;
   bearer_qos_t bearer_qos;
   uint32_t precedence;
+  uint32_t batch_id; // iptables-restore transaction that installed the rule
   STAILQ_ENTRY(pcc_rule_s) entries;
 } pcc_rule_t;
 
 struct pgw_config_s;
+struct itti_async_system_batch_result_s;
 
 int pgw_pcef_emulation_init(const struct pgw_config_s *const pgw_config_p);
 void pgw_pcef_emulation_exit(void);
 void pgw_pcef_emulation_apply_rule(
   const sdf_id_t sdf_id,
   const struct pgw_config_s *const pgw_config_p);
+void pgw_pcef_emulation_apply_rules(
+  const sdf_id_t *const sdf_ids,
+  const int num_sdf_ids,
+  const struct pgw_config_s *const pgw_config_p);
 void pgw_pcef_emulation_apply_sdf_filter(
   sdf_filter_t *const sdf_f,
   const sdf_id_t sdf_id,
-  const struct pgw_config_s *const pgw_config_p);
+  const struct pgw_config_s *const pgw_config_p,
+  bstring ruleset);
+void pgw_pcef_emulation_handle_batch_result(
+  const struct itti_async_system_batch_result_s *const batch_result);
 bstring pgw_pcef_emulation_packet_filter_2_iptable_string(
   packet_filter_contents_t *const packetfiltercontents,
   uint8_t direction);
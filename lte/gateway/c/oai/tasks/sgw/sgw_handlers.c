@@ -52,6 +52,7 @@
 #include "mme_config.h"
 #include "sgw_defs.h"
 #include "sgw_handlers.h"
+#include "sgw_paging.h"
 #include "sgw_context_manager.h"
 #include "sgw.h"
 #include "pgw_pco.h"
@@ -411,6 +412,12 @@ int sgw_handle_sgi_endpoint_created(
         "Mismatch in lengths"); // sceptic mode
       memcpy(&eps_bearer_ctxt_p->paa, &resp_pP->paa, sizeof(paa_t));
       memcpy(&create_session_response_p->paa, &resp_pP->paa, sizeof(paa_t));
+      if (resp_pP->paa.pdn_type != IPv6) {
+        sgw_paging_add_ue_ip(
+          &resp_pP->paa.ipv4_address,
+          (char *) new_bearer_ctxt_info_p->sgw_eps_bearer_context_information
+            .imsi.digit);
+      }
       copy_protocol_configuration_options(
         &create_session_response_p->pco, &resp_pP->pco);
       clear_protocol_configuration_options(&resp_pP->pco);
@@ -1113,6 +1120,7 @@ int sgw_handle_sgi_endpoint_deleted(
       switch (resp_pP->paa.pdn_type) {
         case IPv4:
           inaddr = resp_pP->paa.ipv4_address;
+          sgw_paging_remove_ue_ip(&inaddr);
           if (!release_ue_ipv4_address(imsi, &inaddr)) {
             OAILOG_DEBUG(LOG_SPGW_APP, "Released IPv4 PAA for PDN type IPv4\n");
           } else {
@@ -1128,6 +1136,7 @@ int sgw_handle_sgi_endpoint_deleted(
 
         case IPv4_AND_v6:
           inaddr = resp_pP->paa.ipv4_address;
+          sgw_paging_remove_ue_ip(&inaddr);
           if (!release_ue_ipv4_address(imsi, &inaddr)) {
             OAILOG_DEBUG(
               LOG_SPGW_APP, "Released IPv4 PAA for PDN type IPv4_AND_v6\n");
@@ -1541,6 +1550,77 @@ static void sgw_release_all_enb_related_information(
   OAILOG_FUNC_OUT(LOG_SPGW_APP);
 }
 
+//------------------------------------------------------------------------------
+static bool sgw_find_eps_bearer_by_s1u_teids(
+  const hash_key_t keyP,
+  void *const dataP,
+  void *parameterP,
+  void **resultP)
+{
+  const Gtpv1uTunnelFailureInd *const failure_p = parameterP;
+  s_plus_p_gw_eps_bearer_context_information_t *ctx_p = dataP;
+
+  for (int ebx = 0; ebx < BEARERS_PER_UE; ebx++) {
+    sgw_eps_bearer_ctxt_t *eps_bearer_ctxt =
+      ctx_p->sgw_eps_bearer_context_information.pdn_connection
+        .sgw_eps_bearers_array[ebx];
+    if (
+      eps_bearer_ctxt &&
+      (eps_bearer_ctxt->s_gw_teid_S1u_S12_S4_up == failure_p->sgw_S1u_teid) &&
+      (eps_bearer_ctxt->enb_teid_S1u == failure_p->enb_S1u_teid)) {
+      *resultP = eps_bearer_ctxt;
+      return true;
+    }
+  }
+  return false;
+}
+
+//------------------------------------------------------------------------------
+int sgw_handle_gtpv1uTunnelFailureInd(
+  const Gtpv1uTunnelFailureInd *const failure_p)
+{
+  OAILOG_FUNC_IN(LOG_SPGW_APP);
+  sgw_eps_bearer_ctxt_t *eps_bearer_ctxt = NULL;
+
+  OAILOG_ERROR(
+    LOG_SPGW_APP,
+    "Datapath failed to %s tunnel " TEID_FMT " (eNB) <-> (SGW) " TEID_FMT
+    ": %s\n",
+    failure_p->is_delete ? "delete" : "add",
+    failure_p->enb_S1u_teid,
+    failure_p->sgw_S1u_teid,
+    strerror(failure_p->error));
+  increment_counter(
+    "spgw_tunnel_failure",
+    1,
+    1,
+    "action",
+    failure_p->is_delete ? "delete" : "add");
+
+  if (failure_p->is_delete) {
+    // The bearer is already gone, nothing is left to clean up in the SGW
+    OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNok);
+  }
+
+  // Only the bearer still using the failed tunnel is cleaned up, a later
+  // change of its eNB TEID went to the datapath on its own
+  hashtable_ts_apply_callback_on_elements(
+    sgw_app.s11_bearer_context_information_hashtable,
+    sgw_find_eps_bearer_by_s1u_teids,
+    (void *) failure_p,
+    (void **) &eps_bearer_ctxt);
+  if (eps_bearer_ctxt) {
+    // No downlink path exists: forget the eNB side as on S1 release, so the
+    // next Modify Bearer Request of the UE sets the tunnel up again
+    OAILOG_WARNING(
+      LOG_SPGW_APP,
+      "Releasing eNB information of EPS bearer id %u\n",
+      eps_bearer_ctxt->eps_bearer_id);
+    sgw_release_all_enb_related_information(eps_bearer_ctxt);
+  }
+  OAILOG_FUNC_RETURN(LOG_SPGW_APP, RETURNok);
+}
+
 /* From GPP TS 23.401 version 11.11.0 Release 11, section 5.3.5 S1 release procedure:
    The S-GW releases all eNodeB related information (address and TEIDs) for the UE and responds with a Release
    Access Bearers Response message to the MME. Other elements of the UE's S-GW context are not affected. The
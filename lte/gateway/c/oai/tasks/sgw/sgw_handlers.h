@@ -41,6 +41,8 @@ int sgw_handle_gtpv1uUpdateTunnelResp(
   const Gtpv1uUpdateTunnelResp *const endpoint_updated_p);
 int sgw_handle_gtpv1uDeleteTunnelResp(
   const Gtpv1uDeleteTunnelResp *const endpoint_deleted_p);
+int sgw_handle_gtpv1uTunnelFailureInd(
+  const Gtpv1uTunnelFailureInd *const failure_p);
 int sgw_handle_modify_bearer_request(
   const itti_s11_modify_bearer_request_t *const modify_bearer_p);
 int sgw_handle_delete_session_request(
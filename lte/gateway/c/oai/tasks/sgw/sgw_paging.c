@@ -21,23 +21,109 @@
 
 #include <netinet/ip.h>
 #include <arpa/inet.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "3gpp_23.003.h"
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "dynamic_memory_check.h"
+#include "hashtable.h"
 #include "intertask_interface.h"
 #include "log.h"
-#include "rpc_client.h"
 #include "sgw_paging.h"
 
+#define SGW_UE_IP_INDEX_SIZE 4096
+
+/*
+ * Index of UE IPv4 address to IMSI, for all PDN connections of the SGW.
+ * It is written by the SPGW task and read on paging packet-ins by the
+ * OpenFlow controller thread, so IMSIs are copied out under the read lock.
+ * Keys are host byte order addresses, so that consecutive UE addresses land
+ * in different buckets.
+ */
+static pthread_rwlock_t ue_ip_index_lock = PTHREAD_RWLOCK_INITIALIZER;
+static hash_table_t *ue_ip_index = NULL;
+
+int sgw_paging_init(void)
+{
+  bstring b = bfromcstr("sgw_ue_ip_imsi_hashtable");
+  pthread_rwlock_wrlock(&ue_ip_index_lock);
+  ue_ip_index = hashtable_create(SGW_UE_IP_INDEX_SIZE, NULL, NULL, b);
+  pthread_rwlock_unlock(&ue_ip_index_lock);
+  bdestroy_wrapper(&b);
+  if (ue_ip_index == NULL) {
+    OAILOG_ERROR(LOG_SPGW_APP, "Failed to create UE IP index\n");
+    return RETURNerror;
+  }
+  return RETURNok;
+}
+
+void sgw_paging_exit(void)
+{
+  pthread_rwlock_wrlock(&ue_ip_index_lock);
+  if (ue_ip_index) {
+    hashtable_destroy(ue_ip_index);
+    ue_ip_index = NULL;
+  }
+  pthread_rwlock_unlock(&ue_ip_index_lock);
+}
+
+void sgw_paging_add_ue_ip(const struct in_addr *ue_ip, const char *imsi)
+{
+  char *imsi_copy = calloc(1, IMSI_BCD_DIGITS_MAX + 1);
+  strncpy(imsi_copy, imsi, IMSI_BCD_DIGITS_MAX);
+
+  pthread_rwlock_wrlock(&ue_ip_index_lock);
+  hashtable_rc_t rc =
+    hashtable_insert(ue_ip_index, ntohl(ue_ip->s_addr), imsi_copy);
+  pthread_rwlock_unlock(&ue_ip_index_lock);
+  if (rc != HASH_TABLE_OK && rc != HASH_TABLE_INSERT_OVERWRITTEN_DATA) {
+    OAILOG_ERROR(
+      LOG_SPGW_APP, "Failed to index UE IP for IMSI%s: %d\n", imsi, rc);
+    free_wrapper((void **) &imsi_copy);
+  }
+}
+
+void sgw_paging_remove_ue_ip(const struct in_addr *ue_ip)
+{
+  pthread_rwlock_wrlock(&ue_ip_index_lock);
+  hashtable_free(ue_ip_index, ntohl(ue_ip->s_addr));
+  pthread_rwlock_unlock(&ue_ip_index_lock);
+}
+
+/*
+ * Copy the IMSI of the UE that has the given IP address into imsi, which
+ * must hold IMSI_BCD_DIGITS_MAX + 1 chars
+ */
+static bool get_imsi_from_ue_ip(const struct in_addr *ue_ip, char *imsi)
+{
+  char *indexed_imsi = NULL;
+  bool found = false;
+
+  pthread_rwlock_rdlock(&ue_ip_index_lock);
+  if (
+    hashtable_get(
+      ue_ip_index, ntohl(ue_ip->s_addr), (void **) &indexed_imsi) ==
+    HASH_TABLE_OK) {
+    memcpy(imsi, indexed_imsi, IMSI_BCD_DIGITS_MAX + 1);
+    found = true;
+  }
+  pthread_rwlock_unlock(&ue_ip_index_lock);
+  return found;
+}
+
 int sgw_send_paging_request(const struct in_addr *dest_ip)
 {
-  char *imsi;
-  int ret = get_subscriber_id_from_ipv4(dest_ip, &imsi);
-  if (ret > 0) {
+  char imsi[IMSI_BCD_DIGITS_MAX + 1];
+  if (!get_imsi_from_ue_ip(dest_ip, imsi)) {
     char ip_str[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &(dest_ip->s_addr), ip_str, INET_ADDRSTRLEN);
     OAILOG_ERROR(
       TASK_SPGW_APP, "Subscriber could not be found for ip %s\n", ip_str);
-    return ret;
+    return RETURNerror;
   }
   OAILOG_DEBUG(TASK_SPGW_APP, "Paging procedure initiated for IMSI%s\n", imsi);
   MessageDef *message_p = NULL;
@@ -47,8 +133,6 @@ int sgw_send_paging_request(const struct in_addr *dest_ip)
   paging_request_p = &message_p->ittiMsg.s11_paging_request;
   memset((void *) paging_request_p, 0, sizeof(itti_s11_paging_request_t));
   paging_request_p->imsi = strdup(imsi);
-  free(imsi);
 
-  ret = itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
-  return ret;
+  return itti_send_msg_to_task(TASK_MME_APP, INSTANCE_DEFAULT, message_p);
 }
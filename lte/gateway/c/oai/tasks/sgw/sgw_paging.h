@@ -22,6 +22,24 @@
 #define FILE_SGW_PAGING_SEEN
 #include <netinet/ip.h>
 
+int sgw_paging_init(void);
+void sgw_paging_exit(void);
+
+/*
+ * Index the IMSI of a UE by its IPv4 address, replacing any UE that had the
+ * address before. Called when the UE's PDN connection is created
+ */
+void sgw_paging_add_ue_ip(const struct in_addr *ue_ip, const char *imsi);
+
+/*
+ * Remove a UE IPv4 address from the index, when it is released
+ */
+void sgw_paging_remove_ue_ip(const struct in_addr *ue_ip);
+
+/*
+ * Send a paging request to the MME for the UE that has the given IPv4
+ * address. The UE is looked up in the local index, so this does not block
+ */
 int sgw_send_paging_request(const struct in_addr *dest_ip);
 
 #endif
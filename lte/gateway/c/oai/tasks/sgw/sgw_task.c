@@ -53,14 +53,17 @@
 #include "mme_config.h"
 #include "sgw_defs.h"
 #include "sgw_handlers.h"
+#include "sgw_paging.h"
 #include "sgw.h"
 #include "spgw_config.h"
 #include "pgw_ue_ip_address_alloc.h"
+#include "gtpv1u.h"
 
 spgw_config_t spgw_config;
 sgw_app_t sgw_app;
 
 extern __pid_t g_pid;
+extern const struct gtp_tunnel_ops *gtp_tunnel_ops;
 
 static void sgw_exit(void);
 
@@ -72,7 +75,17 @@ static void *sgw_intertask_interface(void *args_p)
   while (1) {
     MessageDef *received_message_p = NULL;
 
-    itti_receive_msg(TASK_SPGW_APP, &received_message_p);
+    itti_try_receive_msg(TASK_SPGW_APP, &received_message_p);
+    if (!received_message_p) {
+      // Tunnel changes of the messages handled so far are sent to the
+      // datapath together, once there is no message left to handle. Their
+      // failures come back as GTPV1U_TUNNEL_FAILURE_IND, no handler waits for
+      // them.
+      if (gtp_tunnel_ops && gtp_tunnel_ops->flush) {
+        gtp_tunnel_ops->flush();
+      }
+      itti_receive_msg(TASK_SPGW_APP, &received_message_p);
+    }
 
     switch (ITTI_MSG_ID(received_message_p)) {
       case GTPV1U_CREATE_TUNNEL_RESP: {
@@ -147,6 +160,16 @@ static void *sgw_intertask_interface(void *args_p)
           &received_message_p->ittiMsg.s5_create_bearer_response);
       } break;
 
+      case GTPV1U_TUNNEL_FAILURE_IND: {
+        sgw_handle_gtpv1uTunnelFailureInd(
+          &received_message_p->ittiMsg.gtpv1uTunnelFailureInd);
+      } break;
+
+      case ASYNC_SYSTEM_BATCH_RESULT: {
+        pgw_pcef_emulation_handle_batch_result(
+          &received_message_p->ittiMsg.async_system_batch_result);
+      } break;
+
       case TERMINATE_MESSAGE: {
         sgw_exit();
         itti_exit_task();
@@ -181,6 +204,11 @@ int sgw_init(spgw_config_t *spgw_config_pP)
 
   pgw_ip_address_pool_init();
 
+  if (sgw_paging_init() != RETURNok) {
+    OAILOG_ALERT(LOG_SPGW_APP, "Initializing SPGW-APP task interface: ERROR\n");
+    return RETURNerror;
+  }
+
   bstring b = bfromcstr("sgw_s11teid2mme_hashtable");
   sgw_app.s11teid2mme_hashtable = hashtable_ts_create(512, NULL, NULL, b);
   btrunc(b, 0);
@@ -260,4 +288,5 @@ static void sgw_exit(void)
   if (sgw_app.s11_bearer_context_information_hashtable) {
     hashtable_ts_destroy(sgw_app.s11_bearer_context_information_hashtable);
   }
+  sgw_paging_exit();
 }
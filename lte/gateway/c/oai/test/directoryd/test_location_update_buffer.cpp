@@ -0,0 +1,75 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <gtest/gtest.h>
+#include "LocationUpdateBuffer.h"
+
+using namespace magma;
+
+namespace {
+
+TEST(LocationUpdateBufferTest, TestLastChangeWins)
+{
+  LocationUpdateBuffer buffer(10);
+  EXPECT_TRUE(buffer.add_update(IMSI_TO_HWID, "IMSI1", "GW_ID"));
+  EXPECT_TRUE(buffer.add_delete(IMSI_TO_HWID, "IMSI1"));
+  EXPECT_TRUE(buffer.add_delete(IMSI_TO_HWID, "IMSI2"));
+  EXPECT_TRUE(buffer.add_update(IMSI_TO_HWID, "IMSI2", "GW_ID2"));
+  EXPECT_EQ(buffer.size(), 2);
+
+  auto updates = buffer.take_all();
+  ASSERT_EQ(updates.size(), 2);
+  EXPECT_EQ(updates[0].id, "IMSI1");
+  EXPECT_TRUE(updates[0].is_delete);
+  EXPECT_EQ(updates[1].id, "IMSI2");
+  EXPECT_FALSE(updates[1].is_delete);
+  EXPECT_EQ(updates[1].location, "GW_ID2");
+
+  EXPECT_EQ(buffer.size(), 0);
+  EXPECT_TRUE(buffer.take_all().empty());
+}
+
+TEST(LocationUpdateBufferTest, TestTablesAreSeparate)
+{
+  LocationUpdateBuffer buffer(10);
+  buffer.add_update(IMSI_TO_HWID, "IMSI1", "GW_ID");
+  buffer.add_delete(HWID_TO_HOSTNAME, "IMSI1");
+  EXPECT_EQ(buffer.take_all().size(), 2);
+}
+
+TEST(LocationUpdateBufferTest, TestBounded)
+{
+  LocationUpdateBuffer buffer(2);
+  EXPECT_TRUE(buffer.add_update(IMSI_TO_HWID, "IMSI1", "GW_ID"));
+  EXPECT_TRUE(buffer.add_update(IMSI_TO_HWID, "IMSI2", "GW_ID"));
+  EXPECT_FALSE(buffer.add_update(IMSI_TO_HWID, "IMSI3", "GW_ID"));
+  // records already pending can still change
+  EXPECT_TRUE(buffer.add_delete(IMSI_TO_HWID, "IMSI2"));
+  EXPECT_EQ(buffer.take_all().size(), 2);
+  EXPECT_TRUE(buffer.add_update(IMSI_TO_HWID, "IMSI3", "GW_ID"));
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,260 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "itti_trace.h"
+}
+
+using ::testing::Test;
+
+namespace {
+
+const char *const task_names[] = {"TASK_A", "TASK_B"};
+const char *const message_names[] = {"MSG_0", "MSG_1", "MSG_2"};
+
+const uint32_t NB_RECORDS = 16;
+const uint32_t PAYLOAD_SIZE = 4;
+
+struct trace_thread_t {
+  itti_trace_thread_header_t header;
+  std::vector<itti_trace_record_t> records;
+  std::vector<uint8_t> payloads;
+};
+
+// Read back a dump, following the layout described in itti_trace.h
+class TraceReader {
+ public:
+  explicit TraceReader(FILE *file) : file_(file) {}
+
+  bool read(
+    itti_trace_file_header_t *header,
+    std::vector<std::string> *names,
+    std::vector<trace_thread_t> *threads)
+  {
+    if (!read_bytes(header, sizeof(*header))) return false;
+    for (uint32_t i = 0; i < header->nb_tasks + header->nb_messages; i++) {
+      uint16_t length;
+      char name[256];
+      if (!read_bytes(&length, sizeof(length))) return false;
+      if (!read_bytes(name, length)) return false;
+      names->emplace_back(name, length);
+    }
+    for (uint32_t i = 0; i < header->nb_threads; i++) {
+      trace_thread_t thread;
+      if (!read_bytes(&thread.header, sizeof(thread.header))) return false;
+      thread.records.resize(thread.header.nb_records);
+      thread.payloads.resize(thread.header.nb_records * header->payload_size);
+      if (!read_bytes(
+            thread.records.data(),
+            thread.records.size() * sizeof(itti_trace_record_t))) {
+        return false;
+      }
+      if (!read_bytes(thread.payloads.data(), thread.payloads.size())) {
+        return false;
+      }
+      threads->push_back(thread);
+    }
+    return true;
+  }
+
+ private:
+  FILE *file_;
+
+  bool read_bytes(void *buffer, size_t length)
+  {
+    return length == 0 || fread(buffer, length, 1, file_) == 1;
+  }
+};
+
+void dump(
+  itti_trace_file_header_t *header,
+  std::vector<std::string> *names,
+  std::vector<trace_thread_t> *threads)
+{
+  FILE *file = tmpfile();
+  ASSERT_NE(file, nullptr);
+  ASSERT_EQ(itti_trace_dump_fd(fileno(file)), 0);
+  rewind(file);
+  ASSERT_TRUE(TraceReader(file).read(header, names, threads));
+  fclose(file);
+}
+
+// The trace is process wide, so every test runs its messages on new threads
+// and looks up its own rings by thread name
+const trace_thread_t *find_thread(
+  const std::vector<trace_thread_t> &threads,
+  const char *name)
+{
+  for (const auto &thread : threads) {
+    if (strcmp(thread.header.name, name) == 0) return &thread;
+  }
+  return nullptr;
+}
+
+void run_named(const char *name, std::function<void()> body)
+{
+  std::thread thread([name, body]() {
+    pthread_setname_np(pthread_self(), name);
+    body();
+  });
+  thread.join();
+}
+
+class IttiTraceTest : public ::testing::Test {
+ protected:
+  static void SetUpTestCase()
+  {
+    ASSERT_EQ(
+      itti_trace_init(
+        NB_RECORDS - 1,
+        PAYLOAD_SIZE,
+        "/dev/null",
+        2,
+        task_names,
+        3,
+        message_names),
+      0);
+  }
+};
+
+TEST_F(IttiTraceTest, TestHeaderAndNames)
+{
+  itti_trace_file_header_t header;
+  std::vector<std::string> names;
+  std::vector<trace_thread_t> threads;
+
+  dump(&header, &names, &threads);
+  EXPECT_EQ(header.magic, ITTI_TRACE_MAGIC);
+  EXPECT_EQ(header.version, ITTI_TRACE_VERSION);
+  EXPECT_EQ(header.record_size, sizeof(itti_trace_record_t));
+  EXPECT_EQ(header.payload_size, PAYLOAD_SIZE);
+  ASSERT_EQ(names.size(), 5);
+  EXPECT_EQ(names[1], "TASK_B");
+  EXPECT_EQ(names[4], "MSG_2");
+}
+
+TEST_F(IttiTraceTest, TestRecords)
+{
+  run_named("records", []() {
+    uint32_t payload = 0x04030201;
+    itti_trace_message(ITTI_TRACE_RECEIVE, 7, 1, 0, 1, 40, &payload);
+    itti_trace_set_ue(12, 34);
+    itti_trace_message(ITTI_TRACE_SEND, 8, 2, 1, 0, 2, &payload);
+    // receiving the next message clears the UE
+    itti_trace_message(ITTI_TRACE_RECEIVE, 9, 1, 0, 1, 0, nullptr);
+  });
+
+  itti_trace_file_header_t header;
+  std::vector<std::string> names;
+  std::vector<trace_thread_t> threads;
+  dump(&header, &names, &threads);
+
+  auto thread = find_thread(threads, "records");
+  ASSERT_NE(thread, nullptr);
+  ASSERT_EQ(thread->header.nb_records, 3);
+  EXPECT_EQ(thread->header.nb_lost, 0);
+
+  const auto &records = thread->records;
+  EXPECT_EQ(records[0].event, ITTI_TRACE_RECEIVE);
+  EXPECT_EQ(records[0].message_number, 7);
+  EXPECT_EQ(records[0].size, 40);
+  EXPECT_EQ(records[0].mme_ue_s1ap_id, 0);
+  EXPECT_EQ(records[0].payload_length, PAYLOAD_SIZE);
+  EXPECT_EQ(thread->payloads[0], 0x01);
+  EXPECT_EQ(thread->payloads[3], 0x04);
+
+  EXPECT_EQ(records[1].event, ITTI_TRACE_SEND);
+  EXPECT_EQ(records[1].message_id, 2);
+  EXPECT_EQ(records[1].origin_task, 1);
+  EXPECT_EQ(records[1].destination_task, 0);
+  EXPECT_EQ(records[1].enb_ue_s1ap_id, 12);
+  EXPECT_EQ(records[1].mme_ue_s1ap_id, 34);
+  EXPECT_EQ(records[1].payload_length, 2);
+  EXPECT_LE(records[0].timestamp_ns, records[1].timestamp_ns);
+
+  EXPECT_EQ(records[2].mme_ue_s1ap_id, 0);
+  EXPECT_EQ(records[2].payload_length, 0);
+}
+
+TEST_F(IttiTraceTest, TestRingKeepsLastRecords)
+{
+  run_named("wrap", []() {
+    for (uint32_t i = 0; i < 3 * NB_RECORDS + 5; i++) {
+      itti_trace_message(ITTI_TRACE_SEND, i, 0, 0, 1, 0, nullptr);
+    }
+  });
+
+  itti_trace_file_header_t header;
+  std::vector<std::string> names;
+  std::vector<trace_thread_t> threads;
+  dump(&header, &names, &threads);
+
+  auto thread = find_thread(threads, "wrap");
+  ASSERT_NE(thread, nullptr);
+  // the ring size is rounded up to a power of 2, and the slot the thread
+  // would write next is never dumped
+  ASSERT_EQ(thread->header.nb_records, NB_RECORDS - 1);
+  EXPECT_EQ(thread->header.nb_lost, 2 * NB_RECORDS + 6);
+  for (uint32_t i = 0; i < NB_RECORDS - 1; i++) {
+    EXPECT_EQ(thread->records[i].message_number, 2 * NB_RECORDS + 6 + i);
+  }
+}
+
+TEST_F(IttiTraceTest, TestDumpWhileRecording)
+{
+  std::atomic<bool> done(false);
+  std::thread writer([&done]() {
+    pthread_setname_np(pthread_self(), "concurrent");
+    for (uint32_t i = 0; !done; i++) {
+      itti_trace_message(ITTI_TRACE_SEND, i, 0, 0, 1, 0, nullptr);
+    }
+  });
+
+  for (int n = 0; n < 100; n++) {
+    itti_trace_file_header_t header;
+    std::vector<std::string> names;
+    std::vector<trace_thread_t> threads;
+    dump(&header, &names, &threads);
+
+    auto thread = find_thread(threads, "concurrent");
+    if (!thread) continue;
+    // records that were overwritten during the dump are left out, the
+    // remaining ones are consecutive
+    for (uint32_t i = 1; i < thread->header.nb_records; i++) {
+      ASSERT_EQ(
+        thread->records[i].message_number,
+        thread->records[i - 1].message_number + 1);
+    }
+  }
+  done = true;
+  writer.join();
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "memory_pools.h"
+}
+
+using ::testing::Test;
+
+namespace {
+
+class MemoryPoolsTest : public ::testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    pools = memory_pools_create(3);
+    memory_pools_add_pool(pools, 100, 50);
+    memory_pools_add_pool(pools, 100, 100);
+    memory_pools_add_pool(pools, 10, 1000);
+  }
+
+  void *allocate(uint32_t size)
+  {
+    void *ptr = memory_pools_allocate(pools, size, 0, 0);
+    EXPECT_TRUE(ptr != NULL);
+    // the whole requested size must be writable
+    memset(ptr, 0xab, size);
+    return ptr;
+  }
+
+  memory_pool_stats_t get_stats(uint32_t pool)
+  {
+    memory_pool_stats_t stats;
+    EXPECT_EQ(EXIT_SUCCESS, memory_pools_get_stats(pools, pool, &stats));
+    return stats;
+  }
+
+ protected:
+  memory_pools_handle_t pools;
+};
+
+/*
+ * Allocations go to the smallest pool they fit in, with item sizes rounded
+ * up to 8 bytes
+ */
+TEST_F(MemoryPoolsTest, TestSizeClasses)
+{
+  void *small = allocate(56);
+  void *medium = allocate(57);
+  void *large = allocate(1000);
+
+  EXPECT_EQ(1, get_stats(0).items_in_use);
+  EXPECT_EQ(1, get_stats(1).items_in_use);
+  EXPECT_EQ(1, get_stats(2).items_in_use);
+
+  memory_pools_free(pools, small, 0);
+  memory_pools_free(pools, medium, 0);
+  memory_pools_free(pools, large, 0);
+  EXPECT_EQ(0, get_stats(0).items_in_use);
+  EXPECT_EQ(1, get_stats(0).items_high_water);
+}
+
+/*
+ * Pools grow past their preallocated items, and allocations fail once they
+ * reach the memory limit
+ */
+TEST_F(MemoryPoolsTest, TestGrowthAndLimit)
+{
+  std::vector<void *> items;
+  for (int i = 0; i < 20; i++) {
+    items.push_back(allocate(1000));
+  }
+  EXPECT_GE(get_stats(2).items_total, 20);
+  EXPECT_EQ(0, memory_pools_allocation_failures(pools));
+
+  memory_pools_set_memory_limit(pools, 1);
+  EXPECT_TRUE(memory_pools_under_pressure(pools));
+  // bigger than any pool
+  EXPECT_TRUE(memory_pools_allocate(pools, 5000, 0, 0) == NULL);
+  EXPECT_EQ(1, memory_pools_allocation_failures(pools));
+
+  // the free items are still handed out, but the pool doesn't grow
+  uint32_t items_total = get_stats(2).items_total;
+  while (get_stats(2).items_in_use < items_total) {
+    items.push_back(allocate(1000));
+  }
+  EXPECT_TRUE(memory_pools_allocate(pools, 1000, 0, 0) == NULL);
+  EXPECT_EQ(2, memory_pools_allocation_failures(pools));
+  EXPECT_EQ(items_total, get_stats(2).items_total);
+
+  for (auto item : items) {
+    memory_pools_free(pools, item, 0);
+  }
+  EXPECT_EQ(0, get_stats(2).items_in_use);
+  EXPECT_TRUE(memory_pools_allocate(pools, 1000, 0, 0) != NULL);
+}
+
+/*
+ * Items allocated on one thread can be freed on another
+ */
+TEST_F(MemoryPoolsTest, TestMultiThread)
+{
+  std::vector<void *> items[4];
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 1000; i++) {
+        items[t].push_back(allocate(i % 2 ? 40 : 90));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  EXPECT_EQ(2000, get_stats(0).items_in_use);
+  EXPECT_EQ(2000, get_stats(1).items_in_use);
+
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t]() {
+      for (auto item : items[(t + 1) % 4]) {
+        memory_pools_free(pools, item, 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, get_stats(0).items_in_use);
+  EXPECT_EQ(0, get_stats(1).items_in_use);
+  EXPECT_EQ(0, memory_pools_allocation_failures(pools));
+}
+
+} // namespace
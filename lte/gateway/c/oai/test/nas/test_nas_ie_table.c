@@ -0,0 +1,636 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bstrlib.h"
+#include "TLVDecoder.h"
+
+#include "AttachRequest.h"
+#include "TrackingAreaUpdateRequest.h"
+#include "PdnConnectivityRequest.h"
+
+#define TEST_MAX_MESSAGE_LENGTH 512
+
+typedef int (*test_msg_codec_t)(void *msg, uint8_t *buffer, uint32_t len);
+
+/*
+ * A message type decoded through an IE table
+ */
+typedef struct test_codec_s {
+  size_t msg_size;
+  size_t presencemask_offset;
+  uint32_t mandatory_length;
+  test_msg_codec_t decode;
+  test_msg_codec_t encode;
+  void (*free_msg)(void *msg);
+} test_codec_t;
+
+/*
+ * An encoded message, and the golden result of decoding it: the value the
+ * decoder returns, the presencemask, the encoding of the decoded message and
+ * the values of some of its fields
+ */
+typedef struct test_fixture_s {
+  const char *name;
+  const test_codec_t *codec;
+  const uint8_t *encoded;
+  uint32_t length;
+  int decoded;
+  uint32_t presencemask;
+  const uint8_t *reencoded;
+  uint32_t reencoded_length;
+  void (*check)(const void *msg);
+} test_fixture_t;
+
+#define TEST_BUFFER(buffer) buffer, sizeof(buffer)
+
+//------------------------------------------------------------------------------
+static int test_decode_attach_request(void *msg, uint8_t *buffer, uint32_t len)
+{
+  return decode_attach_request((attach_request_msg *) msg, buffer, len);
+}
+
+static int test_encode_attach_request(void *msg, uint8_t *buffer, uint32_t len)
+{
+  return encode_attach_request((attach_request_msg *) msg, buffer, len);
+}
+
+static void test_free_attach_request(void *msg)
+{
+  attach_request_msg *attach_request = (attach_request_msg *) msg;
+
+  bdestroy_wrapper(&attach_request->esmmessagecontainer);
+  bdestroy_wrapper(&attach_request->supportedcodecs);
+}
+
+static int test_decode_tau_request(void *msg, uint8_t *buffer, uint32_t len)
+{
+  return decode_tracking_area_update_request(
+    (tracking_area_update_request_msg *) msg, buffer, len);
+}
+
+static int test_encode_tau_request(void *msg, uint8_t *buffer, uint32_t len)
+{
+  return encode_tracking_area_update_request(
+    (tracking_area_update_request_msg *) msg, buffer, len);
+}
+
+static void test_free_tau_request(void *msg)
+{
+  tracking_area_update_request_msg *tau_request =
+    (tracking_area_update_request_msg *) msg;
+
+  bdestroy_wrapper(&tau_request->supportedcodecs);
+}
+
+static int test_decode_pdn_connectivity_request(
+  void *msg,
+  uint8_t *buffer,
+  uint32_t len)
+{
+  return decode_pdn_connectivity_request(
+    (pdn_connectivity_request_msg *) msg, buffer, len);
+}
+
+static int test_encode_pdn_connectivity_request(
+  void *msg,
+  uint8_t *buffer,
+  uint32_t len)
+{
+  return encode_pdn_connectivity_request(
+    (pdn_connectivity_request_msg *) msg, buffer, len);
+}
+
+static void test_free_pdn_connectivity_request(void *msg)
+{
+  pdn_connectivity_request_msg *pdn_connectivity_request =
+    (pdn_connectivity_request_msg *) msg;
+
+  bdestroy_wrapper(&pdn_connectivity_request->accesspointname);
+  clear_protocol_configuration_options(
+    &pdn_connectivity_request->protocolconfigurationoptions);
+}
+
+// attach type and KSI, IMSI, UE network capability, ESM container
+#define TEST_ATTACH_REQUEST_MANDATORY_IES                                      \
+  0x71, 0x08, 0x09, 0x10, 0x10, 0x10, 0x32, 0x54, 0x76, 0x98, 0x02, 0xe0,      \
+    0xe0, 0x00, 0x02, 0x02, 0x01
+// update type and KSI, old GUTI
+#define TEST_TAU_REQUEST_MANDATORY_IES                                         \
+  0x71, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x80, 0x01, 0x01, 0x01, 0x02, 0x03, 0x04
+// PDN type and request type
+#define TEST_PDN_CONNECTIVITY_REQUEST_MANDATORY_IES 0x11
+
+static const test_codec_t test_attach_request = {
+  sizeof(attach_request_msg),
+  offsetof(attach_request_msg, presencemask),
+  17,
+  test_decode_attach_request,
+  test_encode_attach_request,
+  test_free_attach_request,
+};
+
+static const test_codec_t test_tau_request = {
+  sizeof(tracking_area_update_request_msg),
+  offsetof(tracking_area_update_request_msg, presencemask),
+  13,
+  test_decode_tau_request,
+  test_encode_tau_request,
+  test_free_tau_request,
+};
+
+static const test_codec_t test_pdn_connectivity_request = {
+  sizeof(pdn_connectivity_request_msg),
+  offsetof(pdn_connectivity_request_msg, presencemask),
+  1,
+  test_decode_pdn_connectivity_request,
+  test_encode_pdn_connectivity_request,
+  test_free_pdn_connectivity_request,
+};
+
+// IEs shared by Attach Request and Tracking Area Update Request
+#define TEST_OLD_PTMSI_SIGNATURE_IE 0x19, 0x01, 0x02, 0x03
+#define TEST_ADDITIONAL_GUTI_IE                                                \
+  0x50, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x80, 0x01, 0x01, 0x01, 0x02, 0x03, 0x04
+#define TEST_LAST_VISITED_TAI_IE 0x52, 0x00, 0xf1, 0x10, 0x00, 0x01
+#define TEST_DRX_PARAMETER_IE 0x5c, 0x0a, 0x00
+#define TEST_MS_NETWORK_CAPABILITY_IE 0x31, 0x03, 0xe5, 0xe0, 0x34
+#define TEST_OLD_LAI_IE 0x13, 0x00, 0xf1, 0x10, 0x00, 0x01
+#define TEST_TMSI_STATUS_IE 0x90
+#define TEST_CLASSMARK_2_IE 0x11, 0x03, 0x57, 0x58, 0xa6
+#define TEST_CLASSMARK_3_IE 0x20, 0x05, 0x60, 0x14, 0x04, 0xef, 0x65
+#define TEST_SUPPORTED_CODECS_IE                                               \
+  0x40, 0x08, 0x04, 0x02, 0x60, 0x04, 0x00, 0x02, 0x1f, 0x00
+#define TEST_ADDITIONAL_UPDATE_TYPE_IE 0xf1
+#define TEST_OLD_GUTI_TYPE_IE 0xe1
+#define TEST_VOICE_DOMAIN_PREFERENCE_IE 0x5d, 0x01, 0x03
+#define TEST_MS_NETWORK_FEATURE_SUPPORT_IE 0xc1
+#define TEST_NONCE_UE_IE 0x55, 0x01, 0x02, 0x03, 0x04
+#define TEST_UE_NETWORK_CAPABILITY_IE 0x58, 0x02, 0xe0, 0xe0
+#define TEST_EPS_BEARER_CONTEXT_STATUS_IE 0x57, 0x02, 0x20, 0x00
+#define TEST_ESM_INFORMATION_TRANSFER_FLAG_IE 0xd1
+#define TEST_APN_IE                                                            \
+  0x28, 0x09, 0x08, 'i', 'n', 't', 'e', 'r', 'n', 'e', 't'
+#define TEST_PCO_IE 0x27, 0x07, 0x80, 0x00, 0x0d, 0x00, 0x00, 0x0a, 0x00
+
+//------------------------------------------------------------------------------
+// Attach Request fixtures
+static const uint8_t attach_request_mandatory[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES};
+
+static const uint8_t attach_request_all_ies[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES,
+  TEST_OLD_PTMSI_SIGNATURE_IE,
+  TEST_ADDITIONAL_GUTI_IE,
+  TEST_LAST_VISITED_TAI_IE,
+  TEST_DRX_PARAMETER_IE,
+  TEST_MS_NETWORK_CAPABILITY_IE,
+  TEST_OLD_LAI_IE,
+  TEST_TMSI_STATUS_IE,
+  TEST_CLASSMARK_2_IE,
+  TEST_CLASSMARK_3_IE,
+  TEST_SUPPORTED_CODECS_IE,
+  TEST_ADDITIONAL_UPDATE_TYPE_IE,
+  TEST_OLD_GUTI_TYPE_IE,
+  TEST_VOICE_DOMAIN_PREFERENCE_IE,
+  TEST_MS_NETWORK_FEATURE_SUPPORT_IE};
+
+static const uint8_t attach_request_reversed_ies[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES,
+  TEST_MS_NETWORK_FEATURE_SUPPORT_IE,
+  TEST_VOICE_DOMAIN_PREFERENCE_IE,
+  TEST_OLD_GUTI_TYPE_IE,
+  TEST_ADDITIONAL_UPDATE_TYPE_IE,
+  TEST_SUPPORTED_CODECS_IE,
+  TEST_CLASSMARK_3_IE,
+  TEST_CLASSMARK_2_IE,
+  TEST_TMSI_STATUS_IE,
+  TEST_OLD_LAI_IE,
+  TEST_MS_NETWORK_CAPABILITY_IE,
+  TEST_DRX_PARAMETER_IE,
+  TEST_LAST_VISITED_TAI_IE,
+  TEST_ADDITIONAL_GUTI_IE,
+  TEST_OLD_PTMSI_SIGNATURE_IE};
+
+static const uint8_t attach_request_unknown_iei[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES, TEST_DRX_PARAMETER_IE, 0x6f, 0x01, 0x00};
+
+static const uint8_t attach_request_truncated_ie[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES, TEST_TMSI_STATUS_IE, 0x5c, 0x0a};
+
+static const uint8_t attach_request_repeated_ie[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES,
+  TEST_SUPPORTED_CODECS_IE,
+  TEST_DRX_PARAMETER_IE,
+  TEST_SUPPORTED_CODECS_IE};
+
+static const uint8_t attach_request_ie_overrun[] = {
+  TEST_ATTACH_REQUEST_MANDATORY_IES, 0x31, 0x05, 0xe5, 0xe0, 0x34};
+
+/*
+ * The MME never encodes these UE messages, so their encoders are incomplete:
+ * the additional update type encoder is a stub, MS network feature support
+ * is encoded without its IEI, and the skipped classmark 3 is not decoded
+ */
+static const uint8_t attach_request_all_ies_reencoded[] = {
+  0x71, 0x08, 0x09, 0x10, 0x10, 0x10, 0x32, 0x54, 0x76, 0x98, 0x02, 0xe0, 0xe0,
+  0x00, 0x02, 0x02, 0x01, 0x19, 0x01, 0x02, 0x03, 0x50, 0x0b, 0xf6, 0x00, 0xf1,
+  0x10, 0x80, 0x01, 0x01, 0x01, 0x02, 0x03, 0x04, 0x52, 0x00, 0xf1, 0x10, 0x00,
+  0x01, 0x5c, 0x0a, 0x00, 0x31, 0x03, 0xe5, 0xe0, 0x34, 0x13, 0x00, 0xf1, 0x10,
+  0x00, 0x01, 0x90, 0x11, 0x03, 0x57, 0x58, 0xa6, 0x40, 0x08, 0x04, 0x02, 0x60,
+  0x04, 0x00, 0x02, 0x1f, 0x00, 0xe1, 0x5d, 0x01, 0x03, 0x01};
+
+static void check_attach_request_all_ies(const void *msg)
+{
+  const attach_request_msg *attach_request = (const attach_request_msg *) msg;
+
+  ck_assert_int_eq(attach_request->oldptmsisignature, 0x010203);
+  ck_assert_int_eq(attach_request->drxparameter.splitpgcyclecode, 0x0a);
+  ck_assert_int_eq(attach_request->tmsistatus, 0);
+  ck_assert_int_eq(attach_request->additionalupdatetype, 1);
+  ck_assert_int_eq(attach_request->oldgutitype, 1);
+  ck_assert_int_eq(
+    attach_request->voicedomainpreferenceandueusagesetting
+      .voice_domain_for_eutran,
+    VOICE_DOMAIN_PREFERENCE_IMS_PS_VOICE_PREFERRED_CS_VOICE_AS_SECONDARY);
+  ck_assert_int_eq(
+    attach_request->voicedomainpreferenceandueusagesetting.ue_usage_setting,
+    UE_USAGE_SETTING_VOICE_CENTRIC);
+  ck_assert_int_eq(blength(attach_request->esmmessagecontainer), 2);
+}
+
+//------------------------------------------------------------------------------
+// Tracking Area Update Request fixtures
+static const uint8_t tau_request_mandatory[] = {
+  TEST_TAU_REQUEST_MANDATORY_IES};
+
+static const uint8_t tau_request_all_ies[] = {
+  TEST_TAU_REQUEST_MANDATORY_IES,
+  0xb1, // non-current native KSI
+  0x81, // GPRS ciphering key sequence number
+  TEST_OLD_PTMSI_SIGNATURE_IE,
+  TEST_ADDITIONAL_GUTI_IE,
+  TEST_NONCE_UE_IE,
+  TEST_UE_NETWORK_CAPABILITY_IE,
+  TEST_LAST_VISITED_TAI_IE,
+  TEST_DRX_PARAMETER_IE,
+  0xa1, // UE radio capability update needed
+  TEST_EPS_BEARER_CONTEXT_STATUS_IE,
+  TEST_MS_NETWORK_CAPABILITY_IE,
+  TEST_OLD_LAI_IE,
+  TEST_TMSI_STATUS_IE,
+  TEST_CLASSMARK_2_IE,
+  TEST_CLASSMARK_3_IE,
+  TEST_SUPPORTED_CODECS_IE,
+  TEST_ADDITIONAL_UPDATE_TYPE_IE,
+  TEST_OLD_GUTI_TYPE_IE,
+  TEST_VOICE_DOMAIN_PREFERENCE_IE};
+
+static const uint8_t tau_request_truncated_ie[] = {
+  TEST_TAU_REQUEST_MANDATORY_IES, 0x55, 0x01, 0x02};
+
+// the encoder swaps the nibbles of the update type and KSI octet
+static const uint8_t tau_request_mandatory_reencoded[] = {
+  0x17, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x80, 0x01, 0x01, 0x01, 0x02, 0x03, 0x04};
+
+// without the additional update type and the skipped IEs, see Attach Request
+static const uint8_t tau_request_all_ies_reencoded[] = {
+  0x17, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x80, 0x01, 0x01, 0x01, 0x02, 0x03, 0x04,
+  0xb1, 0x81, 0x19, 0x01, 0x02, 0x03, 0x50, 0x0b, 0xf6, 0x00, 0xf1, 0x10, 0x80,
+  0x01, 0x01, 0x01, 0x02, 0x03, 0x04, 0x55, 0x01, 0x02, 0x03, 0x04, 0x58, 0x02,
+  0xe0, 0xe0, 0x52, 0x00, 0xf1, 0x10, 0x00, 0x01, 0x5c, 0x0a, 0x00, 0xa1, 0x57,
+  0x02, 0x20, 0x00, 0x31, 0x03, 0xe5, 0xe0, 0x34, 0x13, 0x00, 0xf1, 0x10, 0x00,
+  0x01, 0x90, 0x11, 0x03, 0x57, 0x58, 0xa6, 0x40, 0x08, 0x04, 0x02, 0x60, 0x04,
+  0x00, 0x02, 0x1f, 0x00, 0xe1};
+
+static void check_tau_request_all_ies(const void *msg)
+{
+  const tracking_area_update_request_msg *tau_request =
+    (const tracking_area_update_request_msg *) msg;
+
+  ck_assert_int_eq(
+    tau_request->noncurrentnativenaskeysetidentifier.naskeysetidentifier, 1);
+  ck_assert_int_eq(tau_request->gprscipheringkeysequencenumber, 1);
+  ck_assert_int_eq(tau_request->nonceue, 0x01020304);
+  ck_assert_int_eq(tau_request->ueradiocapabilityinformationupdateneeded, 1);
+  ck_assert_int_eq(tau_request->epsbearercontextstatus, 0x2000);
+  ck_assert_int_eq(tau_request->drxparameter.splitpgcyclecode, 0x0a);
+}
+
+//------------------------------------------------------------------------------
+// PDN Connectivity Request fixtures
+static const uint8_t pdn_connectivity_request_mandatory[] = {
+  TEST_PDN_CONNECTIVITY_REQUEST_MANDATORY_IES};
+
+static const uint8_t pdn_connectivity_request_all_ies[] = {
+  TEST_PDN_CONNECTIVITY_REQUEST_MANDATORY_IES,
+  TEST_ESM_INFORMATION_TRANSFER_FLAG_IE,
+  TEST_APN_IE,
+  TEST_PCO_IE};
+
+static const uint8_t pdn_connectivity_request_apn_label_overrun[] = {
+  TEST_PDN_CONNECTIVITY_REQUEST_MANDATORY_IES, 0x28, 0x04, 0x08, 'a', 'b', 'c'};
+
+static const uint8_t pdn_connectivity_request_apn_second_label_overrun[] = {
+  TEST_PDN_CONNECTIVITY_REQUEST_MANDATORY_IES,
+  0x28,
+  0x05,
+  0x01,
+  'a',
+  0x05,
+  'b',
+  'c'};
+
+
+static void check_pdn_connectivity_request_all_ies(const void *msg)
+{
+  const pdn_connectivity_request_msg *pdn_connectivity_request =
+    (const pdn_connectivity_request_msg *) msg;
+  const protocol_configuration_options_t *pco =
+    &pdn_connectivity_request->protocolconfigurationoptions;
+
+  ck_assert_int_eq(pdn_connectivity_request->esminformationtransferflag, 1);
+  ck_assert(biseqcstr(pdn_connectivity_request->accesspointname, "internet"));
+  ck_assert_int_eq(pco->num_protocol_or_container_id, 2);
+  ck_assert_int_eq(pco->protocol_or_container_ids[0].id, 0x000d);
+  ck_assert_int_eq(pco->protocol_or_container_ids[1].id, 0x000a);
+}
+
+//------------------------------------------------------------------------------
+static const test_fixture_t test_fixtures[] = {
+  {"Attach Request, mandatory IEs",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_mandatory),
+   sizeof(attach_request_mandatory),
+   0,
+   TEST_BUFFER(attach_request_mandatory),
+   NULL},
+  {"Attach Request, all IEs",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_all_ies),
+   sizeof(attach_request_all_ies),
+   0x3fff & ~ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_3_PRESENT,
+   TEST_BUFFER(attach_request_all_ies_reencoded),
+   check_attach_request_all_ies},
+  {"Attach Request, IEs in reverse order",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_reversed_ies),
+   sizeof(attach_request_reversed_ies),
+   0x3fff & ~ATTACH_REQUEST_MOBILE_STATION_CLASSMARK_3_PRESENT,
+   TEST_BUFFER(attach_request_all_ies_reencoded),
+   check_attach_request_all_ies},
+  {"Attach Request, unknown IEI",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_unknown_iei),
+   TLV_UNEXPECTED_IEI,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"Attach Request, repeated IE",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_repeated_ie),
+   TLV_UNEXPECTED_IEI,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"Attach Request, truncated IE",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_truncated_ie),
+   TLV_BUFFER_TOO_SHORT,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"Attach Request, IE length past the end of the message",
+   &test_attach_request,
+   TEST_BUFFER(attach_request_ie_overrun),
+   TLV_BUFFER_TOO_SHORT,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"Tracking Area Update Request, mandatory IEs",
+   &test_tau_request,
+   TEST_BUFFER(tau_request_mandatory),
+   sizeof(tau_request_mandatory),
+   0,
+   TEST_BUFFER(tau_request_mandatory_reencoded),
+   NULL},
+  {"Tracking Area Update Request, all IEs",
+   &test_tau_request,
+   TEST_BUFFER(tau_request_all_ies),
+   sizeof(tau_request_all_ies),
+   0x7ffff & ~TRACKING_AREA_UPDATE_REQUEST_MOBILE_STATION_CLASSMARK_3_PRESENT,
+   TEST_BUFFER(tau_request_all_ies_reencoded),
+   check_tau_request_all_ies},
+  {"Tracking Area Update Request, truncated IE",
+   &test_tau_request,
+   TEST_BUFFER(tau_request_truncated_ie),
+   TLV_BUFFER_TOO_SHORT,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"PDN Connectivity Request, mandatory IEs",
+   &test_pdn_connectivity_request,
+   TEST_BUFFER(pdn_connectivity_request_mandatory),
+   sizeof(pdn_connectivity_request_mandatory),
+   0,
+   TEST_BUFFER(pdn_connectivity_request_mandatory),
+   NULL},
+  {"PDN Connectivity Request, all IEs",
+   &test_pdn_connectivity_request,
+   TEST_BUFFER(pdn_connectivity_request_all_ies),
+   sizeof(pdn_connectivity_request_all_ies),
+   PDN_CONNECTIVITY_REQUEST_ESM_INFORMATION_TRANSFER_FLAG_PRESENT |
+     PDN_CONNECTIVITY_REQUEST_ACCESS_POINT_NAME_PRESENT |
+     PDN_CONNECTIVITY_REQUEST_PROTOCOL_CONFIGURATION_OPTIONS_PRESENT,
+   TEST_BUFFER(pdn_connectivity_request_all_ies),
+   check_pdn_connectivity_request_all_ies},
+  {"PDN Connectivity Request, APN label past the end of the IE",
+   &test_pdn_connectivity_request,
+   TEST_BUFFER(pdn_connectivity_request_apn_label_overrun),
+   TLV_VALUE_DOESNT_MATCH,
+   0,
+   NULL,
+   0,
+   NULL},
+  {"PDN Connectivity Request, second APN label past the end of the IE",
+   &test_pdn_connectivity_request,
+   TEST_BUFFER(pdn_connectivity_request_apn_second_label_overrun),
+   TLV_VALUE_DOESNT_MATCH,
+   0,
+   NULL,
+   0,
+   NULL},
+};
+
+#define TEST_NB_FIXTURES (sizeof(test_fixtures) / sizeof(test_fixtures[0]))
+
+/*
+ * Decode a copy of buffer allocated with its exact length, so that reads past
+ * the end of the message are caught by the address sanitizer. Returns the
+ * result of the decoder, msg holds the decoded message
+ */
+static int decode_message(
+  const test_codec_t *codec,
+  void *msg,
+  const uint8_t *buffer,
+  uint32_t len)
+{
+  uint8_t *copy = malloc(len ? len : 1);
+
+  memcpy(copy, buffer, len);
+  int decoded = codec->decode(msg, copy, len);
+  free(copy);
+  return decoded;
+}
+
+static uint32_t get_presencemask(const test_codec_t *codec, const void *msg)
+{
+  return *(const uint32_t *) ((const uint8_t *) msg +
+                              codec->presencemask_offset);
+}
+
+START_TEST(golden_messages_test)
+{
+  uint8_t encoded[TEST_MAX_MESSAGE_LENGTH];
+
+  for (int f = 0; f < TEST_NB_FIXTURES; f++) {
+    const test_fixture_t *fixture = &test_fixtures[f];
+    const test_codec_t *codec = fixture->codec;
+    void *msg = calloc(1, codec->msg_size);
+
+    int decoded =
+      decode_message(codec, msg, fixture->encoded, fixture->length);
+    if (decoded != fixture->decoded) {
+      printf("%s: decoded %d\n", fixture->name, decoded);
+    }
+    ck_assert_int_eq(decoded, fixture->decoded);
+    if (decoded > 0) {
+      ck_assert_uint_eq(get_presencemask(codec, msg), fixture->presencemask);
+      // the encoder only encodes the IEs set in the presencemask, in order
+      int encoded_len = codec->encode(msg, encoded, sizeof(encoded));
+      ck_assert_int_eq(encoded_len, fixture->reencoded_length);
+      ck_assert(!memcmp(encoded, fixture->reencoded, encoded_len));
+      if (fixture->check) {
+        fixture->check(msg);
+      }
+    }
+    codec->free_msg(msg);
+    free(msg);
+  }
+}
+END_TEST
+
+START_TEST(truncated_messages_test)
+{
+  for (int f = 0; f < TEST_NB_FIXTURES; f++) {
+    const test_fixture_t *fixture = &test_fixtures[f];
+    const test_codec_t *codec = fixture->codec;
+
+    if (fixture->decoded <= 0) {
+      continue;
+    }
+    // cut the message in the optional part, the tables decode that part
+    for (uint32_t len = codec->mandatory_length; len < fixture->length;
+         len++) {
+      void *msg = calloc(1, codec->msg_size);
+
+      int decoded = decode_message(codec, msg, fixture->encoded, len);
+      ck_assert_int_le(decoded, len);
+      if (decoded > 0) {
+        // only IEs of the whole message can be found in a part of it
+        ck_assert_uint_eq(
+          get_presencemask(codec, msg) & ~fixture->presencemask, 0);
+      }
+      codec->free_msg(msg);
+      free(msg);
+    }
+  }
+}
+END_TEST
+
+START_TEST(corrupted_messages_test)
+{
+  uint8_t buffer[TEST_MAX_MESSAGE_LENGTH];
+
+  for (int f = 0; f < TEST_NB_FIXTURES; f++) {
+    const test_fixture_t *fixture = &test_fixtures[f];
+    const test_codec_t *codec = fixture->codec;
+
+    // corrupt every byte of the optional part with every value
+    for (uint32_t position = codec->mandatory_length;
+         position < fixture->length;
+         position++) {
+      for (int value = 0; value < 256; value++) {
+        void *msg = calloc(1, codec->msg_size);
+
+        memcpy(buffer, fixture->encoded, fixture->length);
+        buffer[position] = value;
+        int decoded = decode_message(codec, msg, buffer, fixture->length);
+        ck_assert_int_le(decoded, fixture->length);
+        codec->free_msg(msg);
+        free(msg);
+      }
+    }
+  }
+}
+END_TEST
+
+Suite *nas_ie_table_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("NAS IE table tests");
+
+  /* Core test case */
+  tc_core = tcase_create("NAS IE table test");
+  tcase_add_test(tc_core, golden_messages_test);
+  tcase_add_test(tc_core, truncated_messages_test);
+  tcase_add_test(tc_core, corrupted_messages_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = nas_ie_table_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -55,4 +55,15 @@ class MockMessenger : public OpenflowMessenger {
   MOCK_CONST_METHOD2(
     send_of_msg,
     void(fluid_msg::OFMsg &of_msg, fluid_base::OFConnection *ofconn));
+
+  // Queued messages are checked the same way as messages sent right away
+  inline void queue_of_msg(
+    fluid_msg::OFMsg &of_msg,
+    fluid_base::OFConnection *ofconn,
+    const QueuedMsgOrigin &origin) const
+  {
+    send_of_msg(of_msg, ofconn);
+  }
+
+  MOCK_CONST_METHOD0(flush_queued_msgs, void());
 };
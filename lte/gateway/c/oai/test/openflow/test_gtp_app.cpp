@@ -27,6 +27,7 @@
 
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::InSequence;
 using ::testing::Test;
 using namespace fluid_msg;
 using namespace openflow;
@@ -190,6 +191,55 @@ TEST_F(GTPApplicationTest, TestDeleteTunnel)
   controller->dispatch_event(del_tunnel);
 }
 
+/*
+ * Controller with a fake switch connection, that leaves the drains of the
+ * tunnel ops ring to the test
+ */
+class TunnelOpsController : public OpenflowController {
+ public:
+  TunnelOpsController(std::shared_ptr<OpenflowMessenger> messenger):
+    OpenflowController("127.0.0.1", 6666, 2, false, messenger),
+    num_drains_scheduled(0)
+  {
+    // only passed along to the messenger, never used
+    latest_ofconn_ = reinterpret_cast<fluid_base::OFConnection *>(0x1);
+  }
+
+  int num_drains_scheduled;
+
+ protected:
+  void schedule_tunnel_ops_drain() { num_drains_scheduled++; }
+};
+
+/*
+ * Test that flows queued for the tunnel ops of the ring are flushed once per
+ * drain
+ */
+TEST_F(GTPApplicationTest, TestExternalEventFlush)
+{
+  TunnelOpsController ring_controller(messenger);
+  ring_controller.register_for_event(
+    gtp_app, openflow::EVENT_DELETE_GTP_TUNNEL);
+
+  TunnelOp del_tunnel = {};
+  del_tunnel.type = EVENT_DELETE_GTP_TUNNEL;
+  del_tunnel.ue_ip.s_addr = inet_addr("0.0.0.1");
+  for (uint32_t in_tei = 1; in_tei <= 2; in_tei++) {
+    del_tunnel.in_tei = in_tei;
+    EXPECT_TRUE(ring_controller.enqueue_tunnel_op(del_tunnel));
+  }
+  // the second op is picked up by the drain scheduled for the first one
+  EXPECT_EQ(ring_controller.num_drains_scheduled, 1);
+
+  {
+    InSequence dummy;
+    EXPECT_CALL(*messenger, send_of_msg(_, _)).Times(4);
+    EXPECT_CALL(*messenger, flush_queued_msgs()).Times(1);
+  }
+  ring_controller.drain_tunnel_ops();
+  EXPECT_EQ(ring_controller.num_drains_scheduled, 1);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,100 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "MPSCRing.h"
+
+using namespace openflow;
+
+namespace {
+
+TEST(MPSCRingTest, TestPushPop)
+{
+  MPSCRing<int> ring(4);
+  int item;
+  EXPECT_TRUE(ring.empty());
+  EXPECT_FALSE(ring.pop(item));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  // full
+  EXPECT_FALSE(ring.push(4));
+  EXPECT_FALSE(ring.empty());
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.pop(item));
+    EXPECT_EQ(item, i);
+  }
+  EXPECT_TRUE(ring.empty());
+  // slots are reused on the next lap
+  EXPECT_TRUE(ring.push(5));
+  EXPECT_TRUE(ring.pop(item));
+  EXPECT_EQ(item, 5);
+}
+
+TEST(MPSCRingTest, TestCapacity)
+{
+  EXPECT_THROW(MPSCRing<int> ring(3), std::invalid_argument);
+}
+
+// Every item pushed from several threads is popped once, and the items of
+// each producer come out in the order they were pushed
+TEST(MPSCRingTest, TestProducers)
+{
+  const int num_producers = 4;
+  const int items_per_producer = 100000;
+  MPSCRing<std::pair<int, int>> ring(1024);
+  std::vector<std::thread> producers;
+  for (int p = 0; p < num_producers; p++) {
+    producers.emplace_back([&ring, p]() {
+      for (int i = 0; i < items_per_producer; i++) {
+        while (!ring.push(std::make_pair(p, i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<int> next(num_producers, 0);
+  int popped = 0;
+  std::pair<int, int> item;
+  while (popped < num_producers * items_per_producer) {
+    if (!ring.pop(item)) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(item.second, next[item.first]);
+    next[item.first] = item.second + 1;
+    popped++;
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+  EXPECT_TRUE(ring.empty());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
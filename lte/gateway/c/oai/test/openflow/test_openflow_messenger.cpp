@@ -0,0 +1,222 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <arpa/inet.h>
+#include <string.h>
+#include <vector>
+#include <gtest/gtest.h>
+#include <fluid/of13msg.hh>
+#include "OpenflowMessenger.h"
+
+using namespace fluid_msg;
+using namespace openflow;
+
+namespace {
+
+/**
+ * DefaultMessenger that records its writes instead of sending them
+ */
+class RecordingMessenger : public DefaultMessenger {
+ public:
+  using DefaultMessenger::MAX_QUEUED_MSGS;
+  using DefaultMessenger::MAX_TRACKED_ORIGINS;
+
+  struct Write {
+    fluid_base::OFConnection *ofconn;
+    std::vector<uint8_t> data;
+  };
+
+  mutable std::vector<Write> writes;
+
+ protected:
+  void write_msgs(
+    fluid_base::OFConnection *ofconn,
+    uint8_t *data,
+    size_t length) const
+  {
+    writes.push_back({ofconn, std::vector<uint8_t>(data, data + length)});
+  }
+};
+
+/**
+ * Returns the xids of the OpenFlow messages packed in a write
+ */
+std::vector<uint32_t> get_xids(const std::vector<uint8_t> &data)
+{
+  std::vector<uint32_t> xids;
+  size_t offset = 0;
+  while (offset + 8 <= data.size()) {
+    uint16_t length = (data[offset + 2] << 8) | data[offset + 3];
+    uint32_t xid;
+    memcpy(&xid, &data[offset + 4], sizeof(xid));
+    xids.push_back(ntohl(xid));
+    EXPECT_GT(length, 0);
+    offset += length;
+  }
+  EXPECT_EQ(offset, data.size());
+  return xids;
+}
+
+class OpenflowMessengerTest : public ::testing::Test {
+ protected:
+  virtual void SetUp()
+  {
+    conn1 = reinterpret_cast<fluid_base::OFConnection *>(0x1);
+    conn2 = reinterpret_cast<fluid_base::OFConnection *>(0x2);
+    inet_pton(AF_INET, "192.168.128.10", &ue_ip);
+  }
+
+  QueuedMsgOrigin origin(uint32_t tei)
+  {
+    QueuedMsgOrigin origin;
+    origin.action = "add uplink";
+    origin.tei = tei;
+    origin.ue_ip = ue_ip;
+    return origin;
+  }
+
+  void queue_flow_mods(fluid_base::OFConnection *ofconn, uint32_t count)
+  {
+    for (uint32_t i = 0; i < count; i++) {
+      of13::FlowMod fm =
+        messenger.create_default_flow_mod(0, of13::OFPFC_ADD, 0);
+      messenger.queue_of_msg(fm, ofconn, origin(i));
+    }
+  }
+
+ protected:
+  RecordingMessenger messenger;
+  fluid_base::OFConnection *conn1;
+  fluid_base::OFConnection *conn2;
+  struct in_addr ue_ip;
+};
+
+TEST_F(OpenflowMessengerTest, TestFlushWritesOnce)
+{
+  queue_flow_mods(conn1, 3);
+  EXPECT_TRUE(messenger.writes.empty());
+
+  messenger.flush_queued_msgs();
+  ASSERT_EQ(messenger.writes.size(), 1);
+  EXPECT_EQ(messenger.writes[0].ofconn, conn1);
+  auto xids = get_xids(messenger.writes[0].data);
+  ASSERT_EQ(xids.size(), 3);
+  EXPECT_EQ(xids[1], xids[0] + 1);
+  EXPECT_EQ(xids[2], xids[0] + 2);
+
+  // nothing left to flush
+  messenger.flush_queued_msgs();
+  EXPECT_EQ(messenger.writes.size(), 1);
+}
+
+TEST_F(OpenflowMessengerTest, TestBatchBoundary)
+{
+  const uint32_t max = RecordingMessenger::MAX_QUEUED_MSGS;
+  queue_flow_mods(conn1, max - 1);
+  EXPECT_TRUE(messenger.writes.empty());
+
+  // the last message of a batch flushes it
+  queue_flow_mods(conn1, 1);
+  ASSERT_EQ(messenger.writes.size(), 1);
+  EXPECT_EQ(get_xids(messenger.writes[0].data).size(), max);
+
+  // the next one starts a new batch
+  queue_flow_mods(conn1, 1);
+  EXPECT_EQ(messenger.writes.size(), 1);
+  messenger.flush_queued_msgs();
+  ASSERT_EQ(messenger.writes.size(), 2);
+  EXPECT_EQ(get_xids(messenger.writes[1].data).size(), 1);
+}
+
+TEST_F(OpenflowMessengerTest, TestBatchAcrossConnections)
+{
+  const uint32_t max = RecordingMessenger::MAX_QUEUED_MSGS;
+  // messages of all connections count towards the batch
+  queue_flow_mods(conn1, max / 2);
+  queue_flow_mods(conn2, max / 2);
+  ASSERT_EQ(messenger.writes.size(), 2);
+  for (const auto &write : messenger.writes) {
+    EXPECT_EQ(get_xids(write.data).size(), max / 2);
+  }
+  EXPECT_NE(messenger.writes[0].ofconn, messenger.writes[1].ofconn);
+}
+
+TEST_F(OpenflowMessengerTest, TestFlushOnBarrier)
+{
+  queue_flow_mods(conn1, 2);
+  queue_flow_mods(conn2, 1);
+
+  of13::BarrierRequest barrier(42);
+  messenger.send_of_msg(barrier, conn1);
+
+  // the queued messages of the connection go out before the barrier
+  ASSERT_EQ(messenger.writes.size(), 2);
+  EXPECT_EQ(messenger.writes[0].ofconn, conn1);
+  EXPECT_EQ(get_xids(messenger.writes[0].data).size(), 2);
+  EXPECT_EQ(messenger.writes[1].ofconn, conn1);
+  auto barrier_xids = get_xids(messenger.writes[1].data);
+  ASSERT_EQ(barrier_xids.size(), 1);
+  EXPECT_EQ(barrier_xids[0], 42);
+
+  // the other connection's messages are still queued
+  messenger.flush_queued_msgs();
+  ASSERT_EQ(messenger.writes.size(), 3);
+  EXPECT_EQ(messenger.writes[2].ofconn, conn2);
+  EXPECT_EQ(get_xids(messenger.writes[2].data).size(), 1);
+}
+
+TEST_F(OpenflowMessengerTest, TestDiscard)
+{
+  const uint32_t max = RecordingMessenger::MAX_QUEUED_MSGS;
+  queue_flow_mods(conn1, max - 1);
+  messenger.discard_queued_msgs(conn1);
+  messenger.flush_queued_msgs();
+  EXPECT_TRUE(messenger.writes.empty());
+
+  // discarded messages don't count towards the batch
+  queue_flow_mods(conn2, max - 1);
+  EXPECT_TRUE(messenger.writes.empty());
+}
+
+TEST_F(OpenflowMessengerTest, TestQueuedMsgOrigin)
+{
+  queue_flow_mods(conn1, 2);
+  messenger.flush_queued_msgs();
+  auto xids = get_xids(messenger.writes[0].data);
+  ASSERT_EQ(xids.size(), 2);
+
+  EXPECT_EQ(
+    messenger.get_queued_msg_origin(xids[1]),
+    "add uplink tunnel flow, tei 1, ue ip 192.168.128.10");
+  EXPECT_EQ(messenger.get_queued_msg_origin(xids[1] + 1), "");
+  EXPECT_EQ(messenger.get_queued_msg_origin(42), "");
+
+  // old origins are overwritten by newer messages
+  queue_flow_mods(conn1, RecordingMessenger::MAX_TRACKED_ORIGINS);
+  EXPECT_EQ(messenger.get_queued_msg_origin(xids[0]), "");
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
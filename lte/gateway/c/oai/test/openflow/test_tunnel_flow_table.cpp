@@ -0,0 +1,151 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <algorithm>
+#include <gtest/gtest.h>
+#include "TunnelFlowTable.h"
+
+using namespace openflow;
+
+namespace {
+
+static struct in_addr to_addr(const char *ip)
+{
+  struct in_addr addr;
+  addr.s_addr = inet_addr(ip);
+  return addr;
+}
+
+static void add_test_tunnel(
+  TunnelFlowTable &table,
+  const char *ue_ip,
+  uint32_t in_tei)
+{
+  table.add_tunnel(
+    to_addr(ue_ip), to_addr("192.168.60.1"), in_tei, in_tei + 100,
+    "001010000000013");
+}
+
+TEST(TunnelFlowTableTest, TestTrackTunnels)
+{
+  TunnelFlowTable table;
+  add_test_tunnel(table, "10.0.0.1", 1);
+  add_test_tunnel(table, "10.0.0.2", 2);
+  EXPECT_EQ(table.size(), 2);
+  const TunnelFlow &tunnel = table.get_tunnels().at(1);
+  EXPECT_EQ(tunnel.out_tei, 101);
+  EXPECT_STREQ(tunnel.imsi, "001010000000013");
+  EXPECT_FALSE(tunnel.discarding);
+  EXPECT_TRUE(table.owns_downlink(tunnel));
+
+  table.set_discarding(1, true);
+  EXPECT_TRUE(table.get_tunnels().at(1).discarding);
+  table.set_discarding(1, false);
+  EXPECT_FALSE(table.get_tunnels().at(1).discarding);
+  // unknown tunnels are ignored
+  table.set_discarding(3, true);
+  EXPECT_EQ(table.size(), 2);
+
+  table.remove_tunnel(to_addr("10.0.0.1"), 1);
+  EXPECT_EQ(table.size(), 1);
+  EXPECT_EQ(table.get_tunnels().count(1), 0);
+}
+
+// The downlink flow matches on the UE IP only, so the last tunnel added for
+// an IP owns it
+TEST(TunnelFlowTableTest, TestDownlinkOwner)
+{
+  TunnelFlowTable table;
+  add_test_tunnel(table, "10.0.0.1", 1);
+  add_test_tunnel(table, "10.0.0.1", 2);
+  EXPECT_FALSE(table.owns_downlink(table.get_tunnels().at(1)));
+  EXPECT_TRUE(table.owns_downlink(table.get_tunnels().at(2)));
+
+  // a tei moving to another IP leaves the old downlink flow unowned
+  add_test_tunnel(table, "10.0.0.3", 2);
+  ObservedTunnelFlows observed;
+  observed.uplink_teis = {1, 2};
+  observed.downlink_ips = {to_addr("10.0.0.1").s_addr,
+                           to_addr("10.0.0.3").s_addr};
+  TunnelFlowDiff diff = table.diff(observed);
+  ASSERT_EQ(diff.stale_downlink_ips.size(), 1);
+  EXPECT_EQ(diff.stale_downlink_ips[0], to_addr("10.0.0.1").s_addr);
+  EXPECT_TRUE(diff.missing_downlinks.empty());
+}
+
+TEST(TunnelFlowTableTest, TestDiffInSync)
+{
+  TunnelFlowTable table;
+  add_test_tunnel(table, "10.0.0.1", 1);
+  add_test_tunnel(table, "10.0.0.2", 2);
+  table.set_discarding(2, true);
+  ObservedTunnelFlows observed;
+  observed.uplink_teis = {1, 2};
+  observed.downlink_ips = {to_addr("10.0.0.1").s_addr,
+                           to_addr("10.0.0.2").s_addr};
+  observed.discard_uplink_teis = {2};
+  observed.discard_downlink_ips = {to_addr("10.0.0.2").s_addr};
+  EXPECT_TRUE(table.diff(observed).empty());
+}
+
+TEST(TunnelFlowTableTest, TestDiff)
+{
+  TunnelFlowTable table;
+  add_test_tunnel(table, "10.0.0.1", 1);
+  add_test_tunnel(table, "10.0.0.2", 2);
+  table.set_discarding(2, true);
+  ObservedTunnelFlows observed;
+  // uplink of 2 and downlink of 1 are missing, tunnel 3 is left over
+  observed.uplink_teis = {1, 3};
+  observed.downlink_ips = {to_addr("10.0.0.2").s_addr,
+                           to_addr("10.0.0.3").s_addr};
+  observed.discard_uplink_teis = {3};
+  TunnelFlowDiff diff = table.diff(observed);
+
+  ASSERT_EQ(diff.missing_uplinks.size(), 1);
+  EXPECT_EQ(diff.missing_uplinks[0]->in_tei, 2);
+  ASSERT_EQ(diff.missing_downlinks.size(), 1);
+  EXPECT_EQ(diff.missing_downlinks[0]->in_tei, 1);
+  ASSERT_EQ(diff.missing_discard_uplinks.size(), 1);
+  EXPECT_EQ(diff.missing_discard_uplinks[0]->in_tei, 2);
+  ASSERT_EQ(diff.missing_discard_downlinks.size(), 1);
+  EXPECT_EQ(diff.missing_discard_downlinks[0]->in_tei, 2);
+  EXPECT_EQ(diff.stale_uplink_teis, std::vector<uint32_t>{3});
+  EXPECT_EQ(
+    diff.stale_downlink_ips,
+    std::vector<uint32_t>{to_addr("10.0.0.3").s_addr});
+  EXPECT_EQ(diff.stale_discard_uplink_teis, std::vector<uint32_t>{3});
+  EXPECT_TRUE(diff.stale_discard_downlink_ips.empty());
+
+  // nothing is installed after the switch restarted
+  observed.clear();
+  diff = table.diff(observed);
+  EXPECT_EQ(diff.missing_uplinks.size(), 2);
+  EXPECT_EQ(diff.missing_downlinks.size(), 2);
+  EXPECT_TRUE(diff.stale_uplink_teis.empty());
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+} // namespace
@@ -0,0 +1,202 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <gtest/gtest.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include "CSFBCallWindow.h"
+
+using namespace magma;
+
+namespace {
+
+const std::chrono::milliseconds CALL_TIMEOUT(1000);
+
+/**
+ * Clock of the windows under test, only moves when told to
+ */
+class FakeClock {
+ public:
+  CSFBCallWindow::Clock clock()
+  {
+    return [this]() { return now; };
+  }
+
+  std::chrono::steady_clock::time_point now;
+};
+
+/**
+ * Records the calls started by a CSFBCallWindow, and finishes them on demand
+ */
+class CallRecorder {
+ public:
+  CSFBCallWindow::Call call(const std::string &name)
+  {
+    return [this, name](std::function<void()> done) {
+      started.push_back(name);
+      in_flight.push_back(done);
+    };
+  }
+
+  void finish_oldest()
+  {
+    auto done = in_flight.front();
+    in_flight.erase(in_flight.begin());
+    done();
+  }
+
+  std::vector<std::string> started;
+  std::vector<std::function<void()>> in_flight;
+};
+
+TEST(CSFBCallWindowTest, TestWindowIsBounded)
+{
+  CSFBCallWindow window(2, 10, CALL_TIMEOUT);
+  CallRecorder calls;
+  EXPECT_EQ(
+    window.submit("", calls.call("a")), CSFBCallWindow::SubmitResult::STARTED);
+  EXPECT_EQ(
+    window.submit("", calls.call("b")), CSFBCallWindow::SubmitResult::STARTED);
+  EXPECT_EQ(
+    window.submit("", calls.call("c")), CSFBCallWindow::SubmitResult::QUEUED);
+  EXPECT_EQ(
+    window.submit("", calls.call("d")), CSFBCallWindow::SubmitResult::QUEUED);
+  EXPECT_EQ(window.in_flight(), 2);
+  EXPECT_EQ(window.pending(), 2);
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b"}));
+
+  calls.finish_oldest();
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b", "c"}));
+  EXPECT_EQ(window.in_flight(), 2);
+  EXPECT_EQ(window.pending(), 1);
+
+  while (!calls.in_flight.empty()) {
+    calls.finish_oldest();
+  }
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b", "c", "d"}));
+  EXPECT_EQ(window.in_flight(), 0);
+  EXPECT_EQ(window.pending(), 0);
+}
+
+TEST(CSFBCallWindowTest, TestQueuedCallsAreCoalesced)
+{
+  CSFBCallWindow window(1, 10, CALL_TIMEOUT);
+  CallRecorder calls;
+  window.submit("IMSI1", calls.call("lu1 first"));
+  window.submit("IMSI1", calls.call("lu1 second"));
+  window.submit("", calls.call("unitdata"));
+  window.submit("IMSI2", calls.call("lu2"));
+  EXPECT_EQ(
+    window.submit("IMSI1", calls.call("lu1 third")),
+    CSFBCallWindow::SubmitResult::COALESCED);
+  EXPECT_EQ(window.pending(), 3);
+
+  while (!calls.in_flight.empty()) {
+    calls.finish_oldest();
+  }
+  // The in flight call is not superseded, the replacing call keeps the
+  // submission order
+  EXPECT_EQ(
+    calls.started,
+    std::vector<std::string>({"lu1 first", "unitdata", "lu2", "lu1 third"}));
+}
+
+TEST(CSFBCallWindowTest, TestFullQueueDropsCalls)
+{
+  CSFBCallWindow window(1, 2, CALL_TIMEOUT);
+  CallRecorder calls;
+  window.submit("", calls.call("a"));
+  window.submit("", calls.call("b"));
+  window.submit("IMSI1", calls.call("c"));
+  EXPECT_EQ(
+    window.submit("", calls.call("d")), CSFBCallWindow::SubmitResult::DROPPED);
+  // Replacing a queued call does not need room in the queue
+  EXPECT_EQ(
+    window.submit("IMSI1", calls.call("e")),
+    CSFBCallWindow::SubmitResult::COALESCED);
+
+  while (!calls.in_flight.empty()) {
+    calls.finish_oldest();
+  }
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b", "e"}));
+}
+
+TEST(CSFBCallWindowTest, TestDoneCountsOnce)
+{
+  CSFBCallWindow window(1, 10, CALL_TIMEOUT);
+  CallRecorder calls;
+  window.submit("", calls.call("a"));
+  window.submit("", calls.call("b"));
+  window.submit("", calls.call("c"));
+
+  auto done = calls.in_flight.front();
+  calls.finish_oldest();
+  done();
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b"}));
+  EXPECT_EQ(window.in_flight(), 1);
+  EXPECT_EQ(window.pending(), 1);
+}
+
+TEST(CSFBCallWindowTest, TestTimedOutCallsFreeTheirSlot)
+{
+  FakeClock clock;
+  CSFBCallWindow window(2, 10, CALL_TIMEOUT, clock.clock());
+  CallRecorder calls;
+  window.submit("", calls.call("a"));
+  clock.now += CALL_TIMEOUT / 2;
+  window.submit("", calls.call("b"));
+  window.submit("", calls.call("c"));
+  window.submit("", calls.call("d"));
+
+  // a times out, c takes its slot when the window is used next
+  clock.now += CALL_TIMEOUT / 2;
+  EXPECT_EQ(window.pending(), 1);
+  EXPECT_EQ(window.in_flight(), 2);
+  EXPECT_EQ(calls.started, std::vector<std::string>({"a", "b", "c"}));
+
+  // the late done of a does not free the slot of another call
+  calls.finish_oldest();
+  EXPECT_EQ(window.in_flight(), 2);
+  EXPECT_EQ(window.pending(), 1);
+
+  // b and c time out as well, d and e are started right away
+  clock.now += CALL_TIMEOUT;
+  EXPECT_EQ(
+    window.submit("", calls.call("e")), CSFBCallWindow::SubmitResult::STARTED);
+  EXPECT_EQ(
+    calls.started, std::vector<std::string>({"a", "b", "c", "d", "e"}));
+  EXPECT_EQ(window.in_flight(), 2);
+  EXPECT_EQ(window.pending(), 0);
+
+  while (!calls.in_flight.empty()) {
+    calls.finish_oldest();
+  }
+  EXPECT_EQ(window.in_flight(), 0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,279 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+/* The cache reads CLOCK_MONOTONIC, drive it from the tests instead */
+static time_t test_now = 1000;
+
+static int test_clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+  tp->tv_sec = test_now;
+  tp->tv_nsec = 0;
+  return 0;
+}
+
+#define clock_gettime test_clock_gettime
+#include "emm_auth_vector_cache.c"
+#undef clock_gettime
+
+#define TEST_IMSI64 ((imsi64_t) 1010000000001)
+
+static const plmn_t home_plmn = {.mcc_digit1 = 0,
+                                 .mcc_digit2 = 0,
+                                 .mcc_digit3 = 1,
+                                 .mnc_digit1 = 0,
+                                 .mnc_digit2 = 1,
+                                 .mnc_digit3 = 0xf};
+static const plmn_t other_plmn = {.mcc_digit1 = 3,
+                                  .mcc_digit2 = 1,
+                                  .mcc_digit3 = 0,
+                                  .mnc_digit1 = 1,
+                                  .mnc_digit2 = 5,
+                                  .mnc_digit3 = 0};
+
+void increment_counter(
+  const char *name,
+  double increment,
+  size_t n_labels,
+  ...)
+{
+}
+
+/* Vectors are told apart by the first octet of their RAND */
+static void make_vectors(eutran_vector_t *vectors, int num, uint8_t first)
+{
+  memset(vectors, 0, num * sizeof(eutran_vector_t));
+  for (int i = 0; i < num; i++) {
+    vectors[i].rand[0] = first + i;
+  }
+}
+
+static void assert_take(const plmn_t *plmn, uint8_t expected)
+{
+  eutran_vector_t vector = {0};
+  ck_assert(emm_auth_vector_cache_take(TEST_IMSI64, plmn, &vector));
+  ck_assert_uint_eq(vector.rand[0], expected);
+}
+
+static void assert_empty(const plmn_t *plmn)
+{
+  eutran_vector_t vector = {0};
+  ck_assert(!emm_auth_vector_cache_take(TEST_IMSI64, plmn, &vector));
+}
+
+static void setup(void)
+{
+  test_now = 1000;
+  ck_assert_int_eq(emm_auth_vector_cache_init(), RETURNok);
+}
+
+static void teardown(void)
+{
+  emm_auth_vector_cache_exit();
+}
+
+START_TEST(take_oldest_first_test)
+{
+  eutran_vector_t vectors[3];
+  make_vectors(vectors, 3, 1);
+
+  assert_empty(&home_plmn);
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 3, vectors);
+  assert_take(&home_plmn, 1);
+  assert_take(&home_plmn, 2);
+  assert_take(&home_plmn, 3);
+  assert_empty(&home_plmn);
+}
+END_TEST
+
+START_TEST(ttl_expiry_test)
+{
+  eutran_vector_t vectors[2];
+  make_vectors(vectors, 2, 1);
+
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vectors[0]);
+  test_now += AUTH_VECTOR_CACHE_TTL_S / 2;
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vectors[1]);
+
+  // the first vector expires, the second one is still valid
+  test_now += AUTH_VECTOR_CACHE_TTL_S / 2;
+  assert_take(&home_plmn, 2);
+
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 2, vectors);
+  test_now += AUTH_VECTOR_CACHE_TTL_S;
+  assert_empty(&home_plmn);
+}
+END_TEST
+
+START_TEST(vector_overflow_test)
+{
+  eutran_vector_t vectors[MAX_EPS_AUTH_VECTORS_PER_AIR + 2];
+  make_vectors(vectors, MAX_EPS_AUTH_VECTORS_PER_AIR + 2, 1);
+
+  // the oldest vectors are dropped to make room for the new ones
+  emm_auth_vector_cache_add(
+    TEST_IMSI64, &home_plmn, MAX_EPS_AUTH_VECTORS_PER_AIR, vectors);
+  emm_auth_vector_cache_add(
+    TEST_IMSI64, &home_plmn, 2, &vectors[MAX_EPS_AUTH_VECTORS_PER_AIR]);
+  for (int i = 0; i < MAX_EPS_AUTH_VECTORS_PER_AIR; i++) {
+    assert_take(&home_plmn, 3 + i);
+  }
+  assert_empty(&home_plmn);
+
+  // and so are the first ones of an answer with too many vectors
+  emm_auth_vector_cache_add(
+    TEST_IMSI64, &home_plmn, MAX_EPS_AUTH_VECTORS_PER_AIR + 2, vectors);
+  assert_take(&home_plmn, 3);
+}
+END_TEST
+
+START_TEST(subscriber_overflow_test)
+{
+  eutran_vector_t vector;
+  make_vectors(&vector, 1, 1);
+
+  for (imsi64_t i = 0; i < AUTH_VECTOR_CACHE_MAX_SUBSCRIBERS; i++) {
+    emm_auth_vector_cache_add(TEST_IMSI64 + 1 + i, &home_plmn, 1, &vector);
+  }
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vector);
+  assert_empty(&home_plmn);
+  // nothing expires before the first entries, the cache isn't swept until then
+  ck_assert_int_eq(next_sweep, 1000 + AUTH_VECTOR_CACHE_TTL_S);
+
+  // a subscriber whose last vector was taken makes room right away
+  emm_auth_vector_cache_take(TEST_IMSI64 + 1, &home_plmn, &vector);
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vector);
+  assert_take(&home_plmn, 1);
+  emm_auth_vector_cache_add(TEST_IMSI64 + 1, &home_plmn, 1, &vector);
+
+  // expired entries are removed to make room
+  test_now += AUTH_VECTOR_CACHE_TTL_S;
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vector);
+  assert_take(&home_plmn, 1);
+}
+END_TEST
+
+START_TEST(plmn_binding_test)
+{
+  eutran_vector_t vectors[2];
+  make_vectors(vectors, 2, 1);
+
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 1, &vectors[0]);
+  assert_empty(&other_plmn);
+
+  // vectors for another serving network replace the cached ones
+  emm_auth_vector_cache_add(TEST_IMSI64, &other_plmn, 1, &vectors[1]);
+  assert_empty(&home_plmn);
+  assert_take(&other_plmn, 2);
+}
+END_TEST
+
+START_TEST(invalidate_test)
+{
+  eutran_vector_t vectors[2];
+  make_vectors(vectors, 2, 1);
+
+  emm_auth_vector_cache_add(TEST_IMSI64, &home_plmn, 2, vectors);
+  emm_auth_vector_cache_invalidate(TEST_IMSI64);
+  assert_empty(&home_plmn);
+
+  // the answer of the outstanding prefetch is discarded as well
+  ck_assert(emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  emm_auth_vector_cache_invalidate(TEST_IMSI64);
+  ck_assert(
+    emm_auth_vector_cache_prefetch_answer(TEST_IMSI64, true, 2, vectors));
+  assert_empty(&home_plmn);
+}
+END_TEST
+
+START_TEST(prefetch_test)
+{
+  eutran_vector_t vectors[2];
+  make_vectors(vectors, 2, 1);
+
+  ck_assert(
+    !emm_auth_vector_cache_prefetch_answer(TEST_IMSI64, true, 2, vectors));
+  ck_assert(emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  ck_assert(!emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  ck_assert(
+    emm_auth_vector_cache_prefetch_answer(TEST_IMSI64, true, 2, vectors));
+
+  // no prefetch while vectors are cached
+  ck_assert(!emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  assert_take(&home_plmn, 1);
+  assert_take(&home_plmn, 2);
+
+  // a failed prefetch caches nothing
+  ck_assert(emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  ck_assert(
+    emm_auth_vector_cache_prefetch_answer(TEST_IMSI64, false, 0, NULL));
+  assert_empty(&home_plmn);
+
+  // a late answer is dropped, and a new prefetch can be started
+  ck_assert(emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+  test_now += AUTH_VECTOR_PREFETCH_TIMEOUT_S;
+  ck_assert(
+    !emm_auth_vector_cache_prefetch_answer(TEST_IMSI64, true, 2, vectors));
+  assert_empty(&home_plmn);
+  ck_assert(emm_auth_vector_cache_start_prefetch(TEST_IMSI64, &home_plmn));
+}
+END_TEST
+
+Suite *auth_vector_cache_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("Auth vector cache tests");
+
+  /* Core test case */
+  tc_core = tcase_create("Auth vector cache test");
+  tcase_add_checked_fixture(tc_core, setup, teardown);
+  tcase_add_test(tc_core, take_oldest_first_test);
+  tcase_add_test(tc_core, ttl_expiry_test);
+  tcase_add_test(tc_core, vector_overflow_test);
+  tcase_add_test(tc_core, subscriber_overflow_test);
+  tcase_add_test(tc_core, plmn_binding_test);
+  tcase_add_test(tc_core, invalidate_test);
+  tcase_add_test(tc_core, prefetch_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = auth_vector_cache_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,372 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <libmnl/libmnl.h>
+#include <linux/genetlink.h>
+#include <linux/gtp.h>
+
+/*
+ * The genetlink socket is replaced by a fake kernel: requests sent are acked
+ * at once, as the kernel does, unless the acks are held back by the test.
+ */
+#define MAX_TEST_REQUESTS 1024
+
+static struct {
+  int num_sendto;
+  uint32_t num_sent;
+  uint32_t sent_i_tei[MAX_TEST_REQUESTS];
+  bool is_sendto_failing;
+  uint32_t failing_i_tei;
+  int failing_error;
+  bool is_holding_acks;
+  char acks[MAX_TEST_REQUESTS * 64] __attribute__((aligned(4)));
+  size_t acks_len;
+  char held_acks[MAX_TEST_REQUESTS * 64] __attribute__((aligned(4)));
+  size_t held_acks_len;
+} fake_kernel;
+
+static void queue_ack(uint32_t seq, int error)
+{
+  char *acks =
+    fake_kernel.is_holding_acks ? fake_kernel.held_acks : fake_kernel.acks;
+  size_t *acks_len = fake_kernel.is_holding_acks ?
+                       &fake_kernel.held_acks_len :
+                       &fake_kernel.acks_len;
+  struct nlmsghdr *nlh = mnl_nlmsg_put_header(acks + *acks_len);
+  nlh->nlmsg_type = NLMSG_ERROR;
+  nlh->nlmsg_seq = seq;
+  struct nlmsgerr *err = mnl_nlmsg_put_extra_header(nlh, sizeof(*err));
+  err->error = error;
+  *acks_len += nlh->nlmsg_len;
+}
+
+static ssize_t test_mnl_socket_sendto(
+  const struct mnl_socket *nl,
+  const void *req,
+  size_t siz)
+{
+  fake_kernel.num_sendto++;
+  if (fake_kernel.is_sendto_failing) {
+    errno = ENOBUFS;
+    return -1;
+  }
+
+  const struct nlmsghdr *nlh = req;
+  int remaining = (int) siz;
+  while (mnl_nlmsg_ok(nlh, remaining)) {
+    const struct nlattr *attr;
+    uint32_t i_tei = 0;
+    mnl_attr_for_each(attr, nlh, sizeof(struct genlmsghdr))
+    {
+      if (mnl_attr_get_type(attr) == GTPA_I_TEI) {
+        i_tei = mnl_attr_get_u32(attr);
+      }
+    }
+    ck_assert(nlh->nlmsg_flags & NLM_F_ACK);
+    ck_assert_uint_lt(fake_kernel.num_sent, MAX_TEST_REQUESTS);
+    fake_kernel.sent_i_tei[fake_kernel.num_sent++] = i_tei;
+    queue_ack(
+      nlh->nlmsg_seq,
+      (i_tei == fake_kernel.failing_i_tei) ? -fake_kernel.failing_error : 0);
+    nlh = mnl_nlmsg_next(nlh, &remaining);
+  }
+  return siz;
+}
+
+static ssize_t test_recv(int sockfd, void *buf, size_t len, int flags)
+{
+  if (!fake_kernel.acks_len) {
+    // a blocking read only waits for the held acks
+    if ((flags & MSG_DONTWAIT) || !fake_kernel.held_acks_len) {
+      ck_assert(flags & MSG_DONTWAIT);
+      errno = EAGAIN;
+      return -1;
+    }
+    memcpy(fake_kernel.acks, fake_kernel.held_acks, fake_kernel.held_acks_len);
+    fake_kernel.acks_len = fake_kernel.held_acks_len;
+    fake_kernel.held_acks_len = 0;
+  }
+
+  // hands out whole acks only, as the kernel does
+  size_t read_len = 0;
+  while (read_len < fake_kernel.acks_len) {
+    const struct nlmsghdr *nlh =
+      (const struct nlmsghdr *) (fake_kernel.acks + read_len);
+    if (read_len + nlh->nlmsg_len > len) break;
+    read_len += nlh->nlmsg_len;
+  }
+  memcpy(buf, fake_kernel.acks, read_len);
+  memmove(
+    fake_kernel.acks,
+    fake_kernel.acks + read_len,
+    fake_kernel.acks_len - read_len);
+  fake_kernel.acks_len -= read_len;
+  return read_len;
+}
+
+static int test_mnl_socket_get_fd(const struct mnl_socket *nl)
+{
+  return -1;
+}
+
+/* Failure reports are kept by the test instead of going to the SPGW task */
+#define itti_alloc_new_message test_itti_alloc_new_message
+#define itti_send_msg_to_task test_itti_send_msg_to_task
+#define mnl_socket_sendto test_mnl_socket_sendto
+#define mnl_socket_get_fd test_mnl_socket_get_fd
+#define recv test_recv
+#include "gtp_tunnel_libgtpnl.c"
+#undef recv
+#undef mnl_socket_get_fd
+#undef mnl_socket_sendto
+
+#define MAX_TEST_FAILURES 16
+
+static Gtpv1uTunnelFailureInd failures[MAX_TEST_FAILURES];
+static int num_failures;
+static int num_unmatched_acks_counted;
+
+MessageDef *test_itti_alloc_new_message(
+  task_id_t origin_task_id,
+  MessagesIds message_id)
+{
+  MessageDef *message_p = calloc(1, sizeof(MessageDef));
+  message_p->ittiMsgHeader.messageId = message_id;
+  message_p->ittiMsgHeader.originTaskId = origin_task_id;
+  return message_p;
+}
+
+int test_itti_send_msg_to_task(
+  task_id_t task_id,
+  instance_t instance,
+  MessageDef *message)
+{
+  ck_assert_int_eq(task_id, TASK_SPGW_APP);
+  ck_assert_int_eq(ITTI_MSG_ID(message), GTPV1U_TUNNEL_FAILURE_IND);
+  ck_assert_int_lt(num_failures, MAX_TEST_FAILURES);
+  failures[num_failures++] = message->ittiMsg.gtpv1uTunnelFailureInd;
+  free(message);
+  return RETURNok;
+}
+
+void increment_counter(
+  const char *name,
+  double increment,
+  size_t n_labels,
+  ...)
+{
+  if (!strcmp(name, "gtp_tunnel_unmatched_acks")) {
+    num_unmatched_acks_counted++;
+  }
+}
+
+static void add_tunnels(uint32_t first_i_tei, uint32_t num)
+{
+  struct in_addr ue = {.s_addr = htonl(0xc0a80001)};
+  struct in_addr enb = {.s_addr = htonl(0x0a000001)};
+  Imsi_t imsi = {0};
+
+  for (uint32_t i = 0; i < num; i++) {
+    uint32_t i_tei = first_i_tei + i;
+    ck_assert_int_eq(
+      libgtpnl_add_tunnel(ue, enb, i_tei, 1000 + i_tei, imsi), RETURNok);
+  }
+}
+
+static void setup(void)
+{
+  memset(&fake_kernel, 0, sizeof(fake_kernel));
+  memset(&gtp_nl, 0, sizeof(gtp_nl));
+  gtp_nl.is_enabled = true;
+  num_failures = 0;
+  num_unmatched_acks_counted = 0;
+}
+
+START_TEST(batch_test)
+{
+  struct in_addr ue = {.s_addr = htonl(0xc0a80001)};
+
+  add_tunnels(1, 3);
+  ck_assert_int_eq(libgtpnl_del_tunnel(ue, 4, 1004), RETURNok);
+  ck_assert_int_eq(fake_kernel.num_sendto, 0);
+
+  // all the requests go in one message, their acks are read right after
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+  ck_assert_int_eq(fake_kernel.num_sendto, 1);
+  ck_assert_uint_eq(fake_kernel.num_sent, 4);
+  for (uint32_t i = 0; i < 4; i++) {
+    ck_assert_uint_eq(fake_kernel.sent_i_tei[i], i + 1);
+  }
+  ck_assert_uint_eq(gtp_nl.num_in_flight, 0);
+  ck_assert_int_eq(num_failures, 0);
+
+  // nothing left to send
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+  ck_assert_int_eq(fake_kernel.num_sendto, 1);
+}
+END_TEST
+
+START_TEST(full_batch_test)
+{
+  add_tunnels(1, GTP_NL_MAX_BATCH_REQUESTS + 1);
+  ck_assert_int_eq(fake_kernel.num_sendto, 1);
+  ck_assert_uint_eq(fake_kernel.num_sent, GTP_NL_MAX_BATCH_REQUESTS);
+
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+  ck_assert_int_eq(fake_kernel.num_sendto, 2);
+  ck_assert_uint_eq(fake_kernel.num_sent, GTP_NL_MAX_BATCH_REQUESTS + 1);
+  ck_assert_uint_eq(gtp_nl.num_in_flight, 0);
+}
+END_TEST
+
+START_TEST(failed_ack_test)
+{
+  struct in_addr ue = {.s_addr = htonl(0xc0a80001)};
+
+  fake_kernel.failing_i_tei = 2;
+  fake_kernel.failing_error = EEXIST;
+  add_tunnels(1, 3);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+
+  ck_assert_int_eq(num_failures, 1);
+  ck_assert(!failures[0].is_delete);
+  ck_assert_uint_eq(failures[0].sgw_S1u_teid, 2);
+  ck_assert_uint_eq(failures[0].enb_S1u_teid, 1002);
+  ck_assert_int_eq(failures[0].error, EEXIST);
+
+  fake_kernel.failing_error = ENOENT;
+  ck_assert_int_eq(libgtpnl_del_tunnel(ue, 2, 1002), RETURNok);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+
+  ck_assert_int_eq(num_failures, 2);
+  ck_assert(failures[1].is_delete);
+  ck_assert_uint_eq(failures[1].sgw_S1u_teid, 2);
+  ck_assert_int_eq(failures[1].error, ENOENT);
+}
+END_TEST
+
+START_TEST(failed_send_test)
+{
+  fake_kernel.is_sendto_failing = true;
+  add_tunnels(1, 2);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNerror);
+
+  // every request of the batch is reported
+  ck_assert_int_eq(num_failures, 2);
+  ck_assert_uint_eq(failures[0].sgw_S1u_teid, 1);
+  ck_assert_uint_eq(failures[1].sgw_S1u_teid, 2);
+  ck_assert_int_eq(failures[0].error, ENOBUFS);
+  ck_assert_uint_eq(gtp_nl.num_in_flight, 0);
+
+  // the next batch is sent on its own
+  fake_kernel.is_sendto_failing = false;
+  add_tunnels(3, 1);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+  ck_assert_uint_eq(fake_kernel.num_sent, 1);
+  ck_assert_int_eq(num_failures, 2);
+}
+END_TEST
+
+START_TEST(full_window_test)
+{
+  // The acks of the first requests are only read once the window is full,
+  // after the requests of the next batch took their slots
+  fake_kernel.is_holding_acks = true;
+  fake_kernel.failing_i_tei = 1;
+  fake_kernel.failing_error = EEXIST;
+  add_tunnels(1, GTP_NL_MAX_IN_FLIGHT + GTP_NL_MAX_BATCH_REQUESTS);
+  ck_assert_uint_eq(gtp_nl.num_in_flight, GTP_NL_MAX_IN_FLIGHT);
+
+  fake_kernel.is_holding_acks = false;
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+  ck_assert_uint_eq(
+    fake_kernel.num_sent, GTP_NL_MAX_IN_FLIGHT + GTP_NL_MAX_BATCH_REQUESTS);
+  ck_assert_uint_eq(gtp_nl.num_in_flight, 0);
+
+  // the failed ack still found its request
+  ck_assert_int_eq(num_failures, 1);
+  ck_assert_uint_eq(failures[0].sgw_S1u_teid, 1);
+  ck_assert_uint_eq(gtp_nl.num_unmatched_acks, 0);
+  ck_assert_int_eq(num_unmatched_acks_counted, 0);
+}
+END_TEST
+
+START_TEST(unmatched_ack_test)
+{
+  add_tunnels(1, 1);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+
+  // a second ack for the same request, and one for a request never sent,
+  // read with the ack of the next request
+  queue_ack(1, -EEXIST);
+  queue_ack(100, 0);
+  add_tunnels(2, 1);
+  ck_assert_int_eq(libgtpnl_flush(), RETURNok);
+
+  ck_assert_int_eq(num_failures, 0);
+  ck_assert_uint_eq(gtp_nl.num_in_flight, 0);
+  ck_assert_uint_eq(gtp_nl.num_unmatched_acks, 2);
+  ck_assert_int_eq(num_unmatched_acks_counted, 2);
+}
+END_TEST
+
+Suite *gtp_tunnel_libgtpnl_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("GTP tunnel libgtpnl tests");
+
+  /* Core test case */
+  tc_core = tcase_create("GTP tunnel batch test");
+  tcase_add_checked_fixture(tc_core, setup, NULL);
+  tcase_add_test(tc_core, batch_test);
+  tcase_add_test(tc_core, full_batch_test);
+  tcase_add_test(tc_core, failed_ack_test);
+  tcase_add_test(tc_core, failed_send_test);
+  tcase_add_test(tc_core, full_window_test);
+  tcase_add_test(tc_core, unmatched_ack_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = gtp_tunnel_libgtpnl_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
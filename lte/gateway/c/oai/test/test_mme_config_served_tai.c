@@ -0,0 +1,153 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "conversions.h"
+#include "mme_config.h"
+
+#define TEST_CASE_PLMN_MAX 5
+
+/* Stands in for the S1AP PLMNidentity OCTET STRING */
+typedef struct test_plmn_identity_s {
+  uint8_t *buf;
+  int size;
+} test_plmn_identity_t;
+
+static const uint16_t test_mcc[TEST_CASE_PLMN_MAX] = {1, 1, 310, 262, 999};
+static const uint16_t test_mnc[TEST_CASE_PLMN_MAX] = {1, 1, 150, 1, 99};
+static const uint16_t test_mnc_len[TEST_CASE_PLMN_MAX] = {2, 3, 3, 2, 2};
+
+START_TEST(plmn_key_test)
+{
+  for (int i = 0; i < TEST_CASE_PLMN_MAX; i++) {
+    test_plmn_identity_t plmn = {0};
+    test_plmn_identity_t from_key = {0};
+    uint32_t plmn_key =
+      MCC_MNC_TO_PLMN_KEY(test_mcc[i], test_mnc[i], test_mnc_len[i]);
+
+    // the key is the TBCD encoding sent over S1
+    MCC_MNC_TO_PLMNID(test_mcc[i], test_mnc[i], test_mnc_len[i], &plmn);
+    ck_assert_uint_eq(TBCD_TO_PLMN_KEY(&plmn), plmn_key);
+
+    PLMN_KEY_TO_PLMNID(plmn_key, &from_key);
+    ck_assert_int_eq(from_key.size, 3);
+    ck_assert(memcmp(from_key.buf, plmn.buf, 3) == 0);
+
+    free(plmn.buf);
+    free(from_key.buf);
+  }
+
+  // 2 and 3 digit MNCs with the same value are different PLMNs
+  ck_assert(MCC_MNC_TO_PLMN_KEY(1, 1, 2) != MCC_MNC_TO_PLMN_KEY(1, 1, 3));
+}
+END_TEST
+
+START_TEST(served_tai_lookup_test)
+{
+  // unsorted, with duplicate PLMNs and TACs
+  uint16_t plmn_mcc[] = {310, 1, 310, 1, 1};
+  uint16_t plmn_mnc[] = {150, 1, 150, 1, 1};
+  uint16_t plmn_mnc_len[] = {3, 2, 3, 2, 3};
+  uint16_t tac[] = {7, 1, 7, 3, 1};
+  served_tai_t served_tai = {.nb_tai = 5,
+                             .plmn_mcc = plmn_mcc,
+                             .plmn_mnc = plmn_mnc,
+                             .plmn_mnc_len = plmn_mnc_len,
+                             .tac = tac};
+
+  mme_config_build_served_tai_lookup(&served_tai);
+
+  ck_assert_uint_eq(served_tai.nb_plmn_keys, 3);
+  for (int i = 1; i < served_tai.nb_plmn_keys; i++) {
+    ck_assert(served_tai.plmn_keys[i - 1] < served_tai.plmn_keys[i]);
+  }
+  ck_assert_uint_eq(served_tai.nb_tacs, 3);
+  ck_assert_uint_eq(served_tai.tacs[0], 1);
+  ck_assert_uint_eq(served_tai.tacs[1], 3);
+  ck_assert_uint_eq(served_tai.tacs[2], 7);
+
+  for (int i = 0; i < served_tai.nb_tai; i++) {
+    ck_assert(mme_config_is_served_plmn(
+      &served_tai,
+      MCC_MNC_TO_PLMN_KEY(plmn_mcc[i], plmn_mnc[i], plmn_mnc_len[i])));
+    ck_assert(mme_config_is_served_tac(&served_tai, tac[i]));
+  }
+  ck_assert(
+    !mme_config_is_served_plmn(&served_tai, MCC_MNC_TO_PLMN_KEY(1, 2, 2)));
+  ck_assert(!mme_config_is_served_tac(&served_tai, 2));
+
+  free(served_tai.plmn_keys);
+  free(served_tai.tacs);
+}
+END_TEST
+
+START_TEST(empty_served_tai_lookup_test)
+{
+  served_tai_t served_tai = {.nb_tai = 0};
+
+  mme_config_build_served_tai_lookup(&served_tai);
+
+  ck_assert_uint_eq(served_tai.nb_plmn_keys, 0);
+  ck_assert_uint_eq(served_tai.nb_tacs, 0);
+  ck_assert(
+    !mme_config_is_served_plmn(&served_tai, MCC_MNC_TO_PLMN_KEY(1, 1, 2)));
+  ck_assert(!mme_config_is_served_tac(&served_tai, 1));
+
+  free(served_tai.plmn_keys);
+  free(served_tai.tacs);
+}
+END_TEST
+
+Suite *served_tai_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("Served TAI tests");
+
+  /* Core test case */
+  tc_core = tcase_create("Served TAI test");
+  tcase_add_test(tc_core, plmn_key_test);
+  tcase_add_test(tc_core, served_tai_lookup_test);
+  tcase_add_test(tc_core, empty_served_tai_lookup_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = served_tai_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,455 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/* Includes the arena to look at its chunks */
+#include "s1ap_arena.c"
+
+#include "asn_internal.h"
+#include "bstrlib.h"
+#include "common_defs.h"
+#include "intertask_interface.h"
+#include "s1ap_common.h"
+#include "s1ap_ies_defs.h"
+#include "s1ap_mme_decoder.h"
+
+/*
+ * UE capability info indications are left to the full decoder, which copies
+ * the radio capability twice: it does not fit in a single chunk
+ */
+#define LARGE_RADIO_CAPABILITY_LENGTH 12000
+
+static uint8_t test_data[LARGE_RADIO_CAPABILITY_LENGTH];
+
+static int arena_nb_chunks(void)
+{
+  int nb_chunks = 0;
+
+  for (arena_chunk_t *chunk = arena.chunks; chunk; chunk = chunk->next) {
+    nb_chunks++;
+  }
+  return nb_chunks;
+}
+
+static void setup(void)
+{
+  // every test starts without any chunk
+  s1ap_arena_leave();
+  s1ap_arena_reset();
+  free(arena.chunks);
+  arena.chunks = NULL;
+
+  for (int i = 0; i < LARGE_RADIO_CAPABILITY_LENGTH; i++) {
+    test_data[i] = i * 7;
+  }
+}
+
+static void teardown(void)
+{
+  s1ap_arena_reset();
+  free(arena.chunks);
+  arena.chunks = NULL;
+}
+
+/*
+ * Encodes an uplink NAS transport. The PDU is built in the arena so that
+ * nothing has to be freed but the returned bstring.
+ */
+static bstring encode_uplink_nas(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  uint32_t nas_length)
+{
+  S1ap_UplinkNASTransportIEs_t ies = {0};
+  S1ap_UplinkNASTransport_t out = {0};
+  const uint8_t plmn[] = {0x02, 0xf8, 0x59};
+  const uint8_t tac[] = {0x00, 0x01};
+  const uint8_t cell_id[] = {0x12, 0x34, 0x56, 0x70};
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = mme_ue_s1ap_id;
+  ies.eNB_UE_S1AP_ID = 0x10203;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) test_data, nas_length);
+  OCTET_STRING_fromBuf(
+    &ies.eutran_cgi.pLMNidentity, (const char *) plmn, sizeof(plmn));
+  ies.eutran_cgi.cell_ID.buf = MALLOC(sizeof(cell_id));
+  memcpy(ies.eutran_cgi.cell_ID.buf, cell_id, sizeof(cell_id));
+  ies.eutran_cgi.cell_ID.size = sizeof(cell_id);
+  ies.eutran_cgi.cell_ID.bits_unused = 4;
+  OCTET_STRING_fromBuf(&ies.tai.pLMNidentity, (const char *) plmn, 3);
+  OCTET_STRING_fromBuf(&ies.tai.tAC, (const char *) tac, sizeof(tac));
+  ck_assert_int_eq(s1ap_encode_s1ap_uplinknastransporties(&out, &ies), 0);
+  ck_assert_int_gt(
+    s1ap_generate_initiating_message(
+      &buffer,
+      &length,
+      S1ap_ProcedureCode_id_uplinkNASTransport,
+      S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UplinkNASTransport,
+      &out),
+    0);
+  s1ap_arena_leave();
+
+  bstring pdu = blk2bstr(buffer, length);
+  s1ap_arena_reset();
+  return pdu;
+}
+
+static void check_uplink_nas(
+  s1ap_message *message,
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  uint32_t nas_length)
+{
+  S1ap_UplinkNASTransportIEs_t *ies =
+    &message->msg.s1ap_UplinkNASTransportIEs;
+
+  ck_assert_int_eq(
+    s1ap_mme_decode_deferred_ie(message, S1ap_ProtocolIE_ID_id_TAI),
+    RETURNok);
+  ck_assert_uint_eq(ies->mme_ue_s1ap_id, mme_ue_s1ap_id);
+  ck_assert_uint_eq(ies->eNB_UE_S1AP_ID, 0x10203);
+  ck_assert_int_eq(ies->nas_pdu.size, nas_length);
+  ck_assert(!memcmp(ies->nas_pdu.buf, test_data, nas_length));
+  ck_assert_int_eq(ies->tai.tAC.size, 2);
+  ck_assert_int_eq(ies->tai.tAC.buf[1], 0x01);
+  // the decoded TAI is in the arena
+  ck_assert(arena_owns(ies->tai.tAC.buf));
+}
+
+/*
+ * Encodes a UE capability info indication, in the arena like
+ * encode_uplink_nas
+ */
+static bstring encode_ue_capability_ind(uint32_t radio_capability_length)
+{
+  S1ap_UECapabilityInfoIndicationIEs_t ies = {0};
+  S1ap_UECapabilityInfoIndication_t out = {0};
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = 0x405;
+  ies.eNB_UE_S1AP_ID = 0x10203;
+  OCTET_STRING_fromBuf(
+    &ies.ueRadioCapability,
+    (const char *) test_data,
+    radio_capability_length);
+  ck_assert_int_eq(
+    s1ap_encode_s1ap_uecapabilityinfoindicationies(&out, &ies), 0);
+  ck_assert_int_gt(
+    s1ap_generate_initiating_message(
+      &buffer,
+      &length,
+      S1ap_ProcedureCode_id_UECapabilityInfoIndication,
+      S1ap_Criticality_ignore,
+      &asn_DEF_S1ap_UECapabilityInfoIndication,
+      &out),
+    0);
+  s1ap_arena_leave();
+
+  bstring pdu = blk2bstr(buffer, length);
+  s1ap_arena_reset();
+  return pdu;
+}
+
+static void check_ue_capability_ind(
+  s1ap_message *message,
+  uint32_t radio_capability_length)
+{
+  S1ap_UECapabilityInfoIndicationIEs_t *ies =
+    &message->msg.s1ap_UECapabilityInfoIndicationIEs;
+
+  ck_assert_uint_eq(ies->mme_ue_s1ap_id, 0x405);
+  ck_assert_uint_eq(ies->eNB_UE_S1AP_ID, 0x10203);
+  ck_assert_int_eq(ies->ueRadioCapability.size, radio_capability_length);
+  ck_assert(
+    !memcmp(ies->ueRadioCapability.buf, test_data, radio_capability_length));
+  ck_assert(arena_owns(ies->ueRadioCapability.buf));
+}
+
+START_TEST(heap_outside_arena_test)
+{
+  uint8_t *ptr = CALLOC(4, 16);
+
+  ck_assert_ptr_ne(ptr, NULL);
+  ck_assert_ptr_eq(arena.chunks, NULL);
+  for (int i = 0; i < 64; i++) {
+    ck_assert_int_eq(ptr[i], 0);
+  }
+  ptr = REALLOC(ptr, 4096);
+  ck_assert_ptr_ne(ptr, NULL);
+  ck_assert_ptr_eq(arena.chunks, NULL);
+  // freed on the heap, LeakSanitizer reports it otherwise
+  FREEMEM(ptr);
+  FREEMEM(NULL);
+
+  ptr = MALLOC(32);
+  ck_assert_ptr_eq(arena.chunks, NULL);
+  FREEMEM(ptr);
+}
+END_TEST
+
+START_TEST(arena_alloc_test)
+{
+  uint8_t *heap_ptr = MALLOC(16);
+
+  s1ap_arena_enter();
+  uint8_t *ptr = CALLOC(3, 10);
+  ck_assert_ptr_ne(ptr, NULL);
+  ck_assert(arena_owns(ptr));
+  ck_assert_uint_eq((uintptr_t) ptr % ARENA_ALIGNMENT, 0);
+  for (int i = 0; i < 30; i++) {
+    ck_assert_int_eq(ptr[i], 0);
+    ptr[i] = i;
+  }
+
+  // shrinking keeps the block, growing copies it
+  ck_assert_ptr_eq(REALLOC(ptr, 20), ptr);
+  uint8_t *new_ptr = REALLOC(ptr, 1000);
+  ck_assert_ptr_ne(new_ptr, ptr);
+  ck_assert(arena_owns(new_ptr));
+  for (int i = 0; i < 20; i++) {
+    ck_assert_int_eq(new_ptr[i], i);
+  }
+  ck_assert(arena_owns(REALLOC(NULL, 8)));
+
+  // memory from the heap stays on the heap
+  heap_ptr = REALLOC(heap_ptr, 2048);
+  ck_assert_ptr_ne(heap_ptr, NULL);
+  ck_assert(!arena_owns(heap_ptr));
+  FREEMEM(heap_ptr);
+  s1ap_arena_leave();
+
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  s1ap_arena_reset();
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  ck_assert_uint_eq(arena.chunks->used, 0);
+}
+END_TEST
+
+START_TEST(freemem_arena_pointer_test)
+{
+  s1ap_arena_enter();
+  uint8_t *ptr = MALLOC(64);
+  memset(ptr, 0x5a, 64);
+  // AddressSanitizer reports a bad free if it reaches free()
+  FREEMEM(ptr);
+  s1ap_arena_leave();
+  FREEMEM(ptr);
+
+  // the block stays valid until the arena is reset
+  for (int i = 0; i < 64; i++) {
+    ck_assert_int_eq(ptr[i], 0x5a);
+  }
+  ck_assert(arena_owns(ptr));
+  s1ap_arena_reset();
+  ck_assert(!arena_owns(ptr));
+}
+END_TEST
+
+START_TEST(overflow_test)
+{
+  s1ap_arena_enter();
+  uint8_t *ptr1 = MALLOC(ARENA_CHUNK_SIZE / 2);
+  arena_chunk_t *first_chunk = arena.chunks;
+  uint8_t *ptr2 = MALLOC(ARENA_CHUNK_SIZE / 2);
+  ck_assert_int_eq(arena_nb_chunks(), 2);
+
+  // a block larger than a chunk gets a chunk of its own
+  uint8_t *ptr3 = MALLOC(4 * ARENA_CHUNK_SIZE);
+  ck_assert_int_eq(arena_nb_chunks(), 3);
+  ck_assert_uint_ge(arena.chunks->size, 4 * ARENA_CHUNK_SIZE);
+  memset(ptr1, 1, ARENA_CHUNK_SIZE / 2);
+  memset(ptr2, 2, ARENA_CHUNK_SIZE / 2);
+  memset(ptr3, 3, 4 * ARENA_CHUNK_SIZE);
+  ck_assert(arena_owns(ptr1) && arena_owns(ptr2) && arena_owns(ptr3));
+  FREEMEM(ptr1);
+  FREEMEM(ptr2);
+  FREEMEM(ptr3);
+  s1ap_arena_leave();
+
+  // the other chunks go back to the heap, LeakSanitizer checks it
+  s1ap_arena_reset();
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  ck_assert_ptr_eq(arena.chunks, first_chunk);
+  ck_assert_uint_eq(first_chunk->used, 0);
+}
+END_TEST
+
+START_TEST(large_first_chunk_test)
+{
+  s1ap_arena_enter();
+  uint8_t *ptr = MALLOC(2 * ARENA_CHUNK_SIZE);
+  memset(ptr, 0, 2 * ARENA_CHUNK_SIZE);
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  s1ap_arena_leave();
+
+  // a large chunk is not kept for the next message
+  s1ap_arena_reset();
+  ck_assert_ptr_eq(arena.chunks, NULL);
+}
+END_TEST
+
+START_TEST(decode_pdu_test)
+{
+  bstring pdu = encode_uplink_nas(0x80000001, 100);
+  s1ap_message message = {0};
+  MessagesIds message_id = MESSAGES_ID_MAX;
+
+  ck_assert_int_eq(s1ap_mme_decode_pdu(&message, &pdu, &message_id), RETURNok);
+  ck_assert_int_eq(message_id, S1AP_UPLINK_NAS_LOG);
+  check_uplink_nas(&message, 0x80000001, 100);
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  ck_assert_uint_gt(arena.chunks->used, 0);
+
+  s1ap_free_mme_decode_pdu(&message, message_id);
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  ck_assert_uint_eq(arena.chunks->used, 0);
+  bdestroy(pdu);
+}
+END_TEST
+
+START_TEST(decode_large_pdu_test)
+{
+  bstring pdu = encode_ue_capability_ind(LARGE_RADIO_CAPABILITY_LENGTH);
+  s1ap_message message = {0};
+  MessagesIds message_id = MESSAGES_ID_MAX;
+
+  ck_assert_int_eq(s1ap_mme_decode_pdu(&message, &pdu, &message_id), RETURNok);
+  ck_assert_int_eq(message_id, S1AP_UE_CAPABILITY_IND_LOG);
+  check_ue_capability_ind(&message, LARGE_RADIO_CAPABILITY_LENGTH);
+  // the first chunk overflows to the heap
+  ck_assert_int_gt(arena_nb_chunks(), 1);
+
+  s1ap_free_mme_decode_pdu(&message, message_id);
+  ck_assert_int_le(arena_nb_chunks(), 1);
+  bdestroy(pdu);
+}
+END_TEST
+
+START_TEST(reset_between_messages_test)
+{
+  bstring small_pdu = encode_uplink_nas(1, 200);
+  bstring large_pdu = encode_ue_capability_ind(LARGE_RADIO_CAPABILITY_LENGTH);
+  arena_chunk_t *first_chunk = NULL;
+
+  for (int i = 0; i < 20; i++) {
+    s1ap_message message = {0};
+    MessagesIds message_id = MESSAGES_ID_MAX;
+    bool large = i % 3 == 1;
+
+    // the previous message is not freed, the next decode resets the arena
+    ck_assert_int_eq(
+      s1ap_mme_decode_pdu(
+        &message, large ? &large_pdu : &small_pdu, &message_id),
+      RETURNok);
+    if (large) {
+      check_ue_capability_ind(&message, LARGE_RADIO_CAPABILITY_LENGTH);
+      ck_assert_int_gt(arena_nb_chunks(), 1);
+    } else {
+      check_uplink_nas(&message, 1, 200);
+      // the first chunk is reused by every small message
+      ck_assert_int_eq(arena_nb_chunks(), 1);
+      if (!first_chunk) {
+        first_chunk = arena.chunks;
+      }
+      ck_assert_ptr_eq(arena.chunks, first_chunk);
+    }
+  }
+  s1ap_arena_reset();
+  ck_assert_int_eq(arena_nb_chunks(), 1);
+  ck_assert_ptr_eq(arena.chunks, first_chunk);
+  bdestroy(small_pdu);
+  bdestroy(large_pdu);
+}
+END_TEST
+
+START_TEST(asn_struct_free_test)
+{
+  bstring pdu = encode_uplink_nas(3, 300);
+  S1AP_PDU_t *pdu_p = NULL;
+
+  s1ap_arena_enter();
+  asn_dec_rval_t dec_ret = aper_decode(
+    NULL,
+    &asn_DEF_S1AP_PDU,
+    (void **) &pdu_p,
+    bdata(pdu),
+    blength(pdu),
+    0,
+    0);
+  s1ap_arena_leave();
+  ck_assert_int_eq(dec_ret.code, RC_OK);
+  ck_assert(arena_owns(pdu_p));
+
+  // freeing the PDU and its members does not touch the arena
+  ASN_STRUCT_FREE(asn_DEF_S1AP_PDU, pdu_p);
+  ck_assert_int_eq(pdu_p->present, S1AP_PDU_PR_initiatingMessage);
+  ck_assert_int_eq(
+    pdu_p->choice.initiatingMessage.procedureCode,
+    S1ap_ProcedureCode_id_uplinkNASTransport);
+  s1ap_arena_reset();
+  bdestroy(pdu);
+}
+END_TEST
+
+Suite *s1ap_arena_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("S1AP arena tests");
+
+  /* Core test case */
+  tc_core = tcase_create("S1AP arena test");
+  tcase_add_checked_fixture(tc_core, setup, teardown);
+  tcase_add_test(tc_core, heap_outside_arena_test);
+  tcase_add_test(tc_core, arena_alloc_test);
+  tcase_add_test(tc_core, freemem_arena_pointer_test);
+  tcase_add_test(tc_core, overflow_test);
+  tcase_add_test(tc_core, large_first_chunk_test);
+  tcase_add_test(tc_core, decode_pdu_test);
+  tcase_add_test(tc_core, decode_large_pdu_test);
+  tcase_add_test(tc_core, reset_between_messages_test);
+  tcase_add_test(tc_core, asn_struct_free_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = s1ap_arena_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,440 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/* Includes the decoder to run the lazy and the full decoders separately */
+#include "s1ap_mme_decoder.c"
+
+#include "asn_internal.h"
+
+#define NB_MUTATIONS 20000
+
+static uint8_t test_data[1000];
+
+/*
+ * Encodes a message built in the arena, so that nothing has to be freed but
+ * the returned bstring
+ */
+static bstring generate_pdu(
+  int rc,
+  bool successful_outcome,
+  e_S1ap_ProcedureCode procedure_code,
+  S1ap_Criticality_t criticality,
+  asn_TYPE_descriptor_t *td,
+  void *message)
+{
+  uint8_t *buffer = NULL;
+  uint32_t length = 0;
+
+  ck_assert_int_eq(rc, 0);
+  if (successful_outcome) {
+    rc = s1ap_generate_successfull_outcome(
+      &buffer, &length, procedure_code, criticality, td, message);
+  } else {
+    rc = s1ap_generate_initiating_message(
+      &buffer, &length, procedure_code, criticality, td, message);
+  }
+  ck_assert_int_gt(rc, 0);
+  s1ap_arena_leave();
+
+  bstring pdu = blk2bstr(buffer, length);
+  s1ap_arena_reset();
+  return pdu;
+}
+
+static bstring uplink_nas_pdu(uint32_t nas_length, bool gw_address)
+{
+  S1ap_UplinkNASTransportIEs_t ies = {0};
+  S1ap_UplinkNASTransport_t out = {0};
+  const uint8_t plmn[] = {0x02, 0xf8, 0x59};
+  const uint8_t tac[] = {0x00, 0x01};
+  const uint8_t cell_id[] = {0x12, 0x34, 0x56, 0x70};
+  const uint8_t address[] = {192, 168, 60, 142};
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = 0xFFFFFFFF - nas_length;
+  ies.eNB_UE_S1AP_ID = nas_length * 1000;
+  OCTET_STRING_fromBuf(&ies.nas_pdu, (const char *) test_data, nas_length);
+  OCTET_STRING_fromBuf(
+    &ies.eutran_cgi.pLMNidentity, (const char *) plmn, sizeof(plmn));
+  ies.eutran_cgi.cell_ID.buf = MALLOC(sizeof(cell_id));
+  memcpy(ies.eutran_cgi.cell_ID.buf, cell_id, sizeof(cell_id));
+  ies.eutran_cgi.cell_ID.size = sizeof(cell_id);
+  ies.eutran_cgi.cell_ID.bits_unused = 4;
+  OCTET_STRING_fromBuf(&ies.tai.pLMNidentity, (const char *) plmn, 3);
+  OCTET_STRING_fromBuf(&ies.tai.tAC, (const char *) tac, sizeof(tac));
+  if (gw_address) {
+    ies.presenceMask |=
+      S1AP_UPLINKNASTRANSPORTIES_GW_TRANSPORTLAYERADDRESS_PRESENT;
+    ies.gW_TransportLayerAddress.buf = MALLOC(sizeof(address));
+    memcpy(ies.gW_TransportLayerAddress.buf, address, sizeof(address));
+    ies.gW_TransportLayerAddress.size = sizeof(address);
+  }
+  return generate_pdu(
+    s1ap_encode_s1ap_uplinknastransporties(&out, &ies),
+    false,
+    S1ap_ProcedureCode_id_uplinkNASTransport,
+    S1ap_Criticality_ignore,
+    &asn_DEF_S1ap_UplinkNASTransport,
+    &out);
+}
+
+static bstring ue_context_release_request_pdu(bool gw_release)
+{
+  S1ap_UEContextReleaseRequestIEs_t ies = {0};
+  S1ap_UEContextReleaseRequest_t out = {0};
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = 5;
+  ies.eNB_UE_S1AP_ID = 0xFFFFFF;
+  ies.cause.present = S1ap_Cause_PR_radioNetwork;
+  ies.cause.choice.radioNetwork = S1ap_CauseRadioNetwork_user_inactivity;
+  if (gw_release) {
+    ies.presenceMask |=
+      S1AP_UECONTEXTRELEASEREQUESTIES_GWCONTEXTRELEASEINDICATION_PRESENT;
+    ies.gwContextReleaseIndication = S1ap_GWContextReleaseIndication_true;
+  }
+  return generate_pdu(
+    s1ap_encode_s1ap_uecontextreleaserequesties(&out, &ies),
+    false,
+    S1ap_ProcedureCode_id_UEContextReleaseRequest,
+    S1ap_Criticality_ignore,
+    &asn_DEF_S1ap_UEContextReleaseRequest,
+    &out);
+}
+
+static bstring ue_context_release_complete_pdu(bool diagnostics)
+{
+  S1ap_UEContextReleaseCompleteIEs_t ies = {0};
+  S1ap_UEContextReleaseComplete_t out = {0};
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = 70000;
+  ies.eNB_UE_S1AP_ID = 300;
+  if (diagnostics) {
+    ies.presenceMask |=
+      S1AP_UECONTEXTRELEASECOMPLETEIES_CRITICALITYDIAGNOSTICS_PRESENT;
+    ies.criticalityDiagnostics.procedureCode =
+      CALLOC(1, sizeof(S1ap_ProcedureCode_t));
+    *ies.criticalityDiagnostics.procedureCode =
+      S1ap_ProcedureCode_id_UEContextRelease;
+  }
+  return generate_pdu(
+    s1ap_encode_s1ap_uecontextreleasecompleteies(&out, &ies),
+    true,
+    S1ap_ProcedureCode_id_UEContextRelease,
+    S1ap_Criticality_reject,
+    &asn_DEF_S1ap_UEContextReleaseComplete,
+    &out);
+}
+
+static bstring initial_context_setup_response_pdu(int nb_e_rabs)
+{
+  S1ap_InitialContextSetupResponseIEs_t ies = {0};
+  S1ap_InitialContextSetupResponse_t out = {0};
+
+  s1ap_arena_enter();
+  ies.mme_ue_s1ap_id = 1;
+  ies.eNB_UE_S1AP_ID = 2;
+  for (int i = 0; i < nb_e_rabs; i++) {
+    S1ap_E_RABSetupItemCtxtSURes_t *item = CALLOC(1, sizeof(*item));
+    const uint8_t teid[] = {1, 2, 3, i};
+
+    item->e_RAB_ID = 5 + i;
+    item->transportLayerAddress.buf = MALLOC(4);
+    memset(item->transportLayerAddress.buf, i + 1, 4);
+    item->transportLayerAddress.size = 4;
+    OCTET_STRING_fromBuf(&item->gTP_TEID, (const char *) teid, sizeof(teid));
+    ASN_SEQUENCE_ADD(
+      &ies.e_RABSetupListCtxtSURes.s1ap_E_RABSetupItemCtxtSURes, item);
+  }
+  return generate_pdu(
+    s1ap_encode_s1ap_initialcontextsetupresponseies(&out, &ies),
+    true,
+    S1ap_ProcedureCode_id_InitialContextSetup,
+    S1ap_Criticality_reject,
+    &asn_DEF_S1ap_InitialContextSetupResponse,
+    &out);
+}
+
+/*
+ * Compares the encodings of a decoded value, so that both decoders must
+ * agree on every member of the IE
+ */
+static void assert_same_value(
+  asn_TYPE_descriptor_t *td,
+  void *lazy_value,
+  void *full_value)
+{
+  void *lazy_buffer = NULL;
+  void *full_buffer = NULL;
+
+  ssize_t lazy_length =
+    aper_encode_to_new_buffer(td, 0, lazy_value, &lazy_buffer);
+  ssize_t full_length =
+    aper_encode_to_new_buffer(td, 0, full_value, &full_buffer);
+  ck_assert_int_eq(lazy_length, full_length);
+  if (lazy_length > 0) {
+    ck_assert(!memcmp(lazy_buffer, full_buffer, lazy_length));
+  }
+}
+
+// Lists are converted to the IEs structures, which hold a sequence of items
+static void assert_same_list(
+  S1ap_ProtocolIE_ID_t id,
+  void *lazy_list,
+  void *full_list)
+{
+  asn_TYPE_descriptor_t *td =
+    id == S1ap_ProtocolIE_ID_id_E_RABSetupListCtxtSURes ?
+      &asn_DEF_S1ap_E_RABSetupItemCtxtSURes :
+      &asn_DEF_S1ap_E_RABItem;
+  asn_anonymous_sequence_ *lazy_items = lazy_list;
+  asn_anonymous_sequence_ *full_items = full_list;
+
+  ck_assert_int_eq(lazy_items->count, full_items->count);
+  for (int i = 0; i < lazy_items->count; i++) {
+    assert_same_value(td, lazy_items->array[i], full_items->array[i]);
+  }
+}
+
+static void assert_same_message(
+  const s1ap_lazy_procedure_t *procedure,
+  s1ap_message *lazy,
+  s1ap_message *full)
+{
+  uint16_t lazy_presence =
+    *(uint16_t *) ((uint8_t *) &lazy->msg + procedure->presence_offset);
+  uint16_t full_presence =
+    *(uint16_t *) ((uint8_t *) &full->msg + procedure->presence_offset);
+
+  ck_assert_int_eq(lazy->direction, full->direction);
+  ck_assert_int_eq(lazy->procedureCode, full->procedureCode);
+  ck_assert_int_eq(lazy->criticality, full->criticality);
+  ck_assert_int_eq(lazy_presence, full_presence);
+  for (int i = 0; i < procedure->nb_ies; i++) {
+    const s1ap_lazy_ie_t *ie = &procedure->ies[i];
+    void *lazy_field = (uint8_t *) &lazy->msg + ie->offset;
+    void *full_field = (uint8_t *) &full->msg + ie->offset;
+
+    if (ie->present && !(lazy_presence & ie->present)) {
+      continue;
+    }
+    switch (ie->kind) {
+      case LAZY_IE_MME_UE_S1AP_ID:
+        ck_assert_uint_eq(
+          *(S1ap_MME_UE_S1AP_ID_t *) lazy_field,
+          *(S1ap_MME_UE_S1AP_ID_t *) full_field);
+        break;
+      case LAZY_IE_ENB_UE_S1AP_ID:
+        ck_assert_uint_eq(
+          *(S1ap_ENB_UE_S1AP_ID_t *) lazy_field,
+          *(S1ap_ENB_UE_S1AP_ID_t *) full_field);
+        break;
+      case LAZY_IE_OCTET_STRING: {
+        OCTET_STRING_t *lazy_string = lazy_field;
+        OCTET_STRING_t *full_string = full_field;
+        ck_assert_int_eq(lazy_string->size, full_string->size);
+        ck_assert(
+          !memcmp(lazy_string->buf, full_string->buf, lazy_string->size));
+      } break;
+      case LAZY_IE_ASN:
+      case LAZY_IE_ASN_DEFERRED:
+        if (ie->convert) {
+          assert_same_list(ie->id, lazy_field, full_field);
+        } else {
+          assert_same_value(ie->td, lazy_field, full_field);
+        }
+        break;
+    }
+  }
+}
+
+/*
+ * Decodes a PDU with both decoders. Whenever the lazy decoder accepts the PDU
+ * and its deferred IEs, the full decoder must decode the same message.
+ * @return whether the lazy decoder accepted the PDU
+ */
+static bool check_decoders(const uint8_t *data, int length)
+{
+  // exactly sized, for AddressSanitizer to catch any read past the PDU
+  uint8_t *buffer = malloc(length ? length : 1);
+  struct tagbstring raw = {length, length, buffer};
+  bstring raw_p = &raw;
+  s1ap_message lazy = {0};
+  s1ap_message full = {0};
+  MessagesIds lazy_message_id = MESSAGES_ID_MAX;
+  MessagesIds full_message_id = MESSAGES_ID_MAX;
+  S1ap_ProtocolIE_ID_t deferred_ids[S1AP_MAX_DEFERRED_IES];
+  bool deferred_decoded = true;
+
+  memcpy(buffer, data, length);
+  s1ap_arena_reset();
+  s1ap_arena_enter();
+  int lazy_rc = s1ap_mme_decode_lazy(&lazy, &raw_p, &lazy_message_id);
+  s1ap_arena_leave();
+  if (lazy_rc == RETURNok) {
+    int nb_deferred_ies = deferred.nb_ies;
+    for (int i = 0; i < nb_deferred_ies; i++) {
+      deferred_ids[i] = deferred.ies[i].ie->id;
+    }
+    for (int i = 0; i < nb_deferred_ies; i++) {
+      deferred_decoded =
+        s1ap_mme_decode_deferred_ie(&lazy, deferred_ids[i]) == RETURNok &&
+        deferred_decoded;
+    }
+  }
+
+  s1ap_arena_enter();
+  int full_rc = s1ap_mme_decode_full(&full, &raw, &full_message_id);
+  if (lazy_rc == RETURNok && !deferred_decoded) {
+    // the full decoder decodes the IE that the lazy decoder could not
+    ck_assert_int_lt(full_rc, 0);
+  } else if (lazy_rc == RETURNok) {
+    ck_assert_int_ge(full_rc, 0);
+    ck_assert_int_eq(lazy_message_id, full_message_id);
+    for (int i = 0;
+         i < sizeof(lazy_procedures) / sizeof(lazy_procedures[0]);
+         i++) {
+      if (lazy_procedures[i].message_id == lazy_message_id) {
+        assert_same_message(&lazy_procedures[i], &lazy, &full);
+      }
+    }
+  }
+  s1ap_arena_leave();
+  s1ap_arena_reset();
+  deferred.message = NULL;
+  free(buffer);
+  return lazy_rc == RETURNok;
+}
+
+static bstring *test_pdus(int *nb_pdus)
+{
+  static bstring pdus[12];
+
+  if (!pdus[0]) {
+    pdus[0] = uplink_nas_pdu(0, false);
+    pdus[1] = uplink_nas_pdu(1, false);
+    pdus[2] = uplink_nas_pdu(200, true);
+    pdus[3] = uplink_nas_pdu(sizeof(test_data), false);
+    pdus[4] = ue_context_release_request_pdu(false);
+    pdus[5] = ue_context_release_request_pdu(true);
+    pdus[6] = ue_context_release_complete_pdu(false);
+    pdus[7] = ue_context_release_complete_pdu(true);
+    pdus[8] = initial_context_setup_response_pdu(1);
+    pdus[9] = initial_context_setup_response_pdu(3);
+    pdus[10] = initial_context_setup_response_pdu(8);
+    pdus[11] = uplink_nas_pdu(127, true);
+  }
+  *nb_pdus = sizeof(pdus) / sizeof(pdus[0]);
+  return pdus;
+}
+
+static void setup(void)
+{
+  for (int i = 0; i < sizeof(test_data); i++) {
+    test_data[i] = i * 3;
+  }
+}
+
+START_TEST(valid_pdus_test)
+{
+  int nb_pdus = 0;
+  bstring *pdus = test_pdus(&nb_pdus);
+
+  for (int i = 0; i < nb_pdus; i++) {
+    ck_assert(check_decoders(pdus[i]->data, blength(pdus[i])));
+  }
+}
+END_TEST
+
+START_TEST(truncated_pdus_test)
+{
+  int nb_pdus = 0;
+  bstring *pdus = test_pdus(&nb_pdus);
+
+  for (int i = 0; i < nb_pdus; i++) {
+    for (int length = 0; length < blength(pdus[i]); length++) {
+      ck_assert(!check_decoders(pdus[i]->data, length));
+    }
+  }
+}
+END_TEST
+
+START_TEST(mutated_pdus_test)
+{
+  int nb_pdus = 0;
+  bstring *pdus = test_pdus(&nb_pdus);
+  int nb_lazy = 0;
+
+  srand(3);
+  for (int i = 0; i < NB_MUTATIONS; i++) {
+    bstring pdu = bstrcpy(pdus[rand() % nb_pdus]);
+    int nb_bit_flips = 1 + rand() % 4;
+
+    for (int k = 0; k < nb_bit_flips; k++) {
+      pdu->data[rand() % blength(pdu)] ^= 1 << (rand() % 8);
+    }
+    if (check_decoders(pdu->data, blength(pdu))) {
+      nb_lazy++;
+    }
+    bdestroy(pdu);
+  }
+  // enough of the mutated PDUs went through the fast path to compare them
+  ck_assert_int_gt(nb_lazy, NB_MUTATIONS / 10);
+}
+END_TEST
+
+Suite *s1ap_mme_decoder_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("S1AP decoder tests");
+
+  /* Core test case */
+  tc_core = tcase_create("S1AP decoder test");
+  tcase_add_checked_fixture(tc_core, setup, NULL);
+  tcase_add_test(tc_core, valid_pdus_test);
+  tcase_add_test(tc_core, truncated_pdus_test);
+  tcase_add_test(tc_core, mutated_pdus_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = s1ap_mme_decoder_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,320 @@
+/*
+ * Licensed to the OpenAirInterface (OAI) Software Alliance under one or more
+ * contributor license agreements.  See the NOTICE file distributed with
+ * this work for additional information regarding copyright ownership.
+ * The OpenAirInterface Software Alliance licenses this file to You under
+ * the Apache License, Version 2.0  (the "License"); you may not use this file
+ * except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *-------------------------------------------------------------------------------
+ * For more information about the OpenAirInterface (OAI) Software Alliance:
+ *      contact@openairinterface.org
+ */
+#include <check.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/* Includes the templates to compare them with the asn1c encoder directly */
+#include "s1ap_mme_templates.c"
+
+// Longer than the longest template, to also cover the asn1c fallback
+#define MAX_TEST_DATA 16400
+
+static uint8_t test_data[MAX_TEST_DATA];
+
+static void assert_same_pdu(bstring pdu1, bstring pdu2)
+{
+  ck_assert_int_eq(blength(pdu1), blength(pdu2));
+  ck_assert(!memcmp(pdu1->data, pdu2->data, blength(pdu1)));
+}
+
+/*
+ * Encodes a downlink NAS transport with the template and with asn1c, the
+ * PDUs must be the same whenever the template can encode the message. The
+ * PDU sent is the asn1c one in any case.
+ * @return whether the template encoded the message
+ */
+static bool check_dl_nas(
+  mme_ue_s1ap_id_t mme_ue_s1ap_id,
+  enb_ue_s1ap_id_t enb_ue_s1ap_id,
+  uint32_t nas_length)
+{
+  bstring template_pdu = NULL;
+  bstring pdu = NULL;
+  bstring sent_pdu = NULL;
+  bstring nas_pdu = blk2bstr(test_data, nas_length);
+
+  int template_rc = s1ap_dl_nas_encode_template(
+    mme_ue_s1ap_id, enb_ue_s1ap_id, test_data, nas_length, &template_pdu);
+  ck_assert_int_eq(
+    s1ap_dl_nas_encode(
+      mme_ue_s1ap_id, enb_ue_s1ap_id, test_data, nas_length, &pdu),
+    RETURNok);
+  if (template_rc == RETURNok) {
+    assert_same_pdu(template_pdu, pdu);
+  }
+  ck_assert_int_eq(
+    s1ap_mme_generate_downlink_nas_transport_pdu(
+      mme_ue_s1ap_id, enb_ue_s1ap_id, nas_pdu, &sent_pdu),
+    RETURNok);
+  assert_same_pdu(sent_pdu, pdu);
+
+  bdestroy_wrapper(&template_pdu);
+  bdestroy_wrapper(&pdu);
+  bdestroy_wrapper(&sent_pdu);
+  bdestroy_wrapper(&nas_pdu);
+  return template_rc == RETURNok;
+}
+
+// Same as check_dl_nas, for an initial context setup request
+static bool check_ics(
+  const itti_mme_app_connection_establishment_cnf_t *conn_est_cnf)
+{
+  bstring template_pdu = NULL;
+  bstring pdu = NULL;
+  bstring sent_pdu = NULL;
+
+  int template_rc =
+    s1ap_ics_encode_template(conn_est_cnf, 0x10203, 0x405, &template_pdu);
+  ck_assert_int_eq(
+    s1ap_ics_encode(conn_est_cnf, 0x10203, 0x405, &pdu), RETURNok);
+  if (template_rc == RETURNok) {
+    assert_same_pdu(template_pdu, pdu);
+  }
+  ck_assert_int_eq(
+    s1ap_mme_generate_initial_context_setup_pdu(
+      conn_est_cnf, 0x10203, 0x405, &sent_pdu),
+    RETURNok);
+  assert_same_pdu(sent_pdu, pdu);
+
+  bdestroy_wrapper(&template_pdu);
+  bdestroy_wrapper(&pdu);
+  bdestroy_wrapper(&sent_pdu);
+  return template_rc == RETURNok;
+}
+
+static void init_conn_est_cnf(
+  itti_mme_app_connection_establishment_cnf_t *conn_est_cnf,
+  int no_of_e_rabs)
+{
+  memset(conn_est_cnf, 0, sizeof(*conn_est_cnf));
+  conn_est_cnf->ue_ambr.br_dl = 200000000;
+  conn_est_cnf->ue_ambr.br_ul = 100000000;
+  conn_est_cnf->no_of_e_rabs = no_of_e_rabs;
+  for (int item = 0; item < no_of_e_rabs; item++) {
+    conn_est_cnf->e_rab_id[item] = 5 + item;
+    conn_est_cnf->e_rab_level_qos_qci[item] = 9 - (item % 9);
+    conn_est_cnf->e_rab_level_qos_priority_level[item] = 1 + item;
+    conn_est_cnf->e_rab_level_qos_preemption_capability[item] = item & 1;
+    conn_est_cnf->e_rab_level_qos_preemption_vulnerability[item] =
+      (item >> 1) & 1;
+    conn_est_cnf->transport_layer_address[item] = blk2bstr(test_data, 4);
+    conn_est_cnf->gtp_teid[item] = 0x80000000 + item;
+  }
+  conn_est_cnf->ue_security_capabilities_encryption_algorithms = 0xE000;
+  conn_est_cnf->ue_security_capabilities_integrity_algorithms = 0xC000;
+  memcpy(conn_est_cnf->kenb, test_data, AUTH_KENB_SIZE);
+}
+
+static void free_conn_est_cnf(
+  itti_mme_app_connection_establishment_cnf_t *conn_est_cnf)
+{
+  for (int item = 0; item < BEARERS_PER_UE; item++) {
+    bdestroy_wrapper(&conn_est_cnf->transport_layer_address[item]);
+    bdestroy_wrapper(&conn_est_cnf->nas_pdu[item]);
+  }
+  bdestroy_wrapper(&conn_est_cnf->ue_radio_capability);
+}
+
+static void setup(void)
+{
+  for (int i = 0; i < MAX_TEST_DATA; i++) {
+    test_data[i] = (uint8_t) (i * 31 + 7);
+  }
+}
+
+START_TEST(dl_nas_ue_ids_test)
+{
+  // every number of octets of both constrained integers
+  const mme_ue_s1ap_id_t mme_ids[] = {
+    0, 1, 0xFF, 0x100, 0xFFFF, 0x10000, 0xFFFFFF, 0x1000000, 0xFFFFFFFF};
+  const enb_ue_s1ap_id_t enb_ids[] = {
+    0, 1, 0xFF, 0x100, 0xFFFF, 0x10000, 0xFFFFFF};
+
+  for (int i = 0; i < sizeof(mme_ids) / sizeof(mme_ids[0]); i++) {
+    for (int j = 0; j < sizeof(enb_ids) / sizeof(enb_ids[0]); j++) {
+      ck_assert(check_dl_nas(mme_ids[i], enb_ids[j], 20));
+    }
+  }
+}
+END_TEST
+
+START_TEST(dl_nas_length_test)
+{
+  // The NAS PDU length, then the NAS PDU IE length, then the message length
+  // go over 127 octets
+  for (uint32_t nas_length = 0; nas_length <= 160; nas_length++) {
+    ck_assert(check_dl_nas(0x12345678, 0x123456, nas_length));
+  }
+}
+END_TEST
+
+START_TEST(dl_nas_long_length_test)
+{
+  bool encoded_by_template = true;
+
+  // Lengths with a two octet length determinant end at 16383 octets, for
+  // the message first. Longer ones are fragmented, and left to asn1c.
+  for (uint32_t nas_length = 16300; nas_length <= 16390; nas_length++) {
+    bool template_rc = check_dl_nas(0, 0, nas_length);
+    // once the message is too long for the template, so are longer ones
+    ck_assert(encoded_by_template || !template_rc);
+    encoded_by_template = template_rc;
+  }
+  ck_assert(check_dl_nas(0, 0, 16300));
+  ck_assert(!check_dl_nas(0, 0, 16383));
+  ck_assert(!check_dl_nas(0, 0, 16384));
+}
+END_TEST
+
+START_TEST(ics_ambr_test)
+{
+  const uint64_t bit_rates[] = {0,
+                                1,
+                                0xFF,
+                                0x100,
+                                0xFFFFFFFF,
+                                0x100000000ULL,
+                                MAX_BIT_RATE};
+  const int num_bit_rates = sizeof(bit_rates) / sizeof(bit_rates[0]);
+  itti_mme_app_connection_establishment_cnf_t conn_est_cnf;
+
+  init_conn_est_cnf(&conn_est_cnf, 1);
+  for (int i = 0; i < num_bit_rates; i++) {
+    conn_est_cnf.ue_ambr.br_dl = bit_rates[i];
+    conn_est_cnf.ue_ambr.br_ul = bit_rates[num_bit_rates - 1 - i];
+    ck_assert(check_ics(&conn_est_cnf));
+  }
+  free_conn_est_cnf(&conn_est_cnf);
+}
+END_TEST
+
+START_TEST(ics_e_rabs_test)
+{
+  const int tla_lengths[] = {4, 16, 20};
+  itti_mme_app_connection_establishment_cnf_t conn_est_cnf;
+
+  for (int no_of_e_rabs = 1; no_of_e_rabs <= BEARERS_PER_UE; no_of_e_rabs++) {
+    init_conn_est_cnf(&conn_est_cnf, no_of_e_rabs);
+    for (int item = 0; item < no_of_e_rabs; item++) {
+      bdestroy_wrapper(&conn_est_cnf.transport_layer_address[item]);
+      conn_est_cnf.transport_layer_address[item] =
+        blk2bstr(test_data, tla_lengths[item % 3]);
+      // NAS PDU length determinants of one and two octets
+      if (item % 2) {
+        conn_est_cnf.nas_pdu[item] = blk2bstr(test_data, 60 * item);
+      }
+    }
+    ck_assert(check_ics(&conn_est_cnf));
+    free_conn_est_cnf(&conn_est_cnf);
+  }
+}
+END_TEST
+
+START_TEST(ics_nas_pdu_length_test)
+{
+  itti_mme_app_connection_establishment_cnf_t conn_est_cnf;
+
+  init_conn_est_cnf(&conn_est_cnf, 1);
+  for (uint32_t nas_length = 100; nas_length <= 140; nas_length++) {
+    conn_est_cnf.nas_pdu[0] = blk2bstr(test_data, nas_length);
+    ck_assert(check_ics(&conn_est_cnf));
+    bdestroy_wrapper(&conn_est_cnf.nas_pdu[0]);
+  }
+  free_conn_est_cnf(&conn_est_cnf);
+}
+END_TEST
+
+START_TEST(ics_radio_capability_test)
+{
+  const uint32_t lengths[] = {1, 127, 128, 200, 16000};
+  itti_mme_app_connection_establishment_cnf_t conn_est_cnf;
+
+  init_conn_est_cnf(&conn_est_cnf, 1);
+  for (int i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+    conn_est_cnf.ue_radio_capability = blk2bstr(test_data, lengths[i]);
+    ck_assert(check_ics(&conn_est_cnf));
+    bdestroy_wrapper(&conn_est_cnf.ue_radio_capability);
+  }
+  // too long for the template, encoded by asn1c
+  conn_est_cnf.ue_radio_capability = blk2bstr(test_data, 16383);
+  ck_assert(!check_ics(&conn_est_cnf));
+  bdestroy_wrapper(&conn_est_cnf.ue_radio_capability);
+  conn_est_cnf.ue_radio_capability = blk2bstr(test_data, 16384);
+  ck_assert(!check_ics(&conn_est_cnf));
+  free_conn_est_cnf(&conn_est_cnf);
+}
+END_TEST
+
+START_TEST(ics_csfb_test)
+{
+  itti_mme_app_connection_establishment_cnf_t conn_est_cnf;
+
+  init_conn_est_cnf(&conn_est_cnf, 2);
+  conn_est_cnf.presencemask = S1AP_CSFB_INDICATOR_PRESENT;
+  conn_est_cnf.cs_fallback_indicator = CSFB_REQUIRED;
+  ck_assert(check_ics(&conn_est_cnf));
+  conn_est_cnf.cs_fallback_indicator = CSFB_HIGH_PRIORITY;
+  ck_assert(check_ics(&conn_est_cnf));
+  conn_est_cnf.ue_radio_capability = blk2bstr(test_data, 300);
+  ck_assert(check_ics(&conn_est_cnf));
+  free_conn_est_cnf(&conn_est_cnf);
+}
+END_TEST
+
+Suite *s1ap_mme_templates_suite(void)
+{
+  Suite *s;
+  TCase *tc_core;
+
+  s = suite_create("S1AP template tests");
+
+  /* Core test case */
+  tc_core = tcase_create("S1AP template test");
+  tcase_add_checked_fixture(tc_core, setup, NULL);
+  tcase_add_test(tc_core, dl_nas_ue_ids_test);
+  tcase_add_test(tc_core, dl_nas_length_test);
+  tcase_add_test(tc_core, dl_nas_long_length_test);
+  tcase_add_test(tc_core, ics_ambr_test);
+  tcase_add_test(tc_core, ics_e_rabs_test);
+  tcase_add_test(tc_core, ics_nas_pdu_length_test);
+  tcase_add_test(tc_core, ics_radio_capability_test);
+  tcase_add_test(tc_core, ics_csfb_test);
+
+  suite_add_tcase(s, tc_core);
+
+  return s;
+}
+
+int main(void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = s1ap_mme_templates_suite();
+  sr = srunner_create(s);
+
+  srunner_run_all(sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed(sr);
+  srunner_free(sr);
+  return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -15,30 +15,16 @@
 #include <grpc++/grpc++.h>
 #include <lte/protos/session_manager.grpc.pb.h>
 
-#include "GRPCReceiver.h"
+#include "AsyncClientRuntime.h"
 
 namespace magma {
 using namespace lte;
+
 /**
- * AsyncEvbResponse is used to call a callback in a particular event loop when
- * a response is received. This is defined here to limit the dependency on folly
- * in the common library.
+ * SessionCloudReporter proxies session calls to the cloud through the shared
+ * AsyncClientRuntime. Callbacks are run in the given event base.
  */
-template <typename ResponseType>
-class AsyncEvbResponse : public AsyncGRPCResponse<ResponseType> {
-public:
-  AsyncEvbResponse(
-    folly::EventBase* base,
-    std::function<void(grpc::Status, ResponseType)> callback,
-    uint32_t timeout_sec);
-
- void handle_response() override;
-
-private:
- folly::EventBase* base_;
-};
-
-class SessionCloudReporter : public GRPCReceiver {
+class SessionCloudReporter {
 public:
   SessionCloudReporter(folly::EventBase* base,
                        std::shared_ptr<grpc::Channel> channel);
@@ -66,8 +52,25 @@ public:
 
 private:
   folly::EventBase* base_;
-  std::unique_ptr<CentralSessionController::Stub> stub_;
-  static const uint32_t RESPONSE_TIMEOUT = 6; // seconds
+  StubPool<CentralSessionController::Stub> stubs_;
+  static const AsyncCallOptions CALL_OPTIONS;
+
+private:
+  /**
+   * Wrap a callback so that it is called in the event base instead of on the
+   * runtime thread that received the response
+   */
+  template <typename ResponseType>
+  std::function<void(grpc::Status, ResponseType)> run_in_event_base(
+      std::function<void(grpc::Status, ResponseType)> callback) {
+    auto base = base_;
+    return [base, callback](grpc::Status status, ResponseType response) {
+      base->runInEventBaseThread(
+        [callback, status, response = std::move(response)]() mutable {
+          callback(status, std::move(response));
+        });
+    };
+  }
 };
 
 }
@@ -16,6 +16,16 @@ namespace magma {
 ChargingCreditPool::ChargingCreditPool(const std::string& imsi)
   : imsi_(imsi) {}
 
+ChargingCreditPool::ChargingCreditPool(
+    const std::string& imsi,
+    const StoredChargingCreditPool& marshaled)
+  : imsi_(imsi) {
+  for (const auto& credit_pair : marshaled.credits()) {
+    credit_map_[credit_pair.first] =
+      std::make_unique<SessionCredit>(credit_pair.second);
+  }
+}
+
 bool ChargingCreditPool::add_used_credit(
     const uint32_t& key,
     uint64_t used_tx,
@@ -214,9 +224,34 @@ ChargingReAuthAnswer::Result ChargingCreditPool::reauth_all() {
   return res;
 }
 
+StoredChargingCreditPool ChargingCreditPool::marshal() const {
+  StoredChargingCreditPool marshaled;
+  auto& credits = *marshaled.mutable_credits();
+  for (const auto& credit_pair : credit_map_) {
+    credits[credit_pair.first] = credit_pair.second->marshal();
+  }
+  return marshaled;
+}
+
 UsageMonitoringCreditPool::UsageMonitoringCreditPool(const std::string& imsi)
   : imsi_(imsi), session_level_key_(nullptr) {}
 
+UsageMonitoringCreditPool::UsageMonitoringCreditPool(
+    const std::string& imsi,
+    const StoredUsageMonitoringCreditPool& marshaled)
+  : imsi_(imsi), session_level_key_(nullptr) {
+  for (const auto& monitor_pair : marshaled.monitors()) {
+    auto monitor = std::make_unique<UsageMonitoringCreditPool::Monitor>();
+    monitor->credit = SessionCredit(monitor_pair.second.credit());
+    monitor->level = monitor_pair.second.level();
+    monitor_map_[monitor_pair.first] = std::move(monitor);
+  }
+  if (!marshaled.session_level_key().empty()) {
+    session_level_key_ = std::make_unique<std::string>(
+      marshaled.session_level_key());
+  }
+}
+
 bool UsageMonitoringCreditPool::add_used_credit(
     const std::string& key,
     uint64_t used_tx,
@@ -377,4 +412,20 @@ UsageMonitoringCreditPool::get_session_level_key() {
   return std::make_unique<std::string>(*session_level_key_);
 }
 
+StoredUsageMonitoringCreditPool UsageMonitoringCreditPool::marshal() const {
+  StoredUsageMonitoringCreditPool marshaled;
+  auto& monitors = *marshaled.mutable_monitors();
+  for (const auto& monitor_pair : monitor_map_) {
+    StoredMonitor stored_monitor;
+    stored_monitor.mutable_credit()->CopyFrom(
+      monitor_pair.second->credit.marshal());
+    stored_monitor.set_level(monitor_pair.second->level);
+    monitors[monitor_pair.first] = stored_monitor;
+  }
+  if (session_level_key_ != nullptr) {
+    marshaled.set_session_level_key(*session_level_key_);
+  }
+  return marshaled;
+}
+
 }
@@ -80,6 +80,10 @@ class ChargingCreditPool
 public:
   ChargingCreditPool(const std::string& imsi);
 
+  ChargingCreditPool(
+    const std::string& imsi,
+    const StoredChargingCreditPool& marshaled);
+
   bool add_used_credit(
     const uint32_t& key,
     uint64_t used_tx,
@@ -102,6 +106,8 @@ public:
 
   ChargingReAuthAnswer::Result reauth_all();
 
+  StoredChargingCreditPool marshal() const;
+
 private:
   std::unordered_map<uint32_t, std::unique_ptr<SessionCredit>> credit_map_;
   std::string imsi_;
@@ -121,6 +127,10 @@ class UsageMonitoringCreditPool
 public:
   UsageMonitoringCreditPool(const std::string& imsi);
 
+  UsageMonitoringCreditPool(
+    const std::string& imsi,
+    const StoredUsageMonitoringCreditPool& marshaled);
+
   bool add_used_credit(
     const std::string& key,
     uint64_t used_tx,
@@ -141,6 +151,8 @@ public:
   uint64_t get_credit(const std::string& key, Bucket bucket) override;
 
   std::unique_ptr<std::string> get_session_level_key();
+
+  StoredUsageMonitoringCreditPool marshal() const;
 private:
   struct Monitor {
     SessionCredit credit;
@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include "FlowUpdateBatch.h"
+
+namespace magma {
+
+void FlowUpdateBatch::add_activation(
+    const std::string& imsi,
+    const std::string& ip_addr,
+    const std::vector<std::string>& static_rules,
+    const std::vector<PolicyRule>& dynamic_rules) {
+  auto& flows = subscribers_[imsi];
+  flows.ip_addr = ip_addr;
+  for (const auto& id : static_rules) {
+    flows.rules_to_deactivate.erase(id);
+    flows.static_rules_to_activate.insert(id);
+  }
+  for (const auto& rule : dynamic_rules) {
+    flows.rules_to_deactivate.erase(rule.id());
+    flows.dynamic_rules_to_activate[rule.id()] = rule;
+  }
+}
+
+void FlowUpdateBatch::add_deactivation(
+    const std::string& imsi,
+    const std::vector<std::string>& rule_ids,
+    const std::vector<PolicyRule>& dynamic_rules) {
+  if (rule_ids.empty() && dynamic_rules.empty()) {
+    add_deactivate_all(imsi);
+    return;
+  }
+  auto& flows = subscribers_[imsi];
+  for (const auto& id : rule_ids) {
+    add_rule_deactivation(flows, id);
+  }
+  for (const auto& rule : dynamic_rules) {
+    add_rule_deactivation(flows, rule.id());
+  }
+}
+
+void FlowUpdateBatch::add_deactivate_all(const std::string& imsi) {
+  auto& flows = subscribers_[imsi];
+  flows = SubscriberFlows();
+  flows.deactivate_all = true;
+}
+
+bool FlowUpdateBatch::empty() const {
+  return subscribers_.empty();
+}
+
+void FlowUpdateBatch::add_rule_deactivation(
+    SubscriberFlows& flows,
+    const std::string& id) {
+  // the last action on a rule wins: a pending activation is dropped instead
+  // of being sent along with its deactivation
+  flows.static_rules_to_activate.erase(id);
+  flows.dynamic_rules_to_activate.erase(id);
+  // the rule may have been installed by an earlier batch, so it is still
+  // deactivated, unless a full deactivation already covers it
+  if (!flows.deactivate_all) {
+    flows.rules_to_deactivate.insert(id);
+  }
+}
+
+std::vector<UpdateFlowsRequest> FlowUpdateBatch::get_requests(
+    uint32_t max_subscribers) const {
+  std::vector<UpdateFlowsRequest> requests;
+  uint32_t subscribers_in_request = max_subscribers;
+  for (const auto& subscriber_pair : subscribers_) {
+    const auto& imsi = subscriber_pair.first;
+    const auto& flows = subscriber_pair.second;
+    bool deactivate = flows.deactivate_all ||
+      !flows.rules_to_deactivate.empty();
+    bool activate = !flows.static_rules_to_activate.empty() ||
+      !flows.dynamic_rules_to_activate.empty();
+    if (!deactivate && !activate) {
+      // all actions for the subscriber cancelled each other out
+      continue;
+    }
+    if (subscribers_in_request >= max_subscribers) {
+      requests.emplace_back();
+      subscribers_in_request = 0;
+    }
+    auto& request = requests.back();
+    subscribers_in_request++;
+
+    if (deactivate) {
+      auto deactivate_req = request.add_deactivate_requests();
+      deactivate_req->mutable_sid()->set_id(imsi);
+      for (const auto& id : flows.rules_to_deactivate) {
+        deactivate_req->add_rule_ids(id);
+      }
+    }
+    if (activate) {
+      auto activate_req = request.add_activate_requests();
+      activate_req->mutable_sid()->set_id(imsi);
+      activate_req->set_ip_addr(flows.ip_addr);
+      for (const auto& id : flows.static_rules_to_activate) {
+        activate_req->add_rule_ids(id);
+      }
+      for (const auto& rule_pair : flows.dynamic_rules_to_activate) {
+        activate_req->add_dynamic_rules()->CopyFrom(rule_pair.second);
+      }
+    }
+  }
+  return requests;
+}
+
+}
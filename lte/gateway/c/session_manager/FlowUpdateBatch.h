@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#pragma once
+
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <lte/protos/pipelined.pb.h>
+#include <lte/protos/policydb.pb.h>
+
+namespace magma {
+using namespace lte;
+
+/**
+ * FlowUpdateBatch collects flow activations and deactivations for many
+ * subscribers, so that they can be sent to pipelined together instead of as
+ * one RPC per subscriber. Only the last action taken on a rule of a
+ * subscriber is sent. A deactivation is sent even when it cancels a pending
+ * activation, as an earlier batch may have installed the rule.
+ */
+class FlowUpdateBatch {
+public:
+  /**
+   * Add activations of the given rules for a subscriber
+   */
+  void add_activation(
+    const std::string& imsi,
+    const std::string& ip_addr,
+    const std::vector<std::string>& static_rules,
+    const std::vector<PolicyRule>& dynamic_rules);
+
+  /**
+   * Add deactivations of the given rules for a subscriber. If no rules are
+   * given, all flows of the subscriber are deactivated
+   */
+  void add_deactivation(
+    const std::string& imsi,
+    const std::vector<std::string>& rule_ids,
+    const std::vector<PolicyRule>& dynamic_rules);
+
+  /**
+   * Deactivate all flows for a subscriber, dropping any activations added
+   * before for the subscriber
+   */
+  void add_deactivate_all(const std::string& imsi);
+
+  bool empty() const;
+
+  /**
+   * Convert the batch into UpdateFlowsRequests
+   * @param max_subscribers - maximum number of subscribers in one request
+   * @return requests covering all subscribers in the batch
+   */
+  std::vector<UpdateFlowsRequest> get_requests(uint32_t max_subscribers) const;
+
+private:
+  struct SubscriberFlows {
+    // deactivate all flows before applying anything else
+    bool deactivate_all = false;
+    std::string ip_addr;
+    std::unordered_set<std::string> rules_to_deactivate;
+    std::unordered_set<std::string> static_rules_to_activate;
+    std::unordered_map<std::string, PolicyRule> dynamic_rules_to_activate;
+  };
+  // ordered so that requests are deterministic
+  std::map<std::string, SubscriberFlows> subscribers_;
+
+private:
+  void add_rule_deactivation(SubscriberFlows& flows, const std::string& id);
+};
+
+}
@@ -49,7 +49,10 @@ static void mark_rule_failures(
 LocalEnforcer::LocalEnforcer(
   std::shared_ptr<StaticRuleStore> rule_store,
   std::shared_ptr<PipelinedClient> pipelined_client)
-  : rule_store_(rule_store), pipelined_client_(pipelined_client) {}
+  : rule_store_(rule_store),
+    pipelined_client_(pipelined_client),
+    session_store_(nullptr),
+    store_flush_interval_ms_(0) {}
 
 LocalEnforcer::LocalEnforcer()
   : LocalEnforcer(
@@ -78,6 +81,52 @@ folly::EventBase& LocalEnforcer::get_event_base() {
   return *evb_;
 }
 
+void LocalEnforcer::attach_session_store(
+    std::shared_ptr<SessionStore> session_store,
+    uint32_t flush_interval_ms) {
+  session_store_ = session_store;
+  store_flush_interval_ms_ = flush_interval_ms;
+}
+
+void LocalEnforcer::restore_sessions(
+    const std::vector<StoredSessionState>& sessions) {
+  for (const auto& marshaled : sessions) {
+    session_map_[marshaled.imsi()] =
+      std::make_unique<SessionState>(marshaled, *rule_store_);
+  }
+  MLOG(MINFO) << "Restored " << sessions.size() << " sessions from the "
+    << "session store";
+}
+
+void LocalEnforcer::mark_dirty(const std::string& imsi) {
+  if (session_store_ == nullptr) {
+    return;
+  }
+  bool flush_pending = !dirty_sessions_.empty();
+  dirty_sessions_.insert(imsi);
+  if (!flush_pending) {
+    evb_->runAfterDelay(
+      [this] { flush_dirty_sessions(); },
+      store_flush_interval_ms_);
+  }
+}
+
+void LocalEnforcer::flush_dirty_sessions() {
+  std::vector<StoredSessionState> sessions;
+  std::vector<std::string> removed_imsis;
+  for (const auto& imsi : dirty_sessions_) {
+    auto it = session_map_.find(imsi);
+    if (it == session_map_.end()) {
+      removed_imsis.push_back(imsi);
+    } else {
+      sessions.push_back(it->second->marshal());
+    }
+  }
+  dirty_sessions_.clear();
+  session_store_->write_sessions(std::move(sessions));
+  session_store_->remove_sessions(removed_imsis);
+}
+
 void LocalEnforcer::aggregate_records(const RuleRecordTable& records) {
   new_report(); // unmark all credits
   for (const RuleRecord& record : records.records()) {
@@ -96,36 +145,54 @@ void LocalEnforcer::aggregate_records(const RuleRecordTable& records) {
       record.rule_id(),
       record.bytes_tx(),
       record.bytes_rx());
+    if (record.bytes_tx() > 0 || record.bytes_rx() > 0) {
+      mark_dirty(record.sid());
+    }
   }
 }
 
 static void execute_actions(
     PipelinedClient& pipelined_client,
     const std::vector<std::unique_ptr<ServiceAction>>& actions) {
+  FlowUpdateBatch batch;
   for (auto& action_p : actions) {
     if (action_p->get_type() == TERMINATE_SERVICE) {
-      pipelined_client.deactivate_flows_for_rules(
+      batch.add_deactivation(
         action_p->get_imsi(),
         action_p->get_rule_ids(),
         action_p->get_rule_definitions());
     } else if (action_p->get_type() == ACTIVATE_SERVICE) {
-      pipelined_client.activate_flows_for_rules(
+      batch.add_activation(
         action_p->get_imsi(),
         action_p->get_ip_addr(),
         action_p->get_rule_ids(),
         action_p->get_rule_definitions());
     }
   }
+  if (!batch.empty()) {
+    pipelined_client.update_flows(batch);
+  }
 }
 
 UpdateSessionRequest LocalEnforcer::collect_updates() {
   UpdateSessionRequest request;
+  collect_updates(&request);
+  return request;
+}
+
+void LocalEnforcer::collect_updates(UpdateSessionRequest* update_request_out) {
   std::vector<std::unique_ptr<ServiceAction>> actions;
   for (auto& session_pair : session_map_) {
-    session_pair.second->get_updates(&request, &actions);
+    auto prev_size = update_request_out->updates_size()
+      + update_request_out->usage_monitors_size() + actions.size();
+    session_pair.second->get_updates(update_request_out, &actions);
+    if (update_request_out->updates_size()
+        + update_request_out->usage_monitors_size()
+        + actions.size() != prev_size) {
+      mark_dirty(session_pair.first);
+    }
   }
   execute_actions(*pipelined_client_, actions);
-  return request;
 }
 
 void LocalEnforcer::reset_updates(const UpdateSessionRequest& failed_request) {
@@ -138,6 +205,7 @@ void LocalEnforcer::reset_updates(const UpdateSessionRequest& failed_request) {
     }
     it->second->get_charging_pool().reset_reporting_credit(
       update.usage().charging_key());
+    mark_dirty(update.sid());
   }
   for (const auto& update : failed_request.usage_monitors()) {
     auto it = session_map_.find(update.sid());
@@ -148,6 +216,7 @@ void LocalEnforcer::reset_updates(const UpdateSessionRequest& failed_request) {
     }
     it->second->get_monitor_pool().reset_reporting_credit(
       update.update().monitoring_key());
+    mark_dirty(update.sid());
   }
 }
 
@@ -211,6 +280,7 @@ void LocalEnforcer::schedule_dynamic_rule_activation(
             << dynamic_rule.policy_rule().id();
         } else {
           it->second->insert_dynamic_rule(dynamic_rule.policy_rule());
+          mark_dirty(imsi);
         }
       }),
       delta);
@@ -259,6 +329,7 @@ void LocalEnforcer::schedule_dynamic_rule_deactivation(
           PolicyRule rule_dont_care;
           it->second->remove_dynamic_rule(
             dynamic_rule.policy_rule().id(), &rule_dont_care);
+          mark_dirty(imsi);
         }
       }),
       delta);
@@ -351,6 +422,7 @@ bool LocalEnforcer::init_session_credit(
     session_state->get_monitor_pool().receive_credit(monitor);
   }
   session_map_[imsi] = std::unique_ptr<SessionState>(session_state);
+  mark_dirty(imsi);
 
   auto ip_addr = session_state->get_subscriber_ip_addr();
 
@@ -406,7 +478,9 @@ void LocalEnforcer::complete_termination(
   }
   if (session_map_.erase(imsi) == 0) {
     MLOG(MERROR) << "Terminated non existent session for " << imsi;
+    return;
   }
+  mark_dirty(imsi);
 }
 
 void LocalEnforcer::update_session_credit(
@@ -419,6 +493,7 @@ void LocalEnforcer::update_session_credit(
       return;
     }
     it->second->get_charging_pool().receive_credit(response);
+    mark_dirty(response.sid());
   }
   for (const auto& usage_monitor_resp : response.usage_monitor_responses()) {
     auto it = session_map_.find(usage_monitor_resp.sid());
@@ -428,6 +503,7 @@ void LocalEnforcer::update_session_credit(
       return;
     }
     it->second->get_monitor_pool().receive_credit(usage_monitor_resp);
+    mark_dirty(usage_monitor_resp.sid());
   }
 }
 
@@ -444,6 +520,7 @@ SessionTerminateRequest LocalEnforcer::terminate_subscriber(
     MLOG(MERROR)  << "Could not deactivate flows for IMSI " << imsi
       << " during termination";
   }
+  mark_dirty(imsi);
   return it->second->terminate();
 }
 
@@ -477,6 +554,7 @@ ChargingReAuthAnswer::Result LocalEnforcer::init_charging_reauth(
       << " during reauth";
     return ChargingReAuthAnswer::SESSION_NOT_FOUND;
   }
+  mark_dirty(request.sid());
   if (request.type() == ChargingReAuthRequest::SINGLE_SERVICE) {
     MLOG(MDEBUG) << "Initiating reauth of key " << request.charging_key()
       << " for subscriber " << request.sid();
@@ -506,6 +584,7 @@ void LocalEnforcer::init_policy_reauth(
       it->second,
       &rules_to_activate,
       &rules_to_deactivate);
+  mark_dirty(request.imsi());
 
   auto ip_addr = it->second->get_subscriber_ip_addr();
   bool deactivate_success = true;
@@ -14,6 +14,7 @@
 #include "RuleStore.h"
 #include "PipelinedClient.h"
 #include "SessionState.h"
+#include "SessionStore.h"
 
 namespace magma {
 using namespace orc8r;
@@ -37,6 +38,20 @@ public:
 
   void attachEventBase(folly::EventBase* evb);
 
+  /**
+   * Persist session state to the given store. Sessions that change are
+   * written behind, at most once every flush interval.
+   */
+  void attach_session_store(
+    std::shared_ptr<SessionStore> session_store,
+    uint32_t flush_interval_ms);
+
+  /**
+   * Resume tracking sessions that were persisted in the session store before
+   * a restart. Must be called before the event base starts.
+   */
+  void restore_sessions(const std::vector<StoredSessionState>& sessions);
+
   // blocks
   void start();
 
@@ -73,6 +88,13 @@ public:
    */
   UpdateSessionRequest collect_updates();
 
+  /**
+   * Same as collect_updates, but adds the updates to a given request, which
+   * lets the caller allocate the request on a protobuf arena
+   * @param update_request_out (out) - request to add usage updates to
+   */
+  void collect_updates(UpdateSessionRequest* update_request_out);
+
   /**
    * Initialize credit received from the cloud in the system. This adds all the
    * charging keys to the credit manager for tracking
@@ -127,9 +149,25 @@ private:
   std::shared_ptr<PipelinedClient> pipelined_client_;
   std::unordered_map<std::string, std::unique_ptr<SessionState>> session_map_;
   folly::EventBase* evb_;
+  std::shared_ptr<SessionStore> session_store_;
+  uint32_t store_flush_interval_ms_;
+  // IMSIs of sessions changed since the last flush to the session store
+  std::unordered_set<std::string> dirty_sessions_;
 private:
   void new_report();
 
+  /**
+   * Mark a session as changed, scheduling a flush to the session store if one
+   * isn't already pending
+   */
+  void mark_dirty(const std::string& imsi);
+
+  /**
+   * Queue the state of all changed sessions to be written to the session
+   * store. Sessions that no longer exist are removed from the store.
+   */
+  void flush_dirty_sessions();
+
   /**
    * Process the create session response to get rules to activate/deactivate
    * instantly and schedule rules with activation/deactivation time info
@@ -7,8 +7,11 @@
  * of patent rights can be found in the PATENTS file in the same directory.
  */
 #include <chrono>
+#include <memory>
 #include <thread>
 
+#include <google/protobuf/arena.h>
+
 #include "LocalSessionManagerHandler.h"
 #include "magma_logging.h"
 
@@ -23,13 +26,15 @@ LocalSessionManagerHandlerImpl::LocalSessionManagerHandlerImpl(
 
 void LocalSessionManagerHandlerImpl::ReportRuleStats(
     ServerContext* context,
-    const RuleRecordTable* request,
+    RuleRecordTable* request,
     std::function<void(Status, Void)> response_callback) {
-  auto& request_cpy = *request;
-  MLOG(MDEBUG) << "Aggregating " << request_cpy.records_size() << " records";
+  MLOG(MDEBUG) << "Aggregating " << request->records_size() << " records";
+  // Take the records out of the request instead of copying the whole table
+  auto records = std::make_shared<RuleRecordTable>();
+  records->Swap(request);
   enforcer_->get_event_base().runInEventBaseThread(
-    [this, request_cpy]() {
-      enforcer_->aggregate_records(request_cpy);
+    [this, records]() {
+      enforcer_->aggregate_records(*records);
       check_usage_for_reporting();
     }
   );
@@ -37,20 +42,27 @@ void LocalSessionManagerHandlerImpl::ReportRuleStats(
 }
 
 void LocalSessionManagerHandlerImpl::check_usage_for_reporting() {
-  auto request = enforcer_->collect_updates();
-  if (request.updates_size() == 0 && request.usage_monitors_size() == 0) {
+  // The request and all of its updates are allocated on one arena, which is
+  // kept alive by the callback instead of copying the request into it
+  google::protobuf::ArenaOptions arena_options;
+  arena_options.start_block_size = UPDATE_ARENA_START_BLOCK_SIZE;
+  auto arena = std::make_shared<google::protobuf::Arena>(arena_options);
+  auto request =
+    google::protobuf::Arena::CreateMessage<UpdateSessionRequest>(arena.get());
+  enforcer_->collect_updates(request);
+  if (request->updates_size() == 0 && request->usage_monitors_size() == 0) {
     return; // nothing to report
   }
-  MLOG(MDEBUG) << "Sending " << request.updates_size()
-    << " charging updates and " << request.usage_monitors_size()
+  MLOG(MDEBUG) << "Sending " << request->updates_size()
+    << " charging updates and " << request->usage_monitors_size()
     << " monitor updates to OCS and PCRF";
 
   // report to cloud
-  reporter_->report_updates(request,
-    [this, request](Status status, UpdateSessionResponse response) {
+  reporter_->report_updates(*request,
+    [this, arena, request](Status status, UpdateSessionResponse response) {
       if (!status.ok()) {
-        enforcer_->reset_updates(request);
-        MLOG(MERROR) << "Update of size " << request.updates_size() <<
+        enforcer_->reset_updates(*request);
+        MLOG(MERROR) << "Update of size " << request->updates_size() <<
           " to OCS failed entirely: " << status.error_message();
       } else {
         MLOG(MDEBUG) << "Received updated responses from OCS and PCRF";
@@ -30,11 +30,12 @@ public:
   virtual ~LocalSessionManagerHandler() {}
 
   /**
-   * Report flow stats from pipelined and track the usage per rule
+   * Report flow stats from pipelined and track the usage per rule. The
+   * records are moved out of the request, which is left empty
    */
   virtual void ReportRuleStats(
     ServerContext* context,
-    const RuleRecordTable* request,
+    RuleRecordTable* request,
     std::function<void(Status, Void)> response_callback) = 0;
 
   /**
@@ -72,7 +73,7 @@ public:
    */
   void ReportRuleStats(
     ServerContext* context,
-    const RuleRecordTable* request,
+    RuleRecordTable* request,
     std::function<void(Status, Void)> response_callback);
 
   /**
@@ -93,6 +94,7 @@ public:
     std::function<void(Status, LocalEndSessionResponse)> response_callback);
 
 private:
+  static const size_t UPDATE_ARENA_START_BLOCK_SIZE = 4096; // bytes
   LocalEnforcer* enforcer_;
   SessionCloudReporter* reporter_;
   SessionIDGenerator id_gen_;
@@ -6,6 +6,7 @@
  * LICENSE file in the root directory of this source tree. An additional grant
  * of patent rights can be found in the PATENTS file in the same directory.
  */
+#include <algorithm>
 
 #include "PipelinedClient.h"
 
@@ -52,18 +53,36 @@ magma::ActivateFlowsRequest create_activate_req(
   return req;
 }
 
+void log_failed_activations(
+    const std::string& imsi,
+    const magma::ActivateFlowsResult& result) {
+  for (const auto& rule_result : result.static_rule_results()) {
+    if (rule_result.result() != magma::RuleModResult::SUCCESS) {
+      MLOG(MERROR) << "Could not activate static rule " << rule_result.rule_id()
+        << " for subscriber " << imsi;
+    }
+  }
+  for (const auto& rule_result : result.dynamic_rule_results()) {
+    if (rule_result.result() != magma::RuleModResult::SUCCESS) {
+      MLOG(MERROR) << "Could not activate dynamic rule "
+        << rule_result.rule_id() << " for subscriber " << imsi;
+    }
+  }
+}
+
 }  // namespace anonymous
 
 namespace magma {
 
+const AsyncCallOptions AsyncPipelinedClient::CALL_OPTIONS = {
+  .timeout_sec = 6};
+
 AsyncPipelinedClient::AsyncPipelinedClient(
   std::shared_ptr<grpc::Channel> channel
-) : stub_(Pipelined::NewStub(channel)) {}
+) : stubs_(channel) {}
 
 AsyncPipelinedClient::AsyncPipelinedClient()
-  : AsyncPipelinedClient(
-    ServiceRegistrySingleton::Instance()
-      ->GetGrpcChannel("pipelined", ServiceRegistrySingleton::LOCAL)) {}
+  : stubs_("pipelined", ServiceRegistrySingleton::LOCAL) {}
 
 bool AsyncPipelinedClient::deactivate_all_flows(const std::string& imsi) {
   DeactivateFlowsRequest req;
@@ -111,24 +130,69 @@ bool AsyncPipelinedClient::activate_flows_for_rules(
   return true;
 }
 
+bool AsyncPipelinedClient::update_flows(const FlowUpdateBatch& batch) {
+  for (const auto& req : batch.get_requests(MAX_SUBSCRIBERS_PER_UPDATE)) {
+    std::vector<std::string> activated_imsis;
+    for (const auto& activate_req : req.activate_requests()) {
+      activated_imsis.push_back(activate_req.sid().id());
+    }
+    MLOG(MDEBUG) << "Updating flows with " << req.deactivate_requests_size()
+      << " deactivations and " << req.activate_requests_size()
+      << " activations";
+    auto num_deactivated = req.deactivate_requests_size();
+    update_flows_rpc(req, [activated_imsis, num_deactivated](
+        Status status, UpdateFlowsResult resp) {
+      if (!status.ok()) {
+        MLOG(MERROR) << "Could not update flows through pipelined for "
+          << num_deactivated << " deactivations and " << activated_imsis.size()
+          << " activations: " << status.error_message();
+        return;
+      }
+      auto num_results = std::min(
+        static_cast<size_t>(resp.activate_results_size()),
+        activated_imsis.size());
+      for (size_t i = 0; i < num_results; i++) {
+        log_failed_activations(activated_imsis[i], resp.activate_results(i));
+      }
+    });
+  }
+  return true;
+}
+
 void AsyncPipelinedClient::deactivate_flows_rpc(
     const DeactivateFlowsRequest& request,
     std::function<void(Status, DeactivateFlowsResult)> callback) {
-  auto local_resp = new AsyncLocalResponse<DeactivateFlowsResult>(
-      std::move(callback),
-      RESPONSE_TIMEOUT);
-  local_resp->set_response_reader(std::move(stub_->AsyncDeactivateFlows(
-    local_resp->get_context(), request, &queue_)));
+  AsyncClientRuntime::get_instance().call(
+    "Pipelined.DeactivateFlows",
+    stubs_.get(),
+    &Pipelined::Stub::AsyncDeactivateFlows,
+    request,
+    std::move(callback),
+    CALL_OPTIONS);
 }
 
 void AsyncPipelinedClient::activate_flows_rpc(
     const ActivateFlowsRequest& request,
     std::function<void(Status, ActivateFlowsResult)> callback) {
-  auto local_resp = new AsyncLocalResponse<ActivateFlowsResult>(
-      std::move(callback),
-      RESPONSE_TIMEOUT);
-  local_resp->set_response_reader(std::move(stub_->AsyncActivateFlows(
-    local_resp->get_context(), request, &queue_)));
+  AsyncClientRuntime::get_instance().call(
+    "Pipelined.ActivateFlows",
+    stubs_.get(),
+    &Pipelined::Stub::AsyncActivateFlows,
+    request,
+    std::move(callback),
+    CALL_OPTIONS);
+}
+
+void AsyncPipelinedClient::update_flows_rpc(
+    const UpdateFlowsRequest& request,
+    std::function<void(Status, UpdateFlowsResult)> callback) {
+  AsyncClientRuntime::get_instance().call(
+    "Pipelined.UpdateFlows",
+    stubs_.get(),
+    &Pipelined::Stub::AsyncUpdateFlows,
+    request,
+    std::move(callback),
+    CALL_OPTIONS);
 }
 
 }
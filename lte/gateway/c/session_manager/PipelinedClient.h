@@ -14,7 +14,8 @@
 #include <lte/protos/policydb.pb.h>
 #include <lte/protos/pipelined.grpc.pb.h>
 
-#include "GRPCReceiver.h"
+#include "AsyncClientRuntime.h"
+#include "FlowUpdateBatch.h"
 
 using google::protobuf::RepeatedPtrField;
 using grpc::Status;
@@ -54,13 +55,20 @@ public:
     const std::string& ip_addr,
     const std::vector<std::string>& static_rules,
     const std::vector<PolicyRule>& dynamic_rules) = 0;
+
+  /**
+   * Apply the activations and deactivations of many subscribers at once
+   * @param batch - flow changes to apply
+   * @return true if the operation was successful
+   */
+  virtual bool update_flows(const FlowUpdateBatch& batch) = 0;
 };
 
 /**
  * AsyncPipelinedClient implements PipelinedClient but sends calls
- * asynchronously to pipelined.
+ * asynchronously to pipelined, through the shared AsyncClientRuntime.
  */
-class AsyncPipelinedClient : public GRPCReceiver, public PipelinedClient {
+class AsyncPipelinedClient : public PipelinedClient {
 public:
   AsyncPipelinedClient();
 
@@ -93,9 +101,16 @@ public:
     const std::vector<std::string>& static_rules,
     const std::vector<PolicyRule>& dynamic_rules);
 
+  /**
+   * Apply a batch of flow changes, using one UpdateFlows call per
+   * MAX_SUBSCRIBERS_PER_UPDATE subscribers
+   */
+  bool update_flows(const FlowUpdateBatch& batch);
+
 private:
-  static const uint32_t RESPONSE_TIMEOUT = 6; // seconds
-  std::unique_ptr<Pipelined::Stub> stub_;
+  static const uint32_t MAX_SUBSCRIBERS_PER_UPDATE = 100;
+  static const AsyncCallOptions CALL_OPTIONS;
+  StubPool<Pipelined::Stub> stubs_;
 private:
   void deactivate_flows_rpc(
     const DeactivateFlowsRequest& request,
@@ -104,6 +119,10 @@ private:
   void activate_flows_rpc(
     const ActivateFlowsRequest& request,
     std::function<void(Status, ActivateFlowsResult)> callback);
+
+  void update_flows_rpc(
+    const UpdateFlowsRequest& request,
+    std::function<void(Status, UpdateFlowsResult)> callback);
 };
 
 }
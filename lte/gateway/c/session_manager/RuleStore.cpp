@@ -125,6 +125,13 @@ bool PolicyRuleBiMap::get_rule(const std::string& rule_id, PolicyRule* rule) {
   return true;
 }
 
+void PolicyRuleBiMap::get_rules(std::vector<PolicyRule>& rules_out) {
+  std::lock_guard<std::mutex> lock(map_mutex_);
+  for (const auto& rule_pair : rules_by_rule_id_) {
+    rules_out.push_back(*rule_pair.second);
+  }
+}
+
 bool PolicyRuleBiMap::remove_rule(const std::string& rule_id, PolicyRule* rule_out) {
   std::lock_guard<std::mutex> lock(map_mutex_);
   auto it = rules_by_rule_id_.find(rule_id);
@@ -58,6 +58,11 @@ public:
 
   virtual bool get_rule(const std::string& rule_id, PolicyRule* rule);
 
+  /**
+   * Get all the rules in the store. Rules are copied into rules_out
+   */
+  virtual void get_rules(std::vector<PolicyRule>& rules_out);
+
   // Remove a rule from the store by ID. Returns true if the rule ID was found.
   // The removed rule will be copied into rule_out
   virtual bool remove_rule(const std::string& rule_id, PolicyRule* rule_out);
@@ -27,6 +27,32 @@ SessionCredit::SessionCredit(ServiceState start_state)
 SessionCredit::SessionCredit()
   : SessionCredit(SERVICE_ENABLED) {}
 
+SessionCredit::SessionCredit(const StoredSessionCredit& marshaled)
+  : reporting_(false),
+    is_final_(marshaled.is_final()),
+    reauth_state_(static_cast<ReAuthState>(marshaled.reauth_state())),
+    service_state_(static_cast<ServiceState>(marshaled.service_state())),
+    expiry_time_(marshaled.expiry_time()),
+    buckets_{} {
+  for (int i = 0; i < marshaled.buckets_size() && i < MAX_VALUES; i++) {
+    buckets_[i] = marshaled.buckets(i);
+  }
+}
+
+StoredSessionCredit SessionCredit::marshal() const {
+  StoredSessionCredit marshaled;
+  marshaled.set_is_final(is_final_);
+  marshaled.set_reauth_state(
+    reauth_state_ == REAUTH_PROCESSING ? REAUTH_REQUIRED : reauth_state_);
+  marshaled.set_service_state(service_state_);
+  marshaled.set_expiry_time(expiry_time_);
+  for (int i = 0; i < MAX_VALUES; i++) {
+    bool is_reporting_bucket = i == REPORTING_TX || i == REPORTING_RX;
+    marshaled.add_buckets(is_reporting_bucket ? 0 : buckets_[i]);
+  }
+  return marshaled;
+}
+
 void SessionCredit::set_expiry_time(uint32_t validity_time) {
   if (validity_time == 0) {
     // set as max possible time
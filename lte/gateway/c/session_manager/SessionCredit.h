@@ -72,6 +72,18 @@ public:
 
   SessionCredit(ServiceState start_state);
 
+  /**
+   * Restore a credit from its persisted form
+   */
+  SessionCredit(const StoredSessionCredit& marshaled);
+
+  /**
+   * marshal returns the persisted form of the credit. Any usage that was in
+   * the middle of being reported is not persisted as reporting, since the
+   * report response is lost across a restart, and will be reported again.
+   */
+  StoredSessionCredit marshal() const;
+
   /**
    * add_used_credit increments USED_TX and USED_RX
    * as being recently updated
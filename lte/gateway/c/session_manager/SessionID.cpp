@@ -8,18 +8,21 @@
  */
 #include <sstream>
 #include <string>
-#include <time.h>
 
 #include "SessionID.h"
 
-SessionIDGenerator::SessionIDGenerator() {
-  // init random seed
-  srand(time(NULL));
-}
+SessionIDGenerator::SessionIDGenerator()
+  : generator_(std::random_device()()),
+    distribution_(0, 999999) {}
 
 std::string SessionIDGenerator::gen_session_id(const std::string& imsi) {
+  uint32_t number;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    number = distribution_(generator_);
+  }
   // imsi- + random 6 digit number
-  return imsi + "-" + std::to_string(rand() % 1000000);
+  return imsi + "-" + std::to_string(number);
 }
 
 bool SessionIDGenerator::get_imsi_from_session_id(
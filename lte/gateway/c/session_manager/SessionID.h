@@ -9,6 +9,14 @@
 
 #pragma once
 
+#include <mutex>
+#include <random>
+#include <string>
+
+/**
+ * SessionIDGenerator is thread safe, CreateSession runs on any of the server
+ * runtime threads
+ */
 class SessionIDGenerator {
 public:
   SessionIDGenerator();
@@ -25,4 +33,9 @@ public:
   bool get_imsi_from_session_id(
       const std::string& session_id,
       std::string& imsi_out);
+
+private:
+  std::mutex mutex_;
+  std::mt19937 generator_;
+  std::uniform_int_distribution<uint32_t> distribution_;
 };
@@ -14,53 +14,32 @@ using grpc::Status;
 
 namespace magma {
 
-AsyncService::AsyncService(std::unique_ptr<ServerCompletionQueue> cq)
-  : cq_(std::move(cq)) {}
-
-void AsyncService::wait_for_requests() {
-  init_call_data();
-  void* tag;
-  bool ok;
-  running_ = true;
-  while (running_) {
-    if (cq_ == nullptr || !cq_->Next(&tag, &ok)) {
-      // queue shut down
-      MLOG(MINFO) << "sessiond request completion queue shutting down";
-      return;
-    }
-    if (!ok) {
-      MLOG(MINFO)
-        << "sessiond server encountered error while processing request";
-      continue;
-    }
-    static_cast<CallData*>(tag)->proceed();
-  }
-}
-
-void AsyncService::stop() {
-  running_ = false;
-  cq_->Shutdown();
+void AsyncService::add_to_server(service303::MagmaService& server) {
+  // every concrete service also derives from its generated gRPC AsyncService
+  server.AddAsyncServiceToServer(
+    dynamic_cast<grpc::Service*>(this),
+    [this](ServerCompletionQueue* cq) { init_call_data(cq); });
 }
 
 LocalSessionManagerAsyncService::LocalSessionManagerAsyncService(
-  std::unique_ptr<ServerCompletionQueue> cq,
   std::unique_ptr<LocalSessionManagerHandler> handler)
-  : AsyncService(std::move(cq)), handler_(std::move(handler)) {}
+  : handler_(std::move(handler)) {}
 
-void LocalSessionManagerAsyncService::init_call_data() {
-  new ReportRuleStatsCallData(cq_.get(), *this, *handler_);
-  new CreateSessionCallData(cq_.get(), *this, *handler_);
-  new EndSessionCallData(cq_.get(), *this, *handler_);
+void LocalSessionManagerAsyncService::init_call_data(
+    ServerCompletionQueue* cq) {
+  new ReportRuleStatsCallData(cq, *this, *handler_);
+  new CreateSessionCallData(cq, *this, *handler_);
+  new EndSessionCallData(cq, *this, *handler_);
 }
 
 SessionProxyResponderAsyncService::SessionProxyResponderAsyncService(
-  std::unique_ptr<ServerCompletionQueue> cq,
   std::unique_ptr<SessionProxyResponderHandler> handler)
-  : AsyncService(std::move(cq)), handler_(std::move(handler)) {}
+  : handler_(std::move(handler)) {}
 
-void SessionProxyResponderAsyncService::init_call_data() {
-  new ChargingReAuthCallData(cq_.get(), *this, *handler_);
-  new PolicyReAuthCallData(cq_.get(), *this, *handler_);
+void SessionProxyResponderAsyncService::init_call_data(
+    ServerCompletionQueue* cq) {
+  new ChargingReAuthCallData(cq, *this, *handler_);
+  new PolicyReAuthCallData(cq, *this, *handler_);
 }
 
 template<class GRPCService, class RequestType, class ResponseType>
@@ -74,8 +53,10 @@ template<class GRPCService, class RequestType, class ResponseType>
 void AsyncGRPCRequest<GRPCService, RequestType, ResponseType>::proceed() {
   if (status_ == PROCESS) {
     clone();
-    process();
+    // The finish callback may run on another runtime thread before process
+    // returns, so this must not be touched after calling process
     status_ = FINISH;
+    process();
   } else {
     GPR_ASSERT(status_ == FINISH);
     delete this;
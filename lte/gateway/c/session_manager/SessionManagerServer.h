@@ -11,6 +11,7 @@
 #include <lte/protos/session_manager.grpc.pb.h>
 
 #include "LocalSessionManagerHandler.h"
+#include "MagmaService.h"
 #include "SessionProxyResponderHandler.h"
 
 using grpc::ServerContext;
@@ -21,59 +22,50 @@ namespace magma {
 
 
 /**
- * General async gRPC service. It runs a loop pulling requests off a server
- * queue and then processing them. In general, the C++ implementation of async
- * gRPC servers is quite confusing and requires a lot of groundwork. Hopefully
- * this documentation can clear up some of the "magic".
+ * General async gRPC service. Its requests are received on the completion
+ * queues of the MagmaService async server runtime. In general, the C++
+ * implementation of async gRPC servers is quite confusing and requires a lot
+ * of groundwork. Hopefully this documentation can clear up some of the "magic".
  *
  * Every request is represented by a CallData, with one implementation per
  * RPC call. The CallData has a state machine of the life cycle of the request.
  * A request appears on the queue when it needs to be *processed* for the first
  * time and then when it needs to be finished (i.e. sent back as an answer).
  *
- * When the AsyncServer is first initialized, the CallData for each RPC must
- * be initialized. When a CallData is created for a particular RPC, the
+ * When the server starts, the runtime calls init_call_data for every request
+ * slot of every queue. When a CallData is created for a particular RPC, the
  * server will mark an incoming request with a tag, and in this case the tag is
  * a pointer to the CallData itself. When the CallData is then processed, a new
- * CallData for that RPC is created and the next request will have that tag.
+ * CallData for that RPC is created on the same queue and the next request will
+ * have that tag.
  */
 class AsyncService {
 public:
-  AsyncService(std::unique_ptr<ServerCompletionQueue> cq);
+  virtual ~AsyncService() {}
 
   /**
-   * Start the server, blocks
+   * Post a request of every RPC of the service on a queue
    */
-  void wait_for_requests();
+  virtual void init_call_data(ServerCompletionQueue* cq) = 0;
 
   /**
-   * Stop the server and shutdown the completion queue
+   * Add the service to a MagmaService, to be handled by its async runtime
    */
-  void stop();
-protected:
-  /**
-   * Initialize request handlers for report rule stats, end/create session
-   */
-  virtual void init_call_data() = 0;
-
-protected:
-  std::unique_ptr<ServerCompletionQueue> cq_;
-  std::atomic<bool> running_;
-
+  void add_to_server(service303::MagmaService& server);
 };
 
 /**
  * LocalSessionManagerAsyncService handles gRPC calls to LocalSessionManager
- * through a completion queue where requests are processed and returned async
+ * through the server completion queues where requests are processed and
+ * returned async
  */
 class LocalSessionManagerAsyncService final
   : public AsyncService, public LocalSessionManager::AsyncService {
 public:
   LocalSessionManagerAsyncService(
-    std::unique_ptr<ServerCompletionQueue> cq,
     std::unique_ptr<LocalSessionManagerHandler> handler);
-protected:
-  void init_call_data();
+
+  void init_call_data(ServerCompletionQueue* cq) override;
 
 private:
   std::unique_ptr<LocalSessionManagerHandler> handler_;
@@ -81,36 +73,21 @@ private:
 
 /**
  * SessionProxyResponderAsyncService handles gRPC calls to SessionProxyResponder
- * through a completion queue where requests are processed and returned async
+ * through the server completion queues where requests are processed and
+ * returned async
  */
 class SessionProxyResponderAsyncService final
   : public AsyncService, public SessionProxyResponder::AsyncService {
 public:
   SessionProxyResponderAsyncService(
-    std::unique_ptr<ServerCompletionQueue> cq,
     std::unique_ptr<SessionProxyResponderHandler> handler);
-protected:
-  void init_call_data();
+
+  void init_call_data(ServerCompletionQueue* cq) override;
 
 private:
   std::unique_ptr<SessionProxyResponderHandler> handler_;
 };
 
-/**
- * Interface for capturing request call processing. This is required because
- * a templated class cannot be declared without knowing the type. Using this
- * class, we can arbitrarily keep a list of CallData objects of any kind and
- * call proceed on them
- */
-class CallData {
-public:
-  /**
-   * proceed is called by the AsyncService loop when the CallData is found in
-   * the queue
-   */
-  virtual void proceed() = 0;
-};
-
 /**
  * AsyncGRPCRequest represents a GRPC call through the lifetime of its call.
  * On construction, the state machine is started and the call data is
@@ -118,7 +95,7 @@ public:
  * finished, the call data destroys itself
  */
 template <class GRPCService, class RequestType, class ResponseType>
-class AsyncGRPCRequest : public CallData {
+class AsyncGRPCRequest : public service303::ServerCallData {
 public:
   AsyncGRPCRequest(
     ServerCompletionQueue* cq,
@@ -129,7 +106,7 @@ public:
    * the call is processed through the session manager handler. If it's finished
    * then this is destroyed
    */
-  void proceed();
+  void proceed() override;
 
 protected:
   ServerCompletionQueue* cq_;
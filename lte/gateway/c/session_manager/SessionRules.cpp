@@ -49,6 +49,10 @@ bool SessionRules::remove_dynamic_rule(
   return dynamic_rules_.remove_rule(rule_id, rule_out);
 }
 
+void SessionRules::get_dynamic_rules(std::vector<PolicyRule>& rules_out) {
+  dynamic_rules_.get_rules(rules_out);
+}
+
 /**
  * For the charging key, get any applicable rules from the static rule set
  * and the dynamic rule set
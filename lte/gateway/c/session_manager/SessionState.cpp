@@ -24,7 +24,73 @@ SessionState::SessionState(
     // Request number set to 2, because request 1 is INIT call
     request_number_(2),
     curr_state_(SESSION_ACTIVE), session_rules_(rule_store),
-    charging_pool_(imsi), monitor_pool_(imsi) {}
+    charging_pool_(imsi), monitor_pool_(imsi) {
+  init_update_templates();
+}
+
+SessionState::SessionState(
+  const StoredSessionState& marshaled,
+  StaticRuleStore& rule_store)
+  : imsi_(marshaled.imsi()), session_id_(marshaled.session_id()),
+    config_({.ue_ipv4 = marshaled.ue_ipv4(),
+              .spgw_ipv4 = marshaled.spgw_ipv4(),
+              .msisdn = marshaled.msisdn(),
+              .apn = marshaled.apn(),
+              .imei = marshaled.imei(),
+              .plmn_id = marshaled.plmn_id(),
+              .imsi_plmn_id = marshaled.imsi_plmn_id(),
+              .user_location = marshaled.user_location()}),
+    request_number_(marshaled.request_number()),
+    curr_state_(static_cast<State>(marshaled.curr_state())),
+    session_rules_(rule_store),
+    charging_pool_(marshaled.imsi(), marshaled.charging_pool()),
+    monitor_pool_(marshaled.imsi(), marshaled.monitor_pool()) {
+  for (const auto& rule : marshaled.dynamic_rules()) {
+    session_rules_.insert_dynamic_rule(rule);
+  }
+  init_update_templates();
+}
+
+void SessionState::init_update_templates() {
+  charging_update_template_.set_session_id(session_id_);
+  charging_update_template_.set_sid(imsi_);
+  charging_update_template_.set_msisdn(config_.msisdn);
+  charging_update_template_.set_ue_ipv4(config_.ue_ipv4);
+  charging_update_template_.set_spgw_ipv4(config_.spgw_ipv4);
+  charging_update_template_.set_apn(config_.apn);
+  charging_update_template_.set_imei(config_.imei);
+  charging_update_template_.set_plmn_id(config_.plmn_id);
+  charging_update_template_.set_imsi_plmn_id(config_.imsi_plmn_id);
+  charging_update_template_.set_user_location(config_.user_location);
+
+  monitor_update_template_.set_session_id(session_id_);
+  monitor_update_template_.set_sid(imsi_);
+  monitor_update_template_.set_ue_ipv4(config_.ue_ipv4);
+}
+
+StoredSessionState SessionState::marshal() {
+  StoredSessionState marshaled;
+  marshaled.set_imsi(imsi_);
+  marshaled.set_session_id(session_id_);
+  marshaled.set_request_number(request_number_);
+  marshaled.set_curr_state(curr_state_);
+  marshaled.set_ue_ipv4(config_.ue_ipv4);
+  marshaled.set_spgw_ipv4(config_.spgw_ipv4);
+  marshaled.set_msisdn(config_.msisdn);
+  marshaled.set_apn(config_.apn);
+  marshaled.set_imei(config_.imei);
+  marshaled.set_plmn_id(config_.plmn_id);
+  marshaled.set_imsi_plmn_id(config_.imsi_plmn_id);
+  marshaled.set_user_location(config_.user_location);
+  marshaled.mutable_charging_pool()->CopyFrom(charging_pool_.marshal());
+  marshaled.mutable_monitor_pool()->CopyFrom(monitor_pool_.marshal());
+  std::vector<PolicyRule> dynamic_rules;
+  session_rules_.get_dynamic_rules(dynamic_rules);
+  for (const auto& rule : dynamic_rules) {
+    marshaled.add_dynamic_rules()->CopyFrom(rule);
+  }
+  return marshaled;
+}
 
 void SessionState::new_report() {
 }
@@ -74,20 +140,13 @@ void SessionState::get_updates_from_charging_pool(
   std::vector<CreditUsage> charging_updates;
   std::vector<ActionPair<uint32_t>> charging_actions;
   charging_pool_.get_updates(&charging_updates, &charging_actions);
-  for (const auto& update : charging_updates) {
+  for (auto& update : charging_updates) {
     auto new_req = update_request_out->mutable_updates()->Add();
-    new_req->set_session_id(session_id_);
+    new_req->CopyFrom(charging_update_template_);
     new_req->set_request_number(request_number_);
-    new_req->set_sid(imsi_);
-    new_req->set_msisdn(config_.msisdn);
-    new_req->set_ue_ipv4(config_.ue_ipv4);
-    new_req->set_spgw_ipv4(config_.spgw_ipv4);
-    new_req->set_apn(config_.apn);
-    new_req->set_imei(config_.imei);
-    new_req->set_plmn_id(config_.plmn_id);
-    new_req->set_imsi_plmn_id(config_.imsi_plmn_id);
-    new_req->set_user_location(config_.user_location);
-    new_req->mutable_usage()->CopyFrom(update);
+    // Swapping into a message on the request's arena would deep copy, so
+    // the arena takes ownership of a heap message moved out of update
+    new_req->set_allocated_usage(new CreditUsage(std::move(update)));
     request_number_++;
   }
   get_actions_from_pairs(imsi_, config_.ue_ipv4,
@@ -101,13 +160,11 @@ void SessionState::get_updates_from_monitor_pool(
   std::vector<UsageMonitorUpdate> monitor_updates;
   std::vector<ActionPair<std::string>> monitor_actions;
   monitor_pool_.get_updates(&monitor_updates, &monitor_actions);
-  for (const auto& update : monitor_updates) {
+  for (auto& update : monitor_updates) {
     auto new_req = update_request_out->mutable_usage_monitors()->Add();
-    new_req->set_session_id(session_id_);
+    new_req->CopyFrom(monitor_update_template_);
     new_req->set_request_number(request_number_);
-    new_req->set_sid(imsi_);
-    new_req->set_ue_ipv4(config_.ue_ipv4);
-    new_req->mutable_update()->CopyFrom(update);
+    new_req->set_allocated_update(new UsageMonitorUpdate(std::move(update)));
     request_number_++;
   }
   get_actions_from_pairs(imsi_, config_.ue_ipv4,
@@ -38,6 +38,19 @@ public:
     const SessionState::Config& cfg,
     StaticRuleStore& rule_store);
 
+  /**
+   * Restore a session from the state persisted by marshal
+   */
+  SessionState(
+    const StoredSessionState& marshaled,
+    StaticRuleStore& rule_store);
+
+  /**
+   * marshal returns the state of the session, including all credits and
+   * dynamic rules, in the form persisted to the session store
+   */
+  StoredSessionState marshal();
+
   /**
    * new_report unmarks all credits before an update, to tell if any credits
    * were not in the latest report
@@ -96,7 +109,13 @@ private:
   SessionRules session_rules_;
   SessionState::State curr_state_;
   SessionState::Config config_;
+  // Session fields that are the same in every update, set once so that
+  // collecting updates copies prepared messages instead of each string
+  CreditUsageUpdate charging_update_template_;
+  UsageMonitoringUpdateRequest monitor_update_template_;
 private:
+  void init_update_templates();
+
   void get_updates_from_charging_pool(
     UpdateSessionRequest* update_request_out,
     std::vector<std::unique_ptr<ServiceAction>>* actions_out);
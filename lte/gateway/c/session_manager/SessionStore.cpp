@@ -0,0 +1,166 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <chrono>
+#include <thread>
+
+#include "SessionStore.h"
+#include "Serializers.h"
+#include "ServiceConfigLoader.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+SessionStore::SessionStore(std::shared_ptr<cpp_redis::client> client)
+  : client_(client),
+    session_map_(
+      client,
+      "sessiond:sessions",
+      get_proto_serializer(),
+      get_proto_deserializer()),
+    is_running_(false) {}
+
+bool SessionStore::connect() {
+  if (client_->is_connected()) {
+    return true;
+  }
+  ServiceConfigLoader loader;
+  auto config = loader.load_service_config("redis");
+  auto port = config["port"].as<uint32_t>();
+  try {
+    client_->connect("127.0.0.1", port, [](
+        const std::string& host,
+        std::size_t port,
+        cpp_redis::client::connect_state status) {
+      if (status == cpp_redis::client::connect_state::dropped) {
+        MLOG(MERROR) << "Session store disconnected from "
+          << host << ":" << port;
+      }
+    });
+    return client_->is_connected();
+  } catch (const cpp_redis::redis_error& e) {
+    MLOG(MERROR) << "Session store could not connect to redis: " << e.what();
+    return false;
+  }
+}
+
+bool SessionStore::load_sessions(
+    std::vector<StoredSessionState>& sessions_out) {
+  if (!connect()) {
+    return false;
+  }
+  std::vector<std::string> failed_keys;
+  auto result = session_map_.getall(sessions_out, &failed_keys);
+  if (result != SUCCESS) {
+    MLOG(MERROR) << "Failed to load sessions because map error " << result;
+    return false;
+  }
+  for (const auto& imsi : failed_keys) {
+    MLOG(MERROR) << "Dropping persisted session for " << imsi
+      << " because it could not be read";
+  }
+  session_map_.remove_all(failed_keys);
+  return true;
+}
+
+void SessionStore::write_sessions(std::vector<StoredSessionState> sessions) {
+  if (sessions.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    for (auto& session : sessions) {
+      auto imsi = session.imsi();
+      pending_[imsi] = std::make_unique<StoredSessionState>(
+        std::move(session));
+    }
+  }
+  pending_cv_.notify_one();
+}
+
+void SessionStore::remove_sessions(const std::vector<std::string>& imsis) {
+  if (imsis.empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    for (const auto& imsi : imsis) {
+      pending_[imsi] = nullptr;
+    }
+  }
+  pending_cv_.notify_one();
+}
+
+void SessionStore::start_loop() {
+  is_running_ = true;
+  while (is_running_) {
+    std::unordered_map<std::string, std::unique_ptr<StoredSessionState>> batch;
+    {
+      std::unique_lock<std::mutex> lock(pending_mutex_);
+      pending_cv_.wait(lock, [this] {
+        return !pending_.empty() || !is_running_;
+      });
+      batch.swap(pending_);
+    }
+    if (batch.empty()) {
+      continue;
+    }
+    if (!write_batch(batch)) {
+      requeue(batch);
+      std::this_thread::sleep_for(std::chrono::seconds(RETRY_INTERVAL));
+    }
+  }
+}
+
+void SessionStore::stop() {
+  {
+    // Set under the mutex so that the writer thread cannot check the flag
+    // and then miss the wakeup
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    is_running_ = false;
+  }
+  pending_cv_.notify_one();
+}
+
+bool SessionStore::write_batch(
+    const std::unordered_map<std::string,
+                             std::unique_ptr<StoredSessionState>>& batch) {
+  if (!connect()) {
+    return false;
+  }
+  std::vector<std::pair<std::string, StoredSessionState>> to_write;
+  std::vector<std::string> to_remove;
+  for (const auto& session_pair : batch) {
+    if (session_pair.second == nullptr) {
+      to_remove.push_back(session_pair.first);
+    } else {
+      to_write.emplace_back(session_pair.first, *session_pair.second);
+    }
+  }
+  if (session_map_.set_all(to_write) == CLIENT_ERROR ||
+      session_map_.remove_all(to_remove) == CLIENT_ERROR) {
+    MLOG(MERROR) << "Failed to write " << batch.size()
+      << " sessions to the session store, retrying";
+    return false;
+  }
+  MLOG(MDEBUG) << "Wrote " << to_write.size() << " sessions and removed "
+    << to_remove.size() << " sessions in the session store";
+  return true;
+}
+
+void SessionStore::requeue(
+    std::unordered_map<std::string,
+                       std::unique_ptr<StoredSessionState>>& batch) {
+  std::lock_guard<std::mutex> lock(pending_mutex_);
+  for (auto& session_pair : batch) {
+    // emplace does not replace state queued after this batch was taken
+    pending_.emplace(session_pair.first, std::move(session_pair.second));
+  }
+}
+
+}
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+#include <cpp_redis/cpp_redis>
+#include <lte/protos/session_manager.pb.h>
+
+#include "RedisMap.hpp"
+
+namespace magma {
+using namespace lte;
+
+/**
+ * SessionStore persists session state to the local redis so that sessiond can
+ * resume tracking active sessions after a restart, without re-creating them
+ * in the OCS/PCRF. Changes are queued by the enforcer and written behind in
+ * batches on the store's own thread, so the event base never blocks on redis.
+ */
+class SessionStore {
+public:
+  SessionStore(std::shared_ptr<cpp_redis::client> client);
+
+  /**
+   * load_sessions reads all persisted sessions from redis, blocks
+   * @param sessions_out (out) - vector to add the persisted sessions to
+   * @return true if the sessions could be read
+   */
+  bool load_sessions(std::vector<StoredSessionState>& sessions_out);
+
+  /**
+   * write_sessions queues the given sessions to be written. Queued state that
+   * has not been written yet is replaced by newer state for the same IMSI.
+   */
+  void write_sessions(std::vector<StoredSessionState> sessions);
+
+  /**
+   * remove_sessions queues the sessions of the given IMSIs to be removed
+   */
+  void remove_sessions(const std::vector<std::string>& imsis);
+
+  /**
+   * start_loop writes queued changes to redis as they come in, blocks
+   */
+  void start_loop();
+
+  /**
+   * Stop the write loop once the current batch is written
+   */
+  void stop();
+
+private:
+  static const uint32_t RETRY_INTERVAL = 1; // seconds
+  std::shared_ptr<cpp_redis::client> client_;
+  RedisMap<StoredSessionState> session_map_;
+  std::atomic<bool> is_running_;
+  std::mutex pending_mutex_;
+  std::condition_variable pending_cv_;
+  // IMSI -> state to write, or nullptr if the session should be removed
+  std::unordered_map<std::string, std::unique_ptr<StoredSessionState>>
+    pending_;
+
+private:
+  bool connect();
+
+  /**
+   * Write a batch of changes. Returns false if redis could not be written,
+   * in which case the caller should requeue the batch
+   */
+  bool write_batch(
+    const std::unordered_map<std::string,
+                             std::unique_ptr<StoredSessionState>>& batch);
+
+  /**
+   * Put a failed batch back in the queue, unless newer state for the same
+   * IMSI was queued in the meantime
+   */
+  void requeue(
+    std::unordered_map<std::string,
+                       std::unique_ptr<StoredSessionState>>& batch);
+};
+
+}
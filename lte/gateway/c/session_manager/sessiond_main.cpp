@@ -11,6 +11,7 @@
 
 #include <lte/protos/mconfig/mconfigs.pb.h>
 
+#include "AsyncClientRuntime.h"
 #include "SessionManagerServer.h"
 #include "LocalEnforcer.h"
 #include "CloudReporter.h"
@@ -20,6 +21,7 @@
 #include "MConfigLoader.h"
 #include "magma_logging.h"
 #include "SessionCredit.h"
+#include "SessionStore.h"
 
 #define SESSIOND_SERVICE "sessiond"
 #define SESSION_PROXY_SERVICE "session_proxy"
@@ -57,6 +59,21 @@ static bool sessiond_enabled(const magma::mconfig::SessionD& mconfig) {
   return mconfig.relay_enabled();
 }
 
+static bool session_store_enabled(const YAML::Node& config) {
+  return config["persist_session_state"].IsDefined() &&
+    config["persist_session_state"].as<bool>();
+}
+
+static uint32_t get_config_uint(
+    const YAML::Node& config,
+    const std::string& key,
+    uint32_t default_value) {
+  if (!config[key].IsDefined()) {
+    return default_value;
+  }
+  return config[key].as<uint32_t>();
+}
+
 static const std::shared_ptr<grpc::Channel> get_controller_channel(
     const YAML::Node& config) {
   if (!config["use_proxied_controller"].IsDefined() ||
@@ -101,23 +118,42 @@ int main (int argc, char* argv[]) {
     policy_loader.stop();
   });
 
+  // pipelined and cloud responses are received by the shared client runtime
+  magma::AsyncClientRuntime::get_instance().start(
+    get_config_uint(
+      config, "client_runtime_threads",
+      magma::AsyncClientRuntime::DEFAULT_NUM_QUEUES));
   auto pipelined_client = std::make_shared<magma::AsyncPipelinedClient>();
-  std::thread rule_manager_thread([&]() {
-    MLOG(MINFO) << "Started pipelined response thread";
-    pipelined_client->rpc_response_loop();
-  });
 
   auto reporting_limit = config["usage_reporting_limit_bytes"].as<uint64_t>();
   magma::SessionCredit::USAGE_REPORTING_LIMIT = reporting_limit;
 
   auto monitor = magma::LocalEnforcer(rule_store, pipelined_client);
 
-  magma::SessionCloudReporter reporter(evb, get_controller_channel(config));
-  std::thread reporter_thread([&]() {
-    MLOG(MINFO) << "Started reporter thread";
-    reporter.rpc_response_loop();
+  // restore sessions persisted before a restart, so they don't have to be
+  // re-created in the OCS/PCRF
+  std::shared_ptr<magma::SessionStore> session_store = nullptr;
+  if (session_store_enabled(config)) {
+    session_store = std::make_shared<magma::SessionStore>(
+      std::make_shared<cpp_redis::client>());
+    monitor.attach_session_store(
+      session_store,
+      config["session_store_flush_interval_ms"].as<uint32_t>());
+    std::vector<magma::StoredSessionState> stored_sessions;
+    if (session_store->load_sessions(stored_sessions)) {
+      monitor.restore_sessions(stored_sessions);
+    } else {
+      MLOG(MERROR) << "Unable to load persisted sessions, starting empty";
+    }
+  }
+  std::thread session_store_thread([&]() {
+    if (session_store == nullptr) return;
+    MLOG(MINFO) << "Started session store thread";
+    session_store->start_loop();
   });
 
+  magma::SessionCloudReporter reporter(evb, get_controller_channel(config));
+
   magma::service303::MagmaService server(SESSIOND_SERVICE, SESSIOND_VERSION);
   auto local_handler = std::make_unique<magma::LocalSessionManagerHandlerImpl>(
     &monitor, &reporter);
@@ -125,33 +161,36 @@ int main (int argc, char* argv[]) {
     &monitor);
 
   magma::LocalSessionManagerAsyncService local_service(
-    server.GetNewCompletionQueue(), std::move(local_handler));
+    std::move(local_handler));
   magma::SessionProxyResponderAsyncService proxy_service(
-    server.GetNewCompletionQueue(), std::move(proxy_handler));
-  server.AddServiceToServer(&local_service);
-  server.AddServiceToServer(&proxy_service);
+    std::move(proxy_handler));
+  // Requests of both services are spread over all server queues, so that
+  // CreateSession isn't stuck behind a burst of ReportRuleStats
+  server.SetAsyncServerRuntime(
+    get_config_uint(
+      config, "server_completion_queues",
+      magma::service303::MagmaService::DEFAULT_ASYNC_QUEUES),
+    get_config_uint(
+      config, "server_threads",
+      magma::service303::MagmaService::DEFAULT_ASYNC_THREADS),
+    get_config_uint(
+      config, "server_request_slots",
+      magma::service303::MagmaService::DEFAULT_ASYNC_REQUEST_SLOTS));
+  local_service.add_to_server(server);
+  proxy_service.add_to_server(server);
   server.Start();
 
-  std::thread local_thread([&]() {
-    MLOG(MINFO) << "Started local service thread";
-    local_service.wait_for_requests(); // block here instead of on server
-    local_service.stop(); // stop queue after server shuts down
-  });
-  std::thread proxy_thread([&]() {
-    MLOG(MINFO) << "Started proxy service thread";
-    proxy_service.wait_for_requests(); // block here instead of on server
-    proxy_service.stop(); // stop queue after server shuts down
-  });
-
   // Block on main monitor (to keep evb in this thread)
   monitor.attachEventBase(evb);
   monitor.start();
   server.Stop();
+  if (session_store != nullptr) {
+    session_store->stop();
+  }
+
+  magma::AsyncClientRuntime::get_instance().stop();
 
-  reporter_thread.join();
-  local_thread.join();
-  proxy_thread.join();
-  rule_manager_thread.join();
+  session_store_thread.join();
   policy_loader_thread.join();
 
   return 0;
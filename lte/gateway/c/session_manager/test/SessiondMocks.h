@@ -34,6 +34,7 @@ MockPipelined() : Pipelined::Service() {
   ON_CALL(*this, AddRule(_,_,_)).WillByDefault(Return(Status::OK));
   ON_CALL(*this, ActivateFlows(_,_,_)).WillByDefault(Return(Status::OK));
   ON_CALL(*this, DeactivateFlows(_,_,_)).WillByDefault(Return(Status::OK));
+  ON_CALL(*this, UpdateFlows(_,_,_)).WillByDefault(Return(Status::OK));
 }
 
 MOCK_METHOD3(AddRule, Status(grpc::ServerContext*,
@@ -45,6 +46,9 @@ MOCK_METHOD3(ActivateFlows, Status(grpc::ServerContext*,
 MOCK_METHOD3(DeactivateFlows, Status(grpc::ServerContext*,
   const DeactivateFlowsRequest*,
   DeactivateFlowsResult*));
+MOCK_METHOD3(UpdateFlows, Status(grpc::ServerContext*,
+  const UpdateFlowsRequest*,
+  UpdateFlowsResult*));
 };
 
 class MockPipelinedClient : public PipelinedClient {
@@ -55,6 +59,7 @@ public:
       .WillByDefault(Return(true));
     ON_CALL(*this, activate_flows_for_rules(_,_,_,_))
       .WillByDefault(Return(true));
+    ON_CALL(*this, update_flows(_)).WillByDefault(Return(true));
   }
 
   MOCK_METHOD1(deactivate_all_flows, bool(const std::string& imsi));
@@ -67,6 +72,7 @@ public:
     const std::string& ip_addr,
     const std::vector<std::string>& static_rules,
     const std::vector<PolicyRule>& dynamic_rules));
+  MOCK_METHOD1(update_flows, bool(const FlowUpdateBatch& batch));
 };
 
 /**
@@ -105,7 +111,7 @@ public:
   ~MockSessionHandler() {}
 
   MOCK_METHOD3(ReportRuleStats, void(grpc::ServerContext*,
-    const RuleRecordTable*,
+    RuleRecordTable*,
     std::function<void(Status, Void)>));
 
   MOCK_METHOD3(CreateSession, void(grpc::ServerContext*,
@@ -40,26 +40,20 @@ protected:
     mock_handler = mock_handler_p.get();
 
     async_service = std::make_shared<LocalSessionManagerAsyncService>(
-      magma_service->GetNewCompletionQueue(),
       std::move(mock_handler_p));
-    magma_service->AddServiceToServer(async_service.get());
+    // more threads than queues, so calls on one queue run concurrently
+    magma_service->SetAsyncServerRuntime(2, 4, 2);
+    async_service->add_to_server(*magma_service);
 
     stub = LocalSessionManager::NewStub(channel);
 
-    std::thread grpc_thread([&]() {
-      std::cout << "Started grpc thread\n";
-      magma_service->Start();
-      async_service->wait_for_requests(); // block here instead of on server
-      std::cout << "Stopped grpc thread\n";
-    });
+    magma_service->Start();
     // wait for server to start
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    grpc_thread.detach();
   }
 
   virtual void TearDown() {
     magma_service->Stop();
-    async_service->stop();
   }
 
   void create_session() {
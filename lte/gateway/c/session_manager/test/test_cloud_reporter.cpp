@@ -40,11 +40,7 @@ protected:
 
     reporter = std::make_shared<SessionCloudReporter>(&evb, channel);
 
-    std::thread reporter_thread([&]() {
-      std::cout << "Started reporter thread\n";
-      reporter->rpc_response_loop();
-      std::cout << "Stopped reporter thread\n";
-    });
+    AsyncClientRuntime::get_instance().start(1);
 
     std::thread cloud_thread([&]() {
       std::cout << "Started cloud thread\n";
@@ -55,13 +51,12 @@ protected:
 
     // wait for server to start
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    reporter_thread.detach();
     cloud_thread.detach();
   }
 
   virtual void TearDown() {
     magma_service->Stop();
-    reporter->stop();
+    AsyncClientRuntime::get_instance().stop();
   }
 
   // Timeout to not block test
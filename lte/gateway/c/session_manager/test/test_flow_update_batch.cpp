@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <gtest/gtest.h>
+#include "FlowUpdateBatch.h"
+
+using ::testing::Test;
+
+namespace magma {
+
+static PolicyRule create_dynamic_rule(const std::string& id) {
+  PolicyRule rule;
+  rule.set_id(id);
+  return rule;
+}
+
+TEST(test_batch_subscribers, test_flow_update_batch) {
+  FlowUpdateBatch batch;
+  EXPECT_TRUE(batch.empty());
+  batch.add_activation("IMSI1", "1.2.3.4", {"rule1", "rule2"}, {});
+  batch.add_activation("IMSI2", "1.2.3.5", {}, {create_dynamic_rule("dyn1")});
+  batch.add_deactivation("IMSI3", {"rule3"}, {});
+  EXPECT_FALSE(batch.empty());
+
+  auto requests = batch.get_requests(100);
+  EXPECT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0].activate_requests_size(), 2);
+  EXPECT_EQ(requests[0].activate_requests(0).sid().id(), "IMSI1");
+  EXPECT_EQ(requests[0].activate_requests(0).ip_addr(), "1.2.3.4");
+  EXPECT_EQ(requests[0].activate_requests(0).rule_ids_size(), 2);
+  EXPECT_EQ(requests[0].activate_requests(1).dynamic_rules_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests(0).sid().id(), "IMSI3");
+
+  // one subscriber per request
+  EXPECT_EQ(batch.get_requests(1).size(), 3);
+}
+
+TEST(test_last_action_wins, test_flow_update_batch) {
+  FlowUpdateBatch batch;
+  batch.add_activation("IMSI1", "1.2.3.4", {"rule1", "rule2"}, {});
+  batch.add_deactivation("IMSI1", {"rule1"}, {});
+  batch.add_deactivation("IMSI1", {"rule3"}, {});
+  batch.add_activation("IMSI1", "1.2.3.4", {"rule3"}, {});
+
+  auto requests = batch.get_requests(100);
+  EXPECT_EQ(requests.size(), 1);
+  // rule1 may have been installed by an earlier batch
+  EXPECT_EQ(requests[0].deactivate_requests_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests(0).rule_ids_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests(0).rule_ids(0), "rule1");
+  EXPECT_EQ(requests[0].activate_requests_size(), 1);
+  EXPECT_EQ(requests[0].activate_requests(0).rule_ids_size(), 2);
+
+  // a deactivation cancelling a pending activation is still sent
+  FlowUpdateBatch cancelled;
+  cancelled.add_activation("IMSI1", "1.2.3.4", {"rule1"}, {});
+  cancelled.add_deactivation("IMSI1", {"rule1"}, {});
+  requests = cancelled.get_requests(100);
+  EXPECT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests(0).rule_ids(0), "rule1");
+  EXPECT_EQ(requests[0].activate_requests_size(), 0);
+}
+
+TEST(test_deactivate_all, test_flow_update_batch) {
+  FlowUpdateBatch batch;
+  batch.add_activation("IMSI1", "1.2.3.4", {"rule1"}, {});
+  batch.add_deactivation("IMSI1", {}, {});
+  batch.add_activation("IMSI1", "1.2.3.4", {"rule2"}, {});
+
+  auto requests = batch.get_requests(100);
+  EXPECT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests_size(), 1);
+  EXPECT_EQ(requests[0].deactivate_requests(0).rule_ids_size(), 0);
+  EXPECT_EQ(requests[0].activate_requests_size(), 1);
+  EXPECT_EQ(requests[0].activate_requests(0).rule_ids(0), "rule2");
+}
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+}
@@ -101,6 +101,27 @@ MATCHER_P2(CheckActivateFlows, imsi, rule_count, "") {
   return request->sid().id() == imsi && request->rule_ids_size() == rule_count;
 }
 
+MATCHER_P3(CheckUpdateFlows, imsi, deactivate_count, activate_count, "") {
+  auto requests = arg.get_requests(100);
+  if (requests.size() != 1) {
+    return false;
+  }
+  int deactivated = 0, activated = 0;
+  for (const auto& req : requests[0].deactivate_requests()) {
+    if (req.sid().id() != imsi) {
+      return false;
+    }
+    deactivated += req.rule_ids_size();
+  }
+  for (const auto& req : requests[0].activate_requests()) {
+    if (req.sid().id() != imsi) {
+      return false;
+    }
+    activated += req.rule_ids_size() + req.dynamic_rules_size();
+  }
+  return deactivated == deactivate_count && activated == activate_count;
+}
+
 TEST_F(LocalEnforcerTest, test_init_session_credit) {
   insert_static_rule(1, "", "rule1");
 
@@ -258,8 +279,7 @@ TEST_F(LocalEnforcerTest, test_final_unit_handling) {
   create_rule_record("IMSI1", "rule2", 1024, 2048, record_list->Add());
   local_enforcer->aggregate_records(table);
 
-  EXPECT_CALL(*pipelined_client,
-    deactivate_flows_for_rules(testing::_, testing::_, testing::_))
+  EXPECT_CALL(*pipelined_client, update_flows(CheckUpdateFlows("IMSI1", 2, 0)))
     .Times(1)
     .WillOnce(testing::Return(true));
   // call collect_updates to trigger actions
@@ -344,8 +364,7 @@ TEST_F(LocalEnforcerTest, test_re_auth) {
 
   // when next update is collected, this should trigger an action to activate
   // the flow in pipelined
-  EXPECT_CALL(*pipelined_client,
-    activate_flows_for_rules(testing::_, testing::_, testing::_, testing::_))
+  EXPECT_CALL(*pipelined_client, update_flows(CheckUpdateFlows("IMSI1", 0, 1)))
     .Times(1)
     .WillOnce(testing::Return(true));
   local_enforcer->collect_updates();
@@ -398,8 +417,7 @@ TEST_F(LocalEnforcerTest, test_dynamic_rule_actions) {
   create_rule_record("IMSI1", "rule2", 1024, 2048, record_list->Add());
   local_enforcer->aggregate_records(table);
 
-  EXPECT_CALL(*pipelined_client,
-    deactivate_flows_for_rules(testing::_, CheckCount(2), CheckCount(1)))
+  EXPECT_CALL(*pipelined_client, update_flows(CheckUpdateFlows("IMSI1", 3, 0)))
     .Times(1)
     .WillOnce(testing::Return(true));
   auto usage_updates = local_enforcer->collect_updates();
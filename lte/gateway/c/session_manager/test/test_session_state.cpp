@@ -270,6 +270,54 @@ TEST_F(SessionStateTest, test_reauth_all) {
   EXPECT_EQ(reauth_res, ChargingReAuthAnswer::UPDATE_NOT_NEEDED);
 }
 
+TEST_F(SessionStateTest, test_marshal_unmarshal) {
+  insert_rule(1, "m1", "rule1", true);
+  insert_rule(2, "", "dyn_rule1", false);
+
+  receive_credit_from_ocs(1, 1024);
+  receive_credit_from_ocs(2, 1024);
+  receive_credit_from_pcrf("m1", 1024, MonitoringLevel::SESSION_LEVEL);
+
+  session_state->add_used_credit("rule1", 10, 20);
+  session_state->add_used_credit("dyn_rule1", 2000, 40);
+
+  // Credit 2 is exhausted and will be reporting when marshaled
+  UpdateSessionRequest update;
+  std::vector<std::unique_ptr<ServiceAction>> actions;
+  session_state->get_updates(&update, &actions);
+  EXPECT_EQ(update.updates_size(), 1);
+  EXPECT_EQ(
+    session_state->get_charging_pool().get_credit(2, REPORTING_TX), 2000);
+
+  auto marshaled = session_state->marshal();
+  EXPECT_EQ(marshaled.imsi(), "imsi");
+  EXPECT_EQ(marshaled.ue_ipv4(), "127.0.0.1");
+  EXPECT_EQ(marshaled.dynamic_rules_size(), 1);
+
+  SessionState restored(marshaled, *rule_store);
+  EXPECT_EQ(restored.get_session_id(), "session");
+  EXPECT_EQ(restored.get_subscriber_ip_addr(), "127.0.0.1");
+  EXPECT_EQ(restored.get_charging_pool().get_credit(1, USED_TX), 10);
+  EXPECT_EQ(restored.get_charging_pool().get_credit(1, USED_RX), 20);
+  EXPECT_EQ(restored.get_charging_pool().get_credit(2, ALLOWED_TOTAL), 1024);
+  EXPECT_EQ(restored.get_monitor_pool().get_credit("m1", USED_TX), 2010);
+  EXPECT_EQ("m1", *restored.get_monitor_pool().get_session_level_key());
+
+  // In-flight reports are lost on restart, so restored credits report again
+  EXPECT_EQ(restored.get_charging_pool().get_credit(2, REPORTING_TX), 0);
+  UpdateSessionRequest restored_update;
+  restored.get_updates(&restored_update, &actions);
+  EXPECT_EQ(restored_update.updates_size(), 1);
+  EXPECT_EQ(restored_update.updates(0).request_number(),
+            marshaled.request_number());
+  EXPECT_EQ(restored_update.updates(0).usage().bytes_tx(), 2000);
+
+  // Dynamic rules are restored along with their charging keys
+  PolicyRule rule_out;
+  EXPECT_TRUE(restored.remove_dynamic_rule("dyn_rule1", &rule_out));
+  EXPECT_EQ(rule_out.rating_group(), 2);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   FLAGS_logtostderr = 1;
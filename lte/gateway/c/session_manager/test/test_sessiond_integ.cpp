@@ -54,16 +54,14 @@ protected:
     local_service = std::make_shared<service303::MagmaService>(
       "sessiond", "1.0");
     session_manager = std::make_shared<LocalSessionManagerAsyncService>(
-      local_service->GetNewCompletionQueue(),
       std::make_unique<LocalSessionManagerHandlerImpl>(
         monitor.get(), reporter.get()));
 
     proxy_responder = std::make_shared<SessionProxyResponderAsyncService>(
-      local_service->GetNewCompletionQueue(),
       std::make_unique<SessionProxyResponderHandlerImpl>(monitor.get()));
 
-    local_service->AddServiceToServer(session_manager.get());
-    local_service->AddServiceToServer(proxy_responder.get());
+    session_manager->add_to_server(*local_service);
+    proxy_responder->add_to_server(*local_service);
 
     test_service = std::make_shared<service303::MagmaService>(
       "test_service", "1.0");
@@ -77,35 +75,20 @@ protected:
       test_service->Start();
       test_service->WaitForShutdown();
     }).detach();
-    std::thread([&]() {
-      pipelined_client->rpc_response_loop();
-    }).detach();
     std::thread([&]() {
       std::cout << "Started monitor thread\n";
       monitor->attachEventBase(evb);
       monitor->start();
     }).detach();
-    std::thread([&]() {
-      std::cout << "Started reporter thread\n";
-      reporter->rpc_response_loop();
-    }).detach();
-    std::thread([&]() {
-      std::cout << "Started local grpc thread\n";
-      session_manager->wait_for_requests();
-    }).detach();
-    std::thread([&]() {
-      std::cout << "Started local grpc thread\n";
-      proxy_responder->wait_for_requests();
-    }).detach();
+    AsyncClientRuntime::get_instance().start(1);
     std::this_thread::sleep_for(std::chrono::milliseconds(10));
   }
 
   virtual void TearDown() {
     local_service->Stop();
     monitor->stop();
-    reporter->stop();
     test_service->Stop();
-    pipelined_client->stop();
+    AsyncClientRuntime::get_instance().stop();
   }
 
   void insert_static_rule(
@@ -10,7 +10,8 @@ from concurrent.futures import Future
 
 import grpc
 from lte.protos import pipelined_pb2_grpc
-from lte.protos.pipelined_pb2 import DeactivateFlowsResult, FlowResponse
+from lte.protos.pipelined_pb2 import DeactivateFlowsResult, FlowResponse, \
+    UpdateFlowsResult
 from magma.pipelined.app.dpi import DPIController
 from magma.pipelined.app.enforcement import EnforcementController
 from magma.pipelined.app.enforcement_stats import EnforcementStatsController
@@ -94,6 +95,38 @@ class PipelinedRpcServicer(pipelined_pb2_grpc.PipelinedServicer):
                 request.sid.id, request.rule_ids)
         return DeactivateFlowsResult()
 
+    def UpdateFlows(self, request, context):
+        """
+        Deactivate and then activate flows for many subscribers at once
+        """
+        if not self._service_manager.is_app_enabled(
+                EnforcementController.APP_NAME):
+            context.set_code(grpc.StatusCode.UNAVAILABLE)
+            context.set_details('Service not enabled!')
+            return None
+        stats_enabled = self._service_manager.is_app_enabled(
+            EnforcementStatsController.APP_NAME)
+        for deactivate_req in request.deactivate_requests:
+            self._loop.call_soon_threadsafe(
+                self._enforcer_app.deactivate_flows,
+                deactivate_req.sid.id, deactivate_req.rule_ids)
+            if stats_enabled:
+                self._loop.call_soon_threadsafe(
+                    self._enforcement_stats.delete_stats,
+                    deactivate_req.sid.id, deactivate_req.rule_ids)
+        # The loop runs callbacks in order, so all deactivations are applied
+        # before the activations below
+        futures = []
+        for activate_req in request.activate_requests:
+            fut = Future()
+            self._loop.call_soon_threadsafe(
+                self._enforcer_app.activate_flows,
+                activate_req.sid.id, activate_req.ip_addr,
+                activate_req.rule_ids, activate_req.dynamic_rules, fut)
+            futures.append(fut)
+        return UpdateFlowsResult(
+            activate_results=[fut.result() for fut in futures])
+
     # --------------------------
     # DPI App
     # --------------------------
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+
+"""
+Copyright (c) 2016-present, Facebook, Inc.
+All rights reserved.
+
+This source code is licensed under the BSD-style license found in the
+LICENSE file in the root directory of this source tree. An additional grant
+of patent rights can be found in the PATENTS file in the same directory.
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+from collections import namedtuple
+
+# Layouts from lte/gateway/c/oai/lib/itti/itti_trace.h
+MAGIC = 0x52545449
+VERSION = 1
+FILE_HEADER = struct.Struct('=IHHIIII')
+THREAD_HEADER = struct.Struct('=16sIIQ')
+RECORD = struct.Struct('=QIIIIHHHBB')
+
+SEND, RECEIVE, DROP = range(3)
+EVENT_NAMES = {SEND: 'send', RECEIVE: 'recv', DROP: 'drop'}
+
+Record = namedtuple(
+    'Record',
+    ['timestamp_ns', 'message_number', 'size', 'enb_ue_s1ap_id',
+     'mme_ue_s1ap_id', 'message_id', 'origin_task', 'destination_task',
+     'event', 'payload_length', 'thread', 'payload'],
+)
+
+
+class TraceFormatError(Exception):
+    pass
+
+
+def _read(trace, size):
+    data = trace.read(size)
+    if len(data) != size:
+        raise TraceFormatError('Trace file is truncated')
+    return data
+
+
+def _read_names(trace, count):
+    names = []
+    for _ in range(count):
+        length, = struct.unpack('=H', _read(trace, 2))
+        names.append(_read(trace, length).decode('ascii', 'replace'))
+    return names
+
+
+def read_trace(trace):
+    """
+    Read a trace dump, and return the task names, the message names and all
+    records sorted by time
+    """
+    magic, version, record_size, payload_size, nb_tasks, nb_messages, \
+        nb_threads = FILE_HEADER.unpack(_read(trace, FILE_HEADER.size))
+    if magic != MAGIC:
+        raise TraceFormatError('Not an ITTI trace')
+    if version != VERSION or record_size != RECORD.size:
+        raise TraceFormatError('Unsupported trace version %d' % version)
+    task_names = _read_names(trace, nb_tasks)
+    message_names = _read_names(trace, nb_messages)
+
+    records = []
+    for _ in range(nb_threads):
+        name, tid, nb_records, nb_lost = THREAD_HEADER.unpack(
+            _read(trace, THREAD_HEADER.size))
+        thread = '%s/%d' % (name.split(b'\0', 1)[0].decode(), tid)
+        data = _read(trace, nb_records * RECORD.size)
+        fields = [RECORD.unpack_from(data, i * RECORD.size)
+                  for i in range(nb_records)]
+        payloads = _read(trace, nb_records * payload_size)
+        for i, field in enumerate(fields):
+            start = i * payload_size
+            payload = payloads[start:start + field[-1]]
+            records.append(Record(*field, thread=thread, payload=payload))
+        if nb_lost:
+            print('# %s: %d older records were overwritten' %
+                  (thread, nb_lost), file=sys.stderr)
+    records.sort(key=lambda r: (r.timestamp_ns, r.message_number))
+    return task_names, message_names, records
+
+
+def _name(names, index):
+    return names[index] if index < len(names) else str(index)
+
+
+def _ue(record):
+    if not record.enb_ue_s1ap_id and not record.mme_ue_s1ap_id:
+        return ''
+    return 'enb_ue_s1ap_id=%d mme_ue_s1ap_id=%d' % (
+        record.enb_ue_s1ap_id, record.mme_ue_s1ap_id)
+
+
+def print_timeline(task_names, message_names, records, out):
+    for r in records:
+        time = datetime.datetime.fromtimestamp(r.timestamp_ns / 1e9)
+        ue = _ue(r)
+        print('%s.%06d %-20s %s %s -> %s %s #%d %dB%s%s' % (
+            time.strftime('%H:%M:%S'), time.microsecond, r.thread,
+            EVENT_NAMES.get(r.event, '?'),
+            _name(task_names, r.origin_task),
+            _name(task_names, r.destination_task),
+            _name(message_names, r.message_id), r.message_number, r.size,
+            ' ' + ue if ue else '',
+            ' ' + r.payload.hex() if r.payload else ''), file=out)
+
+
+def print_msc(task_names, message_names, records, out):
+    """
+    Render the sent and dropped messages as an mscgen sequence chart
+    """
+    arcs = [r for r in records if r.event in (SEND, DROP)]
+    tasks = sorted({t for r in arcs for t in (r.origin_task,
+                                                r.destination_task)})
+    print('msc {', file=out)
+    print('  hscale = "2";', file=out)
+    print('  %s;' % ', '.join(
+        '"%s"' % _name(task_names, t) for t in tasks), file=out)
+    for r in arcs:
+        label = '%s #%d' % (_name(message_names, r.message_id),
+                            r.message_number)
+        ue = _ue(r)
+        if ue:
+            label += '\\n' + ue
+        print('  "%s" %s "%s" [label="%s"];' % (
+            _name(task_names, r.origin_task),
+            '->' if r.event == SEND else '-x',
+            _name(task_names, r.destination_task), label), file=out)
+    print('}', file=out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Decode a binary ITTI trace dumped by the MME on SIGUSR2 '
+                    'or on failure')
+    parser.add_argument('trace', help='trace file, e.g. '
+                                      '/var/log/mme_itti_trace.bin')
+    parser.add_argument('--msc', action='store_true',
+                        help='print an mscgen sequence chart instead of a '
+                             'timeline')
+    parser.add_argument('--ue', type=int,
+                        help='only keep the messages of this mme_ue_s1ap_id')
+    parser.add_argument('--task', action='append',
+                        help='only keep the messages from or to this task, '
+                             'may be repeated')
+    args = parser.parse_args()
+
+    with open(args.trace, 'rb') as trace:
+        task_names, message_names, records = read_trace(trace)
+    if args.ue is not None:
+        records = [r for r in records if r.mme_ue_s1ap_id == args.ue]
+    if args.task:
+        records = [r for r in records
+                   if _name(task_names, r.origin_task) in args.task or
+                   _name(task_names, r.destination_task) in args.task]
+
+    if args.msc:
+        print_msc(task_names, message_names, records, sys.stdout)
+    else:
+        print_timeline(task_names, message_names, records, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
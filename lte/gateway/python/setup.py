@@ -50,6 +50,7 @@ setup(
         'scripts/feg_hello_cli.py',
         'scripts/generate_oai_config.py',
         'scripts/hello_cli.py',
+        'scripts/itti_trace_decode.py',
         'scripts/mobility_cli.py',
         'scripts/ocs_cli.py',
         'scripts/packet_ryu_cli.py',
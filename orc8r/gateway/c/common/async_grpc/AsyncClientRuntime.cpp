@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <stdarg.h>
+
+#include "AsyncClientRuntime.h"
+#include "MetricsSingleton.h"
+#include "ServiceRegistrySingleton.h"
+#include "magma_logging.h"
+
+namespace magma {
+
+// Channels with a different value for this argument get their own connection
+#define CHANNEL_INDEX_ARG "magma.channel_index"
+
+static void observe_histogram(
+    const char* name,
+    double observation,
+    size_t n_labels,
+    ...) {
+  va_list ap;
+  va_start(ap, n_labels);
+  service303::MetricsSingleton::Instance().ObserveHistogram(
+    name, observation, n_labels, ap);
+  va_end(ap);
+}
+
+void observe_client_latency(
+    const char* method,
+    const grpc::Status& status,
+    std::chrono::steady_clock::time_point start_time) {
+  std::chrono::duration<double, std::milli> latency =
+    std::chrono::steady_clock::now() - start_time;
+  observe_histogram(
+    "grpc_client_latency_ms", latency.count(),
+    2, "method", method, "result", status.ok() ? "success" : "failure",
+    (size_t) 6, 1., 5., 10., 50., 100., 1000.);
+}
+
+AsyncClientRuntime& AsyncClientRuntime::get_instance() {
+  static AsyncClientRuntime runtime;
+  return runtime;
+}
+
+AsyncClientRuntime::AsyncClientRuntime()
+  : next_queue_(0),
+    channel_pool_size_(DEFAULT_CHANNEL_POOL_SIZE) {}
+
+void AsyncClientRuntime::start(uint32_t num_queues) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_locked(num_queues);
+}
+
+void AsyncClientRuntime::start_locked(uint32_t num_queues) {
+  if (!queues_.empty()) {
+    return;
+  }
+  for (uint32_t i = 0; i < num_queues; i++) {
+    queues_.emplace_back(new grpc::CompletionQueue());
+  }
+  for (const auto& queue : queues_) {
+    auto queue_p = queue.get();
+    threads_.emplace_back([queue_p]() { drain_queue(queue_p); });
+  }
+  MLOG(MINFO) << "Started async gRPC client runtime with " << num_queues
+    << " completion queues";
+}
+
+void AsyncClientRuntime::stop() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& queue : queues_) {
+    queue->Shutdown();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  queues_.clear();
+}
+
+void AsyncClientRuntime::set_channel_pool_size(uint32_t size) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  channel_pool_size_ = size;
+}
+
+std::vector<std::shared_ptr<grpc::Channel>> AsyncClientRuntime::get_channels(
+    const std::string& service,
+    const std::string& destination) {
+  uint32_t pool_size;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pool_size = channel_pool_size_;
+  }
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  for (uint32_t i = 0; i < pool_size; i++) {
+    grpc::ChannelArguments args;
+    args.SetInt(CHANNEL_INDEX_ARG, i);
+    channels.push_back(ServiceRegistrySingleton::Instance()->GetGrpcChannel(
+      service, destination, args));
+  }
+  return channels;
+}
+
+grpc::CompletionQueue* AsyncClientRuntime::get_queue() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  start_locked(DEFAULT_NUM_QUEUES);
+  return queues_[next_queue_++ % queues_.size()].get();
+}
+
+void AsyncClientRuntime::drain_queue(grpc::CompletionQueue* queue) {
+  void* tag;
+  bool ok = false;
+  while (queue->Next(&tag, &ok)) {
+    auto response = static_cast<AsyncResponse*>(tag);
+    if (!ok) {
+      MLOG(MINFO) << "gRPC client runtime encountered error while processing "
+        << "request";
+      // the call still has to run its callback and be freed
+      response->handle_error();
+      continue;
+    }
+    response->handle_response();
+  }
+}
+
+}
@@ -0,0 +1,301 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <grpc++/grpc++.h>
+
+#include "GRPCReceiver.h"
+
+namespace magma {
+
+/**
+ * AsyncCallOptions sets the deadline of a single call. Calls are not retried:
+ * UNAVAILABLE is also returned when the connection breaks after the request
+ * was sent, so the server may have handled a failed call, and the clients
+ * retry at the application level where it is safe.
+ */
+struct AsyncCallOptions {
+  uint32_t timeout_sec;
+};
+
+/**
+ * Record the latency of a finished call in the grpc_client_latency_ms
+ * histogram, labeled with the method and whether the call succeeded
+ */
+void observe_client_latency(
+  const char* method,
+  const grpc::Status& status,
+  std::chrono::steady_clock::time_point start_time);
+
+/**
+ * AsyncClientCall is one call made through the AsyncClientRuntime. Finished
+ * calls are kept in a per type pool and reused, so that the response message
+ * and callback storage are not allocated for every call. A new ClientContext
+ * is still created for every call, because gRPC does not allow reusing them.
+ */
+template <typename RequestType, typename ResponseType>
+class AsyncClientCall : public AsyncResponse {
+public:
+  using Starter = std::function<
+    std::unique_ptr<grpc::ClientAsyncResponseReader<ResponseType>>(
+      grpc::ClientContext*,
+      const RequestType&,
+      grpc::CompletionQueue*)>;
+  using Callback = std::function<void(grpc::Status, ResponseType)>;
+
+  /**
+   * Take a call from the pool, or allocate one if the pool is empty
+   */
+  static AsyncClientCall* acquire() {
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex_);
+      if (!pool_.empty()) {
+        auto call = pool_.back();
+        pool_.pop_back();
+        return call;
+      }
+    }
+    return new AsyncClientCall();
+  }
+
+  /**
+   * Start the call on the given completion queue
+   */
+  void start(
+      const char* method,
+      const RequestType& request,
+      Starter starter,
+      Callback callback,
+      const AsyncCallOptions& options,
+      grpc::CompletionQueue* queue) {
+    method_ = method;
+    callback_ = std::move(callback);
+    start_time_ = std::chrono::steady_clock::now();
+    context_.reset(new grpc::ClientContext());
+    context_->set_deadline(
+      std::chrono::system_clock::now() +
+      std::chrono::seconds(options.timeout_sec));
+    reader_ = starter(context_.get(), request, queue);
+    reader_->Finish(&response_, &status_, this);
+  }
+
+  void handle_response() override {
+    finish();
+  }
+
+  void handle_error() override {
+    // The call was cancelled, e.g. because the queue is shutting down. The
+    // callback must still run exactly once
+    if (status_.ok()) {
+      status_ = grpc::Status(
+        grpc::StatusCode::CANCELLED, "gRPC client call was cancelled");
+    }
+    finish();
+  }
+
+private:
+  void finish() {
+    observe_client_latency(method_, status_, start_time_);
+    callback_(status_, std::move(response_));
+    release();
+  }
+
+  static const size_t MAX_POOLED_CALLS = 64;
+  static std::mutex pool_mutex_;
+  static std::vector<AsyncClientCall*> pool_;
+
+  const char* method_;
+  Callback callback_;
+  std::chrono::steady_clock::time_point start_time_;
+  ResponseType response_;
+  grpc::Status status_;
+  std::unique_ptr<grpc::ClientContext> context_;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<ResponseType>> reader_;
+
+private:
+  AsyncClientCall() {}
+
+  void release() {
+    callback_ = nullptr;
+    reader_.reset();
+    context_.reset();
+    response_.Clear();
+    status_ = grpc::Status::OK;
+    {
+      std::lock_guard<std::mutex> lock(pool_mutex_);
+      if (pool_.size() < MAX_POOLED_CALLS) {
+        pool_.push_back(this);
+        return;
+      }
+    }
+    delete this;
+  }
+};
+
+template <typename RequestType, typename ResponseType>
+std::mutex AsyncClientCall<RequestType, ResponseType>::pool_mutex_;
+
+template <typename RequestType, typename ResponseType>
+std::vector<AsyncClientCall<RequestType, ResponseType>*>
+  AsyncClientCall<RequestType, ResponseType>::pool_;
+
+/**
+ * AsyncClientRuntime is shared by all asynchronous gRPC clients of a process.
+ * It owns a set of completion queues, each drained by its own thread, and a
+ * pool of channels per service so that calls are spread over several
+ * connections. Calls go through call(), which takes care of deadlines and
+ * latency metrics. Callbacks run on the completion queue
+ * threads, so they should be quick and thread safe.
+ * Here is an example usage:
+ *   StubPool<YourService::Stub> stubs("your_service", LOCAL);
+ *   AsyncClientRuntime::get_instance().call(
+ *     "YourService.YourRPCCall", stubs.get(),
+ *     &YourService::Stub::AsyncYourRPCCall, request, callback, options);
+ */
+class AsyncClientRuntime {
+public:
+  static const uint32_t DEFAULT_NUM_QUEUES = 2;
+  static const uint32_t DEFAULT_CHANNEL_POOL_SIZE = 2;
+
+  static AsyncClientRuntime& get_instance();
+
+  /**
+   * Start num_queues completion queues with one thread each. Does nothing if
+   * the runtime is already running. If start is not called, the runtime
+   * starts with DEFAULT_NUM_QUEUES on the first call
+   */
+  void start(uint32_t num_queues);
+
+  /**
+   * Shut down all queues and wait for their threads to finish. Calls that
+   * are still in flight are dropped
+   */
+  void stop();
+
+  /**
+   * Set how many channels are created per service by get_channels. Only
+   * applies to channels created afterwards
+   */
+  void set_channel_pool_size(uint32_t size);
+
+  /**
+   * Create a pool of channels to a service, each with its own connection
+   * @param service - service name to look up in the service registry
+   * @param destination - ServiceRegistrySingleton::LOCAL or CLOUD
+   */
+  std::vector<std::shared_ptr<grpc::Channel>> get_channels(
+    const std::string& service,
+    const std::string& destination);
+
+  /**
+   * Returns the completion queue to put the next call on, round robin
+   */
+  grpc::CompletionQueue* get_queue();
+
+  /**
+   * Make an asynchronous call
+   * @param method - name of the RPC, used to label metrics
+   * @param stub - stub to make the call on
+   * @param async_method - the Async* method of the stub to call
+   * @param request - request to send
+   * @param callback - called with the final status and response
+   * @param options - deadline of the call
+   */
+  template <typename Stub, typename RequestType, typename ResponseType>
+  void call(
+      const char* method,
+      Stub* stub,
+      std::unique_ptr<grpc::ClientAsyncResponseReader<ResponseType>>
+        (Stub::*async_method)(
+          grpc::ClientContext*,
+          const RequestType&,
+          grpc::CompletionQueue*),
+      const RequestType& request,
+      typename AsyncClientCall<RequestType, ResponseType>::Callback callback,
+      const AsyncCallOptions& options) {
+    auto call = AsyncClientCall<RequestType, ResponseType>::acquire();
+    call->start(
+      method,
+      request,
+      [stub, async_method](
+          grpc::ClientContext* context,
+          const RequestType& req,
+          grpc::CompletionQueue* queue) {
+        return (stub->*async_method)(context, req, queue);
+      },
+      std::move(callback),
+      options,
+      get_queue());
+  }
+
+private:
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<grpc::CompletionQueue>> queues_;
+  std::vector<std::thread> threads_;
+  uint32_t next_queue_;
+  uint32_t channel_pool_size_;
+
+private:
+  AsyncClientRuntime();
+  AsyncClientRuntime(const AsyncClientRuntime&) = delete;
+  AsyncClientRuntime& operator=(const AsyncClientRuntime&) = delete;
+
+  void start_locked(uint32_t num_queues);
+
+  static void drain_queue(grpc::CompletionQueue* queue);
+};
+
+/**
+ * StubPool holds one stub per channel of a channel pool, and hands them out
+ * round robin so that calls are spread over the pool's connections
+ */
+template <typename Stub>
+class StubPool {
+public:
+  StubPool(const std::string& service, const std::string& destination)
+    : next_(0) {
+    auto channels = AsyncClientRuntime::get_instance().get_channels(
+      service, destination);
+    for (const auto& channel : channels) {
+      stubs_.push_back(create_stub(channel));
+    }
+  }
+
+  /**
+   * Create a pool with a single, given channel
+   */
+  explicit StubPool(std::shared_ptr<grpc::Channel> channel) : next_(0) {
+    stubs_.push_back(create_stub(channel));
+  }
+
+  Stub* get() {
+    return stubs_[next_++ % stubs_.size()].get();
+  }
+
+private:
+  std::vector<std::unique_ptr<Stub>> stubs_;
+  std::atomic<uint32_t> next_;
+
+private:
+  static std::unique_ptr<Stub> create_stub(
+      std::shared_ptr<grpc::Channel> channel) {
+    return std::unique_ptr<Stub>(new Stub(channel));
+  }
+};
+
+}
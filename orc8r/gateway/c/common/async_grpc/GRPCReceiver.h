@@ -46,6 +46,15 @@ public:
    * Override handle_response to be called when a response comes into the queue
    */
   virtual void handle_response() = 0;
+
+  /**
+   * Called instead of handle_response when the queue returns the tag with
+   * ok == false. Override it if the tag has to be finished differently, by
+   * default it is handled as a response
+   */
+  virtual void handle_error() {
+    handle_response();
+  }
 };
 
 /**
@@ -63,7 +72,7 @@ public:
   AsyncGRPCResponse(
       std::function<void(grpc::Status, ResponseType)> callback,
       uint32_t timeout_sec)
-      : callback_(callback) {
+      : callback_(std::move(callback)) {
     context_.set_deadline(
       std::chrono::system_clock::now() + std::chrono::seconds(timeout_sec));
   }
@@ -115,10 +124,11 @@ public:
   AsyncLocalResponse(
     std::function<void(grpc::Status, ResponseType)> callback,
     uint32_t timeout_sec)
-  : AsyncGRPCResponse<ResponseType>(callback, timeout_sec) {}
+  : AsyncGRPCResponse<ResponseType>(std::move(callback), timeout_sec) {}
 
   void handle_response() {
-    this->callback_(this->status_, this->response_);
+    // the response is not used after the callback, so hand it over
+    this->callback_(this->status_, std::move(this->response_));
     delete this;
   }
 };
@@ -36,6 +36,8 @@ class ObjectMap {
     ObjectType& object_out) = 0;
 
   virtual ObjectMapResult getall(std::vector<ObjectType>& values_out) = 0;
+
+  virtual ObjectMapResult remove(const std::string& key) = 0;
 };
 
 }
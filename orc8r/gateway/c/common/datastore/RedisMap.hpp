@@ -52,6 +52,43 @@ public:
     return SUCCESS;
   }
 
+  /**
+   * set_all serializes and stores all the given key, object pairs with a
+   * single redis command. Objects that fail to serialize are skipped and
+   * SERIALIZE_FAIL is returned once the rest are stored.
+   */
+  ObjectMapResult set_all(
+      const std::vector<std::pair<std::string, ObjectType>>& objects) {
+    if (objects.empty()) {
+      return SUCCESS;
+    }
+    auto result = SUCCESS;
+    std::vector<std::pair<std::string, std::string>> values;
+    values.reserve(objects.size());
+    for (const auto& object_pair : objects) {
+      std::string value;
+      if (!serializer_(object_pair.second, value)) {
+        MLOG(MERROR) << "Unable to serialize value for key "
+          << object_pair.first;
+        result = SERIALIZE_FAIL;
+        continue;
+      }
+      values.emplace_back(object_pair.first, std::move(value));
+    }
+    if (values.empty()) {
+      // HMSET needs at least one field
+      return result;
+    }
+    auto hmset_future = client_->hmset(hash_, values);
+    client_->sync_commit();
+    if (hmset_future.get().is_error()) {
+      MLOG(MERROR) << "Error setting " << values.size()
+        << " values in redis";
+      return CLIENT_ERROR;
+    }
+    return result;
+  }
+
   /**
    * get returns the object located at key. If the key was not found or the
    * operation was unsuccessful, this returns false
@@ -127,6 +164,31 @@ public:
     return SUCCESS;
   }
 
+  /**
+   * remove deletes the object located at key. Removing a key that doesn't
+   * exist is not an error
+   */
+  ObjectMapResult remove(const std::string& key) override {
+    return remove_all({key});
+  }
+
+  /**
+   * remove_all deletes the objects located at all the given keys with a
+   * single redis command
+   */
+  ObjectMapResult remove_all(const std::vector<std::string>& keys) {
+    if (keys.empty()) {
+      return SUCCESS;
+    }
+    auto hdel_future = client_->hdel(hash_, keys);
+    client_->sync_commit();
+    if (hdel_future.get().is_error()) {
+      MLOG(MERROR) << "Error removing " << keys.size() << " keys from redis";
+      return CLIENT_ERROR;
+    }
+    return SUCCESS;
+  }
+
 private:
   std::shared_ptr<cpp_redis::client> client_;
   std::string hash_;
@@ -9,7 +9,6 @@
 
 #include <ctime>
 #include <iostream>
-#include <thread>
 #include <utility>
 
 #include <orc8r/protos/logging_service.grpc.pb.h>
@@ -32,23 +31,21 @@ LoggingServiceClient::LoggingServiceClient() {
   initializeClient();
 }
 
+const magma::AsyncCallOptions LoggingServiceClient::CALL_OPTIONS = {
+  RESPONSE_TIMEOUT};
+
 LoggingServiceClient &LoggingServiceClient::get_instance() {
   static LoggingServiceClient client_instance;
-  if (client_instance.stub_ == nullptr) {
+  if (client_instance.stubs_ == nullptr) {
     client_instance.initializeClient();
   }
   return client_instance;
 }
 
 void LoggingServiceClient::initializeClient() {
-  auto channel = ServiceRegistrySingleton::Instance()
-      ->GetGrpcChannel("logger", ServiceRegistrySingleton::CLOUD);
-  // Create stub for LoggingService gRPC service
-  stub_ = LoggingService::NewStub(channel);
-  stub_ == nullptr;
-  std::cerr << "Unable to create LoggingServiceClient " << std::endl;
-  std::thread resp_loop_thread([&]() { rpc_response_loop(); });
-  resp_loop_thread.detach();
+  // Create a stub per pooled channel for the LoggingService gRPC service
+  stubs_.reset(new magma::StubPool<LoggingService::Stub>(
+      "logger", ServiceRegistrySingleton::CLOUD));
 }
 
 bool LoggingServiceClient::shouldLog(float samplingRate) {
@@ -66,7 +63,7 @@ int LoggingServiceClient::log_to_scribe(
     float sampling_rate,
     std::function<void(Status, Void)> callback) {
   LoggingServiceClient &client = get_instance();
-  if (client.stub_ == nullptr || !client.shouldLog(sampling_rate)) return 0;
+  if (client.stubs_ == nullptr || !client.shouldLog(sampling_rate)) return 0;
   LogRequest request;
   Void response;
   LoggerDestination dest;
@@ -88,19 +85,12 @@ int LoggingServiceClient::log_to_scribe(
     int val = int_params[i].val;
     (*intMap)[key] = val;
   }
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto local_response = new AsyncLocalResponse<Void>(
-      std::move(callback), RESPONSE_TIMEOUT);
-  // Create a response reader for the `Log` RPC call. This reader
-  // stores the client context, the request to pass in, and the queue to add
-  // the response to when done
-  auto response_reader = client.stub_->AsyncLog(
-      local_response->get_context(), request, &client.queue_);
-  // Set the reader for the local response. This executes the `Log`
-  // response using the response reader. When it is done, the callback stored in
-  // `local_response` will be called
-  local_response->set_response_reader(std::move(response_reader));
+  // Make the `Log` call through the shared client runtime. When it is
+  // answered, the callback will be called on a runtime thread
+  magma::AsyncClientRuntime::get_instance().call(
+      "LoggingService.Log", client.stubs_->get(),
+      &LoggingService::Stub::AsyncLog, request, std::move(callback),
+      CALL_OPTIONS);
   return 0;
 }
 
@@ -112,7 +102,7 @@ void LoggingServiceClient::log_to_scribe(
     float sampling_rate,
     std::function<void(Status, Void)> callback) {
   LoggingServiceClient &client = get_instance();
-  if (client.stub_ == nullptr || !client.shouldLog(sampling_rate)) return;
+  if (client.stubs_ == nullptr || !client.shouldLog(sampling_rate)) return;
   LogRequest request;
   Void response;
   LoggerDestination dest;
@@ -130,17 +120,10 @@ void LoggingServiceClient::log_to_scribe(
   for (const auto &pair : int_params) {
     (*intMap)[pair.first] = pair.second;
   }
-  // Create a raw response pointer that stores a callback to be called when the
-  // gRPC call is answered
-  auto local_response = new AsyncLocalResponse<Void>(
-      std::move(callback), RESPONSE_TIMEOUT);
-  // Create a response reader for the `Log` RPC call. This reader
-  // stores the client context, the request to pass in, and the queue to add
-  // the response to when done
-  auto response_reader = client.stub_->AsyncLog(
-      local_response->get_context(), request, &client.queue_);
-  // Set the reader for the local response. This executes the `Log`
-  // response using the response reader. When it is done, the callback stored in
-  // `local_response` will be called
-  local_response->set_response_reader(std::move(response_reader));
+  // Make the `Log` call through the shared client runtime. When it is
+  // answered, the callback will be called on a runtime thread
+  magma::AsyncClientRuntime::get_instance().call(
+      "LoggingService.Log", client.stubs_->get(),
+      &LoggingService::Stub::AsyncLog, request, std::move(callback),
+      CALL_OPTIONS);
 }
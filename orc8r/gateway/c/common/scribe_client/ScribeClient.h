@@ -14,7 +14,7 @@
 
 #include "scribe_rpc_client.h"
 
-#include "GRPCReceiver.h"
+#include "AsyncClientRuntime.h"
 
 using grpc::Status;
 
@@ -32,7 +32,7 @@ using namespace orc8r;
 /*
  * gRPC client for LoggingService
  */
-class LoggingServiceClient : public GRPCReceiver{
+class LoggingServiceClient {
  public:
   /**
    * Log one scribe entry to the given category on scribe. API for C.
@@ -88,10 +88,11 @@ class LoggingServiceClient : public GRPCReceiver{
  private:
   explicit LoggingServiceClient();
   static LoggingServiceClient& get_instance();
-  std::shared_ptr<LoggingService::Stub> stub_;
+  std::unique_ptr<StubPool<LoggingService::Stub>> stubs_;
   bool shouldLog(float samplingRate);
   void initializeClient();
   static const uint32_t RESPONSE_TIMEOUT = 3; // seconds
+  static const AsyncCallOptions CALL_OPTIONS;
 };
 
 } // namespace magma
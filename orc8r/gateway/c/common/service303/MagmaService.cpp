@@ -11,6 +11,7 @@
 #include <ctime>
 #include <chrono>
 #include <ratio>
+#include <algorithm>
 
 #include <iostream>
 
@@ -42,13 +43,33 @@ using namespace std::chrono;
 MagmaService::MagmaService(const std::string& name, const std::string& version)
     : name_(name), version_(version), health_(ServiceInfo::APP_UNKNOWN),
       start_time_(steady_clock::now()), wall_start_time_(system_clock::now()),
-      service_info_callback_(nullptr)
+      service_info_callback_(nullptr),
+      async_num_queues_(DEFAULT_ASYNC_QUEUES),
+      async_num_threads_(DEFAULT_ASYNC_THREADS),
+      async_request_slots_(DEFAULT_ASYNC_REQUEST_SLOTS)
       {}
 
 void MagmaService::AddServiceToServer(grpc::Service *service) {
   builder_.RegisterService(service);
 }
 
+void MagmaService::AddAsyncServiceToServer(
+    grpc::Service* service,
+    AsyncRequestPoster post_requests) {
+  builder_.RegisterService(service);
+  async_request_posters_.push_back(std::move(post_requests));
+}
+
+void MagmaService::SetAsyncServerRuntime(
+    uint32_t num_queues,
+    uint32_t num_threads,
+    uint32_t request_slots) {
+  async_num_queues_ = std::max(num_queues, 1u);
+  // every queue needs at least one thread draining it
+  async_num_threads_ = std::max(num_threads, async_num_queues_);
+  async_request_slots_ = std::max(request_slots, 1u);
+}
+
 std::unique_ptr<grpc::ServerCompletionQueue>
 MagmaService::GetNewCompletionQueue() {
   return std::move(builder_.AddCompletionQueue());
@@ -61,7 +82,13 @@ void MagmaService::Start() {
       ->GetServiceAddrString(name_);
     builder_.AddListeningPort(service_addr,
                               grpc::InsecureServerCredentials());
+    // queues have to be added before the server is built
+    for (uint32_t i = 0;
+         !async_request_posters_.empty() && i < async_num_queues_; i++) {
+      async_queues_.push_back(builder_.AddCompletionQueue());
+    }
     server_ = builder_.BuildAndStart();
+    startAsyncRuntime();
 }
 
 void MagmaService::WaitForShutdown() {
@@ -70,6 +97,45 @@ void MagmaService::WaitForShutdown() {
 
 void MagmaService::Stop() {
   server_->Shutdown();
+  stopAsyncRuntime();
+}
+
+void MagmaService::startAsyncRuntime() {
+  for (auto& queue : async_queues_) {
+    for (uint32_t slot = 0; slot < async_request_slots_; slot++) {
+      for (const auto& post_requests : async_request_posters_) {
+        post_requests(queue.get());
+      }
+    }
+  }
+  for (uint32_t i = 0; !async_queues_.empty() && i < async_num_threads_; i++) {
+    auto queue = async_queues_[i % async_queues_.size()].get();
+    async_threads_.emplace_back(&MagmaService::drainAsyncQueue, queue);
+  }
+}
+
+void MagmaService::stopAsyncRuntime() {
+  // the server has to be shut down before its queues
+  for (auto& queue : async_queues_) {
+    queue->Shutdown();
+  }
+  for (auto& thread : async_threads_) {
+    thread.join();
+  }
+  async_threads_.clear();
+}
+
+void MagmaService::drainAsyncQueue(grpc::ServerCompletionQueue* queue) {
+  void* tag;
+  bool ok;
+  while (queue->Next(&tag, &ok)) {
+    if (!ok) {
+      // posted requests come back without a call when the server shuts down
+      MLOG(MDEBUG) << "Async server request cancelled";
+      continue;
+    }
+    static_cast<ServerCallData*>(tag)->proceed();
+  }
 }
 
 void MagmaService::SetServiceInfoCallback(ServiceInfoCallback callback) {
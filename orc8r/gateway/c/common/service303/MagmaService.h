@@ -11,6 +11,8 @@
 #include <grpc++/grpc++.h>
 #include <orc8r/protos/service303.grpc.pb.h>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 #include "MetricsRegistry.h"
 #include "MetricsSingleton.h"
@@ -28,6 +30,22 @@ namespace magma { namespace service303 {
 using ServiceInfoMeta = std::map<std::string,std::string>;
 using ServiceInfoCallback = std::function<ServiceInfoMeta()>;
 
+/**
+ * Interface of the tags that async services post on the completion queues of
+ * the MagmaService async server runtime. proceed is called by a runtime
+ * thread when the tag comes off a queue
+ */
+class ServerCallData {
+  public:
+    virtual ~ServerCallData() {}
+    virtual void proceed() = 0;
+};
+
+/**
+ * Posts one request for each RPC of an async service on the given queue
+ */
+using AsyncRequestPoster = std::function<void(grpc::ServerCompletionQueue*)>;
+
 /**
  * MagmaService provides the framework for all Magma services.
  * This class also implements the Service303 interface for external
@@ -35,6 +53,10 @@ using ServiceInfoCallback = std::function<ServiceInfoMeta()>;
  */
 class MagmaService final : public Service303::Service {
   public:
+    static const uint32_t DEFAULT_ASYNC_QUEUES = 1;
+    static const uint32_t DEFAULT_ASYNC_THREADS = 1;
+    static const uint32_t DEFAULT_ASYNC_REQUEST_SLOTS = 1;
+
     MagmaService(const std::string& name, const std::string& version);
 
     /**
@@ -59,6 +81,31 @@ class MagmaService final : public Service303::Service {
      */
     void AddServiceToServer(grpc::Service* service);
 
+    /**
+     * Add an async service to the grpc server before starting. Its requests
+     * are handled by the async server runtime, which is started and stopped
+     * along with the server
+     *
+     * @param service: pointer to service to add
+     * @param post_requests: posts one request of every RPC of the service on
+     *   a queue. It is called request_slots times for every runtime queue
+     */
+    void AddAsyncServiceToServer(
+        grpc::Service* service,
+        AsyncRequestPoster post_requests);
+
+    /**
+     * Configure the async server runtime before starting. Requests of all
+     * async services are spread over num_queues completion queues, which are
+     * drained by num_threads threads. Each queue has request_slots requests
+     * of every RPC posted at all times, so that new calls don't wait for a
+     * handler to post the next request
+     */
+    void SetAsyncServerRuntime(
+        uint32_t num_queues,
+        uint32_t num_threads,
+        uint32_t request_slots);
+
     /**
      * Return a new completion queue for handling async services
      */
@@ -157,6 +204,19 @@ class MagmaService final : public Service303::Service {
      */
     void setMemoryUsage();
 
+    /*
+     * Create the async server queues, post the initial requests and start
+     * the threads draining the queues
+     */
+    void startAsyncRuntime();
+
+    /*
+     * Shut down the async server queues and wait for their threads
+     */
+    void stopAsyncRuntime();
+
+    static void drainAsyncQueue(grpc::ServerCompletionQueue* queue);
+
   private:
     const std::string name_;
     const std::string version_;
@@ -166,6 +226,12 @@ class MagmaService final : public Service303::Service {
     std::unique_ptr<Server> server_;
     grpc::ServerBuilder builder_;
     ServiceInfoCallback service_info_callback_;
+    std::vector<AsyncRequestPoster> async_request_posters_;
+    uint32_t async_num_queues_;
+    uint32_t async_num_threads_;
+    uint32_t async_request_slots_;
+    std::vector<std::unique_ptr<grpc::ServerCompletionQueue>> async_queues_;
+    std::vector<std::thread> async_threads_;
 };
 
 }} // namespace magma::service303
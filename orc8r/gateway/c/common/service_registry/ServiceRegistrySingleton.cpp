@@ -79,10 +79,16 @@ std::string ServiceRegistrySingleton::GetServiceAddrString(
 const std::shared_ptr<Channel> ServiceRegistrySingleton::GetGrpcChannel(
   const std::string& service,
   const std::string& destination){
+    return GetGrpcChannel(service, destination, grpc::ChannelArguments());
+}
+const std::shared_ptr<Channel> ServiceRegistrySingleton::GetGrpcChannel(
+  const std::string& service,
+  const std::string& destination,
+  const grpc::ChannelArguments& channel_args){
     create_grpc_channel_args_t args
       = GetCreateGrpcChannelArgs(service, destination);
     return ServiceRegistrySingleton::CreateGrpcChannel(
-      args.ip, args.port, args.authority);
+      args.ip, args.port, args.authority, channel_args);
 }
 const create_grpc_channel_args_t
 ServiceRegistrySingleton::GetCreateGrpcChannelArgs(
@@ -110,10 +116,10 @@ ServiceRegistrySingleton::GetCreateGrpcChannelArgs(
 const std::shared_ptr<Channel> ServiceRegistrySingleton::CreateGrpcChannel(
   const std::string& ip,
   const std::string& port,
-  const std::string& authority){
+  const std::string& authority,
+  grpc::ChannelArguments arg){
 
   const std::shared_ptr<ChannelCredentials> cred = InsecureChannelCredentials();
-  grpc::ChannelArguments arg;
 
   arg.SetString("grpc.default_authority", authority);
   std::ostringstream ss;
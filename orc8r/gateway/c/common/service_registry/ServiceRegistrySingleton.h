@@ -81,6 +81,16 @@ class ServiceRegistrySingleton {
       const std::string& service,
       const std::string& destination);
 
+    /*
+     * Same as above, but creates the channel with extra channel arguments.
+     * Channels created with different arguments do not share connections.
+     * @param args: extra arguments to create the channel with.
+     */
+    const std::shared_ptr<Channel> GetGrpcChannel(
+      const std::string& service,
+      const std::string& destination,
+      const grpc::ChannelArguments& args);
+
   private:
     ServiceRegistrySingleton(); // Prevent construction
     // Prevent construction by copying
@@ -92,7 +102,8 @@ class ServiceRegistrySingleton {
     const std::shared_ptr<Channel> CreateGrpcChannel(
       const std::string& ip,
       const std::string& port,
-      const std::string& authority);
+      const std::string& authority,
+      grpc::ChannelArguments args);
 private:
     ServiceConfigLoader service_config_loader_;
     std::unique_ptr<YAML::Node> proxy_config_;
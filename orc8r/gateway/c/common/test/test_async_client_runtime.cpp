@@ -0,0 +1,203 @@
+/**
+ * Copyright (c) 2016-present, Facebook, Inc.
+ * All rights reserved.
+ *
+ * This source code is licensed under the BSD-style license found in the
+ * LICENSE file in the root directory of this source tree. An additional grant
+ * of patent rights can be found in the PATENTS file in the same directory.
+ */
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <grpc++/grpc++.h>
+#include <gtest/gtest.h>
+#include <orc8r/protos/service303.grpc.pb.h>
+
+#include "AsyncClientRuntime.h"
+
+using grpc::ServerContext;
+using grpc::Status;
+using magma::orc8r::Service303;
+using magma::orc8r::ServiceInfo;
+using magma::orc8r::Void;
+using ::testing::Test;
+
+namespace magma {
+
+const std::string SERVICE_NAME = "test_service";
+
+/**
+ * Service303 server that answers GetServiceInfo with a configurable status
+ * after a configurable delay, and counts the calls it receives
+ */
+class TestService final : public Service303::Service {
+public:
+  Status GetServiceInfo(
+      ServerContext* context,
+      const Void* request,
+      ServiceInfo* response) override {
+    num_calls++;
+    std::this_thread::sleep_for(delay);
+    response->set_name(SERVICE_NAME);
+    return status;
+  }
+
+  std::atomic<uint32_t> num_calls{0};
+  std::chrono::milliseconds delay{0};
+  Status status = Status::OK;
+};
+
+/**
+ * Collects the results of the calls and the threads their callbacks ran on
+ */
+class CallResults {
+public:
+  AsyncClientCall<Void, ServiceInfo>::Callback callback() {
+    return [this](Status status, ServiceInfo response) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      statuses.push_back(status);
+      responses.push_back(response);
+      threads.push_back(std::this_thread::get_id());
+      cv_.notify_all();
+    };
+  }
+
+  bool wait_for(size_t num_results, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return cv_.wait_for(
+      lock, timeout, [&]() { return statuses.size() >= num_results; });
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return statuses.size();
+  }
+
+  std::vector<Status> statuses;
+  std::vector<ServiceInfo> responses;
+  std::vector<std::thread::id> threads;
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+class AsyncClientRuntimeTest : public ::testing::Test {
+protected:
+  static void SetUpTestCase() {
+    // a single queue, so that every callback runs on the same thread
+    AsyncClientRuntime::get_instance().start(1);
+  }
+
+  static void TearDownTestCase() {
+    AsyncClientRuntime::get_instance().stop();
+  }
+
+  virtual void SetUp() {
+    int port = 0;
+    grpc::ServerBuilder builder;
+    builder.AddListeningPort(
+      "localhost:0", grpc::InsecureServerCredentials(), &port);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    ASSERT_NE(port, 0);
+    stubs_.reset(new StubPool<Service303::Stub>(grpc::CreateChannel(
+      "localhost:" + std::to_string(port),
+      grpc::InsecureChannelCredentials())));
+  }
+
+  virtual void TearDown() {
+    server_->Shutdown(std::chrono::system_clock::now());
+  }
+
+  void call(CallResults& results, uint32_t timeout_sec) {
+    Void request;
+    AsyncClientRuntime::get_instance().call(
+      "Service303.GetServiceInfo", stubs_->get(),
+      &Service303::Stub::AsyncGetServiceInfo, request, results.callback(),
+      {.timeout_sec = timeout_sec});
+  }
+
+  TestService service_;
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<StubPool<Service303::Stub>> stubs_;
+};
+
+TEST_F(AsyncClientRuntimeTest, test_response) {
+  CallResults results;
+
+  call(results, 5);
+  ASSERT_TRUE(results.wait_for(1, std::chrono::seconds(5)));
+  EXPECT_TRUE(results.statuses[0].ok());
+  EXPECT_EQ(results.responses[0].name(), SERVICE_NAME);
+  EXPECT_EQ(service_.num_calls.load(), 1);
+}
+
+TEST_F(AsyncClientRuntimeTest, test_deadline) {
+  CallResults results;
+
+  service_.delay = std::chrono::milliseconds(2000);
+  auto start = std::chrono::steady_clock::now();
+  call(results, 1);
+  ASSERT_TRUE(results.wait_for(1, std::chrono::seconds(5)));
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(
+    results.statuses[0].error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+  EXPECT_GE(elapsed, std::chrono::milliseconds(900));
+  EXPECT_LT(elapsed, std::chrono::milliseconds(1900));
+}
+
+TEST_F(AsyncClientRuntimeTest, test_unavailable_not_retried) {
+  CallResults results;
+
+  service_.status = Status(grpc::StatusCode::UNAVAILABLE, "unavailable");
+  call(results, 5);
+  ASSERT_TRUE(results.wait_for(1, std::chrono::seconds(5)));
+  EXPECT_EQ(results.statuses[0].error_code(), grpc::StatusCode::UNAVAILABLE);
+
+  // give a retry the time to reach the server
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(service_.num_calls.load(), 1);
+  EXPECT_EQ(results.size(), 1);
+}
+
+TEST_F(AsyncClientRuntimeTest, test_unreachable_server) {
+  CallResults results;
+
+  // nothing listens anymore, the call fails without reaching a server
+  server_->Shutdown(std::chrono::system_clock::now());
+  call(results, 5);
+  ASSERT_TRUE(results.wait_for(1, std::chrono::seconds(5)));
+  EXPECT_EQ(results.statuses[0].error_code(), grpc::StatusCode::UNAVAILABLE);
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(results.size(), 1);
+}
+
+TEST_F(AsyncClientRuntimeTest, test_callback_thread) {
+  const size_t num_calls = 20;
+  CallResults results;
+
+  for (size_t i = 0; i < num_calls; i++) {
+    call(results, 5);
+  }
+  ASSERT_TRUE(results.wait_for(num_calls, std::chrono::seconds(5)));
+  for (size_t i = 0; i < num_calls; i++) {
+    EXPECT_TRUE(results.statuses[i].ok());
+    // callbacks run on the completion queue thread, not the caller's
+    EXPECT_NE(results.threads[i], std::this_thread::get_id());
+    EXPECT_EQ(results.threads[i], results.threads[0]);
+  }
+}
+
+} // namespace magma
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}